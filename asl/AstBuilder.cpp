@@ -0,0 +1,328 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AstBuilder - Lower the parser tree to the abstract syntax tree
+//                 of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "AstBuilder.h"
+#include "antlr4-runtime.h"
+#include "AslLexer.h"
+#include "AslParser.h"
+
+#include "../common/SymTable.h"
+#include "../common/AslAst.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>  // std::sort, std::unique
+#include <cstdlib>    // atoi
+
+// using namespace std;
+
+
+// Constructor
+AstBuilder::AstBuilder(SymTable & Symbols) :
+  Symbols{Symbols} {
+}
+
+void AstBuilder::setKeepSource(bool keep) {
+  KeepSource = keep;
+}
+
+AstFunction * AstBuilder::buildFunction(AslParser::FunctionContext *ctx,
+                                        antlr4::ANTLRInputStream & input,
+                                        AstArena & arena) {
+  Arena = &arena;
+  Idents.clear();
+  AstFunction *function = Arena->makeNode<AstFunction>();
+  function->pos  = getPos(ctx->getStart());
+  function->name = buildName(ctx->ID());
+
+  std::vector<AstParam> params;
+  if (ctx->parameters()) {
+    AslParser::ParametersContext *paramsCtx = ctx->parameters();
+    for (std::size_t i = 0; i < paramsCtx->ID().size(); ++i) {
+      AstParam param;
+      param.name = buildName(paramsCtx->ID(i));
+      param.type = buildType(paramsCtx->type(i));
+      params.push_back(param);
+    }
+  }
+  function->params = Arena->makeArray(params);
+
+  if (ctx->type()) {
+    function->hasType = true;
+    function->type    = buildType(ctx->type());
+  }
+
+  std::vector<AstVarDecl> decls;
+  for (auto varDeclCtx : ctx->declarations()->variable_decl()) {
+    std::vector<AstName> names;
+    for (auto id : varDeclCtx->ID()) names.push_back(buildName(id));
+    AstVarDecl decl;
+    decl.names = Arena->makeArray(names);
+    decl.type  = buildType(varDeclCtx->type());
+    decls.push_back(decl);
+  }
+  function->decls = Arena->makeArray(decls);
+
+  function->body = buildStatements(ctx->statements());
+
+  if (KeepSource) {
+    antlr4::Token *start = ctx->getStart(), *stop = ctx->getStop();
+    function->source = Arena->makeText(
+      input.getText(antlr4::misc::Interval(start->getStartIndex(), stop->getStopIndex())));
+    std::sort(Idents.begin(), Idents.end());
+    Idents.erase(std::unique(Idents.begin(), Idents.end()), Idents.end());
+    function->idents = Arena->makeArray(Idents);
+  }
+  Arena = nullptr;
+  return function;
+}
+
+AstArray<AstStmt *> AstBuilder::buildStatements(AslParser::StatementsContext *ctx) {
+  std::vector<AstStmt *> stmts;
+  for (auto stCtx : ctx->statement()) stmts.push_back(buildStatement(stCtx));
+  return Arena->makeArray(stmts);
+}
+
+AstStmt * AstBuilder::buildStatement(AslParser::StatementContext *ctx) {
+  AstStmt *stmt = nullptr;
+  if (auto assignCtx = dynamic_cast<AslParser::AssignStmtContext *>(ctx)) {
+    AstAssignStmt *assign = Arena->makeNode<AstAssignStmt>();
+    assign->kind      = AstStmt::AssignKind;
+    assign->assignPos = getPos(assignCtx->ASSIGN()->getSymbol());
+    assign->left      = buildLeftExpr(assignCtx->left_expr());
+    assign->expr      = buildExpr(assignCtx->expr());
+    stmt = assign;
+  }
+  else if (auto returnCtx = dynamic_cast<AslParser::ReturnStmtContext *>(ctx)) {
+    AstReturnStmt *ret = Arena->makeNode<AstReturnStmt>();
+    ret->kind = AstStmt::ReturnKind;
+    if (returnCtx->expr()) ret->expr = buildExpr(returnCtx->expr());
+    stmt = ret;
+  }
+  else if (auto whileCtx = dynamic_cast<AslParser::WhileStmtContext *>(ctx)) {
+    AstWhileStmt *loop = Arena->makeNode<AstWhileStmt>();
+    loop->kind = AstStmt::WhileKind;
+    loop->cond = buildExpr(whileCtx->expr());
+    loop->body = buildStatements(whileCtx->statements());
+    stmt = loop;
+  }
+  else if (auto ifCtx = dynamic_cast<AslParser::IfStmtContext *>(ctx)) {
+    AstIfStmt *cond = Arena->makeNode<AstIfStmt>();
+    cond->kind     = AstStmt::IfKind;
+    cond->cond     = buildExpr(ifCtx->expr());
+    cond->thenBody = buildStatements(ifCtx->statements(0));
+    if (ifCtx->ELSE()) {
+      cond->hasElse  = true;
+      cond->elseBody = buildStatements(ifCtx->statements(1));
+    }
+    stmt = cond;
+  }
+  else if (auto callCtx = dynamic_cast<AslParser::ProcCallContext *>(ctx)) {
+    AstProcCallStmt *call = Arena->makeNode<AstProcCallStmt>();
+    call->kind   = AstStmt::ProcCallKind;
+    call->callee = buildIdent(callCtx->ident());
+    call->args   = buildArgs(callCtx->expr());
+    stmt = call;
+  }
+  else if (auto readCtx = dynamic_cast<AslParser::ReadStmtContext *>(ctx)) {
+    AstReadStmt *read = Arena->makeNode<AstReadStmt>();
+    read->kind = AstStmt::ReadKind;
+    read->left = buildLeftExpr(readCtx->left_expr());
+    stmt = read;
+  }
+  else if (auto writeCtx = dynamic_cast<AslParser::WriteExprContext *>(ctx)) {
+    AstWriteExprStmt *write = Arena->makeNode<AstWriteExprStmt>();
+    write->kind = AstStmt::WriteExprKind;
+    write->expr = buildExpr(writeCtx->expr());
+    stmt = write;
+  }
+  else {
+    auto writeStrCtx = dynamic_cast<AslParser::WriteStringContext *>(ctx);
+    AstWriteStringStmt *write = Arena->makeNode<AstWriteStringStmt>();
+    write->kind = AstStmt::WriteStringKind;
+    write->text = Arena->makeText(writeStrCtx->STRING()->getText());
+    stmt = write;
+  }
+  stmt->pos = getPos(ctx->getStart());
+  return stmt;
+}
+
+AstExpr * AstBuilder::buildLeftExpr(AslParser::Left_exprContext *ctx) {
+  if (auto identCtx = dynamic_cast<AslParser::LeftExprIdentContext *>(ctx))
+    return buildIdent(identCtx->ident());
+  auto accessCtx = dynamic_cast<AslParser::ArrayAccessLExprContext *>(ctx);
+  AstArrayAccessExpr *access = Arena->makeNode<AstArrayAccessExpr>();
+  access->kind  = AstExpr::ArrayAccessKind;
+  access->pos   = getPos(ctx->getStart());
+  access->array = buildExpr(accessCtx->expr(0));
+  access->index = buildExpr(accessCtx->expr(1));
+  return access;
+}
+
+AstExpr * AstBuilder::buildExpr(AslParser::ExprContext *ctx) {
+  AstExpr *expr = nullptr;
+  if (auto identCtx = dynamic_cast<AslParser::ExprIdentContext *>(ctx)) {
+    return buildIdent(identCtx->ident());
+  }
+  else if (auto valueCtx = dynamic_cast<AslParser::ValueContext *>(ctx)) {
+    AstValueExpr *value = Arena->makeNode<AstValueExpr>();
+    value->kind = AstExpr::ValueKind;
+    if      (valueCtx->INTVAL())   value->basic = AstType::IntegerBasic;
+    else if (valueCtx->FLOATVAL()) value->basic = AstType::FloatBasic;
+    else if (valueCtx->BOOLVAL())  value->basic = AstType::BooleanBasic;
+    else                           value->basic = AstType::CharacterBasic;
+    value->text = Arena->makeText(valueCtx->getText());
+    expr = value;
+  }
+  else if (auto parCtx = dynamic_cast<AslParser::ParenthesisContext *>(ctx)) {
+    AstParenthesisExpr *par = Arena->makeNode<AstParenthesisExpr>();
+    par->kind = AstExpr::ParenthesisKind;
+    par->expr = buildExpr(parCtx->expr());
+    expr = par;
+  }
+  else if (auto accessCtx = dynamic_cast<AslParser::ArrayAccessExprContext *>(ctx)) {
+    AstArrayAccessExpr *access = Arena->makeNode<AstArrayAccessExpr>();
+    access->kind  = AstExpr::ArrayAccessKind;
+    access->array = buildExpr(accessCtx->expr(0));
+    access->index = buildExpr(accessCtx->expr(1));
+    expr = access;
+  }
+  else if (auto unaryCtx = dynamic_cast<AslParser::UnaryArithmeticContext *>(ctx)) {
+    AstUnaryExpr *unary = Arena->makeNode<AstUnaryExpr>();
+    unary->kind = AstExpr::UnaryArithmeticKind;
+    unary->op   = unaryCtx->MINUS() ? AstExpr::MinusOp : AstExpr::PlusOp;
+    unary->expr = buildExpr(unaryCtx->expr());
+    expr = unary;
+  }
+  else if (auto notCtx = dynamic_cast<AslParser::UnaryLogicalContext *>(ctx)) {
+    AstUnaryExpr *unary = Arena->makeNode<AstUnaryExpr>();
+    unary->kind = AstExpr::UnaryLogicalKind;
+    unary->op   = AstExpr::NotOp;
+    unary->expr = buildExpr(notCtx->expr());
+    expr = unary;
+  }
+  else if (auto arithCtx = dynamic_cast<AslParser::ArithmeticContext *>(ctx)) {
+    AstExpr::Operator op;
+    if      (arithCtx->MUL())  op = AstExpr::MulOp;
+    else if (arithCtx->DIV())  op = AstExpr::DivOp;
+    else if (arithCtx->MOD())  op = AstExpr::ModOp;
+    else if (arithCtx->PLUS()) op = AstExpr::PlusOp;
+    else                       op = AstExpr::MinusOp;
+    return buildBinary(AstExpr::ArithmeticKind, op, ctx, arithCtx->op,
+                       arithCtx->expr(0), arithCtx->expr(1));
+  }
+  else if (auto relCtx = dynamic_cast<AslParser::RelationalContext *>(ctx)) {
+    AstExpr::Operator op;
+    if      (relCtx->EQUAL()) op = AstExpr::EqualOp;
+    else if (relCtx->NEQ())   op = AstExpr::NeqOp;
+    else if (relCtx->GT())    op = AstExpr::GtOp;
+    else if (relCtx->LT())    op = AstExpr::LtOp;
+    else if (relCtx->GE())    op = AstExpr::GeOp;
+    else                      op = AstExpr::LeOp;
+    return buildBinary(AstExpr::RelationalKind, op, ctx, relCtx->op,
+                       relCtx->expr(0), relCtx->expr(1));
+  }
+  else if (auto logCtx = dynamic_cast<AslParser::LogicalContext *>(ctx)) {
+    AstExpr::Operator op = logCtx->AND() ? AstExpr::AndOp : AstExpr::OrOp;
+    return buildBinary(AstExpr::LogicalKind, op, ctx, logCtx->op,
+                       logCtx->expr(0), logCtx->expr(1));
+  }
+  else {
+    auto callCtx = dynamic_cast<AslParser::FuncExprContext *>(ctx);
+    AstFuncCallExpr *call = Arena->makeNode<AstFuncCallExpr>();
+    call->kind   = AstExpr::FuncCallKind;
+    call->callee = buildIdent(callCtx->ident());
+    call->args   = buildArgs(callCtx->expr());
+    expr = call;
+  }
+  expr->pos = getPos(ctx->getStart());
+  return expr;
+}
+
+AstBinaryExpr * AstBuilder::buildBinary(AstExpr::Kind kind, AstExpr::Operator op,
+                                        antlr4::ParserRuleContext *ctx, antlr4::Token *opTok,
+                                        AslParser::ExprContext *left,
+                                        AslParser::ExprContext *right) {
+  AstBinaryExpr *binary = Arena->makeNode<AstBinaryExpr>();
+  binary->kind  = kind;
+  binary->pos   = getPos(ctx->getStart());
+  binary->op    = op;
+  binary->opPos = getPos(opTok);
+  binary->left  = buildExpr(left);
+  binary->right = buildExpr(right);
+  return binary;
+}
+
+AstIdentExpr * AstBuilder::buildIdent(AslParser::IdentContext *ctx) {
+  AstIdentExpr *ident = Arena->makeNode<AstIdentExpr>();
+  ident->kind  = AstExpr::IdentKind;
+  ident->pos   = getPos(ctx->getStart());
+  ident->ident = internIdent(ctx->ID()->getSymbol());
+  return ident;
+}
+
+AstArray<AstExpr *> AstBuilder::buildArgs(const std::vector<AslParser::ExprContext *> & ctxs) {
+  std::vector<AstExpr *> args;
+  for (auto exprCtx : ctxs) args.push_back(buildExpr(exprCtx));
+  return Arena->makeArray(args);
+}
+
+AstType AstBuilder::buildType(AslParser::TypeContext *ctx) {
+  AstType type = AstType();
+  AslParser::Basic_typeContext *basicCtx = ctx->basic_type();
+  if      (basicCtx->INT())   type.basic = AstType::IntegerBasic;
+  else if (basicCtx->FLOAT()) type.basic = AstType::FloatBasic;
+  else if (basicCtx->BOOL())  type.basic = AstType::BooleanBasic;
+  else                        type.basic = AstType::CharacterBasic;
+  if (ctx->ARRAY()) {
+    type.isArray = true;
+    type.size    = atoi(ctx->INTVAL()->getText().c_str());
+  }
+  return type;
+}
+
+AstName AstBuilder::buildName(antlr4::tree::TerminalNode *id) {
+  AstName name;
+  name.pos   = getPos(id->getSymbol());
+  name.ident = internIdent(id->getSymbol());
+  return name;
+}
+
+SymTable::IdentId AstBuilder::internIdent(antlr4::Token *tok) {
+  SymTable::IdentId id = Symbols.internIdent(tok->getText());
+  if (KeepSource) Idents.push_back(id);
+  return id;
+}
+
+AstPos AstBuilder::getPos(antlr4::Token *tok) {
+  AstPos pos;
+  pos.line = tok->getLine();
+  pos.col  = tok->getCharPositionInLine();
+  return pos;
+}
@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AstBuilder - Lower the parser tree to the abstract syntax tree
+//                 of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+#include "AslParser.h"
+
+#include "../common/SymTable.h"
+#include "../common/AslAst.h"
+
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class AstBuilder: lowers the parse tree of a function to its AST
+// (see AslAst.h), interning its identifiers in the symbol table.
+// Nothing of the AST refers to the tokens nor to the parse tree, so
+// they can be released as soon as the function has been lowered.
+
+class AstBuilder {
+
+public:
+
+  // Constructor
+  AstBuilder(SymTable & Symbols);
+
+  // Keep the source and the identifiers of each function (for the
+  // function cache)
+  void setKeepSource(bool keep);
+
+  // The AST of the function ctx, allocated in arena. input is the
+  // character stream of the tokens of ctx
+  AstFunction * buildFunction (AslParser::FunctionContext *ctx,
+                               antlr4::ANTLRInputStream & input,
+                               AstArena & arena);
+
+private:
+
+  // Attributes
+  SymTable & Symbols;
+  bool       KeepSource = false;
+  // Arena of the function being lowered
+  AstArena * Arena = nullptr;
+  // Identifiers of the function being lowered (if KeepSource)
+  std::vector<SymTable::IdentId> Idents;
+
+  // Methods to lower each kind of node
+  AstArray<AstStmt *> buildStatements (AslParser::StatementsContext *ctx);
+  AstStmt *           buildStatement  (AslParser::StatementContext *ctx);
+  AstExpr *           buildLeftExpr   (AslParser::Left_exprContext *ctx);
+  AstExpr *           buildExpr       (AslParser::ExprContext *ctx);
+  AstIdentExpr *      buildIdent      (AslParser::IdentContext *ctx);
+  AstArray<AstExpr *> buildArgs       (const std::vector<AslParser::ExprContext *> & ctxs);
+  AstBinaryExpr *     buildBinary     (AstExpr::Kind kind, AstExpr::Operator op,
+                                       antlr4::ParserRuleContext *ctx, antlr4::Token *opTok,
+                                       AslParser::ExprContext *left,
+                                       AslParser::ExprContext *right);
+  AstType             buildType       (AslParser::TypeContext *ctx);
+  AstName             buildName       (antlr4::tree::TerminalNode *id);
+
+  // The IdentId of an identifier token
+  SymTable::IdentId internIdent (antlr4::Token *tok);
+
+  // Position of a token
+  static AstPos getPos (antlr4::Token *tok);
+
+};  // class AstBuilder
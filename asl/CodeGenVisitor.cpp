@@ -1,6 +1,6 @@
 //////////////////////////////////////////////////////////////////////
 //
-//    CodeGenVisitor - Walk the parser tree to do
+//    CodeGenVisitor - Walk the AST to do       
 //                     the generation of code
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -28,14 +28,15 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "CodeGenVisitor.h"
-#include "antlr4-runtime.h"
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
+#include "../common/AslAst.h"
 #include "../common/code.h"
 
 #include <string>
+#include <utility>    // std::move
+#include <iterator>   // std::make_move_iterator
 #include <cstddef>    // std::size_t
 
 // uncomment the following line to enable debugging messages with DEBUG*
@@ -47,11 +48,21 @@
 
 // Constructor
 CodeGenVisitor::CodeGenVisitor(TypesMgr       & Types,
-                               SymTable       & Symbols,
-                               TreeDecoration & Decorations) :
+                               SymTable       & Symbols) :
   Types{Types},
-  Symbols{Symbols},
-  Decorations{Decorations} {
+  Symbols{Symbols} {
+}
+
+void CodeGenVisitor::setReusedSubroutines(const std::map<std::string, subroutine> & subrs) {
+  ReusedSubroutines = subrs;
+}
+
+void CodeGenVisitor::setTrace(TraceWriter *trace) {
+  Trace = trace;
+}
+
+void CodeGenVisitor::setTypeCheck(TypeCheckVisitor *check) {
+  Check = check;
 }
 
 // Accessor/Mutator to the attribute currFunctionType
@@ -63,81 +74,96 @@ void CodeGenVisitor::setCurrentFunctionTy(TypesMgr::TypeId type) {
   currFunctionType = type;
 }
 
+void CodeGenVisitor::beginProgram(AstProgram *program) {
+  Symbols.pushThisScope(program->scope);
+}
+
+subroutine CodeGenVisitor::generateFunction(AstFunction *function) {
+  auto reused = ReusedSubroutines.find(Symbols.getIdentName(function->name.ident));
+  if (reused != ReusedSubroutines.end())
+    return reused->second;
+  return visitFunction(function);
+}
+
+void CodeGenVisitor::endProgram(AstProgram *program) {
+  Symbols.popScope();
+}
+
 // Methods to visit each kind of node:
 //
-antlrcpp::Any CodeGenVisitor::visitProgram(AslParser::ProgramContext *ctx) {
+code CodeGenVisitor::visitProgram(AstProgram *program) {
   DEBUG_ENTER();
   code my_code;
-  SymTable::ScopeId sc = getScopeDecor(ctx);
-  Symbols.pushThisScope(sc);
-  for (auto ctxFunc : ctx->function()) { 
-    subroutine subr = visit(ctxFunc);
-    my_code.add_subroutine(subr);
+  beginProgram(program);
+  for (std::size_t i = 0; i < program->getNumberOfFunctions(); ++i) {
+    my_code.add_subroutine(generateFunction(program->getFunction(i)));
   }
-  Symbols.popScope();
+  endProgram(program);
   DEBUG_EXIT();
   return my_code;
 }
 
-antlrcpp::Any CodeGenVisitor::visitFunction(AslParser::FunctionContext *ctx) {
+subroutine CodeGenVisitor::visitFunction(AstFunction *function) {
   DEBUG_ENTER();
+  const std::string & name = Symbols.getIdentName(function->name.ident);
+  TraceWriter::Span span(Trace, "codegen", name);
   TypesMgr::TypeId t1;
-  if (ctx -> type()) t1 = getTypeDecor(ctx -> type());
+  if (function->hasType) t1 = function->type.type;
   else t1 = Types.createVoidTy();
+  setCurrentFunctionTy(t1);
 
-  SymTable::ScopeId sc = getScopeDecor(ctx);
-  Symbols.pushThisScope(sc);
-  subroutine subr(ctx->ID()->getText());
+  Symbols.pushThisScope(function->scope);
+  if (Check) Check->beginFunction(function);
+  subroutine subr(name);
   codeCounters.reset();
-  std::vector<var> && lvars = visit(ctx->declarations());
+  std::vector<var> lvars = visitDeclarations(function->decls);
   for (auto & onevar : lvars) {
     subr.add_var(onevar);
   }
 
   if (not Types.isVoidTy(t1)) subr.add_param("_result", Types.to_string_basic(t1), Types.isArrayTy(t1)); 
 
-  if (ctx -> parameters()) {
-      std::vector<std::pair<var, TypesMgr::TypeId>> && params = visit(ctx->parameters());
-      for (auto & onevar : params) {
-          subr.add_param(onevar.first.name, onevar.first.type, Types.isArrayTy(onevar.second));
-      }
+  std::vector<std::pair<var, TypesMgr::TypeId>> params = visitParameters(function->params);
+  for (auto & onevar : params) {
+      subr.add_param(onevar.first.name, onevar.first.type, Types.isArrayTy(onevar.second));
   }
 
-  instructionList && code = visit(ctx->statements());
-  code = code || instruction(instruction::RETURN());
-  subr.set_instructions(code);
+  instructionList code = visitStatements(function->body);
+  code = std::move(code) || instruction(instruction::RETURN());
+  subr.set_instructions(std::move(code));
   Symbols.popScope();
   DEBUG_EXIT();
   return subr;
 }
 
-antlrcpp::Any CodeGenVisitor::visitDeclarations(AslParser::DeclarationsContext *ctx) {
+std::vector<var> CodeGenVisitor::visitDeclarations(const AstArray<AstVarDecl> & decls) {
   DEBUG_ENTER();
   std::vector<var> lvars;
-  for (auto & varDeclCtx : ctx->variable_decl()) {
-      std::vector<var> && aux = visit(varDeclCtx);
-      lvars.insert(lvars.end(), aux.begin(), aux.end());
+  for (const AstVarDecl & decl : decls) {
+      std::vector<var> aux = visitVariable_decl(decl);
+      lvars.insert(lvars.end(), std::make_move_iterator(aux.begin()),
+                   std::make_move_iterator(aux.end()));
   }
   DEBUG_EXIT();
   return lvars;
 }
 
-antlrcpp::Any CodeGenVisitor::visitParameters(AslParser::ParametersContext *ctx) {
+std::vector<std::pair<var, TypesMgr::TypeId>> CodeGenVisitor::visitParameters(const AstArray<AstParam> & params) {
   DEBUG_ENTER();
-  std::vector<std::pair<var, TypesMgr::TypeId>> params;
-  for (size_t i = 0; i < ctx->type().size(); ++i) {
-      TypesMgr::TypeId t = getTypeDecor(ctx->type(i));
+  std::vector<std::pair<var, TypesMgr::TypeId>> lparams;
+  for (const AstParam & param : params) {
+      TypesMgr::TypeId t = param.type.type;
       std::size_t size = Types.getSizeOfType(t);
       std::string s = Types.to_string_basic(t);
-      params.push_back({var{ctx->ID(i)->getText(), s , size}, t});
+      lparams.push_back({var{Symbols.getIdentName(param.name.ident), s , size}, t});
   }
   DEBUG_EXIT();
-  return params;
+  return lparams;
 }
 
-antlrcpp::Any CodeGenVisitor::visitVariable_decl(AslParser::Variable_declContext *ctx) {
+std::vector<var> CodeGenVisitor::visitVariable_decl(const AstVarDecl & decl) {
   DEBUG_ENTER();
-  TypesMgr::TypeId   t1 = getTypeDecor(ctx->type());
+  TypesMgr::TypeId   t1 = decl.type.type;
   std::size_t      size = Types.getSizeOfType(t1);
   std::vector<var> lvars;
 
@@ -161,43 +187,107 @@ antlrcpp::Any CodeGenVisitor::visitVariable_decl(AslParser::Variable_declContext
   //  t1 = Types.getArrayElemType(t1);
   // ----------------------------------
 
-  for (auto& a : ctx -> ID()) lvars.push_back(var{a ->getText(), Types.to_string_basic(t1), size}); 
+  for (const AstName & a : decl.names) lvars.push_back(var{Symbols.getIdentName(a.ident), Types.to_string_basic(t1), size}); 
   DEBUG_EXIT();
   return lvars;
 }
 
-antlrcpp::Any CodeGenVisitor::visitStatements(AslParser::StatementsContext *ctx) {
+instructionList CodeGenVisitor::visitStatements(const AstArray<AstStmt *> & stmts) {
   DEBUG_ENTER();
   instructionList code;
-  for (auto stCtx : ctx->statement()) {
-    instructionList && codeS = visit(stCtx);
-    code = code || codeS;
+  for (AstStmt *stmt : stmts) {
+    // in the fused mode a statement is checked right before its code
+    // is generated (the nested ones, by the nested visitStatements);
+    // once there are errors no more code is generated
+    if (Check) {
+      Check->checkStatementHead(stmt);
+      if (Check->hasErrors()) {
+        Check->checkStatementBodies(stmt);
+        continue;
+      }
+    }
+    instructionList codeS = visitStatement(stmt);
+    code = std::move(code) || std::move(codeS);
   }
   DEBUG_EXIT();
   return code;
 }
 
+instructionList CodeGenVisitor::visitStatement(AstStmt *stmt) {
+  switch (stmt->kind) {
+  case AstStmt::AssignKind:
+    return visitAssignStmt(static_cast<AstAssignStmt *>(stmt));
+  case AstStmt::ReturnKind:
+    return visitReturnStmt(static_cast<AstReturnStmt *>(stmt));
+  case AstStmt::WhileKind:
+    return visitWhileStmt(static_cast<AstWhileStmt *>(stmt));
+  case AstStmt::IfKind:
+    return visitIfStmt(static_cast<AstIfStmt *>(stmt));
+  case AstStmt::ProcCallKind:
+    return visitProcCall(static_cast<AstProcCallStmt *>(stmt));
+  case AstStmt::ReadKind:
+    return visitReadStmt(static_cast<AstReadStmt *>(stmt));
+  case AstStmt::WriteExprKind:
+    return visitWriteExpr(static_cast<AstWriteExprStmt *>(stmt));
+  case AstStmt::WriteStringKind:
+    return visitWriteString(static_cast<AstWriteStringStmt *>(stmt));
+  }
+  return instructionList();
+}
+
+// the code of a left expression: the address (and the offset) where
+// its value is stored
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitLeftExpr(AstExpr *expr) {
+  if (expr->kind == AstExpr::ArrayAccessKind)
+    return visitArrayAccessLExpr(static_cast<AstArrayAccessExpr *>(expr));
+  return visitIdent(static_cast<AstIdentExpr *>(expr));
+}
+
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitExpr(AstExpr *expr) {
+  switch (expr->kind) {
+  case AstExpr::IdentKind:
+    return visitIdent(static_cast<AstIdentExpr *>(expr));
+  case AstExpr::ValueKind:
+    return visitValue(static_cast<AstValueExpr *>(expr));
+  case AstExpr::ParenthesisKind:
+    return visitParenthesis(static_cast<AstParenthesisExpr *>(expr));
+  case AstExpr::ArrayAccessKind:
+    return visitArrayAccessExpr(static_cast<AstArrayAccessExpr *>(expr));
+  case AstExpr::UnaryArithmeticKind:
+    return visitUnaryArithmetic(static_cast<AstUnaryExpr *>(expr));
+  case AstExpr::UnaryLogicalKind:
+    return visitUnaryLogical(static_cast<AstUnaryExpr *>(expr));
+  case AstExpr::ArithmeticKind:
+    return visitArithmetic(static_cast<AstBinaryExpr *>(expr));
+  case AstExpr::RelationalKind:
+    return visitRelational(static_cast<AstBinaryExpr *>(expr));
+  case AstExpr::LogicalKind:
+    return visitLogical(static_cast<AstBinaryExpr *>(expr));
+  case AstExpr::FuncCallKind:
+    return visitFuncExpr(static_cast<AstFuncCallExpr *>(expr));
+  }
+  return CodeAttribs();
+}
+
 
-antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx) {
+instructionList CodeGenVisitor::visitAssignStmt(AstAssignStmt *stmt) {
   DEBUG_ENTER();
-  CodeAttribs     && codAtsE1 = visit(ctx->left_expr());
+  CodeAttribs        codAtsE1 = visitLeftExpr(stmt->left);
   std::string           addr1 = codAtsE1.addr;
   std::string           offs1 = codAtsE1.offs;
-  instructionList &     code1 = codAtsE1.code;
-  TypesMgr::TypeId tid1 = getTypeDecor(ctx->left_expr());
+  TypesMgr::TypeId tid1 = stmt->left->type;
 
-  CodeAttribs     && codAtsE2 = visit(ctx->expr());
+  CodeAttribs        codAtsE2 = visitExpr(stmt->expr);
   std::string           addr2 = codAtsE2.addr;
   // std::string           offs2 = codAtsE2.offs;
-  instructionList &     code2 = codAtsE2.code;
-  TypesMgr::TypeId tid2 = getTypeDecor(ctx->expr());
+  TypesMgr::TypeId tid2 = stmt->expr->type;
 
-  instructionList code = code1 || code2;
+  instructionList code = std::move(codAtsE1.code) || std::move(codAtsE2.code);
 
   // type coertion int->float
   if (Types.isFloatTy(tid1) and Types.isIntegerTy(tid2)) {
       std::string temp = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp, addr2);
+      code = std::move(code) || instruction::FLOAT(temp, addr2);
       addr2 = temp;
   }
 
@@ -212,13 +302,13 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
       std::string temp = "%"+codeCounters.newTEMP();
       std::string temp2 = "%"+codeCounters.newTEMP();
 
-      if (Symbols.isParameterClass(ctx -> left_expr() -> getText())) {
-          code = code || instruction::LOAD(temp, addr1);
+      if (isParameterDecor(stmt->left)) {
+          code = std::move(code) || instruction::LOAD(temp, addr1);
           addr1 = temp;
       }
 
-      if (Symbols.isParameterClass(ctx -> expr() -> getText())) {
-          code = code || instruction::LOAD(temp2, addr2);
+      if (isParameterDecor(stmt->expr)) {
+          code = std::move(code) || instruction::LOAD(temp2, addr2);
           addr2 = temp2;
       }
 
@@ -230,54 +320,54 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
       std::string temp7 = "%"+codeCounters.newTEMP();
 
       //n
-      code = code || instruction::ILOAD(temp3, std::to_string(n));
+      code = std::move(code) || instruction::ILOAD(temp3, std::to_string(n));
       //i
-      code = code || instruction::ILOAD(temp4, "0");
+      code = std::move(code) || instruction::ILOAD(temp4, "0");
       //inc en 1
-      code = code || instruction::ILOAD(temp7, "1");
+      code = std::move(code) || instruction::ILOAD(temp7, "1");
 
       std::string initWhile = "labelWhile" + codeCounters.newLabelWHILE();
       std::string endWhile = "endWhile" + codeCounters.newLabelWHILE();
       
-      code = code || instruction::LABEL(initWhile);
-      code = code || instruction::LT(temp5, temp4, temp3);
-      code = code || instruction::FJUMP(temp5, endWhile);
-      code = code || instruction::LOADX(temp6, addr2, temp4);
-      code = code || instruction::XLOAD(addr1, temp4, temp6);
-      code = code || instruction::ADD(temp4, temp4, temp7);
-      code = code || instruction::UJUMP(initWhile);
-      code = code || instruction::LABEL(endWhile);
+      code = std::move(code) || instruction::LABEL(initWhile);
+      code = std::move(code) || instruction::LT(temp5, temp4, temp3);
+      code = std::move(code) || instruction::FJUMP(temp5, endWhile);
+      code = std::move(code) || instruction::LOADX(temp6, addr2, temp4);
+      code = std::move(code) || instruction::XLOAD(addr1, temp4, temp6);
+      code = std::move(code) || instruction::ADD(temp4, temp4, temp7);
+      code = std::move(code) || instruction::UJUMP(initWhile);
+      code = std::move(code) || instruction::LABEL(endWhile);
   }
   
   // load
-  if (offs1 == "") code = code || instruction::LOAD(addr1, addr2);
-  else code = code || instruction::XLOAD(addr1, offs1, addr2);
+  if (offs1 == "") code = std::move(code) || instruction::LOAD(addr1, addr2);
+  else code = std::move(code) || instruction::XLOAD(addr1, offs1, addr2);
   
   DEBUG_EXIT();
   return code;
 }
 
-antlrcpp::Any CodeGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
+instructionList CodeGenVisitor::visitIfStmt(AstIfStmt *stmt) {
   DEBUG_ENTER();
   instructionList code;
-  CodeAttribs     && codAtsE = visit(ctx->expr());
+  CodeAttribs        codAtsE = visitExpr(stmt->cond);
   std::string          addr1 = codAtsE.addr;
-  instructionList &    code1 = codAtsE.code;
-  instructionList &&   code2 = visit(ctx->statements(0));
+  instructionList      code1 = std::move(codAtsE.code);
+  instructionList      code2 = visitStatements(stmt->thenBody);
   std::string label = codeCounters.newLabelIF();
   std::string labelEndIf = "endif"+label;
 
-  if (not ctx -> ELSE()) {
-      code = code1 || instruction::FJUMP(addr1, labelEndIf) ||
-          code2 || instruction::LABEL(labelEndIf);
+  if (not stmt->hasElse) {
+      code = std::move(code1) || instruction::FJUMP(addr1, labelEndIf) ||
+          std::move(code2) || instruction::LABEL(labelEndIf);
   }
 
   else {
       std::string label2 = codeCounters.newLabelIF();
       std::string labelEndElse = "endelse"+label;
-      instructionList &&   code3 = visit(ctx->statements(1));
-      code = code1 || instruction::FJUMP(addr1, labelEndIf) ||
-          code2 || instruction::UJUMP(labelEndElse) ||instruction::LABEL(labelEndIf) || code3
+      instructionList      code3 = visitStatements(stmt->elseBody);
+      code = std::move(code1) || instruction::FJUMP(addr1, labelEndIf) ||
+          std::move(code2) || instruction::UJUMP(labelEndElse) ||instruction::LABEL(labelEndIf) || std::move(code3)
           || instruction::LABEL(labelEndElse);
   }
   DEBUG_EXIT();
@@ -285,398 +375,377 @@ antlrcpp::Any CodeGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
 }
 
 
-antlrcpp::Any CodeGenVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
+instructionList CodeGenVisitor::visitReadStmt(AstReadStmt *stmt) {
   DEBUG_ENTER();
-  CodeAttribs     && codAtsE = visit(ctx->left_expr());
+  CodeAttribs        codAtsE = visitLeftExpr(stmt->left);
 
   std::string          addr1 = codAtsE.addr;
   std::string          offs1 = codAtsE.offs;
 
-  instructionList &    code1 = codAtsE.code;
-  instructionList &     code = code1;
-  TypesMgr::TypeId tid1 = getTypeDecor(ctx->left_expr());
+  instructionList       code = std::move(codAtsE.code);
+  TypesMgr::TypeId tid1 = stmt->left->type;
   
   std::string temp = "%"+codeCounters.newTEMP();
 
-  if (Types.isIntegerTy(tid1) or Types.isBooleanTy(tid1)) code = code1 || instruction::READI(temp);
-  else if (Types.isFloatTy(tid1)) code = code1 || instruction::READF(temp);
-  else if (Types.isCharacterTy(tid1)) code = code1 || instruction::READC(temp);
+  if (Types.isIntegerTy(tid1) or Types.isBooleanTy(tid1)) code = std::move(code) || instruction::READI(temp);
+  else if (Types.isFloatTy(tid1)) code = std::move(code) || instruction::READF(temp);
+  else if (Types.isCharacterTy(tid1)) code = std::move(code) || instruction::READC(temp);
   else std::cout << "Read failed" << std::endl;
 
   //Visentada
   if (offs1 != "") {
-      code = code || instruction::XLOAD(addr1, offs1, temp);
+      code = std::move(code) || instruction::XLOAD(addr1, offs1, temp);
   }
 
-  else code = code || instruction::LOAD(addr1, temp);
+  else code = std::move(code) || instruction::LOAD(addr1, temp);
 
   DEBUG_EXIT();
   return code;
 }
 
-antlrcpp::Any CodeGenVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
+instructionList CodeGenVisitor::visitWriteExpr(AstWriteExprStmt *stmt) {
   DEBUG_ENTER();
-  CodeAttribs     && codAt1 = visit(ctx->expr());
+  CodeAttribs        codAt1 = visitExpr(stmt->expr);
   std::string         addr1 = codAt1.addr;
   // std::string         offs1 = codAt1.offs;
-  instructionList &   code1 = codAt1.code;
-  instructionList &    code = code1;
-  TypesMgr::TypeId tid1 = getTypeDecor(ctx->expr());
+  instructionList      code = std::move(codAt1.code);
+  TypesMgr::TypeId tid1 = stmt->expr->type;
 
-  if (Types.isIntegerTy(tid1)) code = code1 || instruction::WRITEI(addr1);
-  else if (Types.isCharacterTy(tid1)) code = code1 || instruction::WRITEC(addr1);
-  else if (Types.isBooleanTy(tid1)) code = code1 || instruction::WRITEI(addr1);
-  else if (Types.isFloatTy(tid1)) code = code1 || instruction::WRITEF(addr1);
+  if (Types.isIntegerTy(tid1)) code = std::move(code) || instruction::WRITEI(addr1);
+  else if (Types.isCharacterTy(tid1)) code = std::move(code) || instruction::WRITEC(addr1);
+  else if (Types.isBooleanTy(tid1)) code = std::move(code) || instruction::WRITEI(addr1);
+  else if (Types.isFloatTy(tid1)) code = std::move(code) || instruction::WRITEF(addr1);
 
   DEBUG_EXIT();
   return code;
 }
 
-antlrcpp::Any CodeGenVisitor::visitWriteString(AslParser::WriteStringContext *ctx) {
+instructionList CodeGenVisitor::visitWriteString(AstWriteStringStmt *stmt) {
   DEBUG_ENTER();
   instructionList code;
-  std::string s = ctx->STRING()->getText();
-  code = code || instruction::WRITES(s);
+  std::string s = stmt->text;
+  code = std::move(code) || instruction::WRITES(s);
   DEBUG_EXIT();
   return code;
 }
 
-antlrcpp::Any CodeGenVisitor::visitLeftExprIdent(AslParser::LeftExprIdentContext *ctx) {
-  DEBUG_ENTER();
-  CodeAttribs && codAts = visit(ctx->ident());
-  DEBUG_EXIT();
-  return codAts;
-}
-
 //a[2] + 3
-antlrcpp::Any CodeGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitArithmetic(AstBinaryExpr *expr) {
   DEBUG_ENTER();
-  CodeAttribs     && codAt1 = visit(ctx->expr(0));
+  CodeAttribs        codAt1 = visitExpr(expr->left);
   std::string         addr1 = codAt1.addr;
-  instructionList &   code1 = codAt1.code;
-  CodeAttribs     && codAt2 = visit(ctx->expr(1));
+  CodeAttribs        codAt2 = visitExpr(expr->right);
   std::string         addr2 = codAt2.addr;
-  instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
-  TypesMgr::TypeId  t = getTypeDecor(ctx);
+  instructionList      code = std::move(codAt1.code) || std::move(codAt2.code);
+  TypesMgr::TypeId t1 = expr->left->type;
+  TypesMgr::TypeId t2 = expr->right->type;
+  TypesMgr::TypeId  t = expr->type;
   std::string temp = "%"+codeCounters.newTEMP();
-  //else if (ctx -> MOD()) code = code || instruction::MUL(temp, addr1, addr2);
+  //else if (expr->op == AstExpr::ModOp) code = std::move(code) || instruction::MUL(temp, addr1, addr2);
 
   if (Types.isFloatTy(t)) {
       if (Types.isIntegerTy(t1)) {
           std::string temp2 = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp2, addr1);
+          code = std::move(code) || instruction::FLOAT(temp2, addr1);
           addr1 = temp2;
       }
       else if (Types.isIntegerTy(t2)) {
           std::string temp2 = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp2, addr2);
+          code = std::move(code) || instruction::FLOAT(temp2, addr2);
           addr2 = temp2;
       }
 
-      if (ctx->MUL())
-          code = code || instruction::FMUL(temp, addr1, addr2);
-      else if (ctx -> DIV())
-          code = code || instruction::FDIV(temp, addr1, addr2);
-      else if (ctx -> PLUS())
-          code = code || instruction::FADD(temp, addr1, addr2);
-      else if (ctx -> MINUS())
-          code = code || instruction::FSUB(temp, addr1, addr2);
+      if (expr->op == AstExpr::MulOp)
+          code = std::move(code) || instruction::FMUL(temp, addr1, addr2);
+      else if (expr->op == AstExpr::DivOp)
+          code = std::move(code) || instruction::FDIV(temp, addr1, addr2);
+      else if (expr->op == AstExpr::PlusOp)
+          code = std::move(code) || instruction::FADD(temp, addr1, addr2);
+      else if (expr->op == AstExpr::MinusOp)
+          code = std::move(code) || instruction::FSUB(temp, addr1, addr2);
   }
 
   else {
-      if (ctx->MUL())
-          code = code || instruction::MUL(temp, addr1, addr2);
-      else if (ctx -> DIV())
-          code = code || instruction::DIV(temp, addr1, addr2);
-      else if (ctx -> PLUS())
-          code = code || instruction::ADD(temp, addr1, addr2);
-      else if (ctx -> MINUS())
-          code = code || instruction::SUB(temp, addr1, addr2);
-      else if (ctx -> MOD()) {
-          code = code || instruction::DIV(temp, addr1, addr2);
-          code = code || instruction::MUL(temp, temp, addr2);
-          code = code || instruction::SUB(temp, addr1, temp);
+      if (expr->op == AstExpr::MulOp)
+          code = std::move(code) || instruction::MUL(temp, addr1, addr2);
+      else if (expr->op == AstExpr::DivOp)
+          code = std::move(code) || instruction::DIV(temp, addr1, addr2);
+      else if (expr->op == AstExpr::PlusOp)
+          code = std::move(code) || instruction::ADD(temp, addr1, addr2);
+      else if (expr->op == AstExpr::MinusOp)
+          code = std::move(code) || instruction::SUB(temp, addr1, addr2);
+      else if (expr->op == AstExpr::ModOp) {
+          code = std::move(code) || instruction::DIV(temp, addr1, addr2);
+          code = std::move(code) || instruction::MUL(temp, temp, addr2);
+          code = std::move(code) || instruction::SUB(temp, addr1, temp);
       }
   }
 
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitRelational(AslParser::RelationalContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitRelational(AstBinaryExpr *expr) {
   DEBUG_ENTER();
-  CodeAttribs     && codAt1 = visit(ctx->expr(0));
+  CodeAttribs        codAt1 = visitExpr(expr->left);
   std::string         addr1 = codAt1.addr;
-  instructionList &   code1 = codAt1.code;
-  CodeAttribs     && codAt2 = visit(ctx->expr(1));
+  CodeAttribs        codAt2 = visitExpr(expr->right);
   std::string         addr2 = codAt2.addr;
-  instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
-  //TypesMgr::TypeId  t = getTypeDecor(ctx);
+  instructionList      code = std::move(codAt1.code) || std::move(codAt2.code);
+  TypesMgr::TypeId t1 = expr->left->type;
+  TypesMgr::TypeId t2 = expr->right->type;
+  //TypesMgr::TypeId  t = expr->type;
   std::string temp = "%"+codeCounters.newTEMP();
 
   if (Types.isFloatTy(t1) or Types.isFloatTy(t2)) {
 
       if (Types.isIntegerTy(t1)) {
           std::string temp2 = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp2, addr1);
+          code = std::move(code) || instruction::FLOAT(temp2, addr1);
           addr1 = temp2;
       }
       else if (Types.isIntegerTy(t2)) {
           std::string temp2 = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp2, addr2);
+          code = std::move(code) || instruction::FLOAT(temp2, addr2);
           addr2 = temp2;
       }
 
-      if (ctx -> EQUAL())
-          code = code || instruction::FEQ(temp, addr1, addr2);
-      else if (ctx -> NEQ()) {
-          code = code || instruction::FEQ(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      if (expr->op == AstExpr::EqualOp)
+          code = std::move(code) || instruction::FEQ(temp, addr1, addr2);
+      else if (expr->op == AstExpr::NeqOp) {
+          code = std::move(code) || instruction::FEQ(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> GT()) {
-          code = code || instruction::FLE(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      else if (expr->op == AstExpr::GtOp) {
+          code = std::move(code) || instruction::FLE(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> LT())
-          code = code || instruction::FLT(temp, addr1, addr2);
-      else if (ctx -> GE()) {
-          code = code || instruction::FLT(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      else if (expr->op == AstExpr::LtOp)
+          code = std::move(code) || instruction::FLT(temp, addr1, addr2);
+      else if (expr->op == AstExpr::GeOp) {
+          code = std::move(code) || instruction::FLT(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> LE())
-          code = code || instruction::FLE(temp, addr1, addr2);
+      else if (expr->op == AstExpr::LeOp)
+          code = std::move(code) || instruction::FLE(temp, addr1, addr2);
   }
 
   else {
-      if (ctx -> EQUAL())
-          code = code || instruction::EQ(temp, addr1, addr2);
-      else if (ctx -> NEQ()) {
-          code = code || instruction::EQ(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      if (expr->op == AstExpr::EqualOp)
+          code = std::move(code) || instruction::EQ(temp, addr1, addr2);
+      else if (expr->op == AstExpr::NeqOp) {
+          code = std::move(code) || instruction::EQ(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> GT()) {
-          code = code || instruction::LE(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      else if (expr->op == AstExpr::GtOp) {
+          code = std::move(code) || instruction::LE(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> LT())
-          code = code || instruction::LT(temp, addr1, addr2);
-      else if (ctx -> GE()) {
-          code = code || instruction::LT(temp, addr1, addr2);
-          code = code || instruction::NOT(temp, temp);
+      else if (expr->op == AstExpr::LtOp)
+          code = std::move(code) || instruction::LT(temp, addr1, addr2);
+      else if (expr->op == AstExpr::GeOp) {
+          code = std::move(code) || instruction::LT(temp, addr1, addr2);
+          code = std::move(code) || instruction::NOT(temp, temp);
       }
-      else if (ctx -> LE())
-          code = code || instruction::LE(temp, addr1, addr2);
+      else if (expr->op == AstExpr::LeOp)
+          code = std::move(code) || instruction::LE(temp, addr1, addr2);
   }
 
-  CodeAttribs codAts(temp, "", code);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitValue(AslParser::ValueContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitValue(AstValueExpr *expr) {
   DEBUG_ENTER();
   instructionList code;
   std::string temp = "%"+codeCounters.newTEMP();
-  TypesMgr::TypeId t1 = getTypeDecor(ctx);
-  if (Types.isBooleanTy(t1)) code = instruction::ILOAD(temp, ctx->getText() == "true" ? "1" : "0");
-  else if (Types.isFloatTy(t1)) code = instruction::FLOAD(temp, ctx->getText());
+  TypesMgr::TypeId t1 = expr->type;
+  if (Types.isBooleanTy(t1)) code = instruction::ILOAD(temp, std::string(expr->text) == "true" ? "1" : "0");
+  else if (Types.isFloatTy(t1)) code = instruction::FLOAD(temp, expr->text);
   else if (Types.isCharacterTy(t1)) {
-      std::string s = ctx -> getText();
+      std::string s = expr->text;
       s = s.substr(1, s.length() - 2);
       code = instruction::CHLOAD(temp, s);
   }
-  else if (Types.isIntegerTy(t1)) code = instruction::ILOAD(temp, ctx->getText());
-  CodeAttribs codAts(temp, "", code);
-  DEBUG_EXIT();
-  return codAts;
-}
-
-antlrcpp::Any CodeGenVisitor::visitExprIdent(AslParser::ExprIdentContext *ctx) {
-  DEBUG_ENTER();
-  CodeAttribs && codAts = visit(ctx->ident());
+  else if (Types.isIntegerTy(t1)) code = instruction::ILOAD(temp, expr->text);
+  CodeAttribs codAts(temp, "", std::move(code));
   DEBUG_EXIT();
   return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitIdent(AslParser::IdentContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitIdent(AstIdentExpr *expr) {
   DEBUG_ENTER();
-  CodeAttribs codAts(ctx->ID()->getText(), "", instructionList());
+  CodeAttribs codAts(Symbols.getIdentName(expr->ident), "", instructionList());
   DEBUG_EXIT();
   return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitParenthesis(AslParser::ParenthesisContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitParenthesis(AstParenthesisExpr *expr) {
     DEBUG_ENTER();
     DEBUG_EXIT();
-    return visit(ctx -> expr());
+    return visitExpr(expr->expr);
 }
 
-antlrcpp::Any CodeGenVisitor::visitUnaryLogical(AslParser::UnaryLogicalContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitUnaryLogical(AstUnaryExpr *expr) {
     DEBUG_ENTER();
-    CodeAttribs     && codAt1 = visit(ctx->expr());
+    CodeAttribs        codAt1 = visitExpr(expr->expr);
     std::string         addr1 = codAt1.addr;
-    instructionList & code = codAt1.code;
+    instructionList     code = std::move(codAt1.code);
     std::string temp = "%"+codeCounters.newTEMP();
 
-    if (ctx -> NOT()) code  = codAt1.code || instruction::NOT(temp, addr1);
+    if (expr->op == AstExpr::NotOp) code = std::move(code) || instruction::NOT(temp, addr1);
 
-    CodeAttribs codAts(temp, "", code);
+    CodeAttribs codAts(temp, "", std::move(code));
     
     DEBUG_EXIT();
 
     return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitLogical(AslParser::LogicalContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitLogical(AstBinaryExpr *expr) {
     DEBUG_ENTER();
-    CodeAttribs     && codAt1 = visit(ctx->expr(0));
+    CodeAttribs        codAt1 = visitExpr(expr->left);
     std::string         addr1 = codAt1.addr;
-    instructionList &   code1 = codAt1.code;
-    CodeAttribs     && codAt2 = visit(ctx->expr(1));
+    CodeAttribs        codAt2 = visitExpr(expr->right);
     std::string         addr2 = codAt2.addr;
-    instructionList &   code2 = codAt2.code;
-    instructionList &&   code = code1 || code2;
+    instructionList      code = std::move(codAt1.code) || std::move(codAt2.code);
 
     std::string temp = "%"+codeCounters.newTEMP();
 
-    if (ctx -> AND()) code = code || instruction::AND(temp, addr1, addr2);
-    else if (ctx -> OR()) code = code || instruction::OR(temp, addr1, addr2);
+    if (expr->op == AstExpr::AndOp) code = std::move(code) || instruction::AND(temp, addr1, addr2);
+    else if (expr->op == AstExpr::OrOp) code = std::move(code) || instruction::OR(temp, addr1, addr2);
 
-    CodeAttribs codAts(temp, "", code);
+    CodeAttribs codAts(temp, "", std::move(code));
     DEBUG_EXIT();
     return codAts;
 }
 
-antlrcpp::Any CodeGenVisitor::visitUnaryArithmetic(AslParser::UnaryArithmeticContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitUnaryArithmetic(AstUnaryExpr *expr) {
     DEBUG_ENTER();
-    CodeAttribs     && codAt1 = visit(ctx->expr());
+    CodeAttribs        codAt1 = visitExpr(expr->expr);
     std::string         addr1 = codAt1.addr;
-    instructionList &   code1 = codAt1.code;
-    TypesMgr::TypeId  t = getTypeDecor(ctx);
+    instructionList     code1 = std::move(codAt1.code);
+    TypesMgr::TypeId  t = expr->type;
 
-    if (ctx -> MINUS()) {
+    if (expr->op == AstExpr::MinusOp) {
         std::string temp = "%"+codeCounters.newTEMP();
-        if (Types.isFloatTy(t)) code1 = code1 || instruction::FNEG(temp, addr1);
-        else code1 = code1 || instruction::NEG(temp, addr1);
+        if (Types.isFloatTy(t)) code1 = std::move(code1) || instruction::FNEG(temp, addr1);
+        else code1 = std::move(code1) || instruction::NEG(temp, addr1);
         addr1 = temp;
     }
 
-    CodeAttribs codAts(addr1, "", code1);
+    CodeAttribs codAts(addr1, "", std::move(code1));
     DEBUG_EXIT();
     return codAts;
 }
 
 
-antlrcpp::Any CodeGenVisitor::visitWhileStmt(AslParser::WhileStmtContext *ctx) {
+instructionList CodeGenVisitor::visitWhileStmt(AstWhileStmt *stmt) {
     DEBUG_ENTER();
     std::string count = codeCounters.newLabelWHILE();
     std::string initWhile = "while" + count;
     std::string endWhile = "endWhile" + count;
     instructionList && code1 = instruction::LABEL(initWhile);
 
-    CodeAttribs     && codAt1 = visit(ctx->expr());
+    CodeAttribs        codAt1 = visitExpr(stmt->cond);
     std::string         addr1 = codAt1.addr;
 
-    code1 = code1 || codAt1.code;
-    code1 = code1 || instruction::FJUMP(codAt1.addr, endWhile);
+    code1 = std::move(code1) || std::move(codAt1.code);
+    code1 = std::move(code1) || instruction::FJUMP(codAt1.addr, endWhile);
 
-    instructionList && code2 = visit(ctx->statements());
+    instructionList code2 = visitStatements(stmt->body);
 
-    code1 = code1 || code2;
-    code1 = code1 || instruction::UJUMP(initWhile);
-    code1 = code1 || instruction::LABEL(endWhile);
+    code1 = std::move(code1) || std::move(code2);
+    code1 = std::move(code1) || instruction::UJUMP(initWhile);
+    code1 = std::move(code1) || instruction::LABEL(endWhile);
 
     DEBUG_EXIT();
     return code1;
 }
 
 
-// Getters for the necessary tree node atributes:
-//   Scope and Type
-SymTable::ScopeId CodeGenVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) const {
-  return Decorations.getScope(ctx);
-}
-TypesMgr::TypeId CodeGenVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) const {
-  return Decorations.getType(ctx);
+// Only identifier expressions have a symbol class (set by the
+// TypeCheckVisitor), so this is false for any other expression
+bool CodeGenVisitor::isParameterDecor(const AstExpr *expr) {
+  return expr->kind == AstExpr::IdentKind and
+    static_cast<const AstIdentExpr *>(expr)->symClass == SymTable::ParameterId;
 }
 
 
 // Constructors of the class CodeAttribs:
 //
-CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
-                                         const std::string & offs,
-                                         instructionList & code) :
-  addr{addr}, offs{offs}, code{code} {
-}
-
 CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
                                          const std::string & offs,
                                          instructionList && code) :
-  addr{addr}, offs{offs}, code{code} {
+  addr{addr}, offs{offs}, code{std::move(code)} {
 }
 
 
-antlrcpp::Any CodeGenVisitor::visitReturnStmt(AslParser::ReturnStmtContext *ctx) {
+instructionList CodeGenVisitor::visitReturnStmt(AstReturnStmt *stmt) {
     DEBUG_ENTER();
     instructionList code1;
 
-    if (ctx -> expr()) {
-        CodeAttribs     && codAt1 = visit(ctx->expr());
+    if (stmt->expr) {
+        CodeAttribs        codAt1 = visitExpr(stmt->expr);
         std::string         addr1 = codAt1.addr;
-        code1 = codAt1.code || instruction::LOAD("_result", addr1);
+        code1 = std::move(codAt1.code);
+
+        // type coertion: int -> float
+        TypesMgr::TypeId tExpr = stmt->expr->type;
+        if (Types.isIntegerTy(tExpr) and Types.isFloatTy(getCurrentFunctionTy())) {
+          std::string temp = "%"+codeCounters.newTEMP();
+          code1 = std::move(code1) || instruction::FLOAT(temp, addr1);
+          addr1 = temp;
+        }
+        code1 = std::move(code1) || instruction::LOAD("_result", addr1);
     }
 
-    code1 = code1 || instruction::RETURN();
+    code1 = std::move(code1) || instruction::RETURN();
     DEBUG_EXIT();
     return code1;
 }
 
-antlrcpp::Any CodeGenVisitor::visitFuncExpr(AslParser::FuncExprContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitFuncExpr(AstFuncCallExpr *expr) {
     DEBUG_ENTER();
     instructionList && code = instruction::PUSH(); // push _result
 
-    TypesMgr::TypeId tFunc = getTypeDecor(ctx -> ident());
+    TypesMgr::TypeId tFunc = expr->callee->type;
     const std::vector<TypesMgr::TypeId>& functionParams = Types.getFuncParamsTypes(tFunc);
 
-    for (unsigned int i = 0; i < ctx->expr().size(); ++i) {
-        CodeAttribs     && codAt1 = visit(ctx->expr(i));
+    for (unsigned int i = 0; i < expr->args.size(); ++i) {
+        CodeAttribs        codAt1 = visitExpr(expr->args[i]);
         std::string         addr1 = codAt1.addr;
-        code = code || codAt1.code;
+        code = std::move(code) || std::move(codAt1.code);
 
         // type coertion: int -> float
-        TypesMgr::TypeId tExpr = getTypeDecor(ctx->expr(i));
+        TypesMgr::TypeId tExpr = expr->args[i]->type;
         if (Types.isIntegerTy(tExpr) and Types.isFloatTy(functionParams[i])) {
           std::string temp = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp, addr1);
+          code = std::move(code) || instruction::FLOAT(temp, addr1);
           addr1 = temp;
         }
 
-        else if (Types.isArrayTy(tExpr) and not Symbols.isParameterClass(ctx -> expr(i) -> getText())) {
+        else if (Types.isArrayTy(tExpr) and not isParameterDecor(expr->args[i])) {
           std::string temp = "%"+codeCounters.newTEMP();
-          code = code || instruction::ALOAD(temp, addr1);
+          code = std::move(code) || instruction::ALOAD(temp, addr1);
           addr1 = temp;
         }
 
-        code = code || instruction::PUSH(addr1);
+        code = std::move(code) || instruction::PUSH(addr1);
     }
 
-    code = code || instruction::CALL(ctx -> ident() -> getText());
+    code = std::move(code) || instruction::CALL(Symbols.getIdentName(expr->callee->ident));
 
-    for (unsigned int i = 0; i < ctx -> expr().size(); ++i) code = code || instruction::POP();
+    for (unsigned int i = 0; i < expr->args.size(); ++i) code = std::move(code) || instruction::POP();
     
 
     std::string temp = "%"+codeCounters.newTEMP();
 
-    code = code || instruction::POP(temp);
+    code = std::move(code) || instruction::POP(temp);
 
-    CodeAttribs codAts(temp, "", code);
+    CodeAttribs codAts(temp, "", std::move(code));
     
     DEBUG_EXIT();
 
@@ -684,46 +753,46 @@ antlrcpp::Any CodeGenVisitor::visitFuncExpr(AslParser::FuncExprContext *ctx) {
 }
 
 
-antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
+instructionList CodeGenVisitor::visitProcCall(AstProcCallStmt *stmt) {
     DEBUG_ENTER();
     instructionList code;
 
-    TypesMgr::TypeId tFunc = getTypeDecor(ctx -> ident());
+    TypesMgr::TypeId tFunc = stmt->callee->type;
     const std::vector<TypesMgr::TypeId>& functionParams = Types.getFuncParamsTypes(tFunc);
 
-    if (not Types.isVoidFunction(tFunc)) code = code || instruction::PUSH();
+    if (not Types.isVoidFunction(tFunc)) code = std::move(code) || instruction::PUSH();
 
-    for (unsigned int i = 0; i < ctx->expr().size(); ++i) {
-        CodeAttribs     && codAt1 = visit(ctx->expr(i));
+    for (unsigned int i = 0; i < stmt->args.size(); ++i) {
+        CodeAttribs        codAt1 = visitExpr(stmt->args[i]);
         std::string         addr1 = codAt1.addr;
-        code = code || codAt1.code;
+        code = std::move(code) || std::move(codAt1.code);
 
         // type coertion: int -> float
-        TypesMgr::TypeId tExpr = getTypeDecor(ctx->expr(i));
+        TypesMgr::TypeId tExpr = stmt->args[i]->type;
 
         if (Types.isIntegerTy(tExpr) and Types.isFloatTy(functionParams[i])) {
           std::string temp = "%"+codeCounters.newTEMP();
-          code = code || instruction::FLOAT(temp, addr1);
+          code = std::move(code) || instruction::FLOAT(temp, addr1);
           addr1 = temp;
         }
 
-        else if (Types.isArrayTy(tExpr) and not Symbols.isParameterClass(ctx -> expr(i) -> getText())) {
+        else if (Types.isArrayTy(tExpr) and not isParameterDecor(stmt->args[i])) {
           std::string temp = "%"+codeCounters.newTEMP();
-          code = code || instruction::ALOAD(temp, addr1);
+          code = std::move(code) || instruction::ALOAD(temp, addr1);
           addr1 = temp;
         }
 
-        code = code || instruction::PUSH(addr1);
+        code = std::move(code) || instruction::PUSH(addr1);
     }
 
-    code = code || instruction::CALL(ctx -> ident() -> getText());
+    code = std::move(code) || instruction::CALL(Symbols.getIdentName(stmt->callee->ident));
 
-    for (unsigned int i = 0; i < ctx -> expr().size(); ++i) code = code || instruction::POP();
+    for (unsigned int i = 0; i < stmt->args.size(); ++i) code = std::move(code) || instruction::POP();
 
-    if (not Types.isVoidFunction(tFunc)) code = code || instruction::POP();
+    if (not Types.isVoidFunction(tFunc)) code = std::move(code) || instruction::POP();
 
     //std::string temp = "%"+codeCounters.newTEMP();
-    //code = code || instruction::POP(temp);
+    //code = std::move(code) || instruction::POP(temp);
     
     DEBUG_EXIT();
 
@@ -732,61 +801,61 @@ antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
 
 //expr[expr]
 //m[0][0]
-antlrcpp::Any CodeGenVisitor::visitArrayAccessExpr(AslParser::ArrayAccessExprContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitArrayAccessExpr(AstArrayAccessExpr *expr) {
     DEBUG_ENTER();
-    CodeAttribs     && codAt1 = visit(ctx -> expr(0));
+    CodeAttribs        codAt1 = visitExpr(expr->array);
     std::string         addr1 = codAt1.addr;
 
-    CodeAttribs     && codAt2 = visit(ctx -> expr(1));
+    CodeAttribs        codAt2 = visitExpr(expr->index);
     std::string         addr2 = codAt2.addr;
 
-    instructionList && code = codAt1.code || codAt2.code;
+    instructionList code = std::move(codAt1.code) || std::move(codAt2.code);
     
     std::string temp = "%"+codeCounters.newTEMP();
 
-    //TypesMgr::TypeId t = getTypeDecor(ctx->expr(0));
+    //TypesMgr::TypeId t = expr->left->type;
     //t = Types.getArrayElemType(t);
     //std::size_t size = Types.getSizeOfType(t);
 
-    //code = code || instruction::MUL(temp, std::to_string(size), addr2);
+    //code = std::move(code) || instruction::MUL(temp, std::to_string(size), addr2);
 
-    if (Symbols.isParameterClass(ctx -> expr(0) -> getText())) {
+    if (isParameterDecor(expr->array)) {
         std::string temp2 = "%"+codeCounters.newTEMP();
-        code = code || instruction::LOAD(temp2, addr1);
+        code = std::move(code) || instruction::LOAD(temp2, addr1);
         addr1 = temp2;
     }
 
-    code = code || instruction::LOADX(temp, addr1, addr2);
+    code = std::move(code) || instruction::LOADX(temp, addr1, addr2);
 
-    CodeAttribs codAts(temp, "", code);
+    CodeAttribs codAts(temp, "", std::move(code));
     DEBUG_EXIT();
     return codAts;
 }
 
 
-antlrcpp::Any CodeGenVisitor::visitArrayAccessLExpr(AslParser::ArrayAccessLExprContext *ctx) {
+CodeGenVisitor::CodeAttribs CodeGenVisitor::visitArrayAccessLExpr(AstArrayAccessExpr *expr) {
     DEBUG_ENTER();
-    CodeAttribs     && codAt1 = visit(ctx -> expr(0));
+    CodeAttribs        codAt1 = visitExpr(expr->array);
     std::string         addr1 = codAt1.addr;
 
-    CodeAttribs     && codAt2 = visit(ctx -> expr(1));
+    CodeAttribs        codAt2 = visitExpr(expr->index);
     std::string         addr2 = codAt2.addr;
 
-    instructionList && code = codAt1.code || codAt2.code;
+    instructionList code = std::move(codAt1.code) || std::move(codAt2.code);
     
     //std::string temp = "%"+codeCounters.newTEMP();
 
-    //TypesMgr::TypeId t = getTypeDecor(ctx->expr(0));
+    //TypesMgr::TypeId t = expr->left->type;
     //t = Types.getArrayElemType(t);
     //std::size_t size = Types.getSizeOfType(t);
-    //code = code || instruction::MUL(temp, std::to_string(size), addr2);
-    if (Symbols.isParameterClass(ctx -> expr(0) -> getText())) {
+    //code = std::move(code) || instruction::MUL(temp, std::to_string(size), addr2);
+    if (isParameterDecor(expr->array)) {
         std::string temp2 = "%"+codeCounters.newTEMP();
-        code = code || instruction::LOAD(temp2, addr1);
+        code = std::move(code) || instruction::LOAD(temp2, addr1);
         addr1 = temp2;
     }
 
-    CodeAttribs codAts(addr1, addr2, code);
+    CodeAttribs codAts(addr1, addr2, std::move(code));
 
     DEBUG_EXIT();
     return codAts;
@@ -801,14 +870,14 @@ antlrcpp::Any CodeGenVisitor::visitArrayAccessLExpr(AslParser::ArrayAccessLExprC
    std::string initWhile = "while" + countWhile;
    std::string endWhile = "endWhile" + countWhile;
 
-   code = code || instruction::ILOAD(one, "1");
-   code = code || instruction::ILOAD(count, "0");
-   code = code || instruction::ILOAD(lim, LO_QUE_TOQUE);
-   code = code || instruction::LABEL(initWhile);
-   code = code || instruction::LT(leq, count, lim);
-   code = code || instruction::FJUMP(leq, endWhile);
+   code = std::move(code) || instruction::ILOAD(one, "1");
+   code = std::move(code) || instruction::ILOAD(count, "0");
+   code = std::move(code) || instruction::ILOAD(lim, LO_QUE_TOQUE);
+   code = std::move(code) || instruction::LABEL(initWhile);
+   code = std::move(code) || instruction::LT(leq, count, lim);
+   code = std::move(code) || instruction::FJUMP(leq, endWhile);
    //Codigo de dentro
-   code = code || instruction::ADD(count, count, one);
-   code = code || instruction::UJUMP(initWhile);
-   code = code || instruction::LABEL(endWhile);
+   code = std::move(code) || instruction::ADD(count, count, one);
+   code = std::move(code) || instruction::UJUMP(initWhile);
+   code = std::move(code) || instruction::LABEL(endWhile);
 */
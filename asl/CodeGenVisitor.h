@@ -1,6 +1,6 @@
 //////////////////////////////////////////////////////////////////////
 //
-//    CodeGenVisitor - Walk the parser tree to do
+//    CodeGenVisitor - Walk the AST to do       
 //                     the generation of code
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -29,88 +29,63 @@
 
 #pragma once
 
-#include "antlr4-runtime.h"
-#include "AslBaseVisitor.h"
-
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
+#include "../common/AslAst.h"
 #include "../common/code.h"
+#include "../common/TraceWriter.h"
+#include "TypeCheckVisitor.h"
 
+#include <map>
 #include <string>
+#include <vector>
+#include <utility>    // std::pair
 
 // using namespace std;
 
 
 //////////////////////////////////////////////////////////////////////
-// Class CodeGenVisitor: derived from AslBaseVisitor.
-// The tree visitor go through the parser tree and call the methods of
-// this class to generate the code of the program. This is done
-// once the SymbolsVisitor and TypeCheckVisitor have finish with no
-// semantic error. So all the symbols of the program has been added to
-// their respective scope and the type of each expresion has also be
-// computed and decorate the parse tree. In this visit, if some node/method
-// does not have an associated task, it does not have to be visited/called
-// so no redefinition is needed.
-
-class CodeGenVisitor final : public AslBaseVisitor {
+// Class CodeGenVisitor: go through the AST of the program to generate
+// its code. This is done once the SymbolsVisitor and TypeCheckVisitor
+// have finish with no semantic error. So all the symbols of the
+// program has been added to their respective scope and the type of
+// each expresion has also be computed and decorate the AST. Each
+// statement and expression is dispatched on its kind to the method of
+// its node, which returns its code.
+
+class CodeGenVisitor final {
 
 public:
 
   // Constructor
   CodeGenVisitor(TypesMgr       & Types,
-                 SymTable       & Symbols,
-                 TreeDecoration & Decorations);
+                 SymTable       & Symbols);
 
-  // Methods to visit each kind of node:
-  antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
-  antlrcpp::Any visitArrayAccessLExpr(AslParser::ArrayAccessLExprContext *ctx);
-  antlrcpp::Any visitArrayAccessExpr(AslParser::ArrayAccessExprContext *ctx);
-  antlrcpp::Any visitProcCall(AslParser::ProcCallContext *ctx);
-  antlrcpp::Any visitFuncExpr(AslParser::FuncExprContext *ctx);
-  antlrcpp::Any visitReturnStmt(AslParser::ReturnStmtContext *ctx);
-  antlrcpp::Any visitFunction(AslParser::FunctionContext *ctx);
-  antlrcpp::Any visitDeclarations(AslParser::DeclarationsContext *ctx);
-  antlrcpp::Any visitVariable_decl(AslParser::Variable_declContext *ctx);
-  // antlrcpp::Any visitType(AslParser::TypeContext *ctx);
-  antlrcpp::Any visitStatements(AslParser::StatementsContext *ctx);
-  antlrcpp::Any visitAssignStmt(AslParser::AssignStmtContext *ctx);
-  antlrcpp::Any visitIfStmt(AslParser::IfStmtContext *ctx);
-  antlrcpp::Any visitReadStmt(AslParser::ReadStmtContext *ctx);
-  antlrcpp::Any visitWriteExpr(AslParser::WriteExprContext *ctx);
-  antlrcpp::Any visitWriteString(AslParser::WriteStringContext *ctx);
-  antlrcpp::Any visitLeftExprIdent(AslParser::LeftExprIdentContext *ctx);
-  antlrcpp::Any visitExprIdent(AslParser::ExprIdentContext *ctx);
-  antlrcpp::Any visitArithmetic(AslParser::ArithmeticContext *ctx);
-  antlrcpp::Any visitRelational(AslParser::RelationalContext *ctx);
-  antlrcpp::Any visitValue(AslParser::ValueContext *ctx);
-  antlrcpp::Any visitIdent(AslParser::IdentContext *ctx);
-  antlrcpp::Any visitParenthesis(AslParser::ParenthesisContext *ctx);
-  antlrcpp::Any visitUnaryLogical(AslParser::UnaryLogicalContext *ctx);
-  antlrcpp::Any visitUnaryArithmetic(AslParser::UnaryArithmeticContext *ctx);
-  antlrcpp::Any visitLogical(AslParser::LogicalContext *ctx);
-  antlrcpp::Any visitWhileStmt(AslParser::WhileStmtContext *ctx);
-  antlrcpp::Any visitParameters(AslParser::ParametersContext *ctx);
+  // Subroutines generated in a previous compilation: they are used
+  // as they are instead of visiting their functions
+  void setReusedSubroutines(const std::map<std::string, subroutine> & subrs);
 
-private:
+  // Trace where a span is added for each function (null: no trace)
+  void setTrace(TraceWriter *trace);
 
-  // Attributes
-  TypesMgr        & Types;
-  SymTable        & Symbols;
-  TreeDecoration  & Decorations;
-  counters          codeCounters;
-  // Current function type (assigned before visit its instructions)
-  TypesMgr::TypeId currFunctionType;
+  // Type checker of the fused mode: each statement is checked right
+  // before its code is generated, in the same walk (null: the program
+  // has already been checked)
+  void setTypeCheck(TypeCheckVisitor *check);
 
-  // Accessor/Mutator to the type (TypeId) of the current function
-  TypesMgr::TypeId getCurrentFunctionTy ()                      const;
-  void             setCurrentFunctionTy (TypesMgr::TypeId type);
+  // The steps of visitProgram, to generate the program one function
+  // at a time (the fused mode interleaves them with the typecheck):
+  //   - enter the global scope
+  void       beginProgram     (AstProgram *program);
+  //   - the subroutine of a function (the reused one, if any)
+  subroutine generateFunction (AstFunction *function);
+  //   - leave the global scope
+  void       endProgram       (AstProgram *program);
 
-  // Getters for the necessary tree node atributes:
-  //   Scope and Type
-  SymTable::ScopeId getScopeDecor (antlr4::ParserRuleContext *ctx) const;
-  TypesMgr::TypeId  getTypeDecor  (antlr4::ParserRuleContext *ctx) const;
+  // The code of the whole program
+  code       visitProgram     (AstProgram *program);
 
+private:
 
   //////////////////////////////////////////////////////////////////
   // Class CodeAttribs: is declared inside CodeGenVisitor as an
@@ -122,17 +97,18 @@ private:
   class CodeAttribs {
     
   public:
-    // Constructors
-    CodeAttribs(const std::string & addr,
-                const std::string & offs,
-                instructionList & code);
+    // Constructors (the code is moved in, never copied)
+    CodeAttribs() = default;
     CodeAttribs(const std::string & addr,
                 const std::string & offs,
                 instructionList && code);
+    CodeAttribs(const CodeAttribs &) = delete;
+    CodeAttribs & operator=(const CodeAttribs &) = delete;
+    CodeAttribs(CodeAttribs &&) = default;
+    CodeAttribs & operator=(CodeAttribs &&) = default;
 
     // Attributes (publics):
-    // antlrcpp::Any visitArrayAccessLExpr
-    //   - the address that will hold the value of an expression(AslParser::ArrayAccessLExprContext *ctx);
+    //   - the address that will hold the value of an expression
     std::string addr;
     //   - the offset applied to the address (for array access)
     std::string offs;
@@ -140,5 +116,53 @@ private:
     instructionList code;
 
   };  // class CodeAttribs
+
+  // Methods to visit each kind of node:
+  subroutine      visitFunction         (AstFunction *function);
+  std::vector<var> visitDeclarations    (const AstArray<AstVarDecl> & decls);
+  std::vector<var> visitVariable_decl   (const AstVarDecl & decl);
+  std::vector<std::pair<var, TypesMgr::TypeId>>
+                  visitParameters       (const AstArray<AstParam> & params);
+  instructionList visitStatements       (const AstArray<AstStmt *> & stmts);
+  instructionList visitStatement        (AstStmt *stmt);
+  instructionList visitAssignStmt       (AstAssignStmt *stmt);
+  instructionList visitIfStmt           (AstIfStmt *stmt);
+  instructionList visitWhileStmt        (AstWhileStmt *stmt);
+  instructionList visitProcCall         (AstProcCallStmt *stmt);
+  instructionList visitReadStmt         (AstReadStmt *stmt);
+  instructionList visitWriteExpr        (AstWriteExprStmt *stmt);
+  instructionList visitWriteString      (AstWriteStringStmt *stmt);
+  instructionList visitReturnStmt       (AstReturnStmt *stmt);
+  CodeAttribs     visitLeftExpr         (AstExpr *expr);
+  CodeAttribs     visitArrayAccessLExpr (AstArrayAccessExpr *expr);
+  CodeAttribs     visitExpr             (AstExpr *expr);
+  CodeAttribs     visitIdent            (AstIdentExpr *expr);
+  CodeAttribs     visitValue            (AstValueExpr *expr);
+  CodeAttribs     visitParenthesis      (AstParenthesisExpr *expr);
+  CodeAttribs     visitArrayAccessExpr  (AstArrayAccessExpr *expr);
+  CodeAttribs     visitUnaryArithmetic  (AstUnaryExpr *expr);
+  CodeAttribs     visitUnaryLogical     (AstUnaryExpr *expr);
+  CodeAttribs     visitArithmetic       (AstBinaryExpr *expr);
+  CodeAttribs     visitRelational       (AstBinaryExpr *expr);
+  CodeAttribs     visitLogical          (AstBinaryExpr *expr);
+  CodeAttribs     visitFuncExpr         (AstFuncCallExpr *expr);
+
+  // Attributes
+  TypesMgr        & Types;
+  SymTable        & Symbols;
+  counters          codeCounters;
+  // Current function type (assigned before visit its instructions)
+  TypesMgr::TypeId currFunctionType;
+  // Subroutines reused by name
+  std::map<std::string, subroutine> ReusedSubroutines;
+  TraceWriter     * Trace = nullptr;
+  TypeCheckVisitor * Check = nullptr;
+
+  // Accessor/Mutator to the type (TypeId) of the current function
+  TypesMgr::TypeId getCurrentFunctionTy ()                      const;
+  void             setCurrentFunctionTy (TypesMgr::TypeId type);
+
+  // The expression is just the name of a parameter
+  static bool isParameterDecor (const AstExpr *expr);
   
 };  // class CodeGenVisitor
@@ -1,6 +1,6 @@
 //////////////////////////////////////////////////////////////////////
 //
-//    SymbolsVisitor - Walk the parser tree to register symbols
+//    SymbolsVisitor - Walk the AST to register symbols
 //                     for the Asl programming language
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -28,19 +28,16 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "SymbolsVisitor.h"
-#include "antlr4-runtime.h"
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
+#include "../common/AslAst.h"
 #include "../common/SemErrors.h"
 
 #include <iostream>
 #include <string>
 #include <vector>
 
-#include <cstddef>    // std::size_t
-
 // uncomment the following line to enable debugging messages with DEBUG*
 // #define DEBUG_BUILD
 #include "../common/debug.h"
@@ -51,78 +48,81 @@
 // Constructor
 SymbolsVisitor::SymbolsVisitor(TypesMgr       & Types,
                                SymTable       & Symbols,
-                               TreeDecoration & Decorations,
                                SemErrors      & Errors) :
   Types{Types},
   Symbols{Symbols},
-  Decorations{Decorations},
   Errors{Errors} {
 }
 
+void SymbolsVisitor::setTrace(TraceWriter *trace) {
+  Trace = trace;
+}
+
+void SymbolsVisitor::beginProgram(AstProgram *program) {
+  program->scope = Symbols.pushNewScope(SymTable::GLOBAL_SCOPE_NAME);
+}
+
+void SymbolsVisitor::endProgram(AstProgram *program) {
+  // Symbols.print();
+  Symbols.popScope();
+}
+
 // Methods to visit each kind of node:
 //
-antlrcpp::Any SymbolsVisitor::visitProgram(AslParser::ProgramContext *ctx) {
+void SymbolsVisitor::visitProgram(AstProgram *program) {
   DEBUG_ENTER();
-  SymTable::ScopeId sc = Symbols.pushNewScope(SymTable::GLOBAL_SCOPE_NAME);
-  putScopeDecor(ctx, sc);
-  for (auto ctxFunc : ctx->function()) { 
-    visit(ctxFunc);
+  beginProgram(program);
+  for (std::size_t i = 0; i < program->getNumberOfFunctions(); ++i) {
+    visitFunction(program->getFunction(i));
   }
-  // Symbols.print();
-  Symbols.popScope();
+  endProgram(program);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any SymbolsVisitor::visitFunction(AslParser::FunctionContext *ctx) {
+void SymbolsVisitor::visitFunction(AstFunction *function) {
     DEBUG_ENTER();
-    std::string funcName = ctx->ID()->getText();
-    SymTable::ScopeId sc = Symbols.pushNewScope(funcName);
-    putScopeDecor(ctx, sc);
-    std::vector<TypesMgr::TypeId> lParamsTy;
-    if (ctx -> parameters()) {
-        lParamsTy = visit(ctx -> parameters()).as<std::vector<TypesMgr::TypeId>>();
-    }
-    visit(ctx->declarations());
+    std::string funcName = Symbols.getIdentName(function->name.ident);
+    TraceWriter::Span span(Trace, "symbols", funcName);
+    function->scope = Symbols.pushNewScope(funcName);
+    std::vector<TypesMgr::TypeId> lParamsTy = visitParameters(function->params);
+    visitDeclarations(function->decls);
     // Symbols.print();
     Symbols.popScope();
-    std::string ident = ctx->ID()->getText();
-    if (Symbols.findInCurrentScope(ident)) {
-        Errors.declaredIdent(ctx->ID());
+    if (Symbols.findInCurrentScope(funcName)) {
+        Errors.declaredIdent(function->name.pos, funcName);
     }
     else {
         TypesMgr::TypeId tRet = Types.createVoidTy();
 
-        if (ctx -> type()) {
-            visit(ctx -> type());
-            tRet = getTypeDecor(ctx->type());
+        if (function->hasType) {
+            visitType(function->type);
+            tRet = function->type.type;
         }
         TypesMgr::TypeId tFunc = Types.createFunctionTy(lParamsTy, tRet);
-        Symbols.addFunction(ident, tFunc);
+        Symbols.addFunction(funcName, tFunc);
     }
     DEBUG_EXIT();
-    return 0;
 }
 
-antlrcpp::Any SymbolsVisitor::visitDeclarations(AslParser::DeclarationsContext *ctx) {
+void SymbolsVisitor::visitDeclarations(const AstArray<AstVarDecl> & decls) {
   DEBUG_ENTER();
-  visitChildren(ctx);
+  for (auto & decl : decls) visitVarDecl(decl);
   DEBUG_EXIT();
-  return 0;
 }
 
 
-antlrcpp::Any SymbolsVisitor::visitParameters(AslParser::ParametersContext *ctx) {
+std::vector<TypesMgr::TypeId> SymbolsVisitor::visitParameters(const AstArray<AstParam> & params) {
     DEBUG_ENTER();
-    std::vector<TypesMgr::TypeId> lParamsTy((ctx -> ID()).size());
-    for (unsigned int i = 0; i < (ctx -> ID()).size(); ++i) {
-        visit(ctx->type(i));
-        if (Symbols.findInCurrentScope(ctx -> ID(i) -> getText())) {
-            Errors.declaredIdent(ctx -> ID(i));
+    std::vector<TypesMgr::TypeId> lParamsTy(params.size());
+    for (unsigned int i = 0; i < params.size(); ++i) {
+        visitType(params[i].type);
+        const std::string & name = Symbols.getIdentName(params[i].name.ident);
+        if (Symbols.findInCurrentScope(name)) {
+            Errors.declaredIdent(params[i].name.pos, name);
         }
         else {
-            TypesMgr::TypeId t1 = getTypeDecor(ctx->type(i));
-            Symbols.addParameter(ctx -> ID(i) -> getText(), t1);
+            TypesMgr::TypeId t1 = params[i].type.type;
+            Symbols.addParameter(name, t1);
             lParamsTy[i] = t1;
         }
     }
@@ -130,165 +130,33 @@ antlrcpp::Any SymbolsVisitor::visitParameters(AslParser::ParametersContext *ctx)
     return lParamsTy;
 }
 
-antlrcpp::Any SymbolsVisitor::visitVariable_decl(AslParser::Variable_declContext *ctx) {
+void SymbolsVisitor::visitVarDecl(AstVarDecl & decl) {
   DEBUG_ENTER();
-  visit(ctx->type());
-  std::vector<antlr4::tree::TerminalNode*> ident = ctx->ID();
+  visitType(decl.type);
 
-  for (const auto& id: ident) {
-      if (Symbols.findInCurrentScope(id -> getText())) {
-          Errors.declaredIdent(id);
+  for (const auto & id : decl.names) {
+      const std::string & name = Symbols.getIdentName(id.ident);
+      if (Symbols.findInCurrentScope(name)) {
+          Errors.declaredIdent(id.pos, name);
       }
       else {
-          TypesMgr::TypeId t1 = getTypeDecor(ctx->type());
-          Symbols.addLocalVar(id -> getText(), t1);
+          TypesMgr::TypeId t1 = decl.type.type;
+          Symbols.addLocalVar(name, t1);
       }
   }
   DEBUG_EXIT();
-  return 0;
-}
-
-antlrcpp::Any SymbolsVisitor::visitBasic_type(AslParser::Basic_typeContext *ctx) {
-DEBUG_ENTER();
-  if (ctx->INT()) {
-    TypesMgr::TypeId t = Types.createIntegerTy();
-    putTypeDecor(ctx, t);
-  }
-
-  else if (ctx -> BOOL()) {
-    TypesMgr::TypeId t = Types.createBooleanTy();
-    putTypeDecor(ctx, t);
-  }
-
-  else if (ctx -> FLOAT()) {
-    TypesMgr::TypeId t = Types.createFloatTy();
-    putTypeDecor(ctx, t);
-  }
-
-
-  else if (ctx -> CHAR()) {
-    TypesMgr::TypeId t = Types.createCharacterTy();
-    putTypeDecor(ctx, t);
-  }
-
-  DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any SymbolsVisitor::visitType(AslParser::TypeContext *ctx) {
+void SymbolsVisitor::visitType(AstType & type) {
   DEBUG_ENTER();
-
-  visit(ctx -> basic_type());
-  if (ctx -> ARRAY()) {
-    TypesMgr::TypeId t = Types.createArrayTy(atoi(ctx -> INTVAL() -> getText().c_str()), getTypeDecor(ctx -> basic_type()));
-    putTypeDecor(ctx, t);
+  TypesMgr::TypeId t = Types.createErrorTy();
+  switch (type.basic) {
+  case AstType::IntegerBasic:   t = Types.createIntegerTy();   break;
+  case AstType::BooleanBasic:   t = Types.createBooleanTy();   break;
+  case AstType::FloatBasic:     t = Types.createFloatTy();     break;
+  case AstType::CharacterBasic: t = Types.createCharacterTy(); break;
   }
-
-  else putTypeDecor(ctx, getTypeDecor(ctx -> basic_type()));
-
+  if (type.isArray) t = Types.createArrayTy(type.size, t);
+  type.type = t;
   DEBUG_EXIT();
-  return 0;
-}
-
-// antlrcpp::Any SymbolsVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitWriteString(AslParser::WriteStringContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitLeft_expr(AslParser::Left_exprContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitExprIdent(AslParser::ExprIdentContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitRelational(AslParser::RelationalContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitValue(AslParser::ValueContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any SymbolsVisitor::visitIdent(AslParser::IdentContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-
-// Getters for the necessary tree node atributes:
-//   Scope and Type
-SymTable::ScopeId SymbolsVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getScope(ctx);
-}
-TypesMgr::TypeId SymbolsVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getType(ctx);
-}
-
-// Setters for the necessary tree node attributes:
-//   Scope and Type
-void SymbolsVisitor::putScopeDecor(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
-  Decorations.putScope(ctx, s);
-}
-void SymbolsVisitor::putTypeDecor(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
-  Decorations.putType(ctx, t);
 }
@@ -1,6 +1,6 @@
 //////////////////////////////////////////////////////////////////////
 //
-//    SymbolsVisitor - Walk the parser tree to register symbols
+//    SymbolsVisitor - Walk the AST to register symbols
 //                     for the Asl programming language
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -29,74 +29,55 @@
 
 #pragma once
 
-#include "antlr4-runtime.h"
-#include "AslBaseVisitor.h"
-
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
+#include "../common/AslAst.h"
 #include "../common/SemErrors.h"
+#include "../common/TraceWriter.h"
+
+#include <vector>
 
 // using namespace std;
 
 
 //////////////////////////////////////////////////////////////////////
-// Class SymbolVisitor:  derived from AslBaseVisitor.
-// The tree visitor go through the parse tree and call the methods of
-// this class to register the symbols of the program in the symbol
-// table. In this visit, if some node/method does not have an
-// associated task, it does not have to be visited/called so
-// no redefinition is needed.
+// Class SymbolVisitor: goes through the headers and declarations of
+// the functions of the AST to register the symbols of the program in
+// the symbol table. The statements of the functions are not visited.
 
-class SymbolsVisitor final : public AslBaseVisitor {
+class SymbolsVisitor final {
 
 public:
 
   // Constructor
   SymbolsVisitor(TypesMgr       & Types,
                  SymTable       & Symbols,
-                 TreeDecoration & Decorations,
                  SemErrors      & Errors);
 
-  // Methods to visit each kind of node.
-  // Non visited nodes have been commented out:
-  antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
-  antlrcpp::Any visitFunction(AslParser::FunctionContext *ctx);
-  antlrcpp::Any visitDeclarations(AslParser::DeclarationsContext *ctx);
-  antlrcpp::Any visitVariable_decl(AslParser::Variable_declContext *ctx);
-  antlrcpp::Any visitBasic_type(AslParser::Basic_typeContext *ctx);
-  antlrcpp::Any visitType(AslParser::TypeContext *ctx);
-  antlrcpp::Any visitParameters(AslParser::ParametersContext *ctx);
-  //antlrcpp::Any visitArithmetic(AslParser::ArithmeticContext *ctx);
-  // antlrcpp::Any visitStatements(AslParser::StatementsContext *ctx);
-  // antlrcpp::Any visitAssignStmt(AslParser::AssignStmtContext *ctx);
-  // antlrcpp::Any visitIfStmt(AslParser::IfStmtContext *ctx);
-  // antlrcpp::Any visitProcCall(AslParser::ProcCallContext *ctx);
-  // antlrcpp::Any visitReadStmt(AslParser::ReadStmtContext *ctx);
-  // antlrcpp::Any visitWriteExpr(AslParser::WriteExprContext *ctx);
-  // antlrcpp::Any visitWriteString(AslParser::WriteStringContext *ctx);
-  // antlrcpp::Any visitLeft_expr(AslParser::Left_exprContext *ctx);
-  // antlrcpp::Any visitExprIdent(AslParser::ExprIdentContext *ctx);
-  // antlrcpp::Any visitRelational(AslParser::RelationalContext *ctx);
-  // antlrcpp::Any visitValue(AslParser::ValueContext *ctx);
-  // antlrcpp::Any visitIdent(AslParser::IdentContext *ctx);
+  // Trace where a span is added for each function (null: no trace)
+  void setTrace(TraceWriter *trace);
+
+  // The steps of visitProgram, to register the functions one at a
+  // time (as they are lowered to the AST):
+  //   - create the global scope
+  void beginProgram (AstProgram *program);
+  //   - leave the global scope
+  void endProgram   (AstProgram *program);
+
+  // Methods to visit each kind of node:
+  void                          visitProgram      (AstProgram *program);
+  void                          visitFunction     (AstFunction *function);
+  std::vector<TypesMgr::TypeId> visitParameters   (const AstArray<AstParam> & params);
+  void                          visitDeclarations (const AstArray<AstVarDecl> & decls);
+  void                          visitVarDecl      (AstVarDecl & decl);
+  void                          visitType         (AstType & type);
 
 private:
 
   // Attributes:
   TypesMgr       & Types;
   SymTable       & Symbols;
-  TreeDecoration & Decorations;
   SemErrors      & Errors;
-
-  // Getters for the necessary tree node atributes:
-  //   Scope and Type
-  SymTable::ScopeId getScopeDecor (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getTypeDecor  (antlr4::ParserRuleContext *ctx);
-
-  // Setters for the necessary tree node attributes:
-  //   Scope and Type
-  void putScopeDecor (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
-  void putTypeDecor  (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
+  TraceWriter    * Trace = nullptr;
 
 };  // class SymbolsVisitor
@@ -1,5 +1,5 @@
 //////////////////////////////////////////////////////////////////////
-//    TypeCheckVisitor - Walk the parser tree to do the semantic
+//    TypeCheckVisitor - Walk the AST to do the semantic
 //                       typecheck for the Asl programming language
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -27,12 +27,11 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "TypeCheckVisitor.h"
-#include "antlr4-runtime.h"
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "../common/AslAst.h"
 
 #include <iostream>
 #include <string>
@@ -47,14 +46,68 @@
 // Constructor
 TypeCheckVisitor::TypeCheckVisitor(TypesMgr       & Types,
                                    SymTable       & Symbols,
-                                   TreeDecoration & Decorations,
                                    SemErrors      & Errors) :
   Types{Types},
   Symbols{Symbols},
-  Decorations{Decorations},
   Errors{Errors} {
 }
 
+void TypeCheckVisitor::setReusedFunctions(const std::set<std::string> & names) {
+  ReusedFunctions = names;
+}
+
+void TypeCheckVisitor::setTrace(TraceWriter *trace) {
+  Trace = trace;
+}
+
+void TypeCheckVisitor::beginProgram(AstProgram *program) {
+  Symbols.pushThisScope(program->scope);
+}
+
+void TypeCheckVisitor::checkFunction(AstFunction *function) {
+  if (ReusedFunctions.count(Symbols.getIdentName(function->name.ident)) == 0)
+    visitFunction(function);
+}
+
+void TypeCheckVisitor::endProgram(AstProgram *program) {
+  if (Symbols.noMainProperlyDeclared())
+    Errors.noMainProperlyDeclared(program->endPos);
+  Symbols.popScope();
+  Errors.print();
+}
+
+void TypeCheckVisitor::beginFunction(AstFunction *function) {
+  TypesMgr::TypeId tFunc = Types.createVoidTy();
+  if (function->hasType) {
+    tFunc = function->type.type;
+  }
+  setCurrentFunctionTy(tFunc);
+}
+
+void TypeCheckVisitor::checkStatementHead(AstStmt *stmt) {
+  if (stmt->kind == AstStmt::IfKind)
+    checkCondition(stmt, static_cast<AstIfStmt *>(stmt)->cond);
+  else if (stmt->kind == AstStmt::WhileKind)
+    checkCondition(stmt, static_cast<AstWhileStmt *>(stmt)->cond);
+  else
+    visitStatement(stmt);
+}
+
+void TypeCheckVisitor::checkStatementBodies(AstStmt *stmt) {
+  if (stmt->kind == AstStmt::IfKind) {
+    AstIfStmt *ifStmt = static_cast<AstIfStmt *>(stmt);
+    visitStatements(ifStmt->thenBody);
+    if (ifStmt->hasElse) visitStatements(ifStmt->elseBody);
+  }
+  else if (stmt->kind == AstStmt::WhileKind) {
+    visitStatements(static_cast<AstWhileStmt *>(stmt)->body);
+  }
+}
+
+bool TypeCheckVisitor::hasErrors() const {
+  return Errors.getNumberOfSemanticErrors() > 0;
+}
+
 // Accessor/Mutator to the attribute currFunctionType
 TypesMgr::TypeId TypeCheckVisitor::getCurrentFunctionTy() const {
   return currFunctionType;
@@ -66,169 +119,206 @@ void TypeCheckVisitor::setCurrentFunctionTy(TypesMgr::TypeId type) {
 
 // Methods to visit each kind of node:
 //
-antlrcpp::Any TypeCheckVisitor::visitProgram(AslParser::ProgramContext *ctx) {
+void TypeCheckVisitor::visitProgram(AstProgram *program) {
   DEBUG_ENTER();
-  SymTable::ScopeId sc = getScopeDecor(ctx);
-  Symbols.pushThisScope(sc);
-  for (auto ctxFunc : ctx->function()) { 
-    visit(ctxFunc);
+  beginProgram(program);
+  for (std::size_t i = 0; i < program->getNumberOfFunctions(); ++i) {
+    checkFunction(program->getFunction(i));
   }
-  if (Symbols.noMainProperlyDeclared())
-    Errors.noMainProperlyDeclared(ctx);
-  Symbols.popScope();
-  Errors.print();
+  endProgram(program);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitFunction(AslParser::FunctionContext *ctx) {
+void TypeCheckVisitor::visitFunction(AstFunction *function) {
   DEBUG_ENTER();
-  SymTable::ScopeId sc = getScopeDecor(ctx);
-  Symbols.pushThisScope(sc);
+  TraceWriter::Span span(Trace, "typecheck", Symbols.getIdentName(function->name.ident));
+  Symbols.pushThisScope(function->scope);
   // Symbols.print();
-  TypesMgr::TypeId tFunc = Types.createVoidTy();
-  if (ctx->type()) {
-    visit(ctx->type());
-    tFunc = getTypeDecor(ctx->type());
-  }
-  setCurrentFunctionTy(tFunc);
-  visit(ctx->statements());
+  beginFunction(function);
+  visitStatements(function->body);
   Symbols.popScope();
   DEBUG_EXIT();
-  return 0;
-}
-
-// antlrcpp::Any TypeCheckVisitor::visitDeclarations(AslParser::DeclarationsContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any TypeCheckVisitor::visitVariable_decl(AslParser::Variable_declContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-// antlrcpp::Any TypeCheckVisitor::visitType(AslParser::TypeContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
-
-antlrcpp::Any TypeCheckVisitor::visitStatements(AslParser::StatementsContext *ctx) {
+}
+
+void TypeCheckVisitor::visitStatements(const AstArray<AstStmt *> & stmts) {
   DEBUG_ENTER();
-  visitChildren(ctx);
+  for (AstStmt *stmt : stmts)
+    visitStatement(stmt);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx) {
+void TypeCheckVisitor::visitStatement(AstStmt *stmt) {
+  switch (stmt->kind) {
+  case AstStmt::AssignKind:
+    visitAssignStmt(static_cast<AstAssignStmt *>(stmt));
+    break;
+  case AstStmt::ReturnKind:
+    visitReturnStmt(static_cast<AstReturnStmt *>(stmt));
+    break;
+  case AstStmt::WhileKind:
+    visitWhileStmt(static_cast<AstWhileStmt *>(stmt));
+    break;
+  case AstStmt::IfKind:
+    visitIfStmt(static_cast<AstIfStmt *>(stmt));
+    break;
+  case AstStmt::ProcCallKind:
+    visitProcCall(static_cast<AstProcCallStmt *>(stmt));
+    break;
+  case AstStmt::ReadKind:
+    visitReadStmt(static_cast<AstReadStmt *>(stmt));
+    break;
+  case AstStmt::WriteExprKind:
+    visitWriteExpr(static_cast<AstWriteExprStmt *>(stmt));
+    break;
+  case AstStmt::WriteStringKind:
+    break;
+  }
+}
+
+void TypeCheckVisitor::visitAssignStmt(AstAssignStmt *stmt) {
   DEBUG_ENTER();
-  visit(ctx->left_expr());
-  visit(ctx->expr());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->left_expr());
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr());
+  visitExpr(stmt->left);
+  visitExpr(stmt->expr);
+  TypesMgr::TypeId t1 = stmt->left->type;
+  TypesMgr::TypeId t2 = stmt->expr->type;
   if ((not Types.isErrorTy(t1)) and (not Types.isErrorTy(t2)) and
       (not Types.copyableTypes(t1, t2)))
-    Errors.incompatibleAssignment(ctx->ASSIGN());
-  if ((not Types.isErrorTy(t1)) and (not getIsLValueDecor(ctx->left_expr())))
-    Errors.nonReferenceableLeftExpr(ctx->left_expr());
+    Errors.incompatibleAssignment(stmt->assignPos);
+  if ((not Types.isErrorTy(t1)) and (not stmt->left->isLValue))
+    Errors.nonReferenceableLeftExpr(stmt->left);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
+void TypeCheckVisitor::visitIfStmt(AstIfStmt *stmt) {
   DEBUG_ENTER();
-  visit(ctx->expr());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
-  if ((not Types.isErrorTy(t1)) and (not Types.isBooleanTy(t1)))
-    Errors.booleanRequired(ctx);
-  visit(ctx->statements(0));
-  if (ctx -> ELSE()) visit(ctx->statements(1));
+  checkCondition(stmt, stmt->cond);
+  visitStatements(stmt->thenBody);
+  if (stmt->hasElse) visitStatements(stmt->elseBody);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
+void TypeCheckVisitor::visitProcCall(AstProcCallStmt *stmt) {
   DEBUG_ENTER();
-  visit(ctx->ident());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->ident());
+  visitIdent(stmt->callee);
+  TypesMgr::TypeId t1 = stmt->callee->type;
   if (Types.isErrorTy(t1)) {
   } else if (not Types.isFunctionTy(t1)) {
-    Errors.isNotCallable(ctx->ident());
+    Errors.isNotCallable(stmt->callee, Symbols.getIdentName(stmt->callee->ident));
   }
   else {
       const std::vector<TypesMgr::TypeId>& fuctionParams = Types.getFuncParamsTypes(t1);
-      if (fuctionParams.size() != ctx -> expr().size()) Errors.numberOfParameters(ctx);
-      for (unsigned int i = 0; i < ctx -> expr().size(); ++i) {
-          visit(ctx->expr(i));
-          TypesMgr::TypeId tParam = getTypeDecor(ctx->expr(i));
+      if (fuctionParams.size() != stmt->args.size())
+        Errors.numberOfParameters(stmt->callee, Symbols.getIdentName(stmt->callee->ident));
+      for (unsigned int i = 0; i < stmt->args.size(); ++i) {
+          visitExpr(stmt->args[i]);
+          TypesMgr::TypeId tParam = stmt->args[i]->type;
           if (i < fuctionParams.size() and not Types.copyableTypes(fuctionParams[i], tParam)) {
-              Errors.incompatibleParameter(ctx->expr(i), i+1, ctx);
+              Errors.incompatibleParameter(stmt->args[i], i+1, Symbols.getIdentName(stmt->callee->ident));
           }
       }
   }
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
+void TypeCheckVisitor::visitReadStmt(AstReadStmt *stmt) {
   DEBUG_ENTER();
-  visit(ctx->left_expr());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->left_expr());
+  visitExpr(stmt->left);
+  TypesMgr::TypeId t1 = stmt->left->type;
   if ((not Types.isErrorTy(t1)) and (not Types.isPrimitiveTy(t1)) and
       (not Types.isFunctionTy(t1)))
-    Errors.readWriteRequireBasic(ctx);
-  if ((not Types.isErrorTy(t1)) and (not getIsLValueDecor(ctx->left_expr())))
-    Errors.nonReferenceableExpression(ctx);
+    Errors.readWriteRequireBasic(stmt);
+  if ((not Types.isErrorTy(t1)) and (not stmt->left->isLValue))
+    Errors.nonReferenceableExpression(stmt);
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
+void TypeCheckVisitor::visitWriteExpr(AstWriteExprStmt *stmt) {
   DEBUG_ENTER();
-  visit(ctx->expr());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
+  visitExpr(stmt->expr);
+  TypesMgr::TypeId t1 = stmt->expr->type;
   if ((not Types.isErrorTy(t1)) and (not Types.isPrimitiveTy(t1)))
-    Errors.readWriteRequireBasic(ctx);
+    Errors.readWriteRequireBasic(stmt);
   DEBUG_EXIT();
-  return 0;
 }
 
-// antlrcpp::Any TypeCheckVisitor::visitWriteString(AslParser::WriteStringContext *ctx) {
-//   DEBUG_ENTER();
-//   antlrcpp::Any r = visitChildren(ctx);
-//   DEBUG_EXIT();
-//   return r;
-// }
+void TypeCheckVisitor::visitWhileStmt(AstWhileStmt *stmt) {
+    DEBUG_ENTER();
+    checkCondition(stmt, stmt->cond);
+    visitStatements(stmt->body);
+    DEBUG_EXIT();
+}
 
-antlrcpp::Any TypeCheckVisitor::visitLeftExprIdent(AslParser::LeftExprIdentContext *ctx) {
-  DEBUG_ENTER();
-  visit(ctx->ident());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->ident());
-  putTypeDecor(ctx, t1);
-  bool b = getIsLValueDecor(ctx->ident());
-  putIsLValueDecor(ctx, b);
-  DEBUG_EXIT();
-  return 0;
+void TypeCheckVisitor::checkCondition(AstStmt *stmt, AstExpr *cond) {
+  visitExpr(cond);
+  TypesMgr::TypeId t1 = cond->type;
+  if ((not Types.isErrorTy(t1)) and (not Types.isBooleanTy(t1)))
+    Errors.booleanRequired(stmt);
 }
 
-antlrcpp::Any TypeCheckVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx) {
+void TypeCheckVisitor::visitReturnStmt(AstReturnStmt *stmt) {
+    DEBUG_ENTER();
+    TypesMgr::TypeId t = Types.createVoidTy();
+    if (stmt->expr) {
+        visitExpr(stmt->expr);
+        t = stmt->expr->type;
+    }
+
+    TypesMgr::TypeId tFunc = getCurrentFunctionTy();
+
+    if (not Types.isErrorTy(tFunc) and not Types.copyableTypes(tFunc,t)) {
+        Errors.incompatibleReturn(stmt->pos);
+    }
+
+    DEBUG_EXIT();
+}
+
+void TypeCheckVisitor::visitExpr(AstExpr *expr) {
+  switch (expr->kind) {
+  case AstExpr::IdentKind:
+    visitIdent(static_cast<AstIdentExpr *>(expr));
+    break;
+  case AstExpr::ValueKind:
+    visitValue(static_cast<AstValueExpr *>(expr));
+    break;
+  case AstExpr::ParenthesisKind:
+    visitParenthesis(static_cast<AstParenthesisExpr *>(expr));
+    break;
+  case AstExpr::ArrayAccessKind:
+    visitArrayAccess(static_cast<AstArrayAccessExpr *>(expr));
+    break;
+  case AstExpr::UnaryArithmeticKind:
+    visitUnaryArithmetic(static_cast<AstUnaryExpr *>(expr));
+    break;
+  case AstExpr::UnaryLogicalKind:
+    visitUnaryLogical(static_cast<AstUnaryExpr *>(expr));
+    break;
+  case AstExpr::ArithmeticKind:
+    visitArithmetic(static_cast<AstBinaryExpr *>(expr));
+    break;
+  case AstExpr::RelationalKind:
+    visitRelational(static_cast<AstBinaryExpr *>(expr));
+    break;
+  case AstExpr::LogicalKind:
+    visitLogical(static_cast<AstBinaryExpr *>(expr));
+    break;
+  case AstExpr::FuncCallKind:
+    visitFuncExpr(static_cast<AstFuncCallExpr *>(expr));
+    break;
+  }
+}
+
+void TypeCheckVisitor::visitArithmetic(AstBinaryExpr *expr) {
   DEBUG_ENTER();
-  visit(ctx->expr(0));
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  visit(ctx->expr(1));
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
+  visitExpr(expr->left);
+  TypesMgr::TypeId t1 = expr->left->type;
+  visitExpr(expr->right);
+  TypesMgr::TypeId t2 = expr->right->type;
     TypesMgr::TypeId t;
   
-    if (ctx -> MOD()) {
+    if (expr->op == AstExpr::ModOp) {
         if (((not Types.isErrorTy(t1)) and (not Types.isIntegerTy(t1))) or
                 ((not Types.isErrorTy(t2)) and (not Types.isIntegerTy(t2))))
-            Errors.incompatibleOperator(ctx->op);
+            Errors.incompatibleOperator(expr->opPos, expr->op);
 
         t = Types.createIntegerTy();
 
@@ -237,289 +327,189 @@ antlrcpp::Any TypeCheckVisitor::visitArithmetic(AslParser::ArithmeticContext *ct
     else {
         if (((not Types.isErrorTy(t1)) and (not Types.isNumericTy(t1))) or
                 ((not Types.isErrorTy(t2)) and (not Types.isNumericTy(t2))))
-            Errors.incompatibleOperator(ctx->op);
+            Errors.incompatibleOperator(expr->opPos, expr->op);
 
         if (Types.isFloatTy(t1) or Types.isFloatTy(t2)) t = Types.createFloatTy(); 
         else t = Types.createIntegerTy();
     }
-      putTypeDecor(ctx, t);
-      putIsLValueDecor(ctx, false);
+      expr->type = t;
+      expr->isLValue = false;
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitRelational(AslParser::RelationalContext *ctx) {
+void TypeCheckVisitor::visitRelational(AstBinaryExpr *expr) {
   DEBUG_ENTER();
-  visit(ctx->expr(0));
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  visit(ctx->expr(1));
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
-  std::string oper = ctx->op->getText();
+  visitExpr(expr->left);
+  TypesMgr::TypeId t1 = expr->left->type;
+  visitExpr(expr->right);
+  TypesMgr::TypeId t2 = expr->right->type;
+  std::string oper = AstExpr::getOperatorText(expr->op);
   if ((not Types.isErrorTy(t1)) and (not Types.isErrorTy(t2)) and
       (not Types.comparableTypes(t1, t2, oper)))
-    Errors.incompatibleOperator(ctx->op);
+    Errors.incompatibleOperator(expr->opPos, expr->op);
   TypesMgr::TypeId t = Types.createBooleanTy();
-  putTypeDecor(ctx, t);
-  putIsLValueDecor(ctx, false);
-  DEBUG_EXIT();
-  return 0;
-}
-
-antlrcpp::Any TypeCheckVisitor::visitValue(AslParser::ValueContext *ctx) {
-  DEBUG_ENTER();
-  TypesMgr::TypeId t;
-
-  if (ctx -> INTVAL()) t = Types.createIntegerTy();
-  else if (ctx -> CHARVAL()) t = Types.createCharacterTy();
-  else if (ctx -> BOOLVAL()) t = Types.createBooleanTy();
-  else if (ctx -> FLOATVAL()) t = Types.createFloatTy();
-  putTypeDecor(ctx, t);
-  putIsLValueDecor(ctx, false);
+  expr->type = t;
+  expr->isLValue = false;
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitExprIdent(AslParser::ExprIdentContext *ctx) {
+void TypeCheckVisitor::visitValue(AstValueExpr *expr) {
   DEBUG_ENTER();
-  visit(ctx->ident());
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->ident());
-  putTypeDecor(ctx, t1);
-  bool b = getIsLValueDecor(ctx->ident());
-  putIsLValueDecor(ctx, b);
+  TypesMgr::TypeId t = Types.createErrorTy();
+
+  if (expr->basic == AstType::IntegerBasic) t = Types.createIntegerTy();
+  else if (expr->basic == AstType::CharacterBasic) t = Types.createCharacterTy();
+  else if (expr->basic == AstType::BooleanBasic) t = Types.createBooleanTy();
+  else if (expr->basic == AstType::FloatBasic) t = Types.createFloatTy();
+  expr->type = t;
+  expr->isLValue = false;
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitIdent(AslParser::IdentContext *ctx) {
+void TypeCheckVisitor::visitIdent(AstIdentExpr *expr) {
   DEBUG_ENTER();
-  std::string ident = ctx->getText();
-  if (Symbols.findInStack(ident) == -1) {
-    Errors.undeclaredIdent(ctx->ID());
+  // resolve the identifier once: codegen uses the symbol class
+  SymTable::IdentId id = expr->ident;
+  SymTable::SymClassId c = Symbols.getSymbolClass(id);
+  expr->symClass = c;
+  if (c == SymTable::ErrorClassId) {
+    Errors.undeclaredIdent(expr->pos, Symbols.getIdentName(id));
     TypesMgr::TypeId te = Types.createErrorTy();
-    putTypeDecor(ctx, te);
-    putIsLValueDecor(ctx, true);
+    expr->type = te;
+    expr->isLValue = true;
   }
   else {
-    TypesMgr::TypeId t1 = Symbols.getType(ident);
-    putTypeDecor(ctx, t1);
-    if (Symbols.isFunctionClass(ident))
-      putIsLValueDecor(ctx, false);
+    TypesMgr::TypeId t1 = Symbols.getType(id);
+    expr->type = t1;
+    if (c == SymTable::FunctionId)
+      expr->isLValue = false;
     else
-      putIsLValueDecor(ctx, true);
+      expr->isLValue = true;
   }
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitLogical(AslParser::LogicalContext *ctx) {
+void TypeCheckVisitor::visitLogical(AstBinaryExpr *expr) {
   DEBUG_ENTER();
-  visit(ctx->expr(0));
-  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
-  visit(ctx->expr(1));
-  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
+  visitExpr(expr->left);
+  TypesMgr::TypeId t1 = expr->left->type;
+  visitExpr(expr->right);
+  TypesMgr::TypeId t2 = expr->right->type;
   if (((not Types.isErrorTy(t1)) and (not Types.isBooleanTy(t1))) or
       ((not Types.isErrorTy(t2)) and (not Types.isBooleanTy(t2))))
-    Errors.incompatibleOperator(ctx->op);
+    Errors.incompatibleOperator(expr->opPos, expr->op);
   TypesMgr::TypeId t = Types.createBooleanTy();
-  putTypeDecor(ctx, t);
-  putIsLValueDecor(ctx, false);
+  expr->type = t;
+  expr->isLValue = false;
   DEBUG_EXIT();
-  return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitUnaryArithmetic(AslParser::UnaryArithmeticContext *ctx) {
+void TypeCheckVisitor::visitUnaryArithmetic(AstUnaryExpr *expr) {
     DEBUG_ENTER();
-    visit(ctx -> expr());
-    TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
+    visitExpr(expr->expr);
+    TypesMgr::TypeId t1 = expr->expr->type;
     if ((not Types.isErrorTy(t1)) and (not Types.isNumericTy(t1))) 
-        Errors.incompatibleOperator(ctx->op);
+        Errors.incompatibleOperator(expr->pos, expr->op);
 
     TypesMgr::TypeId t;
 
     if (Types.isFloatTy(t1)) t = Types.createFloatTy(); 
     else t = Types.createIntegerTy();
-    putTypeDecor(ctx, t);
-    putIsLValueDecor(ctx, false);
+    expr->type = t;
+    expr->isLValue = false;
     DEBUG_EXIT();
-    return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitUnaryLogical(AslParser::UnaryLogicalContext *ctx) {
+void TypeCheckVisitor::visitUnaryLogical(AstUnaryExpr *expr) {
     DEBUG_ENTER();
-    visit(ctx -> expr());
-    TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
+    visitExpr(expr->expr);
+    TypesMgr::TypeId t1 = expr->expr->type;
     if ((not Types.isErrorTy(t1)) and (not Types.isBooleanTy(t1))) 
-        Errors.incompatibleOperator(ctx->op);
+        Errors.incompatibleOperator(expr->pos, expr->op);
 
     TypesMgr::TypeId t = Types.createBooleanTy();
-    putTypeDecor(ctx, t);
-    putIsLValueDecor(ctx, false);
+    expr->type = t;
+    expr->isLValue = false;
     DEBUG_EXIT();
-    return 0;
 }
 
 
-antlrcpp::Any TypeCheckVisitor::visitParenthesis(AslParser::ParenthesisContext *ctx) {
+void TypeCheckVisitor::visitParenthesis(AstParenthesisExpr *expr) {
     DEBUG_ENTER();
-    visit(ctx -> expr()); 
-    TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
-    putTypeDecor(ctx, t1);
+    visitExpr(expr->expr);
+    TypesMgr::TypeId t1 = expr->expr->type;
+    expr->type = t1;
 
     // ojo
-    bool b = getIsLValueDecor(ctx->expr());
-    putIsLValueDecor(ctx, b);
-    // putIsLValueDecor(ctx, false);
+    bool b = expr->expr->isLValue;
+    expr->isLValue = b;
+    // expr->isLValue = false;
 
     DEBUG_EXIT();
-    return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitWhileStmt(AslParser::WhileStmtContext *ctx) {
+// the array access of left expressions and of expressions
+void TypeCheckVisitor::visitArrayAccess(AstArrayAccessExpr *expr) {
     DEBUG_ENTER();
-    visit(ctx -> expr()); 
-    TypesMgr::TypeId t1 = getTypeDecor(ctx->expr());
-    if ((not Types.isErrorTy(t1)) and (not Types.isBooleanTy(t1))) 
-        Errors.booleanRequired(ctx);
-    visit(ctx -> statements());
-    DEBUG_EXIT();
-    return 0;
-}
-
-antlrcpp::Any TypeCheckVisitor::visitReturnStmt(AslParser::ReturnStmtContext *ctx) {
-    DEBUG_ENTER();
-    TypesMgr::TypeId t = Types.createVoidTy();
-    if (ctx -> expr()) {
-        visit(ctx -> expr()); 
-        t = getTypeDecor(ctx->expr());
-    }
-
-    //std::cout << t << std::endl;
-    //std::cout << getCurrentFunctionTy() << std::endl;
-
-    TypesMgr::TypeId tFunc = getCurrentFunctionTy();
-
-    if (not Types.isErrorTy(tFunc) and not Types.copyableTypes(tFunc,t)) {
-        Errors.incompatibleReturn(ctx -> RETURN());
-    }
-    
-    //if ((not Types.isFloatTy(getCurrentFunctionTy()) and not Types.equalTypes(t, getCurrentFunctionTy())) or ((Types.isFloatTy(getCurrentFunctionTy()) and not Types.isNumericTy(t))) ) {
-    //    Errors.incompatibleReturn(ctx->RETURN());
-    //}
-
-    DEBUG_EXIT();
-    return 0;
-}
-
-antlrcpp::Any TypeCheckVisitor::visitArrayAccessLExpr(AslParser::ArrayAccessLExprContext *ctx) {
-    DEBUG_ENTER();
-    visit(ctx -> expr(1));
-    TypesMgr::TypeId tIndx = getTypeDecor(ctx->expr(1));
-    if ((not Types.isErrorTy(tIndx)) and (not Types.isIntegerTy(tIndx))) 
-        Errors.nonIntegerIndexInArrayAccess(ctx -> expr(1));
-
-    visit(ctx -> expr(0));
-    TypesMgr::TypeId tArray = getTypeDecor(ctx->expr(0));
-
-    if ((not Types.isErrorTy(tArray)) and (not Types.isArrayTy(tArray))) 
-        Errors.nonArrayInArrayAccess(ctx);
-
-    TypesMgr::TypeId tArrayValue = Types.isArrayTy(tArray) ? Types.getArrayElemType(tArray) : Types.createErrorTy();
-    putTypeDecor(ctx, tArrayValue);
-    putIsLValueDecor(ctx, true);
-    DEBUG_EXIT();
-    return 0;
-}
-
-antlrcpp::Any TypeCheckVisitor::visitArrayAccessExpr(AslParser::ArrayAccessExprContext *ctx) {
-    DEBUG_ENTER();
-    visit(ctx -> expr(1));
-    TypesMgr::TypeId tIndx = getTypeDecor(ctx->expr(1));
+    visitExpr(expr->index);
+    TypesMgr::TypeId tIndx = expr->index->type;
     if ((not Types.isErrorTy(tIndx)) and (not Types.isIntegerTy(tIndx))) 
-        Errors.nonIntegerIndexInArrayAccess(ctx -> expr(1));
+        Errors.nonIntegerIndexInArrayAccess(expr->index);
 
-    visit(ctx -> expr(0));
-    TypesMgr::TypeId tArray = getTypeDecor(ctx->expr(0));
+    visitExpr(expr->array);
+    TypesMgr::TypeId tArray = expr->array->type;
 
     if ((not Types.isErrorTy(tArray)) and (not Types.isArrayTy(tArray))) 
-        Errors.nonArrayInArrayAccess(ctx);
+        Errors.nonArrayInArrayAccess(expr);
 
     TypesMgr::TypeId tArrayValue = Types.isArrayTy(tArray) ? Types.getArrayElemType(tArray) : Types.createErrorTy();
-    putTypeDecor(ctx, tArrayValue);
-    putIsLValueDecor(ctx, true);
+    expr->type = tArrayValue;
+    expr->isLValue = true;
     DEBUG_EXIT();
-    return 0;
 }
 
-antlrcpp::Any TypeCheckVisitor::visitFuncExpr(AslParser::FuncExprContext *ctx) {
+void TypeCheckVisitor::visitFuncExpr(AstFuncCallExpr *expr) {
     DEBUG_ENTER();
 
-    //for (unsigned int i = 0; i < ctx->expr().size(); ++i) {
-    //    visit(ctx->expr(i)); 
-    //}
-    
-    visit(ctx -> ident());
-    for (auto& a : ctx -> expr()) visit(a);
+    visitIdent(expr->callee);
+    for (AstExpr *a : expr->args) visitExpr(a);
 
-    TypesMgr::TypeId t = getTypeDecor(ctx -> ident());
+    TypesMgr::TypeId t = expr->callee->type;
     if (not Types.isErrorTy(t) and not Types.isFunctionTy(t)) {
-        Errors.isNotCallable(ctx -> ident());
-        putTypeDecor(ctx, Types.createErrorTy());
+        Errors.isNotCallable(expr->callee, Symbols.getIdentName(expr->callee->ident));
+        expr->type = Types.createErrorTy();
     }
 
     else if (Types.isFunctionTy(t)) {
         TypesMgr::TypeId tRet = Types.getFuncReturnType(t);
 
         if (Types.isVoidFunction(t)) {
-            Errors.isNotFunction(ctx -> ident());
+            Errors.isNotFunction(expr->callee, Symbols.getIdentName(expr->callee->ident));
             tRet = Types.createErrorTy();
         }
         
         const std::vector<TypesMgr::TypeId>& functionParams = Types.getFuncParamsTypes(t);
 
-        if (functionParams.size() != ctx -> expr().size()) Errors.numberOfParameters(ctx);
+        if (functionParams.size() != expr->args.size())
+            Errors.numberOfParameters(expr->callee, Symbols.getIdentName(expr->callee->ident));
         
-            unsigned int min = ctx -> expr().size() < functionParams.size() ? ctx -> expr().size() : functionParams.size();
+            unsigned int min = expr->args.size() < functionParams.size() ? expr->args.size() : functionParams.size();
             for (unsigned int i = 0; i < min; ++i) {
-                TypesMgr::TypeId tParam = getTypeDecor(ctx->expr(i));
+                TypesMgr::TypeId tParam = expr->args[i]->type;
                 if (not Types.isErrorTy(tParam) and not Types.copyableTypes(functionParams[i], tParam)) {
-                    Errors.incompatibleParameter(ctx->expr(i), i+1, ctx);
+                    Errors.incompatibleParameter(expr->args[i], i+1, Symbols.getIdentName(expr->callee->ident));
                 }
             }
 
-        putTypeDecor(ctx, tRet);
+        expr->type = tRet;
     }
     //t es un error
 
     else {
-        putTypeDecor(ctx, t);
+        expr->type = t;
     }
 
-    putIsLValueDecor(ctx, false);
+    expr->isLValue = false;
 
     DEBUG_EXIT();
-    return 0;
-}
-
-// Getters for the necessary tree node atributes:
-//   Scope, Type ans IsLValue
-SymTable::ScopeId TypeCheckVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getScope(ctx);
-}
-TypesMgr::TypeId TypeCheckVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getType(ctx);
-}
-bool TypeCheckVisitor::getIsLValueDecor(antlr4::ParserRuleContext *ctx) {
-  return Decorations.getIsLValue(ctx);
-}
-
-// Setters for the necessary tree node attributes:
-//   Scope, Type ans IsLValue
-void TypeCheckVisitor::putScopeDecor(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
-  Decorations.putScope(ctx, s);
-}
-void TypeCheckVisitor::putTypeDecor(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
-  Decorations.putType(ctx, t);
-}
-void TypeCheckVisitor::putIsLValueDecor(antlr4::ParserRuleContext *ctx, bool b) {
-  Decorations.putIsLValue(ctx, b);
 }
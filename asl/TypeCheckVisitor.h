@@ -1,6 +1,6 @@
 //////////////////////////////////////////////////////////////////////
 //
-//    TypeCheckVisitor - Walk the parser tree to do the semantic
+//    TypeCheckVisitor - Walk the AST to do the semantic
 //                       typecheck for the Asl programming language
 //
 //    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
@@ -29,90 +29,103 @@
 
 #pragma once
 
-#include "antlr4-runtime.h"
-#include "AslBaseVisitor.h"
-
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "../common/TraceWriter.h"
+#include "../common/AslAst.h"
+
+#include <set>
+#include <string>
 
 // using namespace std;
 
 
 //////////////////////////////////////////////////////////////////////
-// Class TypeCheckVisitor: derived from AslBaseVisitor.
-// The tree visitor go through the parser tree and call the methods of
-// this class to do the semantic typecheck of the program. This is
-// done once the SymbolsVisitor has finish and all the symbols of the
-// program has been added to their respective scope. In this visit,
-// if some node/method does not have an associated task, it does not
-// have to be visited/called so no redefinition is needed.
+// Class TypeCheckVisitor: go through the AST of the program to do its
+// semantic typecheck. This is done once the SymbolsVisitor has finish
+// and all the symbols of the program has been added to their
+// respective scope. Each statement and expression is dispatched on
+// its kind to the method of its node, which decorates the expressions
+// with their type and whether they are referenceable (see AslAst.h).
 
-class TypeCheckVisitor final : public AslBaseVisitor {
+class TypeCheckVisitor final {
 
 public:
 
   // Constructor
   TypeCheckVisitor(TypesMgr       & Types,
                    SymTable       & Symbols,
-                   TreeDecoration & Decorations,
                    SemErrors      & Errors);
 
-  // Methods to visit each kind of node.
-  // Non visited nodes have been commented out:
-  antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
-  antlrcpp::Any visitFunction(AslParser::FunctionContext *ctx);
-  // antlrcpp::Any visitDeclarations(AslParser::DeclarationsContext *ctx);
-  // antlrcpp::Any visitVariable_decl(AslParser::Variable_declContext *ctx);
-  // antlrcpp::Any visitType(AslParser::TypeContext *ctx);
-  antlrcpp::Any visitStatements(AslParser::StatementsContext *ctx);
-  antlrcpp::Any visitAssignStmt(AslParser::AssignStmtContext *ctx);
-  antlrcpp::Any visitIfStmt(AslParser::IfStmtContext *ctx);
-  antlrcpp::Any visitProcCall(AslParser::ProcCallContext *ctx);
-  antlrcpp::Any visitReadStmt(AslParser::ReadStmtContext *ctx);
-  antlrcpp::Any visitWriteExpr(AslParser::WriteExprContext *ctx);
-  // antlrcpp::Any visitWriteString(AslParser::WriteStringContext *ctx);
-  antlrcpp::Any visitLeftExprIdent(AslParser::LeftExprIdentContext *ctx);
-  antlrcpp::Any visitExprIdent(AslParser::ExprIdentContext *ctx);
-  antlrcpp::Any visitArithmetic(AslParser::ArithmeticContext *ctx);
-  antlrcpp::Any visitRelational(AslParser::RelationalContext *ctx);
-  antlrcpp::Any visitValue(AslParser::ValueContext *ctx);
-  antlrcpp::Any visitIdent(AslParser::IdentContext *ctx);
-  antlrcpp::Any visitLogical(AslParser::LogicalContext *ctx);
-  antlrcpp::Any visitUnaryArithmetic(AslParser::UnaryArithmeticContext *ctx);
-  antlrcpp::Any visitUnaryLogical(AslParser::UnaryLogicalContext *ctx);
-  antlrcpp::Any visitParenthesis(AslParser::ParenthesisContext *ctx);
-  antlrcpp::Any visitWhileStmt(AslParser::WhileStmtContext *ctx);
-  antlrcpp::Any visitReturnStmt(AslParser::ReturnStmtContext *ctx);
-  antlrcpp::Any visitArrayAccessLExpr(AslParser::ArrayAccessLExprContext *ctx);
-  antlrcpp::Any visitArrayAccessExpr(AslParser::ArrayAccessExprContext *ctx);
-  antlrcpp::Any visitFuncExpr(AslParser::FuncExprContext *ctx);
+  // Functions whose code is reused from a previous compilation: they
+  // are not checked again
+  void setReusedFunctions(const std::set<std::string> & names);
+
+  // Trace where a span is added for each function (null: no trace)
+  void setTrace(TraceWriter *trace);
+
+  // The steps of visitProgram, to check the program one function
+  // at a time (the fused mode interleaves them with code generation):
+  //   - enter the global scope
+  void beginProgram  (AstProgram *program);
+  //   - check a function (unless it is reused)
+  void checkFunction (AstFunction *function);
+  //   - check "main", leave the global scope and print the errors
+  void endProgram    (AstProgram *program);
+
+  // The steps of visitFunction, for the fused mode, where the code
+  // generator checks each statement right before generating its code:
+  //   - start the function (its scope has to be the current one)
+  void beginFunction        (AstFunction *function);
+  //   - check a statement, but not the statements nested in it
+  void checkStatementHead   (AstStmt *stmt);
+  //   - check the statements nested in a statement
+  void checkStatementBodies (AstStmt *stmt);
+  // Some semantic error has been found
+  bool hasErrors            () const;
+
+  // Methods to visit each kind of node
+  void visitProgram         (AstProgram *program);
+  void visitFunction        (AstFunction *function);
+  void visitStatements      (const AstArray<AstStmt *> & stmts);
+  void visitStatement       (AstStmt *stmt);
+  void visitAssignStmt      (AstAssignStmt *stmt);
+  void visitIfStmt          (AstIfStmt *stmt);
+  void visitWhileStmt       (AstWhileStmt *stmt);
+  void visitProcCall        (AstProcCallStmt *stmt);
+  void visitReadStmt        (AstReadStmt *stmt);
+  void visitWriteExpr       (AstWriteExprStmt *stmt);
+  void visitReturnStmt      (AstReturnStmt *stmt);
+  void visitExpr            (AstExpr *expr);
+  void visitIdent           (AstIdentExpr *expr);
+  void visitValue           (AstValueExpr *expr);
+  void visitParenthesis     (AstParenthesisExpr *expr);
+  void visitArrayAccess     (AstArrayAccessExpr *expr);
+  void visitUnaryArithmetic (AstUnaryExpr *expr);
+  void visitUnaryLogical    (AstUnaryExpr *expr);
+  void visitArithmetic      (AstBinaryExpr *expr);
+  void visitRelational      (AstBinaryExpr *expr);
+  void visitLogical         (AstBinaryExpr *expr);
+  void visitFuncExpr        (AstFuncCallExpr *expr);
 
 private:
 
   // Attributes
   TypesMgr       & Types;
   SymTable       & Symbols;
-  TreeDecoration & Decorations;
   SemErrors      & Errors;
   // Current function type (assigned before visit its instructions)
   TypesMgr::TypeId currFunctionType;
+  // Names of the functions not to be checked
+  std::set<std::string> ReusedFunctions;
+  TraceWriter    * Trace = nullptr;
 
   // Accessor/Mutator to the type (TypeId) of the current function
   TypesMgr::TypeId getCurrentFunctionTy ()                      const;
   void             setCurrentFunctionTy (TypesMgr::TypeId type);
 
-  // Getters for the necessary tree node atributes:
-  //   Scope, Type ans IsLValue
-  SymTable::ScopeId getScopeDecor    (antlr4::ParserRuleContext *ctx);
-  TypesMgr::TypeId  getTypeDecor     (antlr4::ParserRuleContext *ctx);
-  bool              getIsLValueDecor (antlr4::ParserRuleContext *ctx);
-
-  // Setters for the necessary tree node attributes:
-  //   Scope, Type ans IsLValue
-  void putScopeDecor    (antlr4::ParserRuleContext *ctx, SymTable::ScopeId s);
-  void putTypeDecor     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
-  void putIsLValueDecor (antlr4::ParserRuleContext *ctx, bool b);
+  // Check the condition of an if or a while statement
+  void checkCondition (AstStmt *stmt, AstExpr *cond);
 
 };  // class TypeCheckVisitor
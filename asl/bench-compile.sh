@@ -0,0 +1,152 @@
+#!/bin/bash
+
+# Compile-time benchmark: generates Asl programs of growing size along
+# one dimension at a time (functions, statements per function,
+# expression depth, array sizes and call fan-out), compiles each one
+# with --timeReport=json and reports the time of the phases, the
+# throughput and the peak memory. The totals are compared with a
+# baseline saved by a previous run (--save), and the script fails if
+# any of them got slower or bigger than the tolerance.
+#
+# usage: ./bench-compile.sh [--save] [--baseline=<file>] [--runs=<n>]
+#                           [--tolerance=<percent>] [--asl=<compiler>]
+
+ASL=./asl
+BASELINE=bench-compile.baseline
+RUNS=3
+TOLERANCE=20
+SAVE=0
+for arg in "$@"; do
+    case "$arg" in
+	--save)         SAVE=1 ;;
+	--baseline=*)   BASELINE="${arg#--baseline=}" ;;
+	--runs=*)       RUNS="${arg#--runs=}" ;;
+	--tolerance=*)  TOLERANCE="${arg#--tolerance=}" ;;
+	--asl=*)        ASL="${arg#--asl=}" ;;
+	*)  echo "usage: $0 [--save] [--baseline=<file>] [--runs=<n>]" \
+		 "[--tolerance=<percent>] [--asl=<compiler>]"
+	    exit 1 ;;
+    esac
+done
+if [ ! -x "$ASL" ]; then
+    echo "No compiler $ASL (make it first)"
+    exit 1
+fi
+
+# name, functions, statements per function, expression depth,
+# array size and calls per function
+CONFIGS="
+base         100   20    4     10   2
+funcs-1k    1000   20    4     10   2
+funcs-4k    4000   20    4     10   2
+stmts-400     20  400    4     10   2
+stmts-2k      20 2000    4     10   2
+depth-64     100   20   64     10   2
+depth-256    100   20  256     10   2
+array-10k    100   20    4  10000   2
+array-1m     100   20    4 1000000 2
+fanout-16    200   20    4     10  16
+fanout-64    200   20    4     10  64
+"
+
+#--------------------------------------------
+# write to stdout a program with the given shape
+function generate_program() {
+    awk -v F=$1 -v S=$2 -v D=$3 -v A=$4 -v C=$5 'BEGIN {
+      ops[0] = "+"; ops[1] = "-"; ops[2] = "*";
+      for (i = 0; i < F; ++i) {
+        printf "func f%d(a : int, v : array [%d] of int) : int\n", i, A;
+        printf "  var x, y, z : int\n  var b : bool\n";
+        printf "  var w : array [%d] of int\n", A;
+        printf "  x = a; y = %d; z = a + 1;\n", i;
+        for (k = 0; k < S; ++k) {
+          if (k % 4 == 0) {
+            e = "a";
+            for (d = 1; d <= D; ++d) e = "(" e " " ops[d % 3] " " (d % 2 ? "x" : d) ")";
+            printf "  x = %s;\n", e;
+          }
+          else if (k % 4 == 1)
+            printf "  if x < y and not b then y = y + %d; else z = z - 1; endif\n", k;
+          else if (k % 4 == 2)
+            printf "  while z > %d do z = z - 1; b = z == x; endwhile\n", k;
+          else
+            printf "  w[%d] = x + v[%d];\n", k % A, (k * 7) % A;
+        }
+        if (i > 0)
+          for (c = 0; c < C; ++c)
+            printf "  y = y + f%d(x, v);\n", (i * 31 + c * 17) % i;
+        printf "  return y + z;\nendfunc\n\n";
+      }
+      printf "func main()\n  var v : array [%d] of int\n", A;
+      printf "  write f%d(1, v);\n  write \"\\n\";\nendfunc\n", F - 1;
+    }'
+}
+
+#--------------------------------------------
+# field of the JSON time report
+function report_field() {
+    sed -n 's/.*"'"$1"'": \([0-9.]*\).*/\1/p' "$2"
+}
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+declare -A BASE_WALL BASE_RSS
+if [ $SAVE == 0 -a -f "$BASELINE" ]; then
+    while read name wall rss; do
+	BASE_WALL[$name]=$wall
+	BASE_RSS[$name]=$rss
+    done < "$BASELINE"
+fi
+
+regressions=0
+printf "%-11s %8s %8s %9s %12s %12s %10s %s\n" \
+       "config" "lines" "instrs" "wall (s)" "lines/s" "instrs/s" "rss (KB)" "baseline"
+while read name nf ns nd na nc; do
+    [ -z "$name" ] && continue
+    generate_program $nf $ns $nd $na $nc > $TMP/$name.asl
+    lines=$(wc -l < $TMP/$name.asl)
+    # the fastest of the runs
+    best=""
+    for ((r = 0; r < RUNS; ++r)); do
+	"$ASL" --timeReport=json $TMP/$name.asl > /dev/null 2> $TMP/$name.err
+	if [ $? != 0 ]; then
+	    echo "$name: compilation failed"
+	    head -5 $TMP/$name.err
+	    exit 1
+	fi
+	grep '^{"phases"' $TMP/$name.err > $TMP/run.json
+	wall=$(sed -n 's/.*"total": {"wall": \([0-9.]*\).*/\1/p' $TMP/run.json)
+	if [ -z "$best" ] || awk "BEGIN {exit !($wall < $best)}"; then
+	    best=$wall
+	    cp $TMP/run.json $TMP/$name.json
+	fi
+    done
+    instrs=$(report_field instructions $TMP/$name.json)
+    rss=$(report_field peakRssKB $TMP/$name.json)
+    status="-"
+    if [ $SAVE == 1 ]; then
+	echo "$name $best $rss" >> $TMP/baseline
+    elif [ -n "${BASE_WALL[$name]}" ]; then
+	# a small absolute slack keeps the tiny configurations out of the noise
+	status=$(awk -v w=$best -v r=$rss -v bw=${BASE_WALL[$name]} -v br=${BASE_RSS[$name]} \
+		     -v t=$TOLERANCE 'BEGIN {
+		       s = sprintf("%+.0f%% time, %+.0f%% rss", 100*(w-bw)/bw, 100*(r-br)/br);
+		       if (w > bw*(1+t/100) + 0.02 || r > br*(1+t/100) + 1024) s = s " REGRESSION";
+		       print s }')
+    fi
+    printf "%-11s %8d %8d %9.4f %12.0f %12.0f %10d %s\n" $name $lines $instrs $best \
+	   $(awk "BEGIN {print $lines/$best}") $(awk "BEGIN {print $instrs/$best}") $rss "$status"
+    # time of each phase of the fastest run
+    grep -o '"name": "[^"]*", "wall": [0-9.]*' $TMP/$name.json |
+	sed 's/"name": "\([^"]*\)", "wall": \([0-9.]*\)/\1=\2/' | tr ' \n' '_ ' |
+	sed 's/^/            /; s/ $/\n/'
+    case "$status" in *REGRESSION*) regressions=$((regressions + 1)) ;; esac
+done <<< "$CONFIGS"
+
+if [ $SAVE == 1 ]; then
+    cp $TMP/baseline "$BASELINE"
+    echo "Baseline saved to $BASELINE"
+elif [ $regressions != 0 ]; then
+    echo "$regressions regressions against $BASELINE"
+    exit 1
+fi
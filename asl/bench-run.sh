@@ -0,0 +1,158 @@
+#!/bin/bash
+
+# Run-time benchmark: runs each kernel of benchmarks/ with the t-code
+# interpreter (tvm) and as a native program built with clang from the
+# LLVM IR of --llvm, at each optimization level. Reports the executed
+# (host) instructions, when perf is available, the wall time, the
+# speedup over the t-code and whether the output is the expected one.
+# The LLVM IR is the one of --llvm=ssa; with --classic it is the one
+# of --llvm, but for the kernels it rejects (a temporal assigned
+# twice), that fall back to --llvm=ssa. With --runtime the I/O is done
+# by the buffered runtime of runtime/aslrt.c.
+# The inputs (.in) are sized so that the t-code runs for a few
+# seconds, and then a native run takes a few milliseconds, most of
+# them the start of the process. So each native program is run again
+# and again until the runs add up to --minTime seconds (1 by default),
+# its wall time is the mean of a run, and its speedup is the one of
+# that time minus the one of an empty program (built the same way:
+# the "startup" rows).
+#
+# usage: ./bench-run.sh [--levels="0 1 2 3"] [--clang=<clang>] [--tvm=<tvm>]
+#                       [--minTime=<s>] [--classic] [--runtime] [<kernel.asl> ...]
+
+HERE=$(dirname "$0")
+ASL=./asl
+TVM=$HERE/../tvm/tvm
+CLANG=clang
+LLVM=--llvm=ssa
+RUNTIME=""
+LEVELS="0 1 2 3"
+MINTIME=1
+KERNELS=""
+for arg in "$@"; do
+    case "$arg" in
+	--levels=*)  LEVELS="${arg#--levels=}" ;;
+	--clang=*)   CLANG="${arg#--clang=}" ;;
+	--tvm=*)     TVM="${arg#--tvm=}" ;;
+	--minTime=*) MINTIME="${arg#--minTime=}" ;;
+	--ssa)       LLVM=--llvm=ssa ;;
+	--classic)   LLVM=--llvm ;;
+	--runtime)   RUNTIME=$(realpath $HERE/../runtime/aslrt.c) ;;
+	--*)  echo "usage: $0 [--levels=\"0 1 2 3\"] [--clang=<clang>] [--tvm=<tvm>] [--minTime=<s>]" \
+		   "[--classic] [--runtime] [<kernel.asl> ...]"
+	      exit 1 ;;
+	*)    KERNELS="$KERNELS $(realpath "$arg")" ;;
+    esac
+done
+[ -z "$KERNELS" ] && KERNELS=$(realpath $HERE/../benchmarks/bench_*.asl)
+ASL=$(realpath "$ASL")
+TVM=$(realpath "$TVM")
+FALLBACK=--llvm=ssa
+if [ -n "$RUNTIME" ]; then
+    LLVM="$LLVM --llvmRuntime"
+    FALLBACK="$FALLBACK --llvmRuntime"
+fi
+if ! command -v $CLANG > /dev/null; then
+    echo "No $CLANG: only the t-code is run"
+    LEVELS=""
+fi
+PERF=""
+if command -v perf > /dev/null && perf stat -e instructions true > /dev/null 2>&1; then
+    PERF=perf
+fi
+
+#--------------------------------------------
+# run "$@" with stdin from $IN and stdout to $OUT, leaving the wall
+# time in $WALL and the executed instructions in $INSTRS
+function measure() {
+    local start end
+    start=$(date +%s.%N)
+    if [ -n "$PERF" ]; then
+	perf stat -x, -e instructions -o $TMP/perf.txt "$@" < $IN > $OUT 2> /dev/null
+    else
+	"$@" < $IN > $OUT 2> /dev/null
+    fi
+    end=$(date +%s.%N)
+    WALL=$(awk "BEGIN {printf \"%.3f\", $end - $start}")
+    INSTRS="-"
+    [ -n "$PERF" ] && INSTRS=$(awk -F, '/instructions/ {print $1}' $TMP/perf.txt)
+}
+
+# measure "$@" once (for its output and instructions) and then run it
+# again and again until the runs add up to $MINTIME seconds, leaving
+# the mean wall time of a run in $WALL and the number of runs in $RUNS
+# (the clock is the one of bash, so no process is started to read it)
+function measureRepeated() {
+    local start now limit
+    measure "$@"
+    limit=$(awk "BEGIN {print int($MINTIME * 1000000)}")
+    RUNS=0
+    start=${EPOCHREALTIME/./}
+    now=$start
+    while [ $RUNS -eq 0 -o $((now - start)) -lt $limit ]; do
+	"$@" < $IN > /dev/null 2>&1
+	RUNS=$((RUNS + 1))
+	now=${EPOCHREALTIME/./}
+    done
+    WALL=$(awk "BEGIN {printf \"%.5f\", ($now - $start) / 1000000 / $RUNS}")
+}
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+cd $TMP
+
+printf "%-16s %-9s %16s %9s %6s %8s %s\n" "kernel" "backend" "instructions" "wall (s)" "runs" \
+       "speedup" "output"
+
+# the time of an empty program at each level, taken out of the times
+# of the kernels for their speedups
+declare -A STARTUP
+if [ -n "$LEVELS" ]; then
+    printf "func main()\nendfunc\n" > startup.asl
+    $ASL $FALLBACK startup.asl > startup.t 2> startup.err
+fi
+IN=/dev/null
+OUT=/dev/null
+for level in $LEVELS; do
+    STARTUP[$level]=0
+    if $CLANG -O$level -Wno-override-module startup.ll $RUNTIME -o startup.O$level 2> startup.err; then
+	measureRepeated ./startup.O$level
+	STARTUP[$level]=$WALL
+	printf "%-16s %-9s %16s %9s %6s %8s %s\n" startup "llvm -O$level" $INSTRS $WALL $RUNS "-" "-"
+    fi
+done
+for f in $KERNELS; do
+    name=$(basename $f .asl)
+    IN=${f/.asl/.in}
+    [ -f $IN ] || IN=/dev/null
+    if ! $ASL $LLVM $f > $name.t 2> $name.err; then
+	echo "$name: compilation errors"
+	continue
+    fi
+    if [ -n "$LEVELS" -a ! -s $name.ll -a "$LLVM" != "$FALLBACK" ]; then
+	echo "$name: no LLVM IR with $LLVM, using $FALLBACK"
+	$ASL $FALLBACK $f > $name.t 2> $name.err
+    fi
+    OUT=$name.tvm.out
+    measure $TVM $name.t
+    base=$WALL
+    check=$(diff -q $OUT ${f/.asl/.out} > /dev/null 2>&1 && echo OK || echo "Wrong output")
+    printf "%-16s %-9s %16s %9s %6s %8s %s\n" $name "t-code" $INSTRS $WALL 1 "1.00" "$check"
+    if [ -n "$LEVELS" -a ! -s $name.ll ]; then
+	echo "$name: no LLVM IR generated:" \
+	     $(grep -o "For example.*" $name.err | sed 's/For example, this happens/happens/')
+	continue
+    fi
+    for level in $LEVELS; do
+	if ! $CLANG -O$level -Wno-override-module $name.ll $RUNTIME -o $name.O$level 2> $name.err; then
+	    echo "$name: clang -O$level failed"
+	    continue
+	fi
+	OUT=$name.O$level.out
+	measureRepeated ./$name.O$level
+	check=$(diff -q $OUT ${f/.asl/.out} > /dev/null 2>&1 && echo OK || echo "Wrong output")
+	net=$(awk "BEGIN {t = $WALL - ${STARTUP[$level]}; print (t > 0.00001 ? t : 0.00001)}")
+	printf "%-16s %-9s %16s %9s %6s %8s %s\n" $name "llvm -O$level" $INSTRS $WALL $RUNS \
+	       $(awk "BEGIN {printf \"%.2f\", $base / $net}") "$check"
+    done
+done
@@ -1,6 +1,16 @@
 #!/bin/bash
 
+# usage: ./checkLLVM.sh <file.asl> [ssa] [runtime]
+#   runtime: the I/O is done by the runtime of ../runtime/aslrt.c
+
 ASLFILE=$(basename -- ${1})
 LLFILE=${ASLFILE/.asl/.ll}
+LLVMOPT=--llvm
+RUNTIME=""
+for opt in "${@:2}"; do
+    [ "${opt}" == "ssa" ] && LLVMOPT=--llvm=ssa
+    [ "${opt}" == "runtime" ] && RUNTIME=$(dirname "$0")/../runtime/aslrt.c
+done
+[ -n "${RUNTIME}" ] && LLVMOPT="${LLVMOPT} --llvmRuntime"
 rm -f ${LLFILE} a.out
-./asl ${1} && clang -Wno-override-module ${LLFILE} && ./a.out < ${1/asl/in} | diff -y -  ${1/asl/out}
+./asl ${LLVMOPT} ${1} > /dev/null && clang -Wno-override-module ${LLFILE} ${RUNTIME} && ./a.out < ${1/asl/in} | diff -y -  ${1/asl/out}
@@ -1,8 +1,32 @@
 input=$1
-./asl $input > a.t
+# ./exec.sh <file.asl> [c|x86|vm|inline]: run the t-code with the tvm
+# or, with c, the C code compiled with gcc or, with x86, the assembler
+# linked with the runtime or, with vm, the t-code with the VM of asl
+# --run or, with inline, the t-code of asl --inline with the tvm
 output_file=${input//.asl/.in}
 comp=${input//.asl/.out}
-../tvm/tvm-linux a.t < $output_file > visentada.t
+if [ "$2" = "c" ]; then
+    ./asl --c $input > a.t
+    c_file=$(basename $input .asl).c
+    gcc -O2 -std=c99 -o a.exe $c_file || exit 1
+    ./a.exe < $output_file > visentada.t
+    rm -f a.exe $c_file
+elif [ "$2" = "x86" ]; then
+    ./asl --x86 $input > a.t
+    s_file=$(basename $input .asl).s
+    as $s_file -o a.o || exit 1
+    cc -o a.exe a.o ../runtime/aslrt.c -lm || exit 1
+    ./a.exe < $output_file > visentada.t
+    rm -f a.exe a.o $s_file
+elif [ "$2" = "vm" ]; then
+    ./asl --run $input < $output_file > visentada.t
+elif [ "$2" = "inline" ]; then
+    ./asl --inline $input > a.t
+    ../tvm/tvm-linux a.t < $output_file > visentada.t
+else
+    ./asl $input > a.t
+    ../tvm/tvm-linux a.t < $output_file > visentada.t
+fi
 
 diff visentada.t $comp > /dev/null
 
@@ -11,6 +35,6 @@ if [ $? -ne 0 ]; then
     diff -y $comp visentada.t   
 else 
     echo "OK"
-    rm a.t
+    rm -f a.t
 fi
 rm visentada.t
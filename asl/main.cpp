@@ -36,130 +36,698 @@
 
 #include "../common/TypesMgr.h"
 #include "../common/SymTable.h"
-#include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "../common/AslAst.h"
+#include "AstBuilder.h"
 #include "SymbolsVisitor.h"
 #include "TypeCheckVisitor.h"
 #include "../common/code.h"
 #include "CodeGenVisitor.h"
+#include "../common/CompileServer.h"
+#include "../common/CompileCache.h"
+#include "../common/TimeReport.h"
+#include "../common/TraceWriter.h"
+#include "../common/TCodeVM.h"
+#include "../common/TCodeProfile.h"
+#include "../common/TCodeInliner.h"
 
 #include <iostream>
 #include <fstream>    // ifstream
+#include <sstream>    // ostringstream
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>     // unique_ptr
+#include <utility>    // std::move
+#include <thread>
+#include <atomic>
 
-#include <cstdio>     // fopen
 #include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
-#include <cstring>    // strcmp
+#include <cstdio>     // snprintf
+#include <cstdint>    // std::uint32_t
 
 // using namespace std;
 // using namespace antlr4;
 
 
-int main(int argc, const char* argv[]) {
-  // early stop options
-  bool onlySyntaxOpt  = (argc > 1 and std::strcmp(argv[1], "--onlySyntax") == 0);
-  bool onlySyntaxOpt2 = (argc > 2 and std::strcmp(argv[2], "--onlySyntax") == 0);
-  bool noCodegenOpt   = (argc > 1 and std::strcmp(argv[1], "--noCodegen")  == 0);
-  bool noCodeGenOpt2  = (argc > 2 and std::strcmp(argv[2], "--noCodegen")  == 0);
-  // check options and correct use of the program
-  if (argc > 3 or onlySyntaxOpt2 or noCodeGenOpt2 or
-      (argc == 3 and not onlySyntaxOpt and not noCodegenOpt)) {
-    std::cout << "Usage: ./asl [--onlySyntax|--noCodegen] [<file>]" << std::endl;
-    return EXIT_FAILURE;
-  }
-  if (argc == 3 or (argc == 2 and not onlySyntaxOpt and not noCodegenOpt)) {
-    if (not std::fopen(argv[argc-1], "r")) {
-      std::cout << "No such file: " << argv[argc-1] << std::endl;
-      return EXIT_FAILURE;
+// Options that select how far the translation goes
+struct CompileOptions {
+  std::string fileName;       // input file ("" when reading std::cin)
+  bool onlySyntax = false;    // stop after the syntactic analysis
+  bool noCodegen  = false;    // stop after the typecheck
+  bool inlineCalls  = false;  // inline the calls to small (or hot) functions
+  bool inlineReport = false;  //   and write the inlined calls to std::cerr
+  bool emitLLVM   = false;    // also write the LLVM IR to a .ll file
+  bool llvmSSA    = false;    //   in SSA form, without memory for the scalars
+  bool llvmRuntime = false;   //   with the I/O of the runtime (runtime/aslrt.c)
+  bool emitC      = false;    // also write the C99 code to a .c file
+  bool emitX86    = false;    // also write the x86-64 assembler to a .s file
+  bool run        = false;    // run the program instead of writing the t-code
+  unsigned long jitThreshold = 10;  //   compile a function after these calls (0: never)
+  std::string profileFile;    //   interpret it and write its counts to this file
+  const TCodeProfile *profile = nullptr;  // counts for the inlining and the LLVM IR (if given)
+  bool fused      = false;    // typecheck and generate each function in turn
+  unsigned int jobs = 1;      // threads of the typecheck
+  bool timeReport     = false;  // write the time report to std::cerr
+  bool timeReportJSON = false;  //   in JSON instead of as a table
+  TraceWriter *trace  = nullptr;  // trace of the phases and functions (if enabled)
+  CompileCache *cache = nullptr;  // cache of translations (if enabled)
+};
+
+// Compiler build stamp: cache entries of other builds are never
+// reused. It is a hash of the executable, so that any rebuild (also
+// one that only changes common/*.cpp) changes it; where the executable
+// can not be read it is the build date of this file. Computed once,
+// the first time the cache needs it
+static const std::string & compilerStamp() {
+  static const std::string stamp = []() -> std::string {
+    std::ifstream exe("/proc/self/exe", std::ios::binary);
+    std::ostringstream bytes;
+    if (exe and bytes << exe.rdbuf()) {
+      char hash[32];
+      std::snprintf(hash, sizeof(hash), "%016llx",
+                    (unsigned long long) CompileCache::fnv1a(bytes.str()));
+      return std::string("asl ") + hash;
     }
+    return "asl " __DATE__ " " __TIME__;
+  }();
+  return stamp;
+}
+
+
+// Options part of the key of the program cache. Options that change
+// the generated code have to be added here
+static std::string cacheOptionsKey(const CompileOptions & opts) {
+  return compilerStamp() + (opts.llvmSSA ? " llvm=ssa" : "") +
+    (opts.llvmRuntime ? " llvmRuntime" : "");
+}
+
+// Write the LLVM IR or the C code to <basename>.<ext> (or output.<ext>
+// when reading std::cin)
+static void writeOutputFile(const CompileOptions & opts, const std::string & ext,
+                            const std::string & outputStr) {
+  std::string outputFileName;
+  if (not opts.fileName.empty()) { // read from <file>
+    std::string inputFileName = opts.fileName;
+    std::size_t slashPos = inputFileName.rfind("/");
+    std::size_t dotPos   = inputFileName.rfind(".");
+    outputFileName = inputFileName.substr(slashPos+1, dotPos-slashPos-1) + "." + ext;
   }
+  else {           // read fron std::cin
+    outputFileName = "output." + ext;
+  }
+  std::ofstream myOutputFile(outputFileName, std::ofstream::out);
+  myOutputFile << outputStr << std::endl;
+}
+
 
-  // open input file (or std::cin) and create a character stream
-  antlr4::ANTLRInputStream input;
-  if ((argc == 3) or (argc == 2 and not onlySyntaxOpt and not noCodegenOpt)) {  // read from <file>
-    std::ifstream stream;
-    stream.open(argv[argc-1]);
-    input = antlr4::ANTLRInputStream(stream);
+// Key of the per-function cache entry of a function: its source text
+// plus the signatures of the global functions whose names it uses
+// (the callees), so it changes when a called function changes its
+// parameters or result type but not when only its body is edited.
+// The entry only has the t-code, that no option changes: the options
+// of the LLVM IR are not part of the key, only the compiler stamp
+static std::string functionCacheKey(AstFunction *function,
+                                    SymTable & symbols, SymTable::ScopeId globalScope,
+                                    TypesMgr & types) {
+  std::set<std::string> idents;
+  for (SymTable::IdentId id : function->idents) idents.insert(symbols.getIdentName(id));
+  std::string signatures;
+  symbols.pushThisScope(globalScope);
+  for (auto & ident : idents) {
+    if (symbols.findInCurrentScope(ident))
+      signatures += ident + ":" + types.to_string(symbols.getType(ident)) + "\n";
   }
-  else {            // read fron std::cin
-    input = antlr4::ANTLRInputStream(std::cin);
+  symbols.popScope();
+  return CompileCache::makeKey(function->source, compilerStamp() + "\n" + signatures);
+}
+
+
+// Parse the function of tokens with its own parser and add its AST to
+// program. Its tokens and parse tree (owned by the parser) are
+// released on return. It fails (reporting nothing) if there are
+// syntactical errors
+static bool parseFunction(std::vector<std::unique_ptr<antlr4::Token>> tokens,
+                          antlr4::ANTLRInputStream & input,
+                          AstBuilder & builder, AstProgram & program) {
+  antlr4::ListTokenSource   source(std::move(tokens));
+  antlr4::CommonTokenStream functionTokens(&source);
+  AslParser                 parser(&functionTokens);
+  parser.removeErrorListeners();
+  AslParser::FunctionContext *tree = parser.function();
+  if (parser.getNumberOfSyntaxErrors() > 0) return false;
+  std::unique_ptr<AstArena> arena(new AstArena);
+  AstFunction *function = builder.buildFunction(tree, input, *arena);
+  program.addFunction(std::move(arena), function);
+  return true;
+}
+
+// Split the tokens of the program into its functions, and parse and
+// lower each one before the next is lexed, so only the tokens and the
+// parse tree of one function are alive at a time. When lexFirst, all
+// the tokens are read before parsing (to time the lexer on its own).
+// It fails (reporting nothing) if there are lexical or syntactical
+// errors or tokens out of the functions: then the program has to be
+// parsed as a whole to report them
+static bool parseByFunction(const std::string & source, bool lexFirst, TimeReport & report,
+                            AstBuilder & builder, AstProgram & program,
+                            std::size_t & numberOfTokens) {
+  antlr4::ANTLRInputStream input(source);
+  AslLexer                 lexer(&input);
+  lexer.removeErrorListeners();
+  std::vector<std::unique_ptr<antlr4::Token>> allTokens;
+  if (lexFirst) {
+    report.startPhase("lexing");
+    do allTokens.push_back(lexer.nextToken());
+    while (allTokens.back()->getType() != antlr4::Token::EOF);
   }
+  report.startPhase("parsing");
+  std::vector<std::unique_ptr<antlr4::Token>> functionTokens;
+  for (std::size_t next = 0; ; ++next) {
+    std::unique_ptr<antlr4::Token> tok = lexFirst ? std::move(allTokens[next]) : lexer.nextToken();
+    ++numberOfTokens;
+    std::size_t type = tok->getType();
+    if (type == antlr4::Token::EOF) {
+      program.endPos = {static_cast<std::uint32_t>(tok->getLine()),
+                        static_cast<std::uint32_t>(tok->getCharPositionInLine())};
+      break;
+    }
+    // a function starts at a 'func' out of the functions
+    if ((type == AslLexer::FUNC) != functionTokens.empty()) return false;
+    functionTokens.push_back(std::move(tok));
+    if (type == AslLexer::ENDFUNC) {
+      if (not parseFunction(std::move(functionTokens), input, builder, program)) return false;
+      functionTokens.clear();
+    }
+  }
+  return lexer.getNumberOfSyntaxErrors() == 0 and functionTokens.empty() and
+    program.getNumberOfFunctions() > 0;
+}
 
-  // create a lexer that consumes the character stream and produces a token stream
-  AslLexer lexer(&input);
+// Parse the whole program, to report its lexical and syntactical
+// errors (with the error listeners of the antlr runtime). If there are
+// none, its functions are lowered to program
+static bool parseProgram(const std::string & source, AstBuilder & builder,
+                         AstProgram & program, std::size_t & numberOfTokens) {
+  antlr4::ANTLRInputStream  input(source);
+  AslLexer                  lexer(&input);
   antlr4::CommonTokenStream tokens(&lexer);
+  AslParser                 parser(&tokens);
+  AslParser::ProgramContext *tree = parser.program();
+  numberOfTokens = tokens.size();
+  if (lexer.getNumberOfSyntaxErrors() > 0 or parser.getNumberOfSyntaxErrors() > 0)
+    return false;
+  program.clear();
+  for (auto ctxFunc : tree->function()) {
+    std::unique_ptr<AstArena> arena(new AstArena);
+    AstFunction *function = builder.buildFunction(ctxFunc, input, *arena);
+    program.addFunction(std::move(arena), function);
+  }
+  antlr4::Token *eof = tree->getStop();
+  program.endPos = {static_cast<std::uint32_t>(eof->getLine()),
+                    static_cast<std::uint32_t>(eof->getCharPositionInLine())};
+  return true;
+}
 
-  // create a parser that consumes the token stream, and parses it.
-  AslParser parser(&tokens);
-
-  // call the parser and get the parse tree
-  antlr4::tree::ParseTree *tree = parser.program();
 
-  // check for lexical or syntactical errors
-  if (lexer.getNumberOfSyntaxErrors() > 0 or
-      parser.getNumberOfSyntaxErrors() > 0) {
-    std::cout << "Lexical and/or syntactical errors have been found." << std::endl;
-    return EXIT_FAILURE;
+// Type check the functions of the program on jobs threads. Each
+// thread takes functions from a shared counter and has its own copy
+// of the symbol table (for the stack of scopes) and its own errors,
+// which are merged at the end. Different functions decorate different
+// nodes, so the threads can share the AST.
+static void typecheckInParallel(AstProgram & program,
+                                TypesMgr & types, SymTable & symbols, SemErrors & errors,
+                                const std::set<std::string> & reusedNames,
+                                unsigned int jobs, TraceWriter *trace) {
+  TypeCheckVisitor typecheck(types, symbols, errors);
+  typecheck.beginProgram(&program);
+  std::atomic<std::size_t> next(0);
+  std::vector<SemErrors>   threadErrors(jobs);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < jobs; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      // a copy with the global scope already pushed
+      SymTable threadSymbols(symbols);
+      TypeCheckVisitor threadCheck(types, threadSymbols, threadErrors[t]);
+      threadCheck.setReusedFunctions(reusedNames);
+      threadCheck.setTrace(trace);
+      for (std::size_t i = next++; i < program.getNumberOfFunctions(); i = next++)
+        threadCheck.checkFunction(program.getFunction(i));
+    }));
   }
+  for (auto & thread : threads) thread.join();
+  for (auto & threadErr : threadErrors) errors.merge(threadErr);
+  typecheck.endProgram(&program);
+}
 
-  // print the parse tree (for debugging purposes)
-  // std::cout << tree->toStringTree(&parser) << std::endl;
 
-  if (onlySyntaxOpt) {
-    std::cout << "-- Early stop: no typecheck has been made." << std::endl;
-    return EXIT_SUCCESS;
+// Translate the program in source writing the result (or the errors)
+// to std::cout, and the time of each phase to report. Returns the
+// exit status of the translation.
+static int translateProgram(const std::string & source,
+                            const CompileOptions & opts,
+                            TimeReport & report) {
+  // a cached translation of the same source skips all the phases (the
+  // C code and the assembler are not kept in the cache: they are
+  // generated again; and a program that is run needs its code). The
+  // inlining is done on the whole program, so it does not use the cache
+  bool useCache = (opts.cache != nullptr and not opts.onlySyntax and not opts.noCodegen and
+                   not opts.inlineCalls);
+  bool useProgramCache = (useCache and not opts.emitC and not opts.emitX86 and not opts.run and
+                          opts.profile == nullptr);
+  std::string cacheKey;
+  if (useProgramCache) {
+    report.startPhase("cache lookup");
+    std::string tcode, llvm;
+    cacheKey = CompileCache::makeKey(source, cacheOptionsKey(opts));
+    if (opts.cache->lookup(cacheKey, opts.emitLLVM, tcode, llvm)) {
+      std::cout << tcode << std::endl;
+      if (opts.emitLLVM) writeOutputFile(opts, "ll", llvm);
+      return EXIT_SUCCESS;
+    }
   }
-  
+
   // auxililary classes we are going to need to store information while
-  // traversing the tree. They are described below in this document
+  // traversing the AST. They are described below in this document
   TypesMgr       types;
   SymTable       symbols(types);
-  TreeDecoration decorations;
   SemErrors      errors;
 
+  // lex the program and parse it one function at a time, lowering each
+  // function to its AST (with its identifiers interned in the symbol
+  // table) and releasing its tokens and parse tree before the next one.
+  // The source of each function is kept for the function cache
+  AstBuilder builder(symbols);
+  builder.setKeepSource(useCache);
+  AstProgram program;
+  std::size_t numberOfTokens = 0;
+  if (not parseByFunction(source, report.isEnabled(), report, builder, program,
+                          numberOfTokens)) {
+    // parse the whole program to report its errors
+    numberOfTokens = 0;
+    if (not parseProgram(source, builder, program, numberOfTokens)) {
+      std::cout << "Lexical and/or syntactical errors have been found." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  report.addCount("tokens", numberOfTokens);
+
+  if (opts.onlySyntax) {
+    std::cout << "-- Early stop: no typecheck has been made." << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  report.startPhase("symbols");
+  report.addCount("ast nodes", program.getNumberOfNodes());
+  report.addCount("functions", program.getNumberOfFunctions());
+
   // create a visitor that looks for variables and function declarations
-  // in the tree and stores required information
-  SymbolsVisitor symboldecl(types, symbols, decorations, errors);
-  symboldecl.visit(tree);
+  // in the AST and stores required information
+  SymbolsVisitor symboldecl(types, symbols, errors);
+  symboldecl.setTrace(opts.trace);
+  symboldecl.visitProgram(&program);
+
+  // functions that did not change since a previous compilation reuse
+  // the subroutine generated then, and are neither checked nor
+  // generated again
+  std::map<std::string, std::string> functionKeys;
+  std::map<std::string, subroutine>  reusedSubrs;
+  std::set<std::string>              reusedNames;
+  if (useCache and errors.getNumberOfSemanticErrors() == 0) {
+    report.startPhase("function cache");
+    for (std::size_t i = 0; i < program.getNumberOfFunctions(); ++i) {
+      AstFunction *function = program.getFunction(i);
+      std::string name = symbols.getIdentName(function->name.ident);
+      functionKeys[name] = functionCacheKey(function, symbols, program.scope, types);
+      subroutine subr(name);
+      if (opts.cache->lookupSubroutine(functionKeys[name], subr)) {
+        reusedSubrs.insert(std::make_pair(name, subr));
+        reusedNames.insert(name);
+      }
+    }
+  }
 
   // create another visitor that will perform type checkings wherever
   // it is needed (on expressions, assignments, parameter passing, etc)
-  TypeCheckVisitor typecheck(types, symbols, decorations, errors);
-  typecheck.visit(tree);
+  TypeCheckVisitor typecheck(types, symbols, errors);
+  typecheck.setReusedFunctions(reusedNames);
+  typecheck.setTrace(opts.trace);
+
+  // and a third visitor that will return the generated code
+  // for each part of the AST, and will store it in 'mycode'
+  CodeGenVisitor codegenerator(types, symbols);
+  codegenerator.setReusedSubroutines(reusedSubrs);
+  codegenerator.setTrace(opts.trace);
+  code mycode;
+  long tempsBefore = counters::getNumberOfTEMPs();
+
+  // in the fused mode the statements are walked once: each one is
+  // checked right before its code is generated (while its AST is still
+  // in the caches), and the generation stops at the first semantic
+  // error (the rest is only checked). The AST of each function is
+  // released once its code has been generated
+  bool fused = opts.fused and not opts.noCodegen;
+  report.startPhase(fused ? "typecheck+codegen" : "typecheck");
+  if (fused) {
+    typecheck.beginProgram(&program);
+    codegenerator.beginProgram(&program);
+    codegenerator.setTypeCheck(&typecheck);
+    for (std::size_t i = 0; i < program.getNumberOfFunctions(); ++i) {
+      if (errors.getNumberOfSemanticErrors() == 0)
+        mycode.add_subroutine(codegenerator.generateFunction(program.getFunction(i)));
+      else
+        typecheck.checkFunction(program.getFunction(i));
+      // the code does not refer to the AST of the function
+      program.releaseFunction(i);
+    }
+    codegenerator.endProgram(&program);
+    typecheck.endProgram(&program);
+  }
+  else if (opts.jobs > 1) {
+    typecheckInParallel(program, types, symbols, errors,
+                        reusedNames, opts.jobs, opts.trace);
+  }
+  else {
+    typecheck.visitProgram(&program);
+  }
+  report.addCount("types",  types.getNumberOfTypes());
+  report.addCount("scopes", symbols.getNumberOfScopes());
 
   if (errors.getNumberOfSemanticErrors() > 0) {
     std::cout << "There are semantic errors: no code generated." << std::endl;
     return EXIT_FAILURE;
   }
 
-  if (noCodegenOpt) {
+  if (opts.noCodegen) {
     std::cout << "-- Early stop: no code generated." << std::endl;
     return EXIT_SUCCESS;
   }
   
-  // create a third visitor that will return the generated code
-  // for each part of the tree, and will store it in 'mycode'
-  CodeGenVisitor codegenerator(types, symbols, decorations);
-  code mycode = codegenerator.visit(tree);
+  if (not fused) {
+    report.startPhase("codegen");
+    mycode = codegenerator.visitProgram(&program);
+  }
+  report.addCount("instructions", mycode.get_number_of_instructions());
+  report.addCount("temps",        counters::getNumberOfTEMPs() - tempsBefore);
+
+  // the code does not refer to the AST: release it before writing the
+  // output (that needs as much memory again)
+  report.startPhase("release AST");
+  program.clear();
 
-  // print generated code as output
-  std::cout << mycode.dump() << std::endl;
+  // inline the calls (before writing the code, so the tvm and all the
+  // backends run the inlined code)
+  if (opts.inlineCalls) {
+    report.startPhase("inlining");
+    TCodeInliner inliner(types, symbols, mycode, opts.profile);
+    inliner.inlineCalls();
+    report.addCount("inlined calls", inliner.getInlinedSites().size());
+    if (opts.inlineReport) {
+      for (auto & site : inliner.getInlinedSites()) {
+        std::cerr << "inlined " << site.callee << " (" << site.size << " instructions) into "
+                  << site.caller << " at " << site.pos;
+        if (site.count > 0) std::cerr << " (" << site.count << " executions)";
+        std::cerr << std::endl;
+      }
+    }
+  }
+
+  // print generated code as output (unless the program is run)
+  std::string tcode;
+  if (not opts.run) {
+    report.startPhase("t-code output");
+    tcode = mycode.dump();
+    std::cout << tcode << std::endl;
+  }
 
   // Visentada
-  // uncomment the following lines to generate LLVM code
-  // and write it to a .ll file
-  //std::string llvmStr = mycode.dumpLLVM(types, symbols);
-  //std::string llvmFileName;
-  //if (argc == 2) { // read from <file>
-  //  std::string inputFileName = std::string(argv[1]);
-  //  std::size_t slashPos = inputFileName.rfind("/");
-  //  std::size_t dotPos   = inputFileName.rfind(".");
-  //  llvmFileName = inputFileName.substr(slashPos+1, dotPos-slashPos-1) + ".ll";
-  //}
-  //else {           // read fron std::cin
-  //  llvmFileName = "output.ll";
-  //}
-  //std::ofstream myLLVMFile(llvmFileName, std::ofstream::out);
-  //myLLVMFile << llvmStr << std::endl;
+  // generate LLVM code and write it to a .ll file
+  std::string llvmStr;
+  if (opts.emitLLVM) {
+    report.startPhase("LLVM output");
+    llvmStr = mycode.dumpLLVM(types, symbols, opts.llvmSSA, opts.llvmRuntime, opts.profile);
+    writeOutputFile(opts, "ll", llvmStr);
+  }
+
+  // generate C code and write it to a .c file
+  if (opts.emitC) {
+    report.startPhase("C output");
+    writeOutputFile(opts, "c", mycode.dumpC(types, symbols));
+  }
+
+  // generate x86-64 assembler and write it to a .s file
+  if (opts.emitX86) {
+    report.startPhase("x86 output");
+    writeOutputFile(opts, "s", mycode.dumpX86(types, symbols));
+  }
+
+  if (useCache) {
+    report.startPhase("cache store");
+    if (useProgramCache) opts.cache->store(cacheKey, tcode, llvmStr);
+    for (auto & subr : mycode.get_subroutine_list()) {
+      if (reusedNames.count(subr.get_name()) == 0 and
+          functionKeys.count(subr.get_name()) > 0)
+        opts.cache->storeSubroutine(functionKeys[subr.get_name()], subr);
+    }
+  }
+
+  // run the program with the VM (its output is the one of the tvm);
+  // when profiling, its counts are written at the end
+  if (opts.run) {
+    report.startPhase("run");
+    bool profiling = not opts.profileFile.empty();
+    TCodeVM vm(types, symbols, mycode, opts.jitThreshold, profiling);
+    vm.setTrace(opts.trace);
+    int status = vm.run();
+    report.addCount("jitted functions", vm.getNumberOfCompiledFunctions());
+    if (profiling) {
+      report.startPhase("profile output");
+      TCodeProfile profile;
+      vm.getProfile(profile);
+      if (not profile.save(opts.profileFile)) {
+        std::cerr << "Cannot write the profile " << opts.profileFile << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    return status;
+  }
 
   return EXIT_SUCCESS;
 }
+
+// Translate the program in source (see translateProgram) and, if it
+// has been requested, write the time report to std::cerr. The phases
+// are timed for the trace too
+static int compileProgram(const std::string & source,
+                          const CompileOptions & opts) {
+  TimeReport report(opts.timeReport or opts.trace != nullptr);
+  report.setTrace(opts.trace);
+  int status = translateProgram(source, opts, report);
+  report.endPhase();
+  if (opts.timeReport) {
+    if (opts.timeReportJSON) report.printJSON(std::cerr);
+    else                     report.print(std::cerr);
+  }
+  return status;
+}
+
+
+// Serve one request of the compile server. Everything the translation
+// writes to std::cout/std::cerr (t-code, semantic and syntax errors)
+// is captured and sent back as the answer.
+// The lexer/parser DFA caches of the antlr runtime are static, so they
+// are built by the first requests and reused by the following ones.
+static int serveRequest(const CompileOptions & defaults,
+                        const std::vector<std::string> & options,
+                        const std::string & source,
+                        std::string & output) {
+  CompileOptions opts = defaults;
+  for (const auto & opt : options) {
+    if      (opt == "--onlySyntax") opts.onlySyntax = true;
+    else if (opt == "--noCodegen")  opts.noCodegen  = true;
+    else if (opt == "--fused")      opts.fused      = true;
+    else if (opt == "--timeReport") opts.timeReport = true;
+    else if (opt == "--timeReport=json")
+      opts.timeReport = opts.timeReportJSON = true;
+    else {
+      output = "Unknown option: " + opt + "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostringstream captured;
+  std::streambuf *coutBuf = std::cout.rdbuf(captured.rdbuf());
+  std::streambuf *cerrBuf = std::cerr.rdbuf(captured.rdbuf());
+  // a request that throws fails on its own: its answer is the error,
+  // and the server goes on with the next ones
+  int status;
+  std::string error;
+  try {
+    counters::reset();
+    status = compileProgram(source, opts);
+  }
+  catch (const std::exception & e) {
+    status = EXIT_FAILURE;
+    error = std::string("Internal compiler error: ") + e.what() + "\n";
+  }
+  catch (...) {
+    status = EXIT_FAILURE;
+    error = "Internal compiler error\n";
+  }
+  std::cout.rdbuf(coutBuf);
+  std::cerr.rdbuf(cerrBuf);
+  output = captured.str() + error;
+  return status;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // parse the options: [--onlySyntax|--noCodegen] [--fused|--jobs=<n>]
+  //   [--inline[=report]] [--llvm[=ssa] [--llvmRuntime]] [--profileUse=<file>]
+  //   [--c] [--x86]
+  //   [--run [--jit=<n>|--profile=<file>]]
+  //   [--cacheDir=<dir> [--cacheStats]] [--timeReport[=json]] [--trace=<file>]
+  //   [--server[=<socket>] | <file>]
+  CompileOptions opts;
+  bool serverOpt = false, cacheStatsOpt = false, jitOpt = false;
+  std::string socketPath, cacheDir, tracePath, profileUsePath;
+  bool usageError = false;
+  for (int i = 1; i < argc and not usageError; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--onlySyntax" and not opts.noCodegen)
+      opts.onlySyntax = true;
+    else if (arg == "--noCodegen" and not opts.onlySyntax)
+      opts.noCodegen = true;
+    else if (arg == "--fused" and opts.jobs == 1)
+      opts.fused = true;
+    else if (arg.compare(0, 7, "--jobs=") == 0 and not opts.fused and
+             arg.size() > 7 and arg.size() < 11 and
+             arg.find_first_not_of("0123456789", 7) == std::string::npos and
+             std::stoi(arg.substr(7)) > 0)
+      opts.jobs = std::stoi(arg.substr(7));
+    else if (arg == "--inline")
+      opts.inlineCalls = true;
+    else if (arg == "--inline=report")
+      opts.inlineCalls = opts.inlineReport = true;
+    else if (arg == "--llvm")
+      opts.emitLLVM = true;
+    else if (arg == "--llvm=ssa")
+      opts.emitLLVM = opts.llvmSSA = true;
+    else if (arg == "--llvmRuntime")
+      opts.llvmRuntime = true;
+    else if (arg == "--c")
+      opts.emitC = true;
+    else if (arg == "--x86")
+      opts.emitX86 = true;
+    else if (arg == "--run")
+      opts.run = true;
+    else if (arg.compare(0, 6, "--jit=") == 0 and
+             arg.size() > 6 and arg.size() < 16 and
+             arg.find_first_not_of("0123456789", 6) == std::string::npos) {
+      jitOpt = true;
+      opts.jitThreshold = std::stoul(arg.substr(6));
+    }
+    else if (arg.compare(0, 10, "--profile=") == 0 and arg.size() > 10)
+      opts.profileFile = arg.substr(10);
+    else if (arg.compare(0, 13, "--profileUse=") == 0 and arg.size() > 13)
+      profileUsePath = arg.substr(13);
+    else if (arg.compare(0, 11, "--cacheDir=") == 0 and arg.size() > 11)
+      cacheDir = arg.substr(11);
+    else if (arg == "--cacheStats")
+      cacheStatsOpt = true;
+    else if (arg == "--timeReport")
+      opts.timeReport = true;
+    else if (arg == "--timeReport=json")
+      opts.timeReport = opts.timeReportJSON = true;
+    else if (arg.compare(0, 8, "--trace=") == 0 and arg.size() > 8)
+      tracePath = arg.substr(8);
+    else if (arg == "--server")
+      serverOpt = true;
+    else if (arg.compare(0, 9, "--server=") == 0 and arg.size() > 9) {
+      serverOpt = true;
+      socketPath = arg.substr(9);
+    }
+    else if (arg.compare(0, 2, "--") != 0 and i == argc-1 and not serverOpt)
+      opts.fileName = arg;
+    else
+      usageError = true;
+  }
+  // check options and correct use of the program
+  if (usageError or (cacheStatsOpt and cacheDir.empty()) or
+      (serverOpt and (opts.emitLLVM or opts.emitC or opts.emitX86 or opts.run)) or
+      (jitOpt and (not opts.run or not opts.profileFile.empty())) or
+      (not opts.profileFile.empty() and not opts.run) or
+      (opts.llvmRuntime and not opts.emitLLVM) or
+      (not profileUsePath.empty() and not opts.emitLLVM and not opts.inlineCalls)) {
+    std::cout << "Usage: ./asl [--onlySyntax|--noCodegen] [--fused|--jobs=<n>] "
+              << "[--inline[=report]] [--llvm[=ssa] [--llvmRuntime]] "
+              << "[--profileUse=<file>] [--c] [--x86] "
+              << "[--run [--jit=<n>|--profile=<file>]] "
+              << "[--cacheDir=<dir> [--cacheStats]] [--timeReport[=json]] "
+              << "[--trace=<file>] [<file>]" << std::endl;
+    std::cout << "       ./asl [--onlySyntax|--noCodegen] [--fused|--jobs=<n>] "
+              << "[--cacheDir=<dir> [--cacheStats]] [--timeReport[=json]] "
+              << "[--trace=<file>] --server[=<socket>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // counts of a profile run for the inlining and the LLVM IR, if a
+  // profile has been given
+  TCodeProfile profile;
+  if (not profileUsePath.empty()) {
+    if (not profile.load(profileUsePath)) {
+      std::cerr << "Cannot read the profile " << profileUsePath << std::endl;
+      return EXIT_FAILURE;
+    }
+    opts.profile = &profile;
+  }
+
+  // cache of translations, if a directory has been given
+  std::unique_ptr<CompileCache> cache;
+  if (not cacheDir.empty()) {
+    cache.reset(new CompileCache(cacheDir));
+    opts.cache = cache.get();
+  }
+
+  // trace of the compilation, if a file has been given
+  std::unique_ptr<TraceWriter> trace;
+  if (not tracePath.empty()) {
+    trace.reset(new TraceWriter(tracePath));
+    if (not trace->isOpen()) {
+      std::cout << "Cannot create trace file: " << tracePath << std::endl;
+      return EXIT_FAILURE;
+    }
+    opts.trace = trace.get();
+  }
+
+  int status;
+  if (serverOpt) {
+    CompileServer server([&opts](const std::vector<std::string> & options,
+                                 const std::string & source,
+                                 std::string & output) {
+                           return serveRequest(opts, options, source, output);
+                         });
+    if (socketPath.empty()) status = server.serveStdio();
+    else                    status = server.serveSocket(socketPath);
+  }
+  else {
+    // read the whole input file (or std::cin)
+    std::ostringstream source;
+    if (not opts.fileName.empty()) {  // read from <file>
+      std::ifstream stream;
+      stream.open(opts.fileName);
+      if (not stream) {
+        std::cout << "No such file: " << opts.fileName << std::endl;
+        return EXIT_FAILURE;
+      }
+      source << stream.rdbuf();
+    }
+    else {            // read fron std::cin
+      source << std::cin.rdbuf();
+    }
+    status = compileProgram(source.str(), opts);
+  }
+
+  if (cacheStatsOpt) cache->printStats(std::cerr);
+  return status;
+}
@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslAst - Compact abstract syntax tree of
+//             the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "AslAst.h"
+
+#include <string>
+#include <vector>
+#include <memory>     // unique_ptr
+#include <utility>    // std::move
+#include <cstring>    // std::memcpy
+#include <cstdint>    // std::uintptr_t
+
+// using namespace std;
+
+
+const char * AstExpr::getOperatorText(Operator op) {
+  switch (op) {
+  case PlusOp:  return "+";
+  case MinusOp: return "-";
+  case MulOp:   return "*";
+  case DivOp:   return "/";
+  case ModOp:   return "%";
+  case EqualOp: return "==";
+  case NeqOp:   return "!=";
+  case GtOp:    return ">";
+  case LtOp:    return "<";
+  case GeOp:    return ">=";
+  case LeOp:    return "<=";
+  case AndOp:   return "and";
+  case OrOp:    return "or";
+  case NotOp:   return "not";
+  }
+  return "";
+}
+
+const char * AstStmt::getKeyword(Kind kind) {
+  switch (kind) {
+  case ReturnKind:      return "return";
+  case WhileKind:       return "while";
+  case IfKind:          return "if";
+  case ReadKind:        return "read";
+  case WriteExprKind:
+  case WriteStringKind: return "write";
+  case AssignKind:
+  case ProcCallKind:    break;
+  }
+  return "";
+}
+
+
+const std::size_t AstArena::MIN_BLOCK_SIZE;
+const std::size_t AstArena::MAX_BLOCK_SIZE;
+
+void * AstArena::allocate(std::size_t size, std::size_t align) {
+  std::size_t pad = (align - reinterpret_cast<std::uintptr_t>(Next) % align) % align;
+  if (Next == nullptr or pad + size > Left) {
+    // a new block (a bigger one for an array that does not fit)
+    std::size_t blockSize = BlockSize;
+    if (size + align > blockSize) blockSize = size + align;
+    else if (BlockSize < MAX_BLOCK_SIZE) BlockSize *= 2;
+    Blocks.emplace_back(new char[blockSize]);
+    Next = Blocks.back().get();
+    Left = blockSize;
+    Size += blockSize;
+    pad = (align - reinterpret_cast<std::uintptr_t>(Next) % align) % align;
+  }
+  void *p = Next + pad;
+  Next += pad + size;
+  Left -= pad + size;
+  return p;
+}
+
+const char * AstArena::makeText(const std::string & text) {
+  char *s = static_cast<char *>(allocate(text.size() + 1, 1));
+  std::memcpy(s, text.c_str(), text.size() + 1);
+  return s;
+}
+
+std::size_t AstArena::getNumberOfNodes() const {
+  return NumNodes;
+}
+
+std::size_t AstArena::getSize() const {
+  return Size;
+}
+
+
+void AstProgram::addFunction(std::unique_ptr<AstArena> arena, AstFunction *function) {
+  Arenas.push_back(std::move(arena));
+  Functions.push_back(function);
+}
+
+std::size_t AstProgram::getNumberOfFunctions() const {
+  return Functions.size();
+}
+
+AstFunction * AstProgram::getFunction(std::size_t i) const {
+  return Functions[i];
+}
+
+void AstProgram::releaseFunction(std::size_t i) {
+  Arenas[i].reset();
+  Functions[i] = nullptr;
+}
+
+void AstProgram::clear() {
+  std::vector<std::unique_ptr<AstArena>>().swap(Arenas);
+  std::vector<AstFunction *>().swap(Functions);
+}
+
+std::size_t AstProgram::getNumberOfNodes() const {
+  std::size_t n = 0;
+  for (auto & arena : Arenas)
+    if (arena) n += arena->getNumberOfNodes();
+  return n;
+}
+
+std::size_t AstProgram::getSize() const {
+  std::size_t n = 0;
+  for (auto & arena : Arenas)
+    if (arena) n += arena->getSize();
+  return n;
+}
@@ -0,0 +1,364 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    AslAst - Compact abstract syntax tree of
+//             the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+
+#include <string>
+#include <vector>
+#include <memory>       // unique_ptr
+#include <new>          // placement new
+#include <type_traits>  // std::is_trivially_destructible
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint8_t, std::uint32_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// The abstract syntax tree (AST) of a program. Each function is
+// lowered from its parse tree right after it has been parsed (see
+// AstBuilder), so its tokens and parse tree are released before the
+// next function is parsed; the visitors work on the AST.
+// The nodes are plain structs allocated in the arena of their function
+// and never destroyed one by one. Each kind of node has its own struct
+// with typed children, and the kind tag of its base (AstExpr or
+// AstStmt) tells which one it is. The identifiers are interned in the
+// symbol table (IdentId's), and the nodes keep the position of their
+// first token for the error messages.
+// The attributes computed by the visitors are fields of the nodes:
+//   - SymbolsVisitor     [TypeCheck phase 1]
+//       * sets the scope of the program and of the functions
+//       * sets the type of the type especifications (AstType)
+//   - TypeCheckVisitor   [TypeCheck phase 2]
+//       * sets the type and isLValue of the expressions
+//       * sets the symbol class of the identifiers
+//   - CodeGenVisitor     [Code Generation]
+//       * accesses all of them
+
+
+// Position of a token in the source
+struct AstPos {
+  std::uint32_t line;
+  std::uint32_t col;
+};
+
+// Array of children of a node (allocated in the arena)
+template <typename T>
+struct AstArray {
+  T           *items;
+  std::size_t  count;
+
+  T *         begin      ()              const { return items; }
+  T *         end        ()              const { return items + count; }
+  std::size_t size       ()              const { return count; }
+  T &         operator[] (std::size_t i) const { return items[i]; }
+};
+
+// Base of the nodes with a position: the one of their first token
+struct AstNode {
+  AstPos pos;
+};
+
+// An identifier in a declaration (of a function, parameter or variable)
+struct AstName : AstNode {
+  SymTable::IdentId ident;
+};
+
+// A type especification
+struct AstType {
+  enum Basic : std::uint8_t { IntegerBasic, FloatBasic, BooleanBasic, CharacterBasic };
+  Basic            basic;
+  bool             isArray;
+  unsigned int     size;      // number of elements of an array
+  TypesMgr::TypeId type;      // attribute
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// Expressions (also the left expressions of assignments and reads)
+
+struct AstExpr : AstNode {
+  enum Kind : std::uint8_t {
+    IdentKind,           // AstIdentExpr
+    ValueKind,           // AstValueExpr
+    ParenthesisKind,     // AstParenthesisExpr
+    ArrayAccessKind,     // AstArrayAccessExpr
+    UnaryArithmeticKind, // AstUnaryExpr
+    UnaryLogicalKind,    // AstUnaryExpr
+    ArithmeticKind,      // AstBinaryExpr
+    RelationalKind,      // AstBinaryExpr
+    LogicalKind,         // AstBinaryExpr
+    FuncCallKind,        // AstFuncCallExpr
+  };
+  enum Operator : std::uint8_t {
+    PlusOp, MinusOp, MulOp, DivOp, ModOp,
+    EqualOp, NeqOp, GtOp, LtOp, GeOp, LeOp,
+    AndOp, OrOp, NotOp,
+  };
+
+  Kind             kind;
+  bool             isLValue;  // attribute
+  TypesMgr::TypeId type;      // attribute
+
+  // The text of an operator, as written in the source
+  static const char * getOperatorText (Operator op);
+};
+
+struct AstIdentExpr : AstExpr {
+  SymTable::IdentId    ident;
+  SymTable::SymClassId symClass;  // attribute
+};
+
+struct AstValueExpr : AstExpr {
+  AstType::Basic basic;
+  const char   * text;        // the literal, as written in the source
+};
+
+struct AstParenthesisExpr : AstExpr {
+  AstExpr *expr;
+};
+
+struct AstArrayAccessExpr : AstExpr {
+  AstExpr *array;
+  AstExpr *index;
+};
+
+// the position of an unary expression is the one of its operator
+struct AstUnaryExpr : AstExpr {
+  Operator op;
+  AstExpr *expr;
+};
+
+struct AstBinaryExpr : AstExpr {
+  Operator op;
+  AstPos   opPos;
+  AstExpr *left;
+  AstExpr *right;
+};
+
+struct AstFuncCallExpr : AstExpr {
+  AstIdentExpr      *callee;
+  AstArray<AstExpr *> args;
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// Statements
+
+struct AstStmt : AstNode {
+  enum Kind : std::uint8_t {
+    AssignKind,          // AstAssignStmt
+    ReturnKind,          // AstReturnStmt
+    WhileKind,           // AstWhileStmt
+    IfKind,              // AstIfStmt
+    ProcCallKind,        // AstProcCallStmt
+    ReadKind,            // AstReadStmt
+    WriteExprKind,       // AstWriteExprStmt
+    WriteStringKind,     // AstWriteStringStmt
+  };
+
+  Kind kind;
+
+  // The keyword a statement starts with ("" for assignments and calls)
+  static const char * getKeyword (Kind kind);
+};
+
+struct AstAssignStmt : AstStmt {
+  AstPos   assignPos;
+  AstExpr *left;
+  AstExpr *expr;
+};
+
+struct AstReturnStmt : AstStmt {
+  AstExpr *expr;              // null if there is no expression
+};
+
+struct AstWhileStmt : AstStmt {
+  AstExpr            *cond;
+  AstArray<AstStmt *> body;
+};
+
+struct AstIfStmt : AstStmt {
+  AstExpr            *cond;
+  AstArray<AstStmt *> thenBody;
+  bool                hasElse;
+  AstArray<AstStmt *> elseBody;
+};
+
+struct AstProcCallStmt : AstStmt {
+  AstIdentExpr       *callee;
+  AstArray<AstExpr *> args;
+};
+
+struct AstReadStmt : AstStmt {
+  AstExpr *left;
+};
+
+struct AstWriteExprStmt : AstStmt {
+  AstExpr *expr;
+};
+
+struct AstWriteStringStmt : AstStmt {
+  const char *text;           // the string, with its quotes
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// Functions
+
+struct AstParam {
+  AstName name;
+  AstType type;
+};
+
+struct AstVarDecl {
+  AstArray<AstName> names;
+  AstType           type;
+};
+
+struct AstFunction : AstNode {
+  AstName                name;
+  AstArray<AstParam>     params;
+  bool                   hasType;
+  AstType                type;          // result type (if hasType)
+  AstArray<AstVarDecl>   decls;
+  AstArray<AstStmt *>    body;
+  SymTable::ScopeId      scope;         // attribute
+  // only for the function cache (null/empty if it is not used): the
+  // source of the function and the identifiers that appear in it
+  const char                  *source;
+  AstArray<SymTable::IdentId>  idents;
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// Class AstArena: the memory of the nodes of one function. They are
+// allocated one after the other in blocks (of growing size, as most
+// functions are small) and freed all at once with the arena.
+
+class AstArena {
+
+public:
+
+  AstArena() = default;
+  AstArena(const AstArena &) = delete;
+  AstArena & operator=(const AstArena &) = delete;
+
+  // A new node of type T, zero initialized
+  template <typename T>
+  T * makeNode ();
+  // An array with a copy of the elements of v
+  template <typename T>
+  AstArray<T> makeArray (const std::vector<T> & v);
+  // A copy of text
+  const char * makeText (const std::string & text);
+
+  // Number of nodes and of bytes allocated
+  std::size_t getNumberOfNodes () const;
+  std::size_t getSize          () const;
+
+private:
+
+  static const std::size_t MIN_BLOCK_SIZE = 1024;
+  static const std::size_t MAX_BLOCK_SIZE = 64*1024;
+
+  std::vector<std::unique_ptr<char[]>> Blocks;
+  char       * Next      = nullptr;
+  std::size_t  Left      = 0;
+  std::size_t  BlockSize = MIN_BLOCK_SIZE;
+  std::size_t  NumNodes  = 0;
+  std::size_t  Size      = 0;
+
+  // size bytes aligned to align
+  void * allocate (std::size_t size, std::size_t align);
+
+};  // class AstArena
+
+
+template <typename T>
+T * AstArena::makeNode() {
+  static_assert(std::is_trivially_destructible<T>::value,
+                "the nodes of the arena are never destroyed");
+  ++NumNodes;
+  return new (allocate(sizeof(T), alignof(T))) T();
+}
+
+template <typename T>
+AstArray<T> AstArena::makeArray(const std::vector<T> & v) {
+  static_assert(std::is_trivially_destructible<T>::value,
+                "the nodes of the arena are never destroyed");
+  AstArray<T> a;
+  a.count = v.size();
+  a.items = nullptr;
+  if (not v.empty()) {
+    a.items = static_cast<T *>(allocate(v.size() * sizeof(T), alignof(T)));
+    for (std::size_t i = 0; i < v.size(); ++i) new (a.items + i) T(v[i]);
+  }
+  return a;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// Class AstProgram: the functions of a program, each one in its own
+// arena, so the fused mode can release each function once its code
+// has been generated.
+
+class AstProgram {
+
+public:
+
+  AstProgram() = default;
+
+  // Add a function (allocated in arena)
+  void          addFunction          (std::unique_ptr<AstArena> arena,
+                                      AstFunction *function);
+  std::size_t   getNumberOfFunctions () const;
+  AstFunction * getFunction          (std::size_t i) const;
+  // Free the nodes of the function i (it becomes null)
+  void          releaseFunction      (std::size_t i);
+  // Free all the functions
+  void          clear                ();
+
+  // Number of nodes and of bytes of the functions not released
+  std::size_t   getNumberOfNodes     () const;
+  std::size_t   getSize              () const;
+
+  // Position of the end of the program (where a missing main is reported)
+  AstPos            endPos = {0, 0};
+  SymTable::ScopeId scope  = 0;      // attribute
+
+private:
+
+  std::vector<std::unique_ptr<AstArena>> Arenas;
+  std::vector<AstFunction *>             Functions;
+
+};  // class AstProgram
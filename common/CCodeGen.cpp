@@ -0,0 +1,454 @@
+/////////////////////////////////////////////////////////////////
+//
+//    CCodeGen - C99 code generation for the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "CCodeGen.h"
+
+#include <sstream>
+
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+static const char * const INDENT = "  ";
+
+// The instructions that assign their first operand
+static bool assignsArg1(instruction::Operation oper) {
+  switch (oper) {
+  case instruction::_ADD:   case instruction::_SUB:    case instruction::_MUL:
+  case instruction::_DIV:   case instruction::_EQ:     case instruction::_LT:
+  case instruction::_LE:    case instruction::_NEG:    case instruction::_NOT:
+  case instruction::_AND:   case instruction::_OR:     case instruction::_FLOAT:
+  case instruction::_FADD:  case instruction::_FSUB:   case instruction::_FMUL:
+  case instruction::_FDIV:  case instruction::_FEQ:    case instruction::_FLT:
+  case instruction::_FLE:   case instruction::_FNEG:   case instruction::_LOAD:
+  case instruction::_ILOAD: case instruction::_CHLOAD: case instruction::_FLOAD:
+  case instruction::_LOADX: case instruction::_ALOAD:  case instruction::_LOADC:
+  case instruction::_READI: case instruction::_READF:  case instruction::_READC:
+  case instruction::_POP:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// The integer arithmetic of the t-code wraps around (as the one of the
+// LLVM IR): it is done on unsigned values, that gcc compiles to the
+// same instructions
+static const char * const C_PROLOGUE =
+  "// C99 code generated by asl: gcc -O2 -std=c99 <file>.c\n"
+  "\n"
+  "#include <stdbool.h>\n"
+  "#include <stdio.h>\n"
+  "#include <stdlib.h>\n"
+  "\n"
+  "static inline int aslAdd(int a, int b) { return (int)((unsigned)a + (unsigned)b); }\n"
+  "static inline int aslSub(int a, int b) { return (int)((unsigned)a - (unsigned)b); }\n"
+  "static inline int aslMul(int a, int b) { return (int)((unsigned)a * (unsigned)b); }\n"
+  "static inline int aslNeg(int a)        { return (int)(0u - (unsigned)a); }\n"
+  "\n"
+  "// a failed read leaves the variable unchanged\n"
+  "static inline void aslReadInt(int *v)     { int n = scanf(\"%d\", v); (void)n; }\n"
+  "static inline void aslReadFloat(float *v) { int n = scanf(\"%f\", v); (void)n; }\n"
+  "static inline void aslReadChar(char *v)   { int n = scanf(\" %c\", v); (void)n; }\n"
+  "\n";
+
+
+CCodeGen::CCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode) :
+  Types{Types}, Symbols{Symbols}, tCode{tCode}, ValueTypes{Types, Symbols, tCode} {
+}
+
+std::string CCodeGen::dumpC() {
+  std::ostringstream cCode;
+  dumpPrologue(cCode);
+  // a function that is never called is not static (gcc warns of an
+  // unused static function)
+  calledFunctions.clear();
+  for (auto & subr : tCode.get_subroutine_list())
+    for (auto & instr : subr.get_instructions())
+      if (instr.oper == instruction::_CALL) calledFunctions.insert(instr.arg1);
+  // the prototypes first: the functions can be called before (and
+  // from) their definitions
+  bool anyPrototype = false;
+  for (auto & subr : tCode.get_subroutine_list()) {
+    if (subr.get_name() == "main") continue;
+    dumpHeader(subr, cCode);
+    cCode << ";\n";
+    anyPrototype = true;
+  }
+  if (anyPrototype) cCode << "\n";
+  for (auto & subr : tCode.get_subroutine_list())
+    dumpSubroutine(subr, cCode);
+  return cCode.str();
+}
+
+
+////////////////////////////////////////////////////////////////
+// Types
+
+std::string CCodeGen::CTypeDecl(const TCodeTypes::ValueType & type, const std::string & name) {
+  std::string elem = type.elem.empty() ? "int" : type.elem;
+  if (type.pointer)
+    return elem + " *" + name;
+  else if (type.size > 0)
+    return elem + " " + name + "[" + std::to_string(type.size) + "]";
+  else
+    return elem + " " + name;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Names and constants
+
+// %4 -> t4, a -> v_a (the Asl identifiers can be C keywords)
+std::string CCodeGen::getCName(const std::string & tcodeArg) const {
+  if (TCodeTypes::isTemporal(tcodeArg))
+    return "t" + tcodeArg.substr(1);
+  else if (ValueTypes.isSymbol(tcodeArg))
+    return "v_" + tcodeArg;
+  else
+    return tcodeArg;
+}
+
+// 3.14 -> 3.14f (a float constant, not rounded from a double one)
+std::string CCodeGen::getCFloat(const std::string & aslFloat) {
+  if (aslFloat.find('.') == std::string::npos)
+    return aslFloat + ".0f";
+  return aslFloat + "f";
+}
+
+// The escape sequences of Asl are the ones of C, but a '?' has to be
+// escaped to avoid the trigraphs of C99
+std::string CCodeGen::getCString(const std::string & aslString) {
+  std::string cString;
+  for (char c : aslString) {
+    if (c == '?') cString += '\\';
+    cString += c;
+  }
+  return cString;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Code
+
+void CCodeGen::dumpPrologue(std::ostream & os) const {
+  os << C_PROLOGUE;
+}
+
+void CCodeGen::dumpHeader(const subroutine & subr, std::ostream & os) const {
+  const TCodeTypes::FunctionType & func = ValueTypes.getFunctionType(subr.get_name());
+  os << (calledFunctions.count(subr.get_name()) > 0 ? "static " : "")
+     << (func.ret.elem.empty() ? "void" : func.ret.elem)
+     << " f_" << subr.get_name() << "(";
+  std::size_t i = 0;
+  for (auto & param : subr.params) {
+    if (param.name == "_result") continue;
+    os << (i == 0 ? "" : ", ") << CTypeDecl(func.params[i], "v_" + param.name);
+    ++i;
+  }
+  os << (i == 0 ? "void)" : ")");
+}
+
+void CCodeGen::dumpSubroutine(const subroutine & subr, std::ostream & os) {
+  bool isMain = (subr.get_name() == "main");
+  currentFunctionName = subr.get_name();
+  ValueTypes.bindSubroutine(subr);
+  const instructionList & instrs = subr.get_instructions();
+  usedLabels.clear();
+  for (auto & instr : instrs) {
+    if (instr.oper == instruction::_UJUMP)
+      usedLabels.insert(instr.arg1);
+    else if (instr.oper == instruction::_FJUMP)
+      usedLabels.insert(instr.arg2);
+  }
+  pushedParams.clear();
+  pendingCalls.clear();
+
+  if (isMain)
+    os << "int main(void)";
+  else
+    dumpHeader(subr, os);
+  os << " {\n";
+  // the scalars start at zero (and so the variables read by a failed read)
+  for (auto & param : subr.params) {
+    if (param.name == "_result")
+      os << INDENT << CTypeDecl(ValueTypes.getTypeOf(param.name), "v__result") << " = 0;\n";
+  }
+  // (the local vars that no instruction uses are not declared, and
+  // the params and vars that are never read are marked as used, so the
+  // code compiles without warnings with gcc -Wall -Wextra)
+  std::set<std::string> usedNames, readNames;
+  for (auto & instr : instrs) {
+    usedNames.insert(instr.arg1);
+    usedNames.insert(instr.arg2);
+    usedNames.insert(instr.arg3);
+    if (not assignsArg1(instr.oper)) readNames.insert(instr.arg1);
+    readNames.insert(instr.arg2);
+    readNames.insert(instr.arg3);
+  }
+  std::vector<std::string> unreadNames;
+  for (auto & param : subr.params)
+    if (param.name != "_result" and readNames.count(param.name) == 0)
+      unreadNames.push_back("v_" + param.name);
+  for (auto & varlocal : subr.vars) {
+    if (usedNames.count(varlocal.name) == 0) continue;
+    TCodeTypes::ValueType type = ValueTypes.getTypeOf(varlocal.name);
+    os << INDENT << CTypeDecl(type, "v_" + varlocal.name)
+       << (type.size > 0 ? " = {0};\n" : " = 0;\n");
+    if (readNames.count(varlocal.name) == 0) unreadNames.push_back("v_" + varlocal.name);
+  }
+  // the temporals in the order of their numbers
+  std::map<int, const TCodeTypes::ValueType *> temps;
+  for (auto & pair : ValueTypes.getTemporalTypes())
+    temps[std::stoi(pair.first.substr(1))] = &pair.second;
+  for (auto & pair : temps) {
+    const TCodeTypes::ValueType & type = *pair.second;
+    os << INDENT << CTypeDecl(type, "t" + std::to_string(pair.first))
+       << (type.pointer ? ";\n" : " = 0;\n");
+    if (readNames.count("%" + std::to_string(pair.first)) == 0)
+      unreadNames.push_back("t" + std::to_string(pair.first));
+  }
+  for (auto & name : unreadNames)
+    os << INDENT << "(void)" << name << ";\n";
+  if (not subr.vars.empty() or not temps.empty() or
+      (not subr.params.empty() and subr.params.front().name == "_result"))
+    os << "\n";
+
+  for (auto & instr : instrs)
+    dumpInstruction(instr, os);
+  if (instrs.empty() or instrs.back().oper != instruction::_RETURN)
+    dumpInstruction(instruction::RETURN(), os);
+  os << "}\n\n";
+}
+
+void CCodeGen::dumpInstruction(const instruction & instr, std::ostream & os) {
+  std::string a1 = getCName(instr.arg1);
+  std::string a2 = getCName(instr.arg2);
+  std::string a3 = getCName(instr.arg3);
+  switch (instr.oper) {
+  case instruction::_LABEL:
+    if (usedLabels.count(instr.arg1))
+      os << "L_" << instr.arg1 << ": ;\n";
+    return;
+  case instruction::_UJUMP:
+    os << INDENT << "goto L_" << instr.arg1 << ";\n";
+    return;
+  case instruction::_FJUMP:
+    os << INDENT << "if (!" << a1 << ") goto L_" << instr.arg2 << ";\n";
+    return;
+  case instruction::_HALT:
+    os << INDENT << "exit(EXIT_FAILURE);\n";
+    return;
+  case instruction::_PUSH:
+    pushedParams.push_back(instr.arg1);
+    return;
+  case instruction::_CALL:
+    {
+      // the params of the callee (with the slot of the result) are the
+      // last ones pushed
+      PendingCall call;
+      call.func = instr.arg1;
+      call.pops = tCode.get_subroutine(call.func).params.size();
+      assert(pushedParams.size() >= call.pops);
+      auto first = pushedParams.end() - call.pops;
+      if (not ValueTypes.getFunctionType(call.func).ret.elem.empty())
+        ++first;                       // the (empty) slot of the result
+      for (auto it = first; it != pushedParams.end(); ++it)
+        call.args.push_back(getCName(*it));
+      pushedParams.erase(pushedParams.end() - call.pops, pushedParams.end());
+      if (call.pops == 0)
+        dumpCall(call, os);
+      else
+        pendingCalls.push_back(call);
+      return;
+    }
+  case instruction::_POP:
+    {
+      // the result is the last one popped
+      if (pendingCalls.empty()) return;
+      PendingCall & call = pendingCalls.back();
+      if (not instr.arg1.empty())
+        call.result = a1;
+      if (--call.pops == 0) {
+        dumpCall(call, os);
+        pendingCalls.pop_back();
+      }
+      return;
+    }
+  case instruction::_RETURN:
+    if (currentFunctionName == "main")
+      os << INDENT << "return 0;\n";
+    else if (ValueTypes.isSymbol("_result"))
+      os << INDENT << "return v__result;\n";
+    else
+      os << INDENT << "return;\n";
+    return;
+  case instruction::_LOAD:
+    {
+      // in an array copy the elements are copied before: a2 is the
+      // address of the other array
+      TCodeTypes::ValueType type1 = ValueTypes.getTypeOf(instr.arg1);
+      if (not TCodeTypes::isTemporal(instr.arg1) and (type1.size > 0 or type1.pointer))
+        return;
+      break;
+    }
+  case instruction::_NOOP:
+  case instruction::_INVALID:
+    return;
+  default:
+    break;
+  }
+
+  os << INDENT;
+  switch (instr.oper) {
+  case instruction::_LOAD:
+    os << a1 << " = " << a2;
+    break;
+  case instruction::_ILOAD:
+    os << a1 << " = " << instr.arg2;
+    break;
+  case instruction::_FLOAD:
+    os << a1 << " = " << getCFloat(instr.arg2);
+    break;
+  case instruction::_CHLOAD:
+    os << a1 << " = '" << instr.arg2 << "'";
+    break;
+  case instruction::_XLOAD:
+    os << a1 << "[" << a2 << "] = " << a3;
+    break;
+  case instruction::_LOADX:
+    os << a1 << " = " << a2 << "[" << a3 << "]";
+    break;
+  case instruction::_ALOAD:
+    // the name of an array is its address
+    if (ValueTypes.getTypeOf(instr.arg2).size > 0 or ValueTypes.getTypeOf(instr.arg2).pointer)
+      os << a1 << " = " << a2;
+    else
+      os << a1 << " = &" << a2;
+    break;
+  case instruction::_LOADC:
+    os << a1 << " = *" << a2;
+    break;
+  case instruction::_CLOAD:
+    os << "*" << a1 << " = " << a2;
+    break;
+  case instruction::_ADD:
+    os << a1 << " = aslAdd(" << a2 << ", " << a3 << ")";
+    break;
+  case instruction::_SUB:
+    os << a1 << " = aslSub(" << a2 << ", " << a3 << ")";
+    break;
+  case instruction::_MUL:
+    os << a1 << " = aslMul(" << a2 << ", " << a3 << ")";
+    break;
+  case instruction::_NEG:
+    os << a1 << " = aslNeg(" << a2 << ")";
+    break;
+  case instruction::_DIV:
+  case instruction::_FDIV:
+    os << a1 << " = " << a2 << " / " << a3;
+    break;
+  case instruction::_FADD:
+    os << a1 << " = " << a2 << " + " << a3;
+    break;
+  case instruction::_FSUB:
+    os << a1 << " = " << a2 << " - " << a3;
+    break;
+  case instruction::_FMUL:
+    os << a1 << " = " << a2 << " * " << a3;
+    break;
+  case instruction::_FNEG:
+    os << a1 << " = -" << a2;
+    break;
+  case instruction::_FLOAT:
+    os << a1 << " = (float)" << a2;
+    break;
+  case instruction::_EQ:
+  case instruction::_FEQ:
+    os << a1 << " = " << a2 << " == " << a3;
+    break;
+  case instruction::_LT:
+  case instruction::_FLT:
+    os << a1 << " = " << a2 << " < " << a3;
+    break;
+  case instruction::_LE:
+  case instruction::_FLE:
+    os << a1 << " = " << a2 << " <= " << a3;
+    break;
+  case instruction::_NOT:
+    os << a1 << " = !" << a2;
+    break;
+  case instruction::_AND:
+    os << a1 << " = " << a2 << " && " << a3;
+    break;
+  case instruction::_OR:
+    os << a1 << " = " << a2 << " || " << a3;
+    break;
+  case instruction::_READI:
+    os << "aslReadInt(&" << a1 << ")";
+    break;
+  case instruction::_READF:
+    os << "aslReadFloat(&" << a1 << ")";
+    break;
+  case instruction::_READC:
+    os << "aslReadChar(&" << a1 << ")";
+    break;
+  case instruction::_WRITEI:
+    os << "printf(\"%d\", " << a1 << ")";
+    break;
+  case instruction::_WRITEF:
+    os << "printf(\"%g\", " << a1 << ")";
+    break;
+  case instruction::_WRITEC:
+    os << "putchar(" << a1 << ")";
+    break;
+  case instruction::_WRITES:
+    os << "fputs(" << getCString(instr.arg1) << ", stdout)";
+    break;
+  case instruction::_WRITELN:
+    os << "putchar('\\n')";
+    break;
+  default:
+    os << "/* " << instr.dump() << " */\n";
+    return;
+  }
+  os << ";\n";
+}
+
+void CCodeGen::dumpCall(const PendingCall & call, std::ostream & os) const {
+  os << INDENT;
+  if (not call.result.empty())
+    os << call.result << " = ";
+  os << "f_" << call.func << "(";
+  for (std::size_t i = 0; i < call.args.size(); ++i)
+    os << (i == 0 ? "" : ", ") << call.args[i];
+  os << ");\n";
+}
@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////
+//
+//    CCodeGen - C99 code generation for the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+#include "code.h"
+#include "TCodeTypes.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <ostream>
+
+// using namespace std;
+
+class code;
+class subroutine;
+class instruction;
+
+// Translation of the t-code of a program into a C99 source file: each
+// subroutine is a (static) C function with its params, local vars and
+// temporals as C locals, the arrays as C arrays (pointers when they
+// are params), and the jumps as gotos to C labels
+class CCodeGen {
+ private:
+  const TypesMgr & Types;
+  const SymTable & Symbols;
+  const code     & tCode;
+
+  // types of the functions and of the values of the current function
+  TCodeTypes ValueTypes;
+  std::string                   currentFunctionName;
+  std::set<std::string>         usedLabels;
+  std::set<std::string>         calledFunctions;   // the others are not static
+
+  // a call is written when the params pushed for it have been popped
+  struct PendingCall {
+    std::string              func;
+    std::vector<std::string> args;
+    std::size_t              pops;    // popparam still to come
+    std::string              result;
+  };
+  std::vector<std::string>      pushedParams;
+  std::vector<PendingCall>      pendingCalls;
+
+  static std::string CTypeDecl(const TCodeTypes::ValueType & type, const std::string & name);
+
+  std::string getCName(const std::string & tcodeArg) const;
+  static std::string getCFloat(const std::string & aslFloat);
+  static std::string getCString(const std::string & aslString);
+
+  void dumpPrologue(std::ostream & os) const;
+  void dumpHeader(const subroutine & subr, std::ostream & os) const;
+  void dumpSubroutine(const subroutine & subr, std::ostream & os);
+  void dumpInstruction(const instruction & instr, std::ostream & os);
+  void dumpCall(const PendingCall & call, std::ostream & os) const;
+
+ public:
+  CCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
+
+  // the C99 code of the program
+  std::string dumpC();
+};
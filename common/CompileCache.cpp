@@ -0,0 +1,160 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileCache - On-disk cache of translations, addressed by
+//                   the contents of the source and the options
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "CompileCache.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <cstdio>     // std::rename, std::remove, std::snprintf
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// using namespace std;
+
+
+// Constructor
+CompileCache::CompileCache(const std::string & dir) :
+  Dir{dir}, Hits{0}, Misses{0}, FunctionHits{0}, FunctionMisses{0} {
+  if (Dir.empty()) Dir = ".";
+  // create the directory (and its missing parents)
+  for (std::size_t pos = Dir.find('/', 1); ; pos = Dir.find('/', pos + 1)) {
+    mkdir(Dir.substr(0, pos).c_str(), 0777);
+    if (pos == std::string::npos) break;
+  }
+}
+
+std::uint64_t CompileCache::fnv1a(const std::string & data, std::uint64_t h) {
+  for (unsigned char c : data) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+std::string CompileCache::makeKey(const std::string & source,
+                                  const std::string & options) {
+  // hash of options and source, plus the source length to make
+  // collisions even less likely
+  std::uint64_t h = fnv1a(source, fnv1a(options + '\0'));
+  char key[64];
+  std::snprintf(key, sizeof(key), "%016llx-%llx",
+                (unsigned long long) h, (unsigned long long) source.size());
+  return key;
+}
+
+bool CompileCache::lookup(const std::string & key, bool withLLVM,
+                          std::string & tcode, std::string & llvm) {
+  bool hit = readFile(entryPath(key, ".t"), tcode);
+  if (hit and withLLVM) hit = readFile(entryPath(key, ".ll"), llvm);
+  if (hit) ++Hits;
+  else     ++Misses;
+  return hit;
+}
+
+void CompileCache::store(const std::string & key,
+                         const std::string & tcode, const std::string & llvm) {
+  // the .t file is written last: a lookup that finds it also finds the .ll
+  if (not llvm.empty()) writeFileAtomic(entryPath(key, ".ll"), llvm);
+  writeFileAtomic(entryPath(key, ".t"), tcode);
+}
+
+bool CompileCache::lookupSubroutine(const std::string & key, subroutine & subr) {
+  std::string text;
+  bool hit = (readFile(entryPath(key, ".sub"), text) and
+              subroutine::deserialize(text, subr));
+  if (hit) ++FunctionHits;
+  else     ++FunctionMisses;
+  return hit;
+}
+
+void CompileCache::storeSubroutine(const std::string & key, const subroutine & subr) {
+  writeFileAtomic(entryPath(key, ".sub"), subr.serialize());
+}
+
+std::size_t CompileCache::getNumberOfHits() const {
+  return Hits;
+}
+
+std::size_t CompileCache::getNumberOfMisses() const {
+  return Misses;
+}
+
+std::size_t CompileCache::getNumberOfFunctionHits() const {
+  return FunctionHits;
+}
+
+std::size_t CompileCache::getNumberOfFunctionMisses() const {
+  return FunctionMisses;
+}
+
+void CompileCache::printStats(std::ostream & os) const {
+  os << "-- Cache " << Dir << ": " << Hits << " hits, " << Misses << " misses"
+     << " (functions: " << FunctionHits << " reused, "
+     << FunctionMisses << " regenerated)" << std::endl;
+}
+
+std::string CompileCache::entryPath(const std::string & key, const std::string & ext) const {
+  return Dir + "/" + key + ext;
+}
+
+bool CompileCache::readFile(const std::string & path, std::string & data) {
+  std::ifstream file(path, std::ios::binary);
+  if (not file) return false;
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  if (file.bad()) return false;
+  data = contents.str();
+  return true;
+}
+
+bool CompileCache::writeFileAtomic(const std::string & path, const std::string & data) {
+  static unsigned int count = 0;
+  std::string tmpPath = path + "." + std::to_string(getpid()) + "." +
+                        std::to_string(++count) + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (not file) return false;
+    file << data;
+    file.close();
+    if (file.fail()) {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+  // rename() is atomic: readers see the old entry or the new one
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
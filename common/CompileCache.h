@@ -0,0 +1,106 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileCache - On-disk cache of translations, addressed by
+//                   the contents of the source and the options
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "code.h"
+
+#include <string>
+#include <ostream>
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint64_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CompileCache: stores the generated t-code (and the LLVM IR,
+// when it has been requested) of each translated program in a
+// directory. The entries are named after a hash of the source bytes
+// and the compiler options, so a hit means the whole translation can
+// be skipped. Entries are written to a temporary file and renamed
+// into place, so concurrent compilers never see a partial entry.
+// The cache also keeps the subroutine generated for each function,
+// so a program where only some functions changed can reuse the code
+// of the others.
+
+class CompileCache {
+
+public:
+
+  // Constructor (the directory is created if it does not exist)
+  CompileCache(const std::string & dir);
+
+  // Key of the translation of source with the given options
+  static std::string makeKey(const std::string & source,
+                             const std::string & options);
+
+  // Look up the entry of key. On a hit returns true and the stored
+  // t-code (and the LLVM IR, if withLLVM is set)
+  bool lookup (const std::string & key, bool withLLVM,
+               std::string & tcode, std::string & llvm);
+
+  // Store the entry of key (an empty llvm is not stored)
+  void store  (const std::string & key,
+               const std::string & tcode, const std::string & llvm);
+
+  // Look up the subroutine stored for the function entry key
+  bool lookupSubroutine (const std::string & key, subroutine & subr);
+  // Store the subroutine of the function entry key
+  void storeSubroutine  (const std::string & key, const subroutine & subr);
+
+  // Accessors to the hit/miss statistics (whole programs and functions)
+  std::size_t getNumberOfHits           () const;
+  std::size_t getNumberOfMisses         () const;
+  std::size_t getNumberOfFunctionHits   () const;
+  std::size_t getNumberOfFunctionMisses () const;
+
+  // Write the hit/miss statistics
+  void printStats (std::ostream & os) const;
+
+  // 64-bit FNV-1a hash of data, starting from hash h
+  static std::uint64_t fnv1a (const std::string & data,
+                              std::uint64_t h = 0xcbf29ce484222325ULL);
+
+private:
+
+  // Attributes
+  std::string Dir;
+  std::size_t Hits;
+  std::size_t Misses;
+  std::size_t FunctionHits;
+  std::size_t FunctionMisses;
+
+  // Path of the file of key with the given extension
+  std::string entryPath (const std::string & key, const std::string & ext) const;
+
+  static bool readFile        (const std::string & path, std::string & data);
+  static bool writeFileAtomic (const std::string & path, const std::string & data);
+
+};  // class CompileCache
@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileServer - Serve compile requests from a long-running
+//                    process (stdin framing or a Unix socket)
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "CompileServer.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#include <csignal>    // std::signal, SIGPIPE
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstring>    // std::strerror
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// using namespace std;
+
+
+// Constructor
+CompileServer::CompileServer(RequestHandler handler) :
+  Handler{handler} {
+}
+
+int CompileServer::serveStdio() {
+  std::signal(SIGPIPE, SIG_IGN);
+  serveConnection(STDIN_FILENO, STDOUT_FILENO);
+  return EXIT_SUCCESS;
+}
+
+int CompileServer::serveSocket(const std::string & path) {
+  std::signal(SIGPIPE, SIG_IGN);
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "Socket path too long: " << path << std::endl;
+    return EXIT_FAILURE;
+  }
+  int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    std::cerr << "Cannot create socket: " << std::strerror(errno) << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path.c_str());
+  unlink(path.c_str());
+  if (bind(listenFd, (struct sockaddr *) &addr, sizeof(addr)) < 0 or
+      listen(listenFd, 16) < 0) {
+    std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+    close(listenFd);
+    return EXIT_FAILURE;
+  }
+  while (true) {
+    int connFd = accept(listenFd, nullptr, nullptr);
+    if (connFd < 0) {
+      if (errno == EINTR or errno == ECONNABORTED) continue;
+      std::cerr << "Cannot accept on " << path << ": " << std::strerror(errno) << std::endl;
+      break;
+    }
+    serveConnection(connFd, connFd);
+    close(connFd);
+  }
+  close(listenFd);
+  unlink(path.c_str());
+  return EXIT_FAILURE;
+}
+
+void CompileServer::serveConnection(int inFd, int outFd) {
+  FdReader reader(inFd);
+  std::string header, source, output;
+  while (reader.readLine(header)) {
+    if (header.empty()) continue;
+    if (header == "quit") break;
+    std::istringstream words(header);
+    std::size_t nbytes;
+    if (not (words >> nbytes)) {
+      if (not writeAll(outFd, "1 0\n")) break;
+      continue;
+    }
+    std::vector<std::string> options;
+    std::string opt;
+    while (words >> opt) options.push_back(opt);
+    if (not reader.readBytes(nbytes, source)) break;
+    output.clear();
+    int status = Handler(options, source, output);
+    if (not writeAll(outFd, std::to_string(status) + " " +
+                            std::to_string(output.size()) + "\n" + output))
+      break;
+  }
+}
+
+bool CompileServer::writeAll(int fd, const std::string & data) {
+  std::size_t done = 0;
+  while (done < data.size()) {
+    ssize_t n = write(fd, data.data() + done, data.size() - done);
+    if (n < 0 and errno == EINTR) continue;
+    if (n <= 0) return false;
+    done += n;
+  }
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////
+// FdReader class
+
+CompileServer::FdReader::FdReader(int fd) :
+  Fd{fd}, Buffer{}, Pos{0} {
+}
+
+bool CompileServer::FdReader::fill() {
+  char chunk[65536];
+  ssize_t n;
+  do {
+    n = read(Fd, chunk, sizeof(chunk));
+  } while (n < 0 and errno == EINTR);
+  if (n <= 0) return false;
+  Buffer.erase(0, Pos);
+  Pos = 0;
+  Buffer.append(chunk, n);
+  return true;
+}
+
+bool CompileServer::FdReader::readLine(std::string & line) {
+  std::size_t eol;
+  while ((eol = Buffer.find('\n', Pos)) == std::string::npos) {
+    if (not fill()) return false;
+  }
+  line.assign(Buffer, Pos, eol - Pos);
+  if (not line.empty() and line.back() == '\r') line.pop_back();
+  Pos = eol + 1;
+  return true;
+}
+
+bool CompileServer::FdReader::readBytes(std::size_t n, std::string & bytes) {
+  while (Buffer.size() - Pos < n) {
+    if (not fill()) return false;
+  }
+  bytes.assign(Buffer, Pos, n);
+  Pos += n;
+  return true;
+}
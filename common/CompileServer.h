@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    CompileServer - Serve compile requests from a long-running
+//                    process (stdin framing or a Unix socket)
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CompileServer: reads compile requests, hands them to a
+// handler and writes back the answers. The process (and with it the
+// parser caches and the heap) stays alive between requests.
+//
+// A request is a header line followed by the program source:
+//     <nbytes> [<option> ...]\n<nbytes bytes of source>
+// and the answer has the same shape:
+//     <exit status> <nbytes>\n<nbytes bytes of output>
+// A header line "quit" (or the end of the input) ends the session.
+
+class CompileServer {
+
+public:
+
+  // Function that serves one request: receives the request options
+  // and the source, leaves the produced text in output and returns
+  // the exit status (EXIT_SUCCESS or EXIT_FAILURE)
+  typedef std::function<int (const std::vector<std::string> & options,
+                             const std::string & source,
+                             std::string & output)> RequestHandler;
+
+  // Constructor
+  CompileServer(RequestHandler handler);
+
+  // Serve the requests read from stdin, answering on stdout
+  int serveStdio();
+
+  // Serve the requests of the clients connected to a Unix socket
+  // (bound at path), one connection at a time
+  int serveSocket(const std::string & path);
+
+private:
+
+  //////////////////////////////////////////////////////////////////////
+  // Class FdReader: buffered reads of lines and byte blocks from a
+  // file descriptor
+  class FdReader {
+  public:
+    FdReader(int fd);
+    // read up to (and without) the next '\n'; false on end of input
+    bool readLine  (std::string & line);
+    // read exactly n bytes; false on end of input
+    bool readBytes (std::size_t n, std::string & bytes);
+  private:
+    int         Fd;
+    std::string Buffer;
+    std::size_t Pos;
+    bool fill ();
+  };  // class FdReader
+
+  // Attributes
+  RequestHandler Handler;
+
+  // Serve the requests of a connection until it ends
+  void serveConnection (int inFd, int outFd);
+
+  // Write the whole buffer to fd; false if the peer went away
+  static bool writeAll (int fd, const std::string & data);
+
+};  // class CompileServer
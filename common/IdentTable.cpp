@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    IdentTable - Interned identifiers of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+
+#include "IdentTable.h"
+
+#include <string>
+#include <vector>
+
+#include <cstddef>    // std::size_t
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+// Constructor
+IdentTable::IdentTable() :
+  Slots(64, 0) {
+}
+
+IdentTable::IdentId IdentTable::intern(const std::string & name) {
+  std::uint32_t h = hash(name);
+  std::size_t slot = findSlot(name, h);
+  if (Slots[slot] != 0)
+    return Slots[slot] - 1;
+  IdentId id = Names.size();
+  Names.push_back(name);
+  Hashes.push_back(h);
+  Slots[slot] = id + 1;
+  // keep the load factor under 1/2
+  if (2 * Names.size() > Slots.size()) grow();
+  return id;
+}
+
+IdentTable::IdentId IdentTable::find(const std::string & name) const {
+  std::size_t slot = findSlot(name, hash(name));
+  return Slots[slot] - 1;   // NO_IDENT if the slot is empty
+}
+
+const std::string & IdentTable::getName(IdentId id) const {
+  assert(id < Names.size());
+  return Names[id];
+}
+
+std::size_t IdentTable::size() const {
+  return Names.size();
+}
+
+std::size_t IdentTable::findSlot(const std::string & name, std::uint32_t h) const {
+  std::size_t mask = Slots.size() - 1;
+  for (std::size_t slot = h & mask; ; slot = (slot + 1) & mask) {
+    IdentId entry = Slots[slot];
+    if (entry == 0 or
+        (Hashes[entry - 1] == h and Names[entry - 1] == name))
+      return slot;
+  }
+}
+
+void IdentTable::grow() {
+  std::vector<IdentId> newSlots(2 * Slots.size(), 0);
+  std::size_t mask = newSlots.size() - 1;
+  for (IdentId id = 0; id < Names.size(); ++id) {
+    std::size_t slot = Hashes[id] & mask;
+    while (newSlots[slot] != 0) slot = (slot + 1) & mask;
+    newSlots[slot] = id + 1;
+  }
+  Slots.swap(newSlots);
+}
+
+// 32-bit FNV-1a
+std::uint32_t IdentTable::hash(const std::string & name) {
+  std::uint32_t h = 2166136261u;
+  for (unsigned char c : name) {
+    h ^= c;
+    h *= 16777619u;
+  }
+  return h;
+}
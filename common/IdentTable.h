@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    IdentTable - Interned identifiers of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint32_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class IdentTable: interns the identifiers of a program. Each
+// different name gets a dense IdentId (0, 1, 2, ...) the first time
+// it is interned, so the rest of the compiler can compare and hash
+// identifiers as integers. The names are kept in an open-addressing
+// hash table (linear probing) together with their hash values.
+
+class IdentTable {
+
+public:
+
+  // The IdentId is an index in a vector
+  typedef std::size_t IdentId;
+
+  // IdentId of a name that has not been interned
+  static const IdentId NO_IDENT = IdentId(-1);
+
+  // Constructor
+  IdentTable();
+
+  // Returns the IdentId of name, interning it if it is new
+  IdentId intern  (const std::string & name);
+  // Returns the IdentId of name, or NO_IDENT if it was never interned
+  IdentId find    (const std::string & name) const;
+  // Returns the name of an interned IdentId
+  const std::string & getName (IdentId id) const;
+  // Number of interned identifiers
+  std::size_t size () const;
+
+private:
+
+  // Attributes
+  //   - the names and their hash values, indexed by IdentId
+  std::vector<std::string>   Names;
+  std::vector<std::uint32_t> Hashes;
+  //   - the hash table: IdentId+1 of each used slot, 0 if empty
+  std::vector<IdentId>       Slots;
+
+  // Slot where name is (or where it should be inserted)
+  std::size_t findSlot (const std::string & name, std::uint32_t h) const;
+  // Double the hash table
+  void        grow     ();
+
+  static std::uint32_t hash (const std::string & name);
+
+};  // class IdentTable
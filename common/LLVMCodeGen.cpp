@@ -38,40 +38,16 @@
 // #define NDEBUG
 #include <cassert>
 #include <algorithm>     // find
+#include <sstream>
+#include <set>
+#include <utility>       // pair
+#include <iterator>      // back_inserter
 
 // using namespace std;
 
 
 const bool LLVMCodeGen::COMMENTS_ENABLED = false;
 
-const std::string LLVMCodeGen::INDENT_INSTR     = "    ";
-const std::string LLVMCodeGen::INDENT_LABEL     = "  ";
-
-const std::string LLVMCodeGen::LLVM_INT         = "i32";
-const std::string LLVMCodeGen::LLVM_FLOAT       = "float";
-const std::string LLVMCodeGen::LLVM_CHAR        = "i8";
-const std::string LLVMCodeGen::LLVM_BOOL        = "i1";
-const std::string LLVMCodeGen::LLVM_VOID        = "void";
-const std::string LLVMCodeGen::LLVM_LABEL       = "label";
-const std::string LLVMCodeGen::LLVM_TYERR       = "tErr";
-const std::string LLVMCodeGen::LLVM_TYMISS      = "tMiss";
-const std::string LLVMCodeGen::LLVM_INT_BOOL    = "tIntBool";
-
-const std::string LLVMCodeGen::LLVM_INT_PTR     = "i32*";
-const std::string LLVMCodeGen::LLVM_FLOAT_PTR   = "float*";
-const std::string LLVMCodeGen::LLVM_CHAR_PTR    = "i8*";
-const std::string LLVMCodeGen::LLVM_BOOL_PTR    = "i1*";
-
-const std::string LLVMCodeGen::LLVM_INT1        = "i1";
-const std::string LLVMCodeGen::LLVM_INT8        = "i8";
-const std::string LLVMCodeGen::LLVM_INT32       = "i32";
-const std::string LLVMCodeGen::LLVM_INT64       = "i64";
-const std::string LLVMCodeGen::LLVM_DOUBLE      = "double";
-
-const std::string LLVMCodeGen::LLVM_GLOBAL_INT_ADDR   = "@.global.i.addr";
-const std::string LLVMCodeGen::LLVM_GLOBAL_FLOAT_ADDR = "@.global.f.addr";
-const std::string LLVMCodeGen::LLVM_GLOBAL_CHAR_ADDR  = "@.global.c.addr";
-
 const std::string LLVMCodeGen::LLVM_ZERO_INT    = "0";
 const std::string LLVMCodeGen::LLVM_ZERO_FLOAT  = "0.0";
 const std::string LLVMCodeGen::LLVM_ONE_INT     = "1";
@@ -105,13 +81,41 @@ const std::map<instruction::Operation, std::string> LLVMCodeGen::tcode2llvmInstr
 };
 
 
-LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode)
+LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+                         bool ssaMode, bool runtimeIO, const TCodeProfile * profile)
   : Types{Types}, Symbols{Symbols}, tCode{tCode},
+    LLVM_INT{TypeCtx.getIntTy(32)},
+    LLVM_FLOAT{TypeCtx.getFloatTy()},
+    LLVM_CHAR{TypeCtx.getIntTy(8)},
+    LLVM_BOOL{TypeCtx.getIntTy(1)},
+    LLVM_VOID{TypeCtx.getVoidTy()},
+    LLVM_LABEL{TypeCtx.getLabelTy()},
+    LLVM_TYERR{TypeCtx.getTyErr()},
+    LLVM_TYMISS{TypeCtx.getTyMiss()},
+    LLVM_INT_BOOL{TypeCtx.getIntBoolTy()},
+    LLVM_INT_PTR{TypeCtx.getPointerTo(LLVM_INT)},
+    LLVM_FLOAT_PTR{TypeCtx.getPointerTo(LLVM_FLOAT)},
+    LLVM_CHAR_PTR{TypeCtx.getPointerTo(LLVM_CHAR)},
+    LLVM_BOOL_PTR{TypeCtx.getPointerTo(LLVM_BOOL)},
+    LLVM_INT1{LLVM_BOOL},
+    LLVM_INT8{LLVM_CHAR},
+    LLVM_INT32{LLVM_INT},
+    LLVM_INT64{TypeCtx.getIntTy(64)},
+    LLVM_DOUBLE{TypeCtx.getDoubleTy()},
+    LLVM_GLOBAL_INT_ADDR{"@.global.i.addr", LLVM_INT_PTR},
+    LLVM_GLOBAL_FLOAT_ADDR{"@.global.f.addr", LLVM_FLOAT_PTR},
+    LLVM_GLOBAL_CHAR_ADDR{"@.global.c.addr", LLVM_CHAR_PTR},
     writeI(false), writeF(false), writeC(false), writeLN(false),
     readI(false), readF(false), readC(false),
     haltAndExit(false),
-    globalI(false), globalF(false), globalC(false)
+    globalI(false), globalF(false), globalC(false),
+    pendingCallLLVMRetType(nullptr), llvmInstrList(nullptr),
+    ssaMode(ssaMode), ssaCurrentBlock(0), runtimeIO(runtimeIO),
+    profile(profile), profileCounts(nullptr), currentTCodePos(0)
 {
+  // the SSA mode renames each definition of a temporal: it can be
+  // multiply defined
+  if (ssaMode) return;
   std::string failFunc, failTempVar;
   check_SSA_tCode(failFunc, failTempVar);
   if (failFunc != "") {
@@ -128,6 +132,7 @@ LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const
   }
 }
 
+
 void LLVMCodeGen::check_SSA_tCode(std::string & failFunc, std::string & failTempVar) const {
   failFunc = "";
   failTempVar = "";
@@ -214,17 +219,17 @@ void LLVMCodeGen::computeReadWriteHaltInfo() {
         break;
       case instruction::_READI:
         readI = true;
-        if (isTCodeTemporal(arg1))
+        if (isTCodeTemporal(arg1) or ssaMode)
           globalI = true;
         break;
       case instruction::_READF:
         readF = true;
-        if (isTCodeTemporal(arg1))
+        if (isTCodeTemporal(arg1) or ssaMode)
           globalF = true;
         break;
       case instruction::_READC:
         readC = true;
-        if (isTCodeTemporal(arg1))
+        if (isTCodeTemporal(arg1) or ssaMode)
           globalC = true;
         break;
       case instruction::_HALT:
@@ -237,6 +242,98 @@ void LLVMCodeGen::computeReadWriteHaltInfo() {
   }
 }
 
+void LLVMCodeGen::computeFunctionEffects() {
+  // A simple effect analysis of the t-code: a function does I/O if it
+  // reads, writes or halts, or calls a function that does it, and it
+  // reads (writes) the memory of its callers if it reads (writes) an
+  // array param, or passes one to a function that reads (writes) it.
+  // The local arrays are not visible to the callers, and there is no
+  // other memory (the pointers are never stored), so the functions
+  // without I/O only access the memory pointed by their params.
+  funcEffectsMap.clear();
+  std::map<std::string, std::vector<std::pair<std::string, bool>>> callsMap;
+  for (auto & subr: tCode.get_subroutine_list()) {
+    std::string funcName = subr.get_name();
+    FuncEffects & effects = funcEffectsMap[funcName];
+    effects.io = effects.readsArgs = effects.writesArgs = false;
+    effects.arrayParams = 0;
+    // the array params and the temporals that point to them
+    std::set<std::string> argPointers;
+    if (funcName != "main") {
+      for (auto & p : subr.params) {
+        if (p.name != "_result" and
+            isPointerType(getLocalSymbolLLVMType(funcName, p.name, true))) {
+          argPointers.insert(p.name);
+          ++effects.arrayParams;
+        }
+      }
+    }
+    const instructionList & instrList = subr.get_instructions();
+    bool changed = not argPointers.empty();
+    while (changed) {
+      changed = false;
+      for (auto & instr: instrList) {
+        if ((instr.oper == instruction::_LOAD or instr.oper == instruction::_ALOAD) and
+            isTCodeTemporal(instr.arg1) and argPointers.count(instr.arg2) and
+            argPointers.insert(instr.arg1).second)
+          changed = true;
+      }
+    }
+    bool pushesArgPointer = false;
+    for (auto & instr: instrList) {
+      switch (instr.oper) {
+      case instruction::_READI:
+      case instruction::_READF:
+      case instruction::_READC:
+      case instruction::_WRITEI:
+      case instruction::_WRITEF:
+      case instruction::_WRITEC:
+      case instruction::_WRITES:
+      case instruction::_WRITELN:
+      case instruction::_HALT:
+        effects.io = true;
+        break;
+      case instruction::_XLOAD:
+        if (argPointers.count(instr.arg1)) effects.writesArgs = true;
+        break;
+      case instruction::_LOADX:
+        if (argPointers.count(instr.arg2)) effects.readsArgs = true;
+        break;
+      case instruction::_PUSH:
+        if (argPointers.count(instr.arg1)) pushesArgPointer = true;
+        break;
+      case instruction::_CALL:
+        callsMap[funcName].push_back(std::make_pair(instr.arg1, pushesArgPointer));
+        pushesArgPointer = false;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  // the effects of the callees, until no function changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto & funcCalls : callsMap) {
+      FuncEffects & effects = funcEffectsMap[funcCalls.first];
+      for (auto & call : funcCalls.second) {
+        const FuncEffects & calleeEffects = funcEffectsMap[call.first];
+        bool io         = effects.io or calleeEffects.io;
+        bool readsArgs  = effects.readsArgs or (call.second and calleeEffects.readsArgs);
+        bool writesArgs = effects.writesArgs or (call.second and calleeEffects.writesArgs);
+        if (io != effects.io or readsArgs != effects.readsArgs or
+            writesArgs != effects.writesArgs) {
+          effects.io = io;
+          effects.readsArgs = readsArgs;
+          effects.writesArgs = writesArgs;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
 void LLVMCodeGen::startNewFunction(const subroutine & subr) {
   currentFunctionName = subr.get_name();
   isMain = (currentFunctionName == "main");
@@ -248,8 +345,16 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
   llvmLocalValueTypeMap.clear();
   llvmLocalValueCountMap.clear();
   std::string funcName = subr.get_name();
+  // fetch the types of all the params and local vars of the function at once
+  localSymbolsFuncName = funcName;
+  localSymbolTypeMap.clear();
+  SymTable::ScopeId sc = Symbols.getFunctionScope(funcName);
+  if (sc != SymTable::NO_SCOPE) {
+    for (auto & sym : Symbols.getScopeSymbols(sc))
+      localSymbolTypeMap[Symbols.getIdentName(sym.ident)] = sym.type;
+  }
   for (auto param : subr.params) {
-    std::string llvmType;
+    const LLVMType *llvmType;
     if (param.name == "_result")
       llvmType = getFuncReturnLLVMType(funcName);
     else
@@ -257,7 +362,7 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     bindTCodeLocalValueWithType(param.name, llvmType);
   }
   for (auto varlocal : subr.vars) {
-    std::string llvmType = getLocalSymbolLLVMType(funcName, varlocal.name);
+    const LLVMType *llvmType = getLocalSymbolLLVMType(funcName, varlocal.name);
     bindTCodeLocalValueWithType(varlocal.name, llvmType);
   }
   for (auto instr : subr.get_instructions()) {
@@ -288,18 +393,23 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     case instruction::_LOAD:
       {
         if (isTCodeIdentifier(arg1) and isTCodeTemporal(arg2)) {       //  a = %4
-          std::string llvmValue1 = getLLVMValue(arg1);
-          std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-          bindTCodeLocalValueWithType(arg2, llvmType1);
+          std::string llvmValue1 = getLLVMValueName(arg1);
+          const LLVMType *llvmType1 = getLLVMTypeOfValue(llvmValue1);
+          // in an array copy the elements are copied before: %4 is the
+          // address of the other array
+          if (not isLLVMArrayType(llvmType1))
+            bindTCodeLocalValueWithType(arg2, llvmType1);
         }
         else if (isTCodeTemporal(arg1) and isTCodeIdentifier(arg2)) {  // %4 = a
-          std::string llvmValue2 = getLLVMValue(arg2);
-          std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
+          std::string llvmValue2 = getLLVMValueName(arg2);
+          const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
+          if (isLLVMArrayType(llvmType2))  // as in _ALOAD
+            llvmType2 = getLLVMArrayTypeAsPointerType(llvmType2);
           bindTCodeLocalValueWithType(arg1, llvmType2);
         }
         else if (isTCodeTemporal(arg1) and isTCodeTemporal(arg2)) {    // %4 = %6
-          std::string llvmValue2 = getLLVMValue(arg2);
-          std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
+          std::string llvmValue2 = getLLVMValueName(arg2);
+          const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
           bindTCodeLocalValueWithType(arg1, llvmType2);
         }
         break;
@@ -339,15 +449,15 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
       }
     case instruction::_CALL:
       {
-        std::vector<std::string> llvmParamTypes = getFuncParamsLLVMTypes(arg1);
+        std::vector<const LLVMType *> llvmParamTypes = getFuncParamsLLVMTypes(arg1);
         int nParams = getFuncNumberOfParams(arg1);
         for (int i = nParams-1; i >= 0; --i) {
           std::string tcodeParam = topPopTCodeParamCallStack();
-          std::string llvmParamType = llvmParamTypes[i];
+          const LLVMType *llvmParamType = llvmParamTypes[i];
           bindTCodeLocalValueWithType(tcodeParam, llvmParamType);
         }
-        std::string retType = getFuncReturnLLVMType(arg1);
-        if (retType != "void")
+        const LLVMType *retType = getFuncReturnLLVMType(arg1);
+        if (retType != LLVM_VOID)
           pendingCallLLVMRetType = retType;
         break;
       }
@@ -357,9 +467,9 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
       }
     case instruction::_ALOAD:
       {
-        std::string llvmValue2 = getLLVMValue(arg2);
-        std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
-        std::string llvmType2Ptr;
+        std::string llvmValue2 = getLLVMValueName(arg2);
+        const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
+        const LLVMType *llvmType2Ptr;
         if (isLLVMArrayType(llvmType2))
           llvmType2Ptr = getLLVMArrayTypeAsPointerType(llvmType2);
         else
@@ -369,9 +479,9 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
       }
     case instruction::_XLOAD:
       {
-        std::string llvmValue1 = getLLVMValue(arg1);
-        std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-        std::string llvmElemType;
+        std::string llvmValue1 = getLLVMValueName(arg1);
+        const LLVMType *llvmType1 = getLLVMTypeOfValue(llvmValue1);
+        const LLVMType *llvmElemType;
         if (isLLVMArrayType(llvmType1))
           llvmElemType = getLLVMElementOfArrayType(llvmType1);
         else if (isPointerType(llvmType1))
@@ -384,9 +494,9 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
       }
     case instruction::_LOADX:
       {
-        std::string llvmValue2 = getLLVMValue(arg2);
-        std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
-        std::string llvmElemType;
+        std::string llvmValue2 = getLLVMValueName(arg2);
+        const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
+        const LLVMType *llvmElemType;
         if (isLLVMArrayType(llvmType2))
           llvmElemType = getLLVMElementOfArrayType(llvmType2);
         else if (isPointerType(llvmType2))
@@ -400,18 +510,18 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     case instruction::_LOADC:
       {
         // only: address ASSIG MUL TEMP   (x = *t1)
-        std::string llvmValue1 = getLLVMValue(arg1);
-        std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-        std::string llvmTypePtr = getPointerToType(llvmType1);
+        std::string llvmValue1 = getLLVMValueName(arg1);
+        const LLVMType *llvmType1 = getLLVMTypeOfValue(llvmValue1);
+        const LLVMType *llvmTypePtr = getPointerToType(llvmType1);
         bindTCodeLocalValueWithType(arg2, llvmTypePtr);
         break;
       }
     case instruction::_CLOAD:
       {
         // only: MUL TEMP ASSIG address   (*t1 = x)
-        std::string llvmValue2 = getLLVMValue(arg2);
-        std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
-        std::string llvmTypePtr = getPointerToType(llvmType2);
+        std::string llvmValue2 = getLLVMValueName(arg2);
+        const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
+        const LLVMType *llvmTypePtr = getPointerToType(llvmType2);
         bindTCodeLocalValueWithType(arg1, llvmTypePtr);
         break;
       }
@@ -469,13 +579,13 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
       {
         bindTCodeLocalValueWithType(arg1, LLVM_BOOL);
         if (isTCodeIdentifier(arg2) and isTCodeTemporal(arg3)) {
-          std::string llvmValue2 = getLLVMValue(arg2);
-          std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
+          std::string llvmValue2 = getLLVMValueName(arg2);
+          const LLVMType *llvmType2 = getLLVMTypeOfValue(llvmValue2);
           bindTCodeLocalValueWithType(arg3, llvmType2);
         }
         else if (isTCodeTemporal(arg2) and isTCodeIdentifier(arg3)) {
-          std::string llvmValue3 = getLLVMValue(arg3);
-          std::string llvmType3 = getLLVMTypeOfValue(llvmValue3);
+          std::string llvmValue3 = getLLVMValueName(arg3);
+          const LLVMType *llvmType3 = getLLVMTypeOfValue(llvmValue3);
           bindTCodeLocalValueWithType(arg2, llvmType3);
         }
         else if (isTCodeTemporal(arg2) and isTCodeTemporal(arg3)) {
@@ -546,7 +656,7 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
   }
   bool errors = false;
   for (auto & llvmValue : llvmLocalValueVec) {
-    std::string llvmType = llvmLocalValueTypeMap.at(llvmValue);
+    const LLVMType *llvmType = llvmLocalValueTypeMap.at(llvmValue);
     if (llvmType == LLVM_TYERR or llvmType == LLVM_TYMISS) {
       errors = true;
       break;
@@ -556,19 +666,19 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     std::cerr << "ERROR: some local values of this function can not been binded to a valid type:" << std::endl;
     std::cerr << "++++++++++++++++++++++++++++++++ function: " << funcName << std::endl;
     for (auto & value : llvmLocalValueVec) {
-      std::cerr << value << ": \t" << llvmLocalValueTypeMap.at(value) << std::endl;
+      std::cerr << value << ": \t" << llvmLocalValueTypeMap.at(value)->str() << std::endl;
     }
     std::cerr << "--------------------------------" << std::endl;
     std::exit(EXIT_FAILURE);
   }
   for (auto & llvmValue : llvmLocalValueVec) {
-    std::string llvmType = llvmLocalValueTypeMap.at(llvmValue);
+    const LLVMType *llvmType = llvmLocalValueTypeMap.at(llvmValue);
     if (llvmType == LLVM_INT_BOOL)
       llvmLocalValueTypeMap[llvmValue] = LLVM_INT;
   }
 }
 
-std::string LLVMCodeGen::getFuncReturnLLVMType(const std::string & tcodeFuncIdent) const {
+const LLVMType * LLVMCodeGen::getFuncReturnLLVMType(const std::string & tcodeFuncIdent) const {
   TypesMgr::TypeId tid = Symbols.getGlobalFunctionType(tcodeFuncIdent);
   TypesMgr::TypeId tr = Types.getFuncReturnType(tid);
   return TypeIdToLLVMType(tr);
@@ -579,17 +689,17 @@ int LLVMCodeGen::getFuncNumberOfParams(const std::string & tcodeFuncIdent) const
   return Types.getNumOfParameters(tid);
 }
 
-std::string LLVMCodeGen::getFuncParamLLVMType(const std::string & tcodeFuncIdent, int i) const {
+const LLVMType * LLVMCodeGen::getFuncParamLLVMType(const std::string & tcodeFuncIdent, int i) const {
   TypesMgr::TypeId tid = Symbols.getGlobalFunctionType(tcodeFuncIdent);
   TypesMgr::TypeId tParam = Types.getParameterType(tid, i);
-  std::string llvmType = TypeIdToLLVMType(tParam, true);
+  const LLVMType *llvmType = TypeIdToLLVMType(tParam, true);
   return llvmType;
 }
 
-std::vector<std::string> LLVMCodeGen::getFuncParamsLLVMTypes(const std::string & tcodeFuncIdent) const {
+std::vector<const LLVMType *> LLVMCodeGen::getFuncParamsLLVMTypes(const std::string & tcodeFuncIdent) const {
   TypesMgr::TypeId tid = Symbols.getGlobalFunctionType(tcodeFuncIdent);
   std::size_t n = Types.getNumOfParameters(tid);
-  std::vector<std::string> typesVec(n);
+  std::vector<const LLVMType *> typesVec(n);
   for (std::size_t i = 0; i < n; ++i) {
     TypesMgr::TypeId tParam = Types.getParameterType(tid, i);
     typesVec[i] = TypeIdToLLVMType(tParam, true);
@@ -597,14 +707,19 @@ std::vector<std::string> LLVMCodeGen::getFuncParamsLLVMTypes(const std::string &
   return typesVec;
 }
 
-std::string LLVMCodeGen::getLocalSymbolLLVMType(const std::string & tcodeFuncIdent,
-                                                const std::string & tcodeSymbolIdent,
-                                                bool isParameter) const {
+const LLVMType * LLVMCodeGen::getLocalSymbolLLVMType(const std::string & tcodeFuncIdent,
+                                                     const std::string & tcodeSymbolIdent,
+                                                     bool isParameter) const {
+  if (tcodeFuncIdent == localSymbolsFuncName) {
+    auto it = localSymbolTypeMap.find(tcodeSymbolIdent);
+    if (it != localSymbolTypeMap.end())
+      return TypeIdToLLVMType(it->second, isParameter);
+  }
   TypesMgr::TypeId tid = Symbols.getLocalSymbolType(tcodeFuncIdent, tcodeSymbolIdent);
   return TypeIdToLLVMType(tid, isParameter);
 }
 
-std::string LLVMCodeGen::TypeIdToLLVMType(TypesMgr::TypeId tid, bool isParameter) const {
+const LLVMType * LLVMCodeGen::TypeIdToLLVMType(TypesMgr::TypeId tid, bool isParameter) const {
   if (Types.isIntegerTy(tid))
     return LLVM_INT;
   else if (Types.isFloatTy(tid))
@@ -617,13 +732,13 @@ std::string LLVMCodeGen::TypeIdToLLVMType(TypesMgr::TypeId tid, bool isParameter
     return LLVM_VOID;
   else if (Types.isArrayTy(tid)) {
     TypesMgr::TypeId te = Types.getArrayElemType(tid);
-    std::string teLLVM = TypeIdToLLVMType(te);
+    const LLVMType *teLLVM = TypeIdToLLVMType(te);
     if (not isParameter) {
       std::size_t n = Types.getArraySize(tid);
-      return "[" + std::to_string(n) + " x " + teLLVM + "]";
+      return TypeCtx.getArrayOf(teLLVM, n);    // [n x teLLVM]
     }
     else {
-      return getPointerToType(teLLVM);  // teLLVM + "*"
+      return getPointerToType(teLLVM);  // teLLVM*
     }
   }
   return LLVM_TYERR;
@@ -651,12 +766,15 @@ void LLVMCodeGen::generateReadWriteHaltBeginEndCode(std::string & begin, std::st
   computeReadWriteHaltInfo();
   if (writeI or writeF or writeC or writeS or writeLN or readI or readF or readC)
     begin += "\n";
-  if (writeI or readI)
+  // the runtime of --llvmRuntime does not need the format strings
+  if ((writeI or readI) and not runtimeIO)
     begin += "@.str.i = constant [3 x i8] c\"%d\\00\"\n";
-  if (writeF or readF)
+  if ((writeF or readF) and not runtimeIO)
     begin += "@.str.f = constant [3 x i8] c\"%g\\00\"\n";
-  if (writeC or readC)
+  if ((writeC or readC) and not runtimeIO)
     begin += "@.str.c = constant [3 x i8] c\"%c\\00\"\n";
+  if (readC and not runtimeIO)
+    begin += "@.str.rc = constant [4 x i8] c\" %c\\00\"\n";
   std::string::size_type n = writeSAslStrVec.size();
   writeSLLVMStrSizeVec = std::vector<std::string::size_type>(n);
   for (std::string::size_type i = 0; i < n; ++i) {
@@ -678,14 +796,30 @@ void LLVMCodeGen::generateReadWriteHaltBeginEndCode(std::string & begin, std::st
     begin += "\n\n";
   if (writeI or writeF or writeC or writeLN or readI or readF or readC or haltAndExit)
     end += "\n";
-  if (writeI or writeF or writeC or writeS or writeLN) {
+  if (runtimeIO) {
+    if (writeI)
+      end += "declare void @__asl_write_int(i32) nounwind\n";
+    if (writeF)
+      end += "declare void @__asl_write_float(double) nounwind\n";
+    if (writeC or writeLN)
+      end += "declare void @__asl_write_char(i32) nounwind\n";
+    if (writeS)
+      end += "declare void @__asl_write_str(i8*, i32) nounwind\n";
+    if (readI)
+      end += "declare void @__asl_read_int(i32*) nounwind\n";
+    if (readF)
+      end += "declare void @__asl_read_float(float*) nounwind\n";
+    if (readC)
+      end += "declare void @__asl_read_char(i8*) nounwind\n";
+  }
+  else if (writeI or writeF or writeC or writeS or writeLN) {
     if (writeI or writeF or writeS)
-      end += "declare dso_local i32 @printf(i8*, ...)\n";
+      end += "declare dso_local i32 @printf(i8*, ...) nounwind\n";
     if (writeC or writeLN)
-      end += "declare dso_local i32 @putchar(i32)\n";
+      end += "declare dso_local i32 @putchar(i32) nounwind\n";
   }
-  if (readI or readF or readC) {
-    end += "declare dso_local i32 @__isoc99_scanf(i8*, ...)\n";
+  if ((readI or readF or readC) and not runtimeIO) {
+    end += "declare dso_local i32 @__isoc99_scanf(i8*, ...) nounwind\n";
   }
   if (haltAndExit) {
     end += "declare dso_local void @exit(i32) noreturn nounwind\n";
@@ -694,141 +828,151 @@ void LLVMCodeGen::generateReadWriteHaltBeginEndCode(std::string & begin, std::st
     end += "\n";
 }
 
+
 std::string LLVMCodeGen::dumpLLVM() {
-  std::string llvmCode, llvmBegin, llvmEnd;
+  std::string llvmBegin, llvmEnd;
   generateReadWriteHaltBeginEndCode(llvmBegin, llvmEnd);
-  bindGlobalValuesWithTypes();
+  computeFunctionEffects();
+  std::ostringstream llvmCode;
+  llvmCode << llvmBegin;
+  profileMetadata.clear();
   for (auto & subr: tCode.get_subroutine_list()) {
     bindTCodeLocalSymbolsToLLVMTypes(subr);
     startNewFunction(subr);
-    llvmCode += dumpSubroutine(subr);
+    profileCounts = (profile == nullptr) ? nullptr :
+      profile->findFunction(subr.get_name(), subr.get_number_of_instructions());
+    // the records of a function are written (and freed) before the
+    // next function is generated
+    LLVMFunction llvmFunction;
+    if (ssaMode)
+      dumpSubroutineSSA(subr, llvmFunction);
+    else
+      dumpSubroutine(subr, llvmFunction);
+    // the entry count goes after the attributes
+    if (profileCounts != nullptr) {
+      std::string entryCount = "!{!\"function_entry_count\", i64 " +
+                               std::to_string(profileCounts->calls) + "}";
+      llvmFunction.attrs += " !prof " + addProfileMetadata(entryCount);
+    }
+    llvmFunction.print(llvmCode);
   }
-  llvmCode = llvmBegin + llvmCode + llvmEnd;
-  return llvmCode;
-}
-
-std::string LLVMCodeGen::dumpSubroutine(const subroutine & subr) {
-  std::string llvmCode;
-  llvmCode += dumpHeader(subr);
-  llvmCode += "{\n";
-  llvmCode += llvmComment("   ENTRY label:");
-  bindLLVMLocalValueWithType(LLVM_ENTRY, LLVM_LABEL);
-  llvmCode += createLABEL(LLVM_ENTRY);
-  llvmCode += llvmComment("   --------------------- alloca params:");
-  llvmCode += dumpAllocaParams(subr);
-  llvmCode += llvmComment("   --------------------- alloca local vars:");
-  llvmCode += dumpAllocaLocalVars(subr);
-  llvmCode += llvmComment("   --------------------- store params:");
-  llvmCode += dumpStoreParams(subr);
-  llvmCode += llvmComment("   --------------------- instructions:");
-  llvmCode += dumpInstructionList(subr);
-  llvmCode += "}\n\n";
-  return llvmCode;
-}
-
-std::string LLVMCodeGen::dumpHeader(const subroutine & subr) {
-  std::string llvmCode;
-  llvmCode += "define dso_local ";
+  llvmCode << llvmEnd;
+  for (std::size_t i = 0; i < profileMetadata.size(); ++i)
+    llvmCode << "!" << i << " = " << profileMetadata[i] << "\n";
+  return llvmCode.str();
+}
+
+void LLVMCodeGen::dumpSubroutine(const subroutine & subr, LLVMFunction & llvmFunction) {
+  dumpHeader(subr, llvmFunction);
+  llvmInstrList = &llvmFunction.body;
+  llvmComment("   ENTRY label:");
+  createLABEL(LLVM_ENTRY);
+  llvmComment("   --------------------- alloca params:");
+  dumpAllocaParams(subr);
+  llvmComment("   --------------------- alloca local vars:");
+  dumpAllocaLocalVars(subr);
+  llvmComment("   --------------------- store params:");
+  dumpStoreParams(subr);
+  llvmComment("   --------------------- instructions:");
+  dumpInstructionList(subr);
+  llvmInstrList = nullptr;
+}
+
+void LLVMCodeGen::dumpHeader(const subroutine & subr, LLVMFunction & llvmFunction) {
+  // The functions other than main are only called from the module:
+  // internal linkage and the fast calling convention (also in the
+  // calls) let LLVM change their interface, inline and remove them.
+  // The attributes come from the effects of computeFunctionEffects.
   std::string funcName = subr.get_name();
+  llvmFunction.name = funcName;
+  llvmFunction.attrs = "nounwind";
   if (funcName == "main") {
-    llvmCode += LLVM_INT + " @" + "main" + "() ";
+    llvmFunction.linkage = "dso_local";
+    llvmFunction.retType = LLVM_INT;
+    return;
   }
-  else {
-    llvmCode += getFuncReturnLLVMType(funcName) + " @" + funcName + "(";
-    bool firstParam = true;
-    for (auto p : subr.params) {
-      if (p.name != "_result") {
-        std::string llvmValue = getLLVMValue(p.name);
-        std::string llvmType  = getLocalSymbolLLVMType(funcName, p.name, true);
-        if (not firstParam) llvmCode += ", ";
-        else firstParam = false;
-        llvmCode += llvmType + " " + llvmValue;
-      }
-    }
-    llvmCode += ") ";
+  llvmFunction.linkage = "internal";
+  llvmFunction.fastCC = true;
+  llvmFunction.retType = getFuncReturnLLVMType(funcName);
+  const FuncEffects & effects = funcEffectsMap.at(funcName);
+  if (not effects.io) {
+    if (not effects.readsArgs and not effects.writesArgs)
+      llvmFunction.attrs += " readnone";
+    else if (not effects.writesArgs)
+      llvmFunction.attrs += " readonly argmemonly";
+    else
+      llvmFunction.attrs += " argmemonly";
+  }
+  // the array params are never captured (a pointer can not be stored
+  // nor returned), and do not alias if there is only one or none of
+  // them is written
+  std::string arrayParamAttrs = "nocapture";
+  if (effects.arrayParams == 1 or not effects.writesArgs)
+    arrayParamAttrs = "noalias nocapture";
+  for (auto p : subr.params) {
+    if (p.name != "_result") {
+      const LLVMType *llvmType = getLocalSymbolLLVMType(funcName, p.name, true);
+      llvmFunction.params.push_back(LLVMValue(getLLVMValueName(p.name), llvmType));
+      llvmFunction.paramAttrs.push_back(isPointerType(llvmType) ? arrayParamAttrs : "");
+    }
   }
-  return llvmCode;
 }
 
-std::string LLVMCodeGen::dumpAllocaParams(const subroutine & subr) {
-  std::string llvmCode;
+void LLVMCodeGen::dumpAllocaParams(const subroutine & subr) {
   std::string funcName = subr.get_name();
   for (auto p : subr.params) {
-    std::string llvmValue = getLLVMValue(p.name);
-    std::string llvmType;
+    const LLVMType *llvmType;
     if (p.name == "_result")
       llvmType = getFuncReturnLLVMType(funcName);
     else
       llvmType = getLocalSymbolLLVMType(funcName, p.name, true);
-    std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
-    std::string llvmTypePtr   = getPointerToType(llvmType);
-    bindLLVMLocalValueWithType(llvmValueAddr, llvmTypePtr);
-    llvmCode += llvmComment("   param " + p.name + " " + llvmType);
-    llvmCode += createALLOCA(llvmValueAddr, llvmType);
+    LLVMValue llvmValue(getLLVMValueName(p.name), llvmType);
+    llvmComment("   param " + p.name + " " + llvmType->str());
+    createALLOCA(getLLVMValueAddr(llvmValue));
   }
-  return llvmCode;
 }
 
-std::string LLVMCodeGen::dumpAllocaLocalVars(const subroutine & subr) {
-  std::string llvmCode;
+void LLVMCodeGen::dumpAllocaLocalVars(const subroutine & subr) {
   std::string funcName = subr.get_name();
   for (auto v : subr.vars) {
-    std::string llvmValue     = getLLVMValue(v.name);
-    std::string llvmType      = getLocalSymbolLLVMType(funcName, v.name);
-    std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
-    std::string llvmTypePtr   = getPointerToType(llvmType);
-    bindLLVMLocalValueWithType(llvmValueAddr, llvmTypePtr);
-    llvmCode += llvmComment("   localVar " + v.name +  " " + llvmType);
-    llvmCode += createALLOCA(llvmValueAddr, llvmType);
+    const LLVMType *llvmType = getLocalSymbolLLVMType(funcName, v.name);
+    LLVMValue llvmValue(getLLVMValueName(v.name), llvmType);
+    llvmComment("   localVar " + v.name +  " " + llvmType->str());
+    createALLOCA(getLLVMValueAddr(llvmValue));
   }
-  return llvmCode;
 }
 
-std::string LLVMCodeGen::dumpStoreParams(const subroutine & subr) {
-  std::string llvmCode;
-  std::string funcName = subr.get_name();
-  if (funcName == "main") {
-    // std::string llvmValue     = getLLVMValue("_result");
-    // // std::string llvmType      = LLVM_INT;
-    // std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
-    // // std::string llvmTypePtr   = getPointerToType(llvmType);
-    // // bindLLVMLocalValueWithType(llvmValue, llvmType);         // DONE IN dumpAllocaParams
-    // // bindLLVMLocalValueWithType(llvmValueAddr, llvmTypePtr);  // DONE IN dumpAllocaParams
-    // llvmCode += createStore(LLVM_ZERO_INT, llvmValueAddr);    // "store i32 0, i32* %_result.addr";
-  }
+void LLVMCodeGen::dumpStoreParams(const subroutine & subr) {
   if (subr.params.size() > 0) {
-    llvmCode += llvmComment("params initialization:");
+    llvmComment("params initialization:");
   }
+  std::string funcName = subr.get_name();
   for (auto p : subr.params) {
     if (p.name != "_result") {
-      std::string llvmValue     = getLLVMValue(p.name);
-      std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
-      llvmCode += createSTORE(llvmValue, llvmValueAddr);
+      LLVMValue llvmValue(getLLVMValueName(p.name), getLocalSymbolLLVMType(funcName, p.name, true));
+      createSTORE(llvmValue, getLLVMValueAddr(llvmValue));
     }
   }
-  return llvmCode;
 }
 
-std::string LLVMCodeGen::dumpInstructionList(const subroutine & subr) {
-  std::string llvmCode;
+void LLVMCodeGen::dumpInstructionList(const subroutine & subr) {
   int n = subr.get_instructions().size();
   instructionList instrList = subr.get_instructions();
   for (int i = 0; i < n-1; ++i) {
-    llvmCode += llvmComment(instrList[i].dump());
-    llvmCode += dumpInstruction(instrList[i], instrList[i+1]);
+    if (COMMENTS_ENABLED) llvmComment(instrList[i].dump());
+    currentTCodePos = i;
+    dumpInstruction(instrList[i], instrList[i+1]);
   }
-  llvmCode += llvmComment(instrList[n-1].dump());
-  llvmCode += dumpInstruction(instrList[n-1], instruction::NOOP());
-  return llvmCode;
+  if (COMMENTS_ENABLED) llvmComment(instrList[n-1].dump());
+  currentTCodePos = n-1;
+  dumpInstruction(instrList[n-1], instruction::NOOP());
 }
 
 
-std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
-                                         const instruction & next) {
-  std::string llvmCode;
-
-  std::string llvmValue1, llvmValue2, llvmValue3;
-  std::string llvmMemCodeValue1, llvmMemCodeValue2, llvmMemCodeValue3;
+void LLVMCodeGen::dumpInstruction(const instruction & instr,
+                                  const instruction & next) {
+  LLVMValue llvmValue1, llvmValue2, llvmValue3;
+  LLVMValue llvmValue1Addr;
 
   std::string tcodeArg1 = getTCodeArg(instr, 1);
   std::string tcodeArg2 = getTCodeArg(instr, 2);
@@ -838,44 +982,38 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
   case instruction::_LABEL:
     {
       std::string label = tcodeArg1;
-      std::string llvmLabel = getLLVMValue(label);
       if (not prevInstrIsTerminator)
-        llvmCode += createBR(llvmLabel);
-      llvmCode += createLABEL(label);
+        createBR(getLLVMValueName(label));
+      createLABEL(label);
       break;
     }
   case instruction::_UJUMP:
     {
-      std::string label = tcodeArg1;
-      std::string llvmLabel = getLLVMValue(label);
-      llvmCode += createBR(llvmLabel);
+      createBR(getLLVMValueName(tcodeArg1));
       if (next.oper != instruction::_LABEL and next.oper != instruction::_NOOP) {
-        std::string labelDead = createNewPrefixedValueWithType("%.dead.cont", LLVM_LABEL);
-        std::string labelDeadName = labelDead.substr(1);
-        llvmCode += createLABEL(labelDeadName);
+        LLVMValue labelDead = createNewPrefixedValueWithType("%.dead.cont", LLVM_LABEL);
+        createLABEL(labelDead.getName().substr(1));
       }
       break;
     }
   case instruction::_FJUMP:
     {
-      accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      llvmCode += llvmMemCodeValue1;
-      std::string labelJump = getLLVMValue(tcodeArg2);
+      accessValueOfArgument(tcodeArg1, llvmValue1);
+      std::string labelJump = getLLVMValueName(tcodeArg2);
       if (next.oper != instruction::_LABEL and next.oper != instruction::_NOOP) {
-        std::string labelCont = createNewPrefixedValueWithType("%.br.cont", LLVM_LABEL);
-        std::string labelContName = labelCont.substr(1);
-        llvmCode += createBR(llvmValue1, labelCont, labelJump);
-        llvmCode += createLABEL(labelContName);
+        LLVMValue labelCont = createNewPrefixedValueWithType("%.br.cont", LLVM_LABEL);
+        createBR(llvmValue1, labelCont.getName(), labelJump);
+        createLABEL(labelCont.getName().substr(1));
       }
       else {
-        std::string labelCont = getLLVMValue(next.arg1);
-        llvmCode += createBR(llvmValue1, labelCont, labelJump);
+        std::string labelCont = getLLVMValueName(next.arg1);
+        createBR(llvmValue1, labelCont, labelJump);
       }
       break;
     }
   case instruction::_HALT:
     {
-      llvmCode += createHALT();
+      createHALT();
       break;
     }
   case instruction::_LOAD:
@@ -883,29 +1021,26 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       llvmValue1 = getLLVMValue(tcodeArg1);
       llvmValue2 = getLLVMValue(tcodeArg2);
       if (isTCodeIdentifier(tcodeArg1)) {  //  a = %4   or   a = b
-        accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += llvmMemCodeValue2;
-        llvmCode += createSTORE(llvmValue2, llvmValue1Addr);
+        accessValueOfArgument(tcodeArg2, llvmValue2);
+        createSTORE(llvmValue2, getLLVMValueAddr(llvmValue1));
       }
       else if (isTCodeIdentifier(tcodeArg2)) {   // %4 = a
-        std::string llvmValue2Addr = getLLVMValueAddr(llvmValue2);
-        llvmCode += createLOAD(llvmValue1, llvmValue2Addr);
+        createLOAD(llvmValue1, getLLVMValueAddr(llvmValue2));
       }
       else {      // %4 = %6
-        std::string llvmType = getLLVMTypeOfValue(llvmValue2);
+        const LLVMType *llvmType = llvmValue2.getType();
         if (isLLVMAnyIntegerType(llvmType)) {
-          std::string llvmTypeOneIntUp = getLLVMTypeOneIntUp(llvmType);
-          std::string newValuePrefix = "%.temp." + tcodeArg1.substr(1) + "." + llvmTypeOneIntUp;
-          std::string llvmValue2Extended = createNewPrefixedValueWithType(newValuePrefix, llvmTypeOneIntUp);
-          llvmCode += createCONVERSION(LLVM_ZEXT, llvmValue2Extended, llvmValue2, llvmTypeOneIntUp);
-          llvmCode += createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2Extended, llvmType);
+          const LLVMType *llvmTypeOneIntUp = getLLVMTypeOneIntUp(llvmType);
+          std::string newValuePrefix = "%.temp." + tcodeArg1.substr(1) + "." + llvmTypeOneIntUp->str();
+          LLVMValue llvmValue2Extended = createNewPrefixedValueWithType(newValuePrefix, llvmTypeOneIntUp);
+          createCONVERSION(LLVM_ZEXT, llvmValue2Extended, llvmValue2, llvmTypeOneIntUp);
+          createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2Extended, llvmType);
         }
         else {  // llvmType == LLVM_FLOAT
           std::string newValuePrefix = "%.temp." + tcodeArg1.substr(1) + ".double";
-          std::string llvmValue2FPDouble = createNewPrefixedValueWithType(newValuePrefix, LLVM_DOUBLE);
-          llvmCode += createCONVERSION(LLVM_FPEXT, llvmValue2FPDouble, llvmValue2, LLVM_DOUBLE);
-          llvmCode += createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2FPDouble, llvmType);
+          LLVMValue llvmValue2FPDouble = createNewPrefixedValueWithType(newValuePrefix, LLVM_DOUBLE);
+          createCONVERSION(LLVM_FPEXT, llvmValue2FPDouble, llvmValue2, LLVM_DOUBLE);
+          createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2FPDouble, llvmType);
         }
       }
       break;
@@ -915,11 +1050,9 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       llvmValue1 = getLLVMValue(tcodeArg1);
       llvmValue2 = getLLVMValue(tcodeArg2);
       if (isTCodeTemporal(tcodeArg1))
-        llvmCode += createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2, LLVM_INT64);
-      else {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += createSTORE(llvmValue2, llvmValue1Addr);
-      }
+        createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2, LLVM_INT64);
+      else
+        createSTORE(llvmValue2, getLLVMValueAddr(llvmValue1));
       break;
     }
   case instruction::_FLOAD:
@@ -927,51 +1060,45 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       llvmValue1 = getLLVMValue(tcodeArg1);
       llvmValue2 = getLLVMValue(tcodeArg2);
       if (isTCodeTemporal(tcodeArg1))
-        llvmCode += createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2, LLVM_DOUBLE);
-      else {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += createSTORE(llvmValue2, llvmValue1Addr);
-      }
+        createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2, LLVM_DOUBLE);
+      else
+        createSTORE(llvmValue2, getLLVMValueAddr(llvmValue1));
       break;
     }
   case instruction::_CHLOAD:
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
       int asciiCode = getAsciiCode(tcodeArg2);
-      llvmValue2 = std::to_string(asciiCode);
+      llvmValue2 = LLVMValue(std::to_string(asciiCode));
       if (isTCodeTemporal(tcodeArg1))
-        llvmCode += createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2, LLVM_INT32);
-      else {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += createSTORE(llvmValue2, llvmValue1Addr);
-      }
+        createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2, LLVM_INT32);
+      else
+        createSTORE(llvmValue2, getLLVMValueAddr(llvmValue1));
       break;
     }
   case instruction::_PUSH:
     {
       if (tcodeArg1 != "") {
-        accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-        std::string llvmType = getLLVMTypeOfValue(llvmValue1);
-        llvmCode += llvmMemCodeValue1;
+        accessValueOfArgument(tcodeArg1, llvmValue1);
         pushLLVMParamCallStack(llvmValue1);
       }
       else {
-        pushLLVMParamCallStack("");
+        pushLLVMParamCallStack(LLVMValue());
       }
       break;
     }
   case instruction::_POP:
     {
-      std::string param = topPopLLVMParamCallStack();
-      if (param != "")
+      LLVMValue param = topPopLLVMParamCallStack();
+      if (not param.isNull())
         pendingCallArgs.push_back(param);
       if (tcodeArg1 != "") {
-        modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-        llvmCode += createCALL(pendingCallFunc, llvmValue1, pendingCallArgs);
-        llvmCode += llvmMemCodeValue1;
+        modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+        createCALL(pendingCallFunc, llvmValue1, pendingCallArgs);
+        storeModifiedValue(llvmValue1, llvmValue1Addr);
       }
       else if (isEmptyLLVMParamCallStack()) {
-        llvmCode += createCALL(pendingCallFunc, pendingCallArgs);
+        createCALL(pendingCallFunc, pendingCallArgs);
       }
       break;
     }
@@ -980,92 +1107,86 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       pendingCallFunc = tcodeArg1;
       pendingCallArgs.clear();
       if (isEmptyLLVMParamCallStack())
-        llvmCode += createCALL(pendingCallFunc, pendingCallArgs);
+        createCALL(pendingCallFunc, pendingCallArgs);
       break;
     }
   case instruction::_RETURN:
     {
-      std::string retType = getFuncReturnLLVMType(currentFunctionName);
+      const LLVMType *retType = getFuncReturnLLVMType(currentFunctionName);
       if (retType == LLVM_VOID) {
         if (isMain)
-          llvmCode += createRET(LLVM_ZERO_INT, LLVM_INT);
+          createRET(LLVMValue(LLVM_ZERO_INT), LLVM_INT);
         else
-          llvmCode += createRET();
+          createRET();
       }
       else {
-        accessValueOfArgument("_result", llvmValue1, llvmMemCodeValue1);
-        llvmCode += llvmMemCodeValue1;
-        llvmCode += createRET(llvmValue1);
+        accessValueOfArgument("_result", llvmValue1);
+        createRET(llvmValue1);
       }
       if (next.oper != instruction::_LABEL and next.oper != instruction::_NOOP) {
-        std::string labelDead = createNewPrefixedValueWithType("%.dead.code", LLVM_LABEL);
-        std::string labelDeadName = labelDead.substr(1);
-        llvmCode += createLABEL(labelDeadName);
+        LLVMValue labelDead = createNewPrefixedValueWithType("%.dead.code", LLVM_LABEL);
+        createLABEL(labelDead.getName().substr(1));
       }
       break;
     }
   case instruction::_XLOAD:
     {
       llvmValue1 =  getLLVMValue(tcodeArg1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      std::string llvmType = getLLVMTypeOfValue(llvmValue1);   // it can  be "array of" or "pointer to"
-      std::string llvmElemType;
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      const LLVMType *llvmType = llvmValue1.getType();   // it can  be "array of" or "pointer to"
+      const LLVMType *llvmElemType = LLVM_TYERR;
       if (isLLVMArrayType(llvmType))
         llvmElemType = getLLVMElementOfArrayType(llvmType);
       else if (isPointerType(llvmType))
         llvmElemType = getPointedType(llvmType);
-      std::string llvmElemTypePtr = getPointerToType(llvmElemType);
-      std::string arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
-      std::string arrayPointer = createNewPrefixedValueWithType("%.arrPtr", llvmElemTypePtr);
-      std::string llvmValue1Addr;
+      const LLVMType *llvmElemTypePtr = getPointerToType(llvmElemType);
+      LLVMValue arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
+      LLVMValue arrayPointer = createNewPrefixedValueWithType("%.arrPtr", llvmElemTypePtr);
       if (isTCodeIdentifier(tcodeArg1))
         llvmValue1Addr = getLLVMValueAddr(llvmValue1);
       else
         llvmValue1Addr = llvmValue1;
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue2, LLVM_INT);
-      llvmCode += createGETELEMENTPTR(arrayPointer, llvmValue1Addr, arrayIndex64);
-      llvmCode += createSTORE(llvmValue3, arrayPointer);
+      createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue2, LLVM_INT);
+      createGETELEMENTPTR(arrayPointer, llvmValue1Addr, arrayIndex64);
+      createSTORE(llvmValue3, arrayPointer);
       break;
     }
   case instruction::_LOADX:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
       llvmValue2 = getLLVMValue(tcodeArg2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      std::string llvmType = getLLVMTypeOfValue(llvmValue2);   // it can  be "array of" or "pointer to"
-      std::string llvmElemType;
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      const LLVMType *llvmType = llvmValue2.getType();   // it can  be "array of" or "pointer to"
+      const LLVMType *llvmElemType = LLVM_TYERR;
       if (isLLVMArrayType(llvmType))
         llvmElemType = getLLVMElementOfArrayType(llvmType);
       else if (isPointerType(llvmType))
         llvmElemType = getPointedType(llvmType);
-      std::string llvmElemTypePtr = getPointerToType(llvmElemType);
-      std::string arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
-      std::string arrayPointer = createNewPrefixedValueWithType("%.arrPtr", llvmElemTypePtr);
-      std::string llvmValue2Addr;
+      const LLVMType *llvmElemTypePtr = getPointerToType(llvmElemType);
+      LLVMValue arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
+      LLVMValue arrayPointer = createNewPrefixedValueWithType("%.arrPtr", llvmElemTypePtr);
+      LLVMValue llvmValue2Addr;
       if (isTCodeIdentifier(tcodeArg2))
         llvmValue2Addr = getLLVMValueAddr(llvmValue2);
       else
         llvmValue2Addr = llvmValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue3, LLVM_INT);
-      llvmCode += createGETELEMENTPTR(arrayPointer, llvmValue2Addr, arrayIndex64);
-      llvmCode += createLOAD(llvmValue1, arrayPointer);
-      llvmCode += llvmMemCodeValue1;
+      createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue3, LLVM_INT);
+      createGETELEMENTPTR(arrayPointer, llvmValue2Addr, arrayIndex64);
+      createLOAD(llvmValue1, arrayPointer);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_ALOAD:
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
       llvmValue2 = getLLVMValue(tcodeArg2);
-      std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
-      std::string llvmValue2Addr= getLLVMValueAddr(llvmValue2);
+      const LLVMType *llvmType2 = llvmValue2.getType();
+      LLVMValue llvmValue2Addr = getLLVMValueAddr(llvmValue2);
       if (isLLVMArrayType(llvmType2))
-        llvmCode += createGETELEMENTPTR(llvmValue1, llvmValue2Addr, LLVM_ZERO_INT);
+        createGETELEMENTPTR(llvmValue1, llvmValue2Addr, LLVMValue(LLVM_ZERO_INT));
       else if (isPointerType(llvmType2))
-        llvmCode += createLOAD(llvmValue1, llvmValue2Addr);
+        createLOAD(llvmValue1, llvmValue2Addr);
       break;
     }
     /*
@@ -1082,33 +1203,29 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
     */
   case instruction::_WRITEI:
     {
-      accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-      llvmCode += llvmMemCodeValue1;
-      std::string printIntValue = llvmValue1;
-      if (llvmType1 == LLVM_INT1) {
+      accessValueOfArgument(tcodeArg1, llvmValue1);
+      LLVMValue printIntValue = llvmValue1;
+      if (llvmValue1.getType() == LLVM_INT1) {
         printIntValue = createNewPrefixedValueWithType("%.wrti.i32", LLVM_INT32);
-        llvmCode += createCONVERSION(LLVM_ZEXT, printIntValue, llvmValue1, LLVM_INT1);
+        createCONVERSION(LLVM_ZEXT, printIntValue, llvmValue1, LLVM_INT1);
       }
-      llvmCode += createPRINTF(printIntValue, LLVM_INT);
+      createPRINTF(printIntValue, LLVM_INT);
       break;
     }
   case instruction::_WRITEF:
     {
-      accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      llvmCode += llvmMemCodeValue1;
-      std::string fpextValue = createNewPrefixedValueWithType("%.wrtf.double", LLVM_DOUBLE);
-      llvmCode += createCONVERSION(LLVM_FPEXT, fpextValue, llvmValue1, LLVM_FLOAT);
-      llvmCode += createPRINTF(fpextValue, LLVM_DOUBLE);
+      accessValueOfArgument(tcodeArg1, llvmValue1);
+      LLVMValue fpextValue = createNewPrefixedValueWithType("%.wrtf.double", LLVM_DOUBLE);
+      createCONVERSION(LLVM_FPEXT, fpextValue, llvmValue1, LLVM_FLOAT);
+      createPRINTF(fpextValue, LLVM_DOUBLE);
       break;
     }
   case instruction::_WRITEC:
     {
-      accessValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      llvmCode += llvmMemCodeValue1;
-      std::string zextValue = createNewPrefixedValueWithType("%.wrtc.i32", LLVM_INT32);
-      llvmCode += createCONVERSION(LLVM_ZEXT, zextValue, llvmValue1, LLVM_INT8);
-      llvmCode += createPUTCHAR(zextValue);
+      accessValueOfArgument(tcodeArg1, llvmValue1);
+      LLVMValue zextValue = createNewPrefixedValueWithType("%.wrtc.i32", LLVM_INT32);
+      createCONVERSION(LLVM_ZEXT, zextValue, llvmValue1, LLVM_INT8);
+      createPUTCHAR(zextValue);
       break;
     }
   case instruction::_WRITES:
@@ -1117,47 +1234,46 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
       std::size_t i = std::distance(writeSAslStrVec.begin(), it);
       std::string strFormat = "@.str.s." + std::to_string(i+1);
       std::string::size_type llvmStrSize = writeSLLVMStrSizeVec[i];
-      llvmCode += createPRINTS(strFormat, llvmStrSize);
+      createPRINTS(strFormat, llvmStrSize);
       break;
     }
   case instruction::_WRITELN:
     { int asciiNL = int('\n');
-      llvmCode += createPUTCHAR(std::to_string(asciiNL));   // "10"
+      createPUTCHAR(LLVMValue(std::to_string(asciiNL)));   // "10"
       break;
     }
   case instruction::_READI:
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
-      std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
+      const LLVMType *llvmType1 = llvmValue1.getType();
       if (not isTCodeTemporal(tcodeArg1)) {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
+        llvmValue1Addr = getLLVMValueAddr(llvmValue1);
         if (llvmType1 == LLVM_INT1) {
-          std::string globalInt = createNewPrefixedValueWithType("%.readi.global.i", LLVM_INT32);
-          std::string compare0 = createNewPrefixedValueWithType("%.readi.i1.cmp1", LLVM_INT1);
-          std::string notCompare0 = createNewPrefixedValueWithType("%.readi.i1.not", LLVM_INT1);
-          llvmCode += createSCANF(LLVM_GLOBAL_INT_ADDR);
-          llvmCode += createLOAD(globalInt, LLVM_GLOBAL_INT_ADDR);
-          llvmCode += createCOMPARISON(instruction::_EQ, compare0, globalInt, LLVM_ZERO_INT, LLVM_INT);
-          llvmCode += createNOT(notCompare0, compare0);
-          llvmCode += createSTORE(notCompare0, llvmValue1Addr);
+          LLVMValue globalInt = createNewPrefixedValueWithType("%.readi.global.i", LLVM_INT32);
+          LLVMValue compare0 = createNewPrefixedValueWithType("%.readi.i1.cmp1", LLVM_INT1);
+          LLVMValue notCompare0 = createNewPrefixedValueWithType("%.readi.i1.not", LLVM_INT1);
+          createSCANF(LLVM_GLOBAL_INT_ADDR);
+          createLOAD(globalInt, LLVM_GLOBAL_INT_ADDR);
+          createCOMPARISON(instruction::_EQ, compare0, globalInt, LLVMValue(LLVM_ZERO_INT), LLVM_INT);
+          createNOT(notCompare0, compare0);
+          createSTORE(notCompare0, llvmValue1Addr);
         }
         else {
-          llvmCode += createSCANF(llvmValue1Addr);
+          createSCANF(llvmValue1Addr);
         }
       }
       else {
         if (llvmType1 == LLVM_INT1) {
-          std::string globalInt = createNewPrefixedValueWithType("%.readi.global.i", LLVM_INT32);
-          std::string compare0 = createNewPrefixedValueWithType("%.readi.i1.cmp1", LLVM_INT1);
-          std::string notCompare0 = createNewPrefixedValueWithType("%.readi.i1.not", LLVM_INT1);
-          llvmCode += createSCANF(LLVM_GLOBAL_INT_ADDR);
-          llvmCode += createLOAD(globalInt, LLVM_GLOBAL_INT_ADDR);
-          llvmCode += createCOMPARISON(instruction::_EQ, compare0, globalInt, LLVM_ZERO_INT, LLVM_INT);
-          llvmCode += createNOT(llvmValue1, compare0);
+          LLVMValue globalInt = createNewPrefixedValueWithType("%.readi.global.i", LLVM_INT32);
+          LLVMValue compare0 = createNewPrefixedValueWithType("%.readi.i1.cmp1", LLVM_INT1);
+          createSCANF(LLVM_GLOBAL_INT_ADDR);
+          createLOAD(globalInt, LLVM_GLOBAL_INT_ADDR);
+          createCOMPARISON(instruction::_EQ, compare0, globalInt, LLVMValue(LLVM_ZERO_INT), LLVM_INT);
+          createNOT(llvmValue1, compare0);
         }
         else {
-          llvmCode += createSCANF(LLVM_GLOBAL_INT_ADDR);
-          llvmCode += createLOAD(llvmValue1, LLVM_GLOBAL_INT_ADDR);
+          createSCANF(LLVM_GLOBAL_INT_ADDR);
+          createLOAD(llvmValue1, LLVM_GLOBAL_INT_ADDR);
         }
       }
      break;
@@ -1166,12 +1282,11 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
       if (not isTCodeTemporal(tcodeArg1)) {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += createSCANF(llvmValue1Addr);
+        createSCANF(getLLVMValueAddr(llvmValue1));
       }
       else {
-        llvmCode += createSCANF(LLVM_GLOBAL_FLOAT_ADDR);
-        llvmCode += createLOAD(llvmValue1, LLVM_GLOBAL_FLOAT_ADDR);
+        createSCANF(LLVM_GLOBAL_FLOAT_ADDR);
+        createLOAD(llvmValue1, LLVM_GLOBAL_FLOAT_ADDR);
       }
       break;
     }
@@ -1179,12 +1294,11 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
     {
       llvmValue1 = getLLVMValue(tcodeArg1);
       if (not isTCodeTemporal(tcodeArg1)) {
-        std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
-        llvmCode += createSCANF(llvmValue1Addr);
+        createSCANF(getLLVMValueAddr(llvmValue1));
       }
       else {
-        llvmCode += createSCANF(LLVM_GLOBAL_CHAR_ADDR);
-        llvmCode += createLOAD(llvmValue1, LLVM_GLOBAL_CHAR_ADDR);
+        createSCANF(LLVM_GLOBAL_CHAR_ADDR);
+        createLOAD(llvmValue1, LLVM_GLOBAL_CHAR_ADDR);
       }
       break;
     }
@@ -1193,57 +1307,46 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
   case instruction::_MUL:
   case instruction::_DIV:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_INT);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_INT);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_EQ:
   case instruction::_LT:
   case instruction::_LE:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      std::string llvmType23 = LLVM_INT;
-      if (isTCodeIdentifier(tcodeArg2) or isTCodeTemporal(tcodeArg2)) {
-        std::string llvmValue2 = getLLVMValue(tcodeArg2);
-        llvmType23 = getLLVMTypeOfValue(llvmValue2);
-      }
-      else if (isTCodeIdentifier(tcodeArg3) or isTCodeTemporal(tcodeArg3)) {
-        std::string llvmValue3 = getLLVMValue(tcodeArg3);
-        llvmType23 = getLLVMTypeOfValue(llvmValue3);
-      }
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, llvmType23);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      const LLVMType *llvmType23 = LLVM_INT;
+      if (isTCodeIdentifier(tcodeArg2) or isTCodeTemporal(tcodeArg2))
+        llvmType23 = getLLVMValue(tcodeArg2).getType();
+      else if (isTCodeIdentifier(tcodeArg3) or isTCodeTemporal(tcodeArg3))
+        llvmType23 = getLLVMValue(tcodeArg3).getType();
+      createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, llvmType23);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
      }
   case instruction::_FEQ:
   case instruction::_FLT:
   case instruction::_FLE:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
      }
   case instruction::_NEG:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += createARITHMETIC(instruction::_SUB, llvmValue1, LLVM_ZERO_INT, llvmValue2, LLVM_INT);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      createARITHMETIC(instruction::_SUB, llvmValue1, LLVMValue(LLVM_ZERO_INT), llvmValue2, LLVM_INT);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_FADD:
@@ -1251,64 +1354,55 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
   case instruction::_FMUL:
   case instruction::_FDIV:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_FNEG:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      if (isTCodeTemporal(tcodeArg1))
-        bindLLVMLocalValueWithType(llvmValue1, LLVM_FLOAT);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += createFNEG(llvmValue1, llvmValue2);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      createFNEG(llvmValue1, llvmValue2);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_FLOAT:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += createSITOFP(llvmValue1, llvmValue2, LLVM_INT);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      createSITOFP(llvmValue1, llvmValue2, LLVM_INT);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_AND:
   case instruction::_OR:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      accessValueOfArgument(tcodeArg3, llvmValue3, llvmMemCodeValue3);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += llvmMemCodeValue3;
-      llvmCode += createLOGICAL(instr.oper, llvmValue1, llvmValue2, llvmValue3);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      accessValueOfArgument(tcodeArg3, llvmValue3);
+      createLOGICAL(instr.oper, llvmValue1, llvmValue2, llvmValue3);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_NOT:
     {
-      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmMemCodeValue1);
-      accessValueOfArgument(tcodeArg2, llvmValue2, llvmMemCodeValue2);
-      llvmCode += llvmMemCodeValue2;
-      llvmCode += createNOT(llvmValue1, llvmValue2);
-      llvmCode += llvmMemCodeValue1;
+      modifyValueOfArgument(tcodeArg1, llvmValue1, llvmValue1Addr);
+      accessValueOfArgument(tcodeArg2, llvmValue2);
+      createNOT(llvmValue1, llvmValue2);
+      storeModifiedValue(llvmValue1, llvmValue1Addr);
       break;
     }
   case instruction::_NOOP:
     {
-      llvmCode += ";   noop\n";
+      llvmInstrList->push_back(LLVMInstr(LLVMInstr::COMMENT, "noop"));
       break;
     }
   default:
     {
-      llvmCode += ";   UNKNOWN\n";
+      llvmInstrList->push_back(LLVMInstr(LLVMInstr::COMMENT, "UNKNOWN"));
       break;
     }
   }
@@ -1316,8 +1410,6 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
   prevInstrIsTerminator = (instr.oper == instruction::_UJUMP or
                            instr.oper == instruction::_FJUMP or
                            instr.oper == instruction::_RETURN);
-  
-  return llvmCode;
 }
 
 
@@ -1332,235 +1424,290 @@ std::string LLVMCodeGen::getTCodeArg(const instruction & instr, int i) const {
   return arg;
 }
 
-std::string LLVMCodeGen::getLLVMValue(const std::string & tcodeIdent) const {
+std::string LLVMCodeGen::getLLVMValueName(const std::string & tcodeIdent) const {
   if (tcodeIdent.size() == 0) return "";
   if (tcodeIdent[0] == '%') return "%.temp." + tcodeIdent.substr(1);
   if (std::isdigit(tcodeIdent[0])) return tcodeIdent;
   return "%"+tcodeIdent;
 }
 
-std::string LLVMCodeGen::getLLVMValueAddr(const std::string & llvmValue) const {
-  return llvmValue + ".addr";
+LLVMValue LLVMCodeGen::getLLVMValue(const std::string & tcodeIdent) const {
+  // the constants have no type: the instructions give it
+  std::string llvmValue = getLLVMValueName(tcodeIdent);
+  auto it = llvmLocalValueTypeMap.find(llvmValue);
+  if (it == llvmLocalValueTypeMap.end())
+    return LLVMValue(llvmValue);
+  return LLVMValue(llvmValue, it->second);
+}
+
+LLVMValue LLVMCodeGen::getLLVMValueAddr(const LLVMValue & llvmValue) const {
+  return LLVMValue(llvmValue.getName() + ".addr", getPointerToType(llvmValue.getType()));
 }
 
-std::string LLVMCodeGen::createALLOCA(const std::string & llvmValueAddr, const std::string & llvmType) const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + llvmValueAddr + " = alloca " + llvmType + "\n";
-  return llvmCode;
+void LLVMCodeGen::createALLOCA(const LLVMValue & llvmValueAddr) {
+  LLVMInstr instr(LLVMInstr::ALLOCA);
+  instr.result = llvmValueAddr;
+  instr.type   = getPointedType(llvmValueAddr.getType());
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createSTORE(const std::string & llvmValue1,
-                                     const std::string & llvmValue2Addr) const {
-  std::string llvmCode;
-  std::string llvmType2Ptr = getLLVMTypeOfValue(llvmValue2Addr);
-  std::string llvmType2    = getPointedType(llvmType2Ptr);
-  llvmCode += INDENT_INSTR + "store " + llvmType2 + " " + llvmValue1 + ", " + llvmType2Ptr + " " + llvmValue2Addr + "\n";
-  return llvmCode;
+void LLVMCodeGen::createSTORE(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2Addr) {
+  LLVMInstr instr(LLVMInstr::STORE);
+  instr.operands = {llvmValue1, llvmValue2Addr};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createLABEL(const std::string & label) const {
-  std::string llvmCode;
-  llvmCode += INDENT_LABEL + label + ":\n";
-  return llvmCode;
+void LLVMCodeGen::createLABEL(const std::string & label) {
+  llvmInstrList->push_back(LLVMInstr(LLVMInstr::LABEL, label));
 }
 
-std::string LLVMCodeGen::createCONVERSION(const std::string & llvmInstr, const std::string & llvmValue1,
-                                          const std::string & llvmValue2, const std::string & llvmType2) const {
-  std::string llvmCode;
-  std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-  llvmCode += INDENT_INSTR + llvmValue1 + " = " + llvmInstr + " " + llvmType2 + " " + llvmValue2 + " to " + llvmType1 + "\n";
-  return llvmCode;
+void LLVMCodeGen::createCONVERSION(const std::string & llvmInstr, const LLVMValue & llvmValue1,
+                                   const LLVMValue & llvmValue2, const LLVMType * llvmType2) {
+  // <result> = <llvmInstr> <llvmType2> <llvmValue2> to <type of result>
+  LLVMInstr instr(LLVMInstr::CAST, llvmInstr);
+  instr.result   = llvmValue1;
+  instr.type     = llvmType2;
+  instr.operands = {llvmValue2};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createLOAD(const std::string & llvmValue1, const std::string & llvmValue2Addr) const {
-  std::string llvmCode;
-  std::string llvmTypePtr = getLLVMTypeOfValue(llvmValue2Addr);
-  std::string llvmType    = getPointedType(llvmTypePtr);
-  llvmCode += INDENT_INSTR + llvmValue1 + " = load " + llvmType + ", " + llvmTypePtr + " " + llvmValue2Addr + "\n";
-  return llvmCode;
+void LLVMCodeGen::createLOAD(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2Addr) {
+  LLVMInstr instr(LLVMInstr::LOAD);
+  instr.result   = llvmValue1;
+  instr.operands = {llvmValue2Addr};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createARITHMETIC(instruction::Operation oper, const std::string & llvmValue1,
-                                          const std::string & llvmValue2, const std::string & llvmValue3,
-                                          const std::string & llvmType23) const {
-  std::string llvmCode;
-  std::string llvmInstr = tcode2llvmInstrMap.at(oper);
-  llvmCode = INDENT_INSTR + llvmValue1 + " = " + llvmInstr + " " + llvmType23 + " " + llvmValue2 + ", " + llvmValue3 + "\n";
-  return llvmCode;
+void LLVMCodeGen::createARITHMETIC(instruction::Operation oper, const LLVMValue & llvmValue1,
+                                   const LLVMValue & llvmValue2, const LLVMValue & llvmValue3,
+                                   const LLVMType * llvmType23) {
+  LLVMInstr instr(LLVMInstr::BINARY, tcode2llvmInstrMap.at(oper));
+  instr.result   = llvmValue1;
+  instr.type     = llvmType23;
+  instr.operands = {llvmValue2, llvmValue3};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createCOMPARISON(instruction::Operation oper, const std::string & llvmValue1,
-                                          const std::string & llvmValue2, const std::string & llvmValue3,
-                                          const std::string & llvmType23) const {
-  std::string llvmCode;
-  std::string llvmInstr = tcode2llvmInstrMap.at(oper);
-  llvmCode = INDENT_INSTR + llvmValue1 + " = " + llvmInstr + " " + llvmType23 + " " + llvmValue2 + ", " + llvmValue3 + "\n";
-  return llvmCode;
+void LLVMCodeGen::createCOMPARISON(instruction::Operation oper, const LLVMValue & llvmValue1,
+                                   const LLVMValue & llvmValue2, const LLVMValue & llvmValue3,
+                                   const LLVMType * llvmType23) {
+  LLVMInstr instr(LLVMInstr::BINARY, tcode2llvmInstrMap.at(oper));
+  instr.result   = llvmValue1;
+  instr.type     = llvmType23;
+  instr.operands = {llvmValue2, llvmValue3};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createLOGICAL(instruction::Operation oper, const std::string & llvmValue1,
-                                       const std::string & llvmValue2, const std::string & llvmValue3) const {
-  std::string llvmCode;
-  std::string llvmInstr = tcode2llvmInstrMap.at(oper);
-  llvmCode = INDENT_INSTR + llvmValue1 + " = " + llvmInstr + " " + LLVM_BOOL + " " + llvmValue2 + ", " + llvmValue3 + "\n";
-  return llvmCode;
+void LLVMCodeGen::createLOGICAL(instruction::Operation oper, const LLVMValue & llvmValue1,
+                                const LLVMValue & llvmValue2, const LLVMValue & llvmValue3) {
+  LLVMInstr instr(LLVMInstr::BINARY, tcode2llvmInstrMap.at(oper));
+  instr.result   = llvmValue1;
+  instr.type     = LLVM_BOOL;
+  instr.operands = {llvmValue2, llvmValue3};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createNOT(const std::string & llvmValue1, const std::string & llvmValue2) const {
-  std::string llvmCode;
-  llvmCode = INDENT_INSTR + llvmValue1 + " = xor " + LLVM_BOOL + " " + llvmValue2 + ", " + LLVM_ONE_INT + "\n";
-  return llvmCode;
+void LLVMCodeGen::createNOT(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2) {
+  LLVMInstr instr(LLVMInstr::BINARY, "xor");
+  instr.result   = llvmValue1;
+  instr.type     = LLVM_BOOL;
+  instr.operands = {llvmValue2, LLVMValue(LLVM_ONE_INT)};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createFNEG(const std::string & llvmValue1, const std::string & llvmValue2) const {
-  std::string llvmCode;
+void LLVMCodeGen::createFNEG(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2) {
   // <result> = fneg [fast-math flags]* <ty> <op1>    ; yields ty:result
-  llvmCode += INDENT_INSTR + llvmValue1 + " = fneg " + LLVM_FLOAT + " " + llvmValue2 + "\n";
-  return llvmCode;
+  LLVMInstr instr(LLVMInstr::UNARY, "fneg");
+  instr.result   = llvmValue1;
+  instr.type     = LLVM_FLOAT;
+  instr.operands = {llvmValue2};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createSITOFP(const std::string & llvmValue1, const std::string & llvmValue2,
-                                      const std::string & llvmType2) const {
-  std::string llvmCode;
+void LLVMCodeGen::createSITOFP(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2,
+                               const LLVMType * llvmType2) {
   // <result> = sitofp <ty> <value> to <ty2>    ; yields ty2
-  std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
-  llvmCode += INDENT_INSTR + llvmValue1 + " = sitofp " + llvmType2 + " " + llvmValue2 + " to " + llvmType1 + "\n";
-  return llvmCode;
+  createCONVERSION("sitofp", llvmValue1, llvmValue2, llvmType2);
 }
 
 
-std::string LLVMCodeGen::createPRINTF(const std::string & llvmValue, const std::string & llvmType) const {
-  std::string llvmCode;
+LLVMValue LLVMCodeGen::getFormatString(const std::string & strFormat, int strSize) const {
+  // the address of the first char of a global string, as a constant
+  std::string arrayType = "[" + std::to_string(strSize) + " x i8]";
+  return LLVMValue("getelementptr inbounds (" + arrayType + ", " + arrayType + "* " +
+                   strFormat + ", i64 0, i64 0)", LLVM_CHAR_PTR);
+}
+
+void LLVMCodeGen::createPRINTF(const LLVMValue & llvmValue, const LLVMType * llvmType) {
+  if (runtimeIO) {
+    LLVMInstr instr(LLVMInstr::CALL, llvmType == LLVM_INT ? "__asl_write_int" : "__asl_write_float");
+    instr.type     = LLVM_VOID;
+    instr.operands = {LLVMValue(llvmValue.getName(), llvmType)};
+    llvmInstrList->push_back(std::move(instr));
+    return;
+  }
   std::string format;
   if (llvmType == LLVM_INT)
     format = "@.str.i";
   else if (llvmType == LLVM_DOUBLE)
     format = "@.str.f";
-  llvmCode += INDENT_INSTR + "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* " + format + ", i64 0, i64 0), " + llvmType + " " + llvmValue + ")\n";
-  return llvmCode;
-}
-
-std::string LLVMCodeGen::createPRINTS(const std::string & strFormat, const int strSize) const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([" + std::to_string(strSize) + " x i8], [" + std::to_string(strSize) + " x i8]* " + strFormat + ", i64 0, i64 0))\n";
-  return llvmCode;
+  LLVMInstr instr(LLVMInstr::CALL, "printf");
+  instr.type     = LLVM_INT32;
+  instr.varArg   = true;
+  instr.operands = {getFormatString(format, 3), LLVMValue(llvmValue.getName(), llvmType)};
+  llvmInstrList->push_back(std::move(instr));
+}
+
+void LLVMCodeGen::createPRINTS(const std::string & strFormat, const int strSize) {
+  if (runtimeIO) {
+    // the string is written as it is (without the final '\0')
+    LLVMInstr instr(LLVMInstr::CALL, "__asl_write_str");
+    instr.type     = LLVM_VOID;
+    instr.operands = {getFormatString(strFormat, strSize),
+                      LLVMValue(std::to_string(strSize-1), LLVM_INT32)};
+    llvmInstrList->push_back(std::move(instr));
+    return;
+  }
+  LLVMInstr instr(LLVMInstr::CALL, "printf");
+  instr.type     = LLVM_INT32;
+  instr.varArg   = true;
+  instr.operands = {getFormatString(strFormat, strSize)};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createPUTCHAR(const std::string & llvmValue) const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "call i32 @putchar(i32 " + llvmValue+ ")\n";
-  return llvmCode;
+void LLVMCodeGen::createPUTCHAR(const LLVMValue & llvmValue) {
+  LLVMInstr instr(LLVMInstr::CALL, runtimeIO ? "__asl_write_char" : "putchar");
+  instr.type     = runtimeIO ? LLVM_VOID : LLVM_INT32;
+  instr.operands = {LLVMValue(llvmValue.getName(), LLVM_INT32)};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createSCANF(const std::string & llvmValueAddr) const {
-  std::string llvmCode;
+void LLVMCodeGen::createSCANF(const LLVMValue & llvmValueAddr) {
   std::string format;
-  std::string llvmTypePtr = getLLVMTypeOfValue(llvmValueAddr);
-  std::string llvmType = getPointedType(llvmTypePtr);
+  const LLVMType *llvmType = getPointedType(llvmValueAddr.getType());
+  if (runtimeIO) {
+    LLVMInstr instr(LLVMInstr::CALL, llvmType == LLVM_INT   ? "__asl_read_int"   :
+                                     llvmType == LLVM_FLOAT ? "__asl_read_float" :
+                                                              "__asl_read_char");
+    instr.type     = LLVM_VOID;
+    instr.operands = {llvmValueAddr};
+    llvmInstrList->push_back(std::move(instr));
+    return;
+  }
   if (llvmType == LLVM_INT)
     format = "@.str.i";
   else if (llvmType == LLVM_FLOAT)
     format = "@.str.f";
-  else  // LLVM_CHAR
-    format = "@.str.c";
-  llvmCode += INDENT_INSTR + "call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* " + format + ", i64 0, i64 0), " + llvmTypePtr + " " + llvmValueAddr + ")\n";
-  return llvmCode;
+  else  // LLVM_CHAR: as the tvm, after the white space
+    format = "@.str.rc";
+  LLVMInstr instr(LLVMInstr::CALL, "__isoc99_scanf");
+  instr.type     = LLVM_INT32;
+  instr.varArg   = true;
+  instr.operands = {getFormatString(format, format == "@.str.rc" ? 4 : 3), llvmValueAddr};
+  llvmInstrList->push_back(std::move(instr));
+}
+
+void LLVMCodeGen::createHALT() {
+  LLVMInstr instr(LLVMInstr::CALL, "exit");
+  instr.type     = LLVM_VOID;
+  instr.operands = {LLVMValue(LLVM_ONE_INT, LLVM_INT32)};
+  llvmInstrList->push_back(std::move(instr));
+}
+
+void LLVMCodeGen::createBR(const std::string & label) {
+  LLVMInstr instr(LLVMInstr::BR);
+  instr.labels = {label};
+  llvmInstrList->push_back(std::move(instr));
+}
+
+// A node of metadata of the module: returns its name ("!3")
+std::string LLVMCodeGen::addProfileMetadata(const std::string & node) {
+  profileMetadata.push_back(node);
+  return "!" + std::to_string(profileMetadata.size() - 1);
+}
+
+// The conditional branch of the ifFalse at currentTCodePos: with a
+// profile, the times it fell through and jumped are its weights
+// (scaled down to 32 bits)
+void LLVMCodeGen::createBR(const LLVMValue & llvmValue,
+                           const std::string & labelCont, const std::string & labelJump) {
+  LLVMInstr instr(LLVMInstr::CONDBR);
+  instr.operands = {llvmValue};
+  instr.labels   = {labelCont, labelJump};
+  if (profileCounts != nullptr) {
+    auto it = profileCounts->branches.find(currentTCodePos);
+    if (it != profileCounts->branches.end() and
+        (it->second.first > 0 or it->second.second > 0)) {
+      std::uint64_t jumps = it->second.first, fallThroughs = it->second.second;
+      while (jumps > 0xFFFFFFFFu or fallThroughs > 0xFFFFFFFFu) {
+        jumps >>= 1;
+        fallThroughs >>= 1;
+      }
+      instr.metadata = "!prof " +
+        addProfileMetadata("!{!\"branch_weights\", i32 " + std::to_string(fallThroughs) +
+                           ", i32 " + std::to_string(jumps) + "}");
+    }
+  }
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createHALT() const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "call void @exit(i32 1)" + "\n";
-  return llvmCode;
+void LLVMCodeGen::createRET(const LLVMValue & llvmValue, const LLVMType * llvmType) {
+  LLVMInstr instr(LLVMInstr::RET);
+  instr.type     = llvmType;
+  instr.operands = {llvmValue};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createBR(const std::string & llvmValue) const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "br label " + llvmValue + "\n";
-  return llvmCode;
+void LLVMCodeGen::createRET(const LLVMValue & llvmValue) {
+  createRET(llvmValue, llvmValue.getType());
 }
 
-std::string LLVMCodeGen::createBR(const std::string & llvmValue,
-                                  const std::string & labelCont, const std::string & labelJump) const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "br i1 " + llvmValue + ", label " + labelCont + ", label " + labelJump + "\n";
-  return llvmCode;
+void LLVMCodeGen::createRET() {
+  llvmInstrList->push_back(LLVMInstr(LLVMInstr::RET));
 }
 
-std::string LLVMCodeGen::createRET(const std::string & llvmValue, const std::string & llvmType) const {
-  std::string llvmCode;
-  llvmCode = INDENT_INSTR + "ret " + llvmType + " " + llvmValue + "\n";
-  return llvmCode;
+void LLVMCodeGen::createCALL(const std::string & tcodeFunc, const LLVMValue & llvmValue1,
+                             const std::vector<LLVMValue> & llvmArgs) {
+  // the arguments are in reverse order (as popped)
+  LLVMInstr instr(LLVMInstr::CALL, tcodeFunc);
+  instr.result   = llvmValue1;
+  instr.fastCC   = true;
+  instr.type     = getFuncReturnLLVMType(tcodeFunc);
+  instr.operands.assign(llvmArgs.rbegin(), llvmArgs.rend());
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createRET(const std::string & llvmValue) const {
-  std::string llvmCode;
-  std::string llvmType = getLLVMTypeOfValue(llvmValue);
-  llvmCode += INDENT_INSTR + "ret " + llvmType + " " + llvmValue + "\n";
-  return llvmCode;
+void LLVMCodeGen::createCALL(const std::string & tcodeFunc,
+                             const std::vector<LLVMValue> & llvmArgs) {
+  createCALL(tcodeFunc, LLVMValue(), llvmArgs);
 }
 
-std::string LLVMCodeGen::createRET() const {
-  std::string llvmCode;
-  llvmCode += INDENT_INSTR + "ret void" + "\n";
-  return llvmCode;
+void LLVMCodeGen::createGETELEMENTPTR(const LLVMValue & llvmArrayPointerValue,
+                                      const LLVMValue & llvmArrayBaseValue,
+                                      const LLVMValue & llvmArrayIndexValue) {
+  // the base is a pointer to an array or to its first element
+  LLVMInstr instr(LLVMInstr::GEP);
+  instr.result   = llvmArrayPointerValue;
+  instr.operands = {llvmArrayBaseValue, llvmArrayIndexValue};
+  llvmInstrList->push_back(std::move(instr));
 }
 
-std::string LLVMCodeGen::createCALL(const std::string & tcodeFunc, const std::string & llvmValue1,
-                                    const std::vector<std::string> & llvmArgs) const {
-  std::string llvmCode;
-  std::string llvmRetType = getFuncReturnLLVMType(tcodeFunc);
-  int n = llvmArgs.size();
-  std::string llvmCodeArgs;
-  for (int i = n-1; i >= 0; --i) {
-    std::string param = llvmArgs[i];
-    std::string paramType = getLLVMTypeOfValue(param);
-    if (i == n-1)
-      llvmCodeArgs += paramType + " " + param;
-    else
-      llvmCodeArgs += ", " + paramType + " " + param;
-  }
-  llvmCode += INDENT_INSTR + llvmValue1 + " = call " + llvmRetType + " @" + tcodeFunc + "(" + llvmCodeArgs + ")\n";
-  return llvmCode;
-}
-
-std::string LLVMCodeGen::createCALL(const std::string & tcodeFunc,
-                                    const std::vector<std::string> & llvmArgs) const {
-  std::string llvmCode;
-  std::string llvmRetType = getFuncReturnLLVMType(tcodeFunc);
-  int n = llvmArgs.size();
-  std::string llvmCodeArgs;
-  for (int i = n-1; i >= 0; --i) {
-    std::string param = llvmArgs[i];
-    std::string paramType = getLLVMTypeOfValue(param);
-    if (i == n-1)
-      llvmCodeArgs += paramType + " " + param;
-    else
-      llvmCodeArgs += ", " + paramType + " " + param;
-  }
-  llvmCode += INDENT_INSTR + "call " + llvmRetType + " @" + tcodeFunc + "(" + llvmCodeArgs + ")\n";
-  return llvmCode;
-}
-
-std::string LLVMCodeGen::createGETELEMENTPTR(const std::string & llvmArrayPointerValue,
-                                             const std::string & llvmArrayBaseValue,
-                                             const std::string & llvmArrayIndexValue) const {
-  std::string llvmCode;
-  std::string llvmArrayPtrType = getLLVMTypeOfValue(llvmArrayBaseValue);
-  std::string llvmPointedType = getPointedType(llvmArrayPtrType);
-  if (isLLVMArrayType(llvmPointedType)) {
-    // %arrayidx = getelementptr inbounds [10 x i32], [10 x i32]* %A, i64 0, i64 %idxprom
-    llvmCode += INDENT_INSTR + llvmArrayPointerValue + " = getelementptr inbounds " + llvmPointedType + ", " + llvmArrayPtrType + " " + llvmArrayBaseValue + ", i64 0, i64 " + llvmArrayIndexValue + "\n";
-  }
-  else {
-    // %arrayidx = getelementptr inbounds i32, i32* %1, i64 %idxprom
-    llvmCode += INDENT_INSTR + llvmArrayPointerValue + " = getelementptr inbounds " + llvmPointedType + ", " + llvmArrayPtrType + " " + llvmArrayBaseValue + ", i64 " + llvmArrayIndexValue + "\n";
-  }
-  return llvmCode;
+void LLVMCodeGen::createPHI(const LLVMValue & llvmPhi, const std::vector<LLVMValue> & llvmValues,
+                            const std::vector<std::string> & labels) {
+  LLVMInstr instr(LLVMInstr::PHI);
+  instr.result   = llvmPhi;
+  instr.type     = llvmPhi.getType();
+  instr.operands = llvmValues;
+  instr.labels   = labels;
+  llvmInstrList->push_back(std::move(instr));
+}
+
+void LLVMCodeGen::createUNREACHABLE() {
+  llvmInstrList->push_back(LLVMInstr(LLVMInstr::UNREACHABLE));
 }
 
 
-void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn,
-                                        std::string & llvmValueOut, std::string & llvmAccInstr) {
+void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn, LLVMValue & llvmValueOut) {
   // Pre:  if tcodeArgIn is a tcode identifiier then:
   //          * the llvmValueIn corresponding to tcodeArgIn
   //            has been previously typed (using llvmValueTypeMap's)
@@ -1568,27 +1715,24 @@ void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn,
   //          * -
   // Post: if tcodeArgIn is a tcode identifiier then:
   //          * the new created llvmValueOut uses llvmValueIn as a prefix
-  //          * the new created llvmValueOut has been binded to the same type of llvmValueIn
-  //          * a new llvmAccInstr is created: a LOAD from the value of llvmValueIn
-  //            (in llvmValueInAddr) to the new created value llvmValueOut
+  //          * the new created llvmValueOut has the same type of llvmValueIn
+  //          * a LOAD from the value of llvmValueIn (in llvmValueInAddr)
+  //            to the new created value llvmValueOut has been added
   //       if tcodeArgIn is a tcode temporal or a constant then:
   //          * llmValueOut is the llvm value corresponding to tcodeArgIn
-  //          * no additional instruction is needed (llvmAccInstr is equal to "")
+  //          * no additional instruction is needed
   if (isTCodeIdentifier(tcodeArgIn)) {
-    std::string llvmValueIn     = getLLVMValue(tcodeArgIn);
-    std::string llvmType        = getLLVMTypeOfValue(llvmValueIn);
-    std::string llvmValueInAddr = getLLVMValueAddr(llvmValueIn);
-    llvmValueOut = createNewPrefixedValueWithType(llvmValueIn, llvmType);
-    llvmAccInstr = createLOAD(llvmValueOut, llvmValueInAddr);
+    LLVMValue llvmValueIn = getLLVMValue(tcodeArgIn);
+    llvmValueOut = createNewPrefixedValueWithType(llvmValueIn.getName(), llvmValueIn.getType());
+    createLOAD(llvmValueOut, getLLVMValueAddr(llvmValueIn));
   }
   else {
     llvmValueOut = getLLVMValue(tcodeArgIn);  // = tcodeArgIn;
-    llvmAccInstr = "";
   }
 }
 
 void LLVMCodeGen::modifyValueOfArgument(const std::string & tcodeArgIn,
-                                        std::string & llvmValueOut, std::string & llvmModInstr) {
+                                        LLVMValue & llvmValueOut, LLVMValue & llvmValueOutAddr) {
   // Pre:  if tcodeArgIn is a tcode identifiier then:
   //          * the llvmValueIn corresponding to tcodeArgIn
   //            has been previously typed (using llvmValueTypeMap's)
@@ -1596,27 +1740,31 @@ void LLVMCodeGen::modifyValueOfArgument(const std::string & tcodeArgIn,
   //          * -
   // Post: if tcodeArgIn is a tcode identifiier then:
   //          * the new created llvmValueOut uses llvmValueIn as a prefix
-  //          * the new created llvmValueOut is binded to the same type of llvmValueIn
-  //          * a new llvmModInstr is created: a STORE of the new created value llvmValueOut
-  //            into the memory address of llvmValueIn (llvmValueInAddr)
+  //          * the new created llvmValueOut has the same type of llvmValueIn
+  //          * llvmValueOutAddr is the memory address of llvmValueIn, where
+  //            llvmValueOut has to be stored (with storeModifiedValue) once
+  //            it is computed
   //       if tcodeArgIn is a tcode temporal or a constant then:
   //          * llmValueOut is the llvm value corresponding to tcodeArgIn
-  //          * no additional instruction is needed (llvmModInstr is equal to "")
+  //          * no additional instruction is needed (llvmValueOutAddr is null)
   if (isTCodeIdentifier(tcodeArgIn)) {
-    std::string llvmValueIn     = getLLVMValue(tcodeArgIn);
-    std::string llvmType        = getLLVMTypeOfValue(llvmValueIn);
-    std::string llvmValueInAddr = getLLVMValueAddr(llvmValueIn);
-    llvmValueOut = createNewPrefixedValueWithType(llvmValueIn, llvmType);
-    llvmModInstr = createSTORE(llvmValueOut, llvmValueInAddr);
+    LLVMValue llvmValueIn = getLLVMValue(tcodeArgIn);
+    llvmValueOut     = createNewPrefixedValueWithType(llvmValueIn.getName(), llvmValueIn.getType());
+    llvmValueOutAddr = getLLVMValueAddr(llvmValueIn);
   }
   else {
-    llvmValueOut = getLLVMValue(tcodeArgIn);  // = tcodeArgIn;
-    llvmModInstr = "";
+    llvmValueOut     = getLLVMValue(tcodeArgIn);  // = tcodeArgIn;
+    llvmValueOutAddr = LLVMValue();
   }
 }
 
-std::string LLVMCodeGen::createNewPrefixedValueWithType(const std::string & llvmValuePrefix,
-                                                        const std::string & llvmType) {
+void LLVMCodeGen::storeModifiedValue(const LLVMValue & llvmValue, const LLVMValue & llvmValueAddr) {
+  if (not llvmValueAddr.isNull())
+    createSTORE(llvmValue, llvmValueAddr);
+}
+
+LLVMValue LLVMCodeGen::createNewPrefixedValueWithType(const std::string & llvmValuePrefix,
+                                                      const LLVMType * llvmType) {
   // This method creates a new llvm value using the llvmLocalValueCountMap to generate  different
   // llvm identifiers.
   // Pre:  * llvmValuePrefix can be a llvm value of a tcode variable or parameter (for example, "%a"),
@@ -1624,40 +1772,23 @@ std::string LLVMCodeGen::createNewPrefixedValueWithType(const std::string & llvm
   // Post: * a completely new llvmValue is generated formed by the prefix, followed by a character '.',
   //         followed by the (integer) value of the counter in the llvmLocalValueCountMap.
   //         The value of llvmLocalValueCountMap is incremented for future uses.
-  //       * The new llvm value generated is binded to th type llvmType, using the method
-  //         bindLLVMLocalValueWithType
-  llvmLocalValueCountMap[llvmValuePrefix] += 1;
-  std::string llvmNewValue = llvmValuePrefix + "." + std::to_string(llvmLocalValueCountMap[llvmValuePrefix]);
-  bindLLVMLocalValueWithType(llvmNewValue, llvmType);
-  return llvmNewValue;
-}
-
-void LLVMCodeGen::bindGlobalValuesWithTypes() {
-  if (globalI) {
-    llvmGlobalValueVec.push_back(LLVM_GLOBAL_INT_ADDR);
-    llvmGlobalValueTypeMap[LLVM_GLOBAL_INT_ADDR] = LLVM_INT_PTR;
-  }
-  if (globalF) {
-    llvmGlobalValueVec.push_back(LLVM_GLOBAL_FLOAT_ADDR);
-    llvmGlobalValueTypeMap[LLVM_GLOBAL_FLOAT_ADDR] = LLVM_FLOAT_PTR;
-  }
-  if (globalC) {
-    llvmGlobalValueVec.push_back(LLVM_GLOBAL_CHAR_ADDR);
-    llvmGlobalValueTypeMap[LLVM_GLOBAL_CHAR_ADDR] = LLVM_CHAR_PTR;
-  }
+  //       * The new llvm value generated has the type llvmType
+  int & count = llvmLocalValueCountMap[llvmValuePrefix];
+  count += 1;
+  return LLVMValue(llvmValuePrefix + "." + std::to_string(count), llvmType);
 }
 
 void LLVMCodeGen::bindTCodeLocalValueWithType(const std::string & tcodeArg,
-                                              const std::string & llvmType) {
+                                              const LLVMType * llvmType) {
   if (isTCodeIdentifier(tcodeArg) or isTCodeTemporal(tcodeArg)) {
-    std::string llvmValue = getLLVMValue(tcodeArg);
+    std::string llvmValue = getLLVMValueName(tcodeArg);
     if (llvmLocalValueTypeMap.find(llvmValue) == llvmLocalValueTypeMap.end()) {
       llvmLocalValueVec.push_back(llvmValue);
       llvmLocalValueTypeMap[llvmValue]  = llvmType;
       llvmLocalValueCountMap[llvmValue] = 0;
     }
     else {
-      std::string llvmCurrentType = llvmLocalValueTypeMap.at(llvmValue);
+      const LLVMType *llvmCurrentType = llvmLocalValueTypeMap.at(llvmValue);
       if (llvmCurrentType != LLVM_TYERR and llvmType != LLVM_TYMISS) {
         if (llvmCurrentType == LLVM_INT_BOOL) {
           if (llvmType == LLVM_INT or llvmType == LLVM_BOOL or llvmType == LLVM_INT_BOOL)
@@ -1681,8 +1812,8 @@ void LLVMCodeGen::bindTCodeLocalValueWithType(const std::string & tcodeArg,
 
 void LLVMCodeGen::bindPairOfTCodeLocalValuesWithTypes(const std::string & tcodeArg1,
                                                       const std::string & tcodeArg2) {
-  std::string llvmValue1 = getLLVMValue(tcodeArg1);
-  std::string llvmValue2 = getLLVMValue(tcodeArg2);
+  std::string llvmValue1 = getLLVMValueName(tcodeArg1);
+  std::string llvmValue2 = getLLVMValueName(tcodeArg2);
   auto search1 = llvmLocalValueTypeMap.find(tcodeArg1);
   auto search2 = llvmLocalValueTypeMap.find(tcodeArg2);
   if (search1 == llvmLocalValueTypeMap.end() and search2 == llvmLocalValueTypeMap.end()) {
@@ -1690,22 +1821,22 @@ void LLVMCodeGen::bindPairOfTCodeLocalValuesWithTypes(const std::string & tcodeA
     llvmLocalValueTypeMap[tcodeArg2] = LLVM_TYMISS;
   }
   else if (search2 == llvmLocalValueTypeMap.end()) {
-    std::string llvmType1 = llvmLocalValueTypeMap.at(llvmValue1);
+    const LLVMType *llvmType1 = llvmLocalValueTypeMap.at(llvmValue1);
     if (llvmType1 == LLVM_TYERR)
       llvmLocalValueTypeMap[tcodeArg2] = LLVM_TYMISS;
     else
       llvmLocalValueTypeMap[tcodeArg2] = llvmType1;
   }
   else if (search1 == llvmLocalValueTypeMap.end()) {
-    std::string llvmType2 = llvmLocalValueTypeMap.at(llvmValue2);
+    const LLVMType *llvmType2 = llvmLocalValueTypeMap.at(llvmValue2);
     if (llvmType2 == LLVM_TYERR)
       llvmLocalValueTypeMap[tcodeArg1] = LLVM_TYMISS;
     else
       llvmLocalValueTypeMap[tcodeArg1] = llvmType2;
   }
   else {
-    std::string llvmType1 = llvmLocalValueTypeMap.at(llvmValue1);
-    std::string llvmType2 = llvmLocalValueTypeMap.at(llvmValue2);
+    const LLVMType *llvmType1 = llvmLocalValueTypeMap.at(llvmValue1);
+    const LLVMType *llvmType2 = llvmLocalValueTypeMap.at(llvmValue2);
     if (llvmType1 != LLVM_TYERR and llvmType2 != LLVM_TYERR) {
       if (llvmType1 != LLVM_TYMISS and llvmType2 == LLVM_TYMISS)
         llvmLocalValueTypeMap[tcodeArg2] = llvmType1;
@@ -1726,13 +1857,6 @@ void LLVMCodeGen::bindPairOfTCodeLocalValuesWithTypes(const std::string & tcodeA
   }
 }
 
-void LLVMCodeGen::bindLLVMLocalValueWithType(const std::string & llvmValue,
-                                             const std::string & llvmType) {
-  llvmLocalValueVec.push_back(llvmValue);
-  llvmLocalValueTypeMap[llvmValue]  = llvmType;
-  llvmLocalValueCountMap[llvmValue] = 0;
-}
-
 // void LLVMCodeGen::bindTempWithType(const std::string & tcodeArg,
 //                                    const std::string & llvmType) {
 //   if (isTCodeTemporal(tcodeArg)) {
@@ -1743,19 +1867,16 @@ void LLVMCodeGen::bindLLVMLocalValueWithType(const std::string & llvmValue,
 //   }
 // }
 
-std::string LLVMCodeGen::getLLVMTypeOfValue(const std::string & llvmValue) const {
-  if (llvmValue[0] == '%')  // local var
-    return llvmLocalValueTypeMap.at(llvmValue);
-  else  // llvmValue[0] == '@'  // global var
-    return llvmGlobalValueTypeMap.at(llvmValue);
+const LLVMType * LLVMCodeGen::getLLVMTypeOfValue(const std::string & llvmValue) const {
+  return llvmLocalValueTypeMap.at(llvmValue);
 }
 
 
-bool LLVMCodeGen::isLLVMAnyIntegerType(const std::string & llvmType) const {
+bool LLVMCodeGen::isLLVMAnyIntegerType(const LLVMType * llvmType) const {
   return (llvmType == LLVM_INT or llvmType == LLVM_INT8 or llvmType == LLVM_INT1);
 }
 
-std::string LLVMCodeGen::getLLVMTypeOneIntUp(const std::string & llvmIntType) const {
+const LLVMType * LLVMCodeGen::getLLVMTypeOneIntUp(const LLVMType * llvmIntType) const {
   if (llvmIntType == LLVM_INT) // LLVM_INT == LLVM_INT32
     return LLVM_INT64;
   else if (llvmIntType == LLVM_INT8)
@@ -1766,63 +1887,57 @@ std::string LLVMCodeGen::getLLVMTypeOneIntUp(const std::string & llvmIntType) co
     return LLVM_TYERR;
 }
 
-bool LLVMCodeGen::isLLVMArrayType(const std::string & llvmType) const {
-  std::string::size_type xpos = llvmType.find(" x ");
-  return xpos != std::string::npos;
+bool LLVMCodeGen::isLLVMArrayType(const LLVMType * llvmType) const {
+  return llvmType->isArray();
 }
 
-std::string LLVMCodeGen::getLLVMElementOfArrayType(const std::string & llvmArrayType) const {
-  std::string::size_type xpos = llvmArrayType.find(" x ");
-  assert(xpos != std::string::npos);
-  std::string::size_type len = llvmArrayType.size();
-  std::string elemType = llvmArrayType.substr(xpos+3, len-xpos-4);
-  return elemType;
+const LLVMType * LLVMCodeGen::getLLVMElementOfArrayType(const LLVMType * llvmArrayType) const {
+  assert(llvmArrayType->isArray());
+  return llvmArrayType->getElement();
 }
 
-std::string LLVMCodeGen::getLLVMArrayTypeAsPointerType(const std::string & llvmArrayType) const {
-  std::string elemType = getLLVMElementOfArrayType(llvmArrayType);
+const LLVMType * LLVMCodeGen::getLLVMArrayTypeAsPointerType(const LLVMType * llvmArrayType) const {
+  const LLVMType *elemType = getLLVMElementOfArrayType(llvmArrayType);
   return getPointerToType(elemType);
 }
 
-bool LLVMCodeGen::isPointerType(const std::string & llvmType) const {
-  std::size_t n = llvmType.size();
-  return llvmType[n-1] == '*';
+bool LLVMCodeGen::isPointerType(const LLVMType * llvmType) const {
+  return llvmType->isPointer();
 }
 
-std::string LLVMCodeGen::getPointerToType(const std::string & llvmType) const {
-  return llvmType + "*";
+const LLVMType * LLVMCodeGen::getPointerToType(const LLVMType * llvmType) const {
+  return TypeCtx.getPointerTo(llvmType);
 }
 
-std::string LLVMCodeGen::getPointedType(const std::string & llvmTypePtr) const {
-  std::size_t n = llvmTypePtr.size();
-  return llvmTypePtr.substr(0,n-1);
+const LLVMType * LLVMCodeGen::getPointedType(const LLVMType * llvmTypePtr) const {
+  return llvmTypePtr->getElement();
 }
 
 
 void LLVMCodeGen::pushTCodeParamCallStack(const std::string & tcodeParam) {
-  paramCallsStack.push(tcodeParam);
+  tcodeParamCallsStack.push(tcodeParam);
 }
 
 std::string LLVMCodeGen::topPopTCodeParamCallStack() {
-  assert(paramCallsStack.size() > 0);
-  std::string tcodeParam = paramCallsStack.top();
-  paramCallsStack.pop();
+  assert(tcodeParamCallsStack.size() > 0);
+  std::string tcodeParam = tcodeParamCallsStack.top();
+  tcodeParamCallsStack.pop();
   return tcodeParam;
 }
 
-void LLVMCodeGen::pushLLVMParamCallStack(const std::string & llvmParam) {
-  paramCallsStack.push(llvmParam);
+void LLVMCodeGen::pushLLVMParamCallStack(const LLVMValue & llvmParam) {
+  llvmParamCallsStack.push(llvmParam);
 }
 
-std::string LLVMCodeGen::topPopLLVMParamCallStack() {
-  assert(paramCallsStack.size() > 0);
-  std::string llvmParam = paramCallsStack.top();
-  paramCallsStack.pop();
+LLVMValue LLVMCodeGen::topPopLLVMParamCallStack() {
+  assert(llvmParamCallsStack.size() > 0);
+  LLVMValue llvmParam = llvmParamCallsStack.top();
+  llvmParamCallsStack.pop();
   return llvmParam;
 }
 
 bool LLVMCodeGen::isEmptyLLVMParamCallStack() const {
-  return paramCallsStack.empty();
+  return llvmParamCallsStack.empty();
 }
 
 
@@ -1844,7 +1959,647 @@ int LLVMCodeGen::getAsciiCode(const std::string & s) const {
 }
 
 
-std::string LLVMCodeGen::llvmComment(const std::string & comm) const {
-  if (COMMENTS_ENABLED) return ";   " + comm + "\n";
-  return "";
+void LLVMCodeGen::llvmComment(const std::string & comm) {
+  if (COMMENTS_ENABLED)
+    llvmInstrList->push_back(LLVMInstr(LLVMInstr::COMMENT, comm));
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+// SSA mode
+//
+// The instructions of a subroutine are split in basic blocks and the
+// scalar params, local vars and temporals are renamed into SSA values
+// as the blocks are emitted, following the algorithm of Braun et al.
+// ("Simple and Efficient Construction of Static Single Assignment
+// Form", CC 2013): each block keeps the current definition of each
+// variable, a use without a definition in its block looks for it in
+// the predecessors, and a phi node is placed when they do not agree.
+// A block is sealed when all its predecessors have been emitted; the
+// phis placed before are completed then. The phis that end up with a
+// single incoming value are removed at the end of the subroutine.
+// Only the local arrays are kept in memory.
+
+void LLVMCodeGen::dumpSubroutineSSA(const subroutine & subr, LLVMFunction & llvmFunction) {
+  instructionList instrList = subr.get_instructions();
+  ssaPhiVec.clear();
+  ssaPhiMap.clear();
+  ssaReplacedPhiMap.clear();
+  splitBasicBlocksSSA(instrList);
+  std::string funcName = subr.get_name();
+  // the entry block: the params are the first definitions
+  ssaCurrentBlock = 0;
+  llvmInstrList = &ssaBlocks[0].instrs;
+  sealBlockSSA(0);
+  for (auto p : subr.params) {
+    if (p.name != "_result" and isSSAVariable(p.name))
+      writeVariableSSA(p.name, 0, getLLVMValue(p.name));
+  }
+  for (auto v : subr.vars) {
+    const LLVMType *llvmType = getLocalSymbolLLVMType(funcName, v.name);
+    if (isLLVMArrayType(llvmType)) {
+      llvmComment("   localVar " + v.name +  " " + llvmType->str());
+      createALLOCA(getLLVMValueAddr(LLVMValue(getLLVMValueName(v.name), llvmType)));
+    }
+  }
+  // the blocks in the order of the t-code
+  for (std::size_t b = 0; b < ssaBlocks.size(); ++b) {
+    SSABlock & block = ssaBlocks[b];
+    ssaCurrentBlock = b;
+    llvmInstrList = &block.instrs;
+    if (not block.sealed and allPredsFilledSSA(b))
+      sealBlockSSA(b);
+    prevInstrIsTerminator = false;
+    for (std::size_t i = block.begin; i < block.end; ++i) {
+      if (COMMENTS_ENABLED) llvmComment(instrList[i].dump());
+      currentTCodePos = i;
+      dumpInstructionSSA(instrList[i]);
+    }
+    if (not prevInstrIsTerminator) {
+      if (block.succs.empty())
+        createUNREACHABLE();
+      else
+        createBR("%" + ssaBlocks[b+1].label);
+    }
+    block.filled = true;
+    for (std::size_t s : block.succs) {
+      if (not ssaBlocks[s].sealed and allPredsFilledSSA(s))
+        sealBlockSSA(s);
+    }
+  }
+  removeTrivialPhisSSA();
+  // the blocks, each one with its phis first
+  dumpHeader(subr, llvmFunction);
+  llvmInstrList = &llvmFunction.body;
+  for (auto & block : ssaBlocks) {
+    createLABEL(block.label);
+    for (auto & llvmPhi : block.phis) {
+      if (ssaReplacedPhiMap.find(llvmPhi) == ssaReplacedPhiMap.end())
+        dumpPhiSSA(llvmPhi);
+    }
+    if (not ssaReplacedPhiMap.empty())
+      replacePhisSSA(block.instrs);
+    std::move(block.instrs.begin(), block.instrs.end(), std::back_inserter(llvmFunction.body));
+  }
+  llvmInstrList = nullptr;
+  ssaBlocks.clear();
+}
+
+void LLVMCodeGen::splitBasicBlocksSSA(const instructionList & instrList) {
+  // A block starts at each label and after each jump or return; the
+  // blocks after a jump or a return get the names of dumpInstruction
+  ssaBlocks.clear();
+  std::map<std::string, std::size_t> labelBlocks;
+  std::size_t n = instrList.size();
+  auto newBlock = [this] (const std::string & label, std::size_t begin) {
+    SSABlock block;
+    block.label  = label;
+    block.begin  = block.end = begin;
+    block.sealed = block.filled = false;
+    ssaBlocks.push_back(block);
+  };
+  newBlock(LLVM_ENTRY, 0);
+  bool open = true;
+  for (std::size_t i = 0; i < n; ++i) {
+    const instruction & instr = instrList[i];
+    if (instr.oper == instruction::_LABEL) {
+      if (open) ssaBlocks.back().end = i;
+      labelBlocks[instr.arg1] = ssaBlocks.size();
+      newBlock(instr.arg1, i+1);
+      open = true;
+    }
+    else if (instr.oper == instruction::_UJUMP or instr.oper == instruction::_FJUMP or
+             instr.oper == instruction::_RETURN) {
+      ssaBlocks.back().end = i+1;
+      open = false;
+      bool nextIsLabel = (i+1 < n and instrList[i+1].oper == instruction::_LABEL);
+      if (not nextIsLabel and (i+1 < n or instr.oper == instruction::_FJUMP)) {
+        std::string prefix = (instr.oper == instruction::_FJUMP ? "%.br.cont" :
+                              instr.oper == instruction::_UJUMP ? "%.dead.cont" : "%.dead.code");
+        LLVMValue label = createNewPrefixedValueWithType(prefix, LLVM_LABEL);
+        newBlock(label.getName().substr(1), i+1);
+        open = true;
+      }
+    }
+  }
+  if (open) ssaBlocks.back().end = n;
+  // the edges: a block without a jump or a return at the end goes on
+  // with the next one
+  for (std::size_t b = 0; b < ssaBlocks.size(); ++b) {
+    SSABlock & block = ssaBlocks[b];
+    instruction::Operation last = instruction::_NOOP;
+    if (block.end > block.begin) last = instrList[block.end-1].oper;
+    if (last == instruction::_UJUMP)
+      block.succs.push_back(labelBlocks.at(instrList[block.end-1].arg1));
+    else if (last == instruction::_FJUMP) {
+      block.succs.push_back(b+1);
+      block.succs.push_back(labelBlocks.at(instrList[block.end-1].arg2));
+    }
+    else if (last != instruction::_RETURN and b+1 < ssaBlocks.size())
+      block.succs.push_back(b+1);
+    for (std::size_t s : block.succs)
+      ssaBlocks[s].preds.push_back(b);
+  }
+}
+
+void LLVMCodeGen::dumpInstructionSSA(const instruction & instr) {
+  LLVMValue llvmValue1, llvmValue2, llvmValue3;
+
+  std::string tcodeArg1 = getTCodeArg(instr, 1);
+  std::string tcodeArg2 = getTCodeArg(instr, 2);
+  std::string tcodeArg3 = getTCodeArg(instr, 3);
+
+  switch (instr.oper) {
+  case instruction::_UJUMP:
+    {
+      createBR(getLLVMValueName(tcodeArg1));
+      break;
+    }
+  case instruction::_FJUMP:
+    {
+      llvmValue1 = readValueSSA(tcodeArg1);
+      std::string labelCont = "%" + ssaBlocks[ssaCurrentBlock+1].label;
+      createBR(llvmValue1, labelCont, getLLVMValueName(tcodeArg2));
+      break;
+    }
+  case instruction::_HALT:
+    {
+      createHALT();
+      break;
+    }
+  case instruction::_LOAD:
+    {
+      // a copy: the value of arg2 becomes the definition of arg1 (the
+      // copy of an array ends with its address, when the elements have
+      // already been copied)
+      if (not isSSAVariable(tcodeArg1)) break;
+      if (isTCodeIdentifier(tcodeArg2) and isLLVMArrayType(getTCodeArgLLVMType(tcodeArg2))) {
+        llvmValue1 = newDefinitionSSA(tcodeArg1);
+        createGETELEMENTPTR(llvmValue1, getArrayBaseSSA(tcodeArg2), LLVMValue(LLVM_ZERO_INT));
+        break;
+      }
+      llvmValue2 = readValueSSA(tcodeArg2);
+      writeVariableSSA(tcodeArg1, ssaCurrentBlock, llvmValue2);
+      break;
+    }
+  case instruction::_ILOAD:
+    {
+      writeVariableSSA(tcodeArg1, ssaCurrentBlock,
+                       LLVMValue(tcodeArg2, getTCodeArgLLVMType(tcodeArg1)));
+      break;
+    }
+  case instruction::_FLOAD:
+    {
+      // a float constant may not have an exact decimal representation
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createCONVERSION(LLVM_FPTRUNC, llvmValue1, LLVMValue(tcodeArg2), LLVM_DOUBLE);
+      break;
+    }
+  case instruction::_CHLOAD:
+    {
+      int asciiCode = getAsciiCode(tcodeArg2);
+      writeVariableSSA(tcodeArg1, ssaCurrentBlock,
+                       LLVMValue(std::to_string(asciiCode), getTCodeArgLLVMType(tcodeArg1)));
+      break;
+    }
+  case instruction::_PUSH:
+    {
+      if (tcodeArg1 != "") {
+        // the argument has the type of the pushed variable
+        llvmValue1 = readValueSSA(tcodeArg1);
+        pushLLVMParamCallStack(LLVMValue(llvmValue1.getName(), getTCodeArgLLVMType(tcodeArg1)));
+      }
+      else {
+        pushLLVMParamCallStack(LLVMValue());
+      }
+      break;
+    }
+  case instruction::_POP:
+    {
+      LLVMValue param = topPopLLVMParamCallStack();
+      if (not param.isNull())
+        pendingCallArgs.push_back(param);
+      if (tcodeArg1 != "") {
+        llvmValue1 = newDefinitionSSA(tcodeArg1);
+        createCALL(pendingCallFunc, llvmValue1, pendingCallArgs);
+      }
+      else if (isEmptyLLVMParamCallStack()) {
+        createCALL(pendingCallFunc, pendingCallArgs);
+      }
+      break;
+    }
+  case instruction::_CALL:
+    {
+      pendingCallFunc = tcodeArg1;
+      pendingCallArgs.clear();
+      if (isEmptyLLVMParamCallStack())
+        createCALL(pendingCallFunc, pendingCallArgs);
+      break;
+    }
+  case instruction::_RETURN:
+    {
+      const LLVMType *retType = getFuncReturnLLVMType(currentFunctionName);
+      if (retType == LLVM_VOID) {
+        if (isMain)
+          createRET(LLVMValue(LLVM_ZERO_INT), LLVM_INT);
+        else
+          createRET();
+      }
+      else {
+        llvmValue1 = readValueSSA("_result");
+        createRET(llvmValue1, getTCodeArgLLVMType("_result"));
+      }
+      break;
+    }
+  case instruction::_XLOAD:
+    {
+      llvmValue1 = getArrayBaseSSA(tcodeArg1);
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      const LLVMType *llvmType = getTCodeArgLLVMType(tcodeArg1);   // it can  be "array of" or "pointer to"
+      const LLVMType *llvmElemType;
+      if (isLLVMArrayType(llvmType))
+        llvmElemType = getLLVMElementOfArrayType(llvmType);
+      else
+        llvmElemType = getPointedType(llvmType);
+      LLVMValue arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
+      LLVMValue arrayPointer = createNewPrefixedValueWithType("%.arrPtr", getPointerToType(llvmElemType));
+      createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue2, LLVM_INT);
+      createGETELEMENTPTR(arrayPointer, llvmValue1, arrayIndex64);
+      createSTORE(llvmValue3, arrayPointer);
+      break;
+    }
+  case instruction::_LOADX:
+    {
+      llvmValue2 = getArrayBaseSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      const LLVMType *llvmType = getTCodeArgLLVMType(tcodeArg2);   // it can  be "array of" or "pointer to"
+      const LLVMType *llvmElemType;
+      if (isLLVMArrayType(llvmType))
+        llvmElemType = getLLVMElementOfArrayType(llvmType);
+      else
+        llvmElemType = getPointedType(llvmType);
+      LLVMValue arrayIndex64 = createNewPrefixedValueWithType("%.idx64", LLVM_INT64);
+      LLVMValue arrayPointer = createNewPrefixedValueWithType("%.arrPtr", getPointerToType(llvmElemType));
+      createCONVERSION(LLVM_SEXT, arrayIndex64, llvmValue3, LLVM_INT);
+      createGETELEMENTPTR(arrayPointer, llvmValue2, arrayIndex64);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createLOAD(llvmValue1, arrayPointer);
+      break;
+    }
+  case instruction::_ALOAD:
+    {
+      const LLVMType *llvmType2 = getTCodeArgLLVMType(tcodeArg2);
+      if (isLLVMArrayType(llvmType2)) {
+        llvmValue1 = newDefinitionSSA(tcodeArg1);
+        createGETELEMENTPTR(llvmValue1, getArrayBaseSSA(tcodeArg2), LLVMValue(LLVM_ZERO_INT));
+      }
+      else
+        writeVariableSSA(tcodeArg1, ssaCurrentBlock, getArrayBaseSSA(tcodeArg2));
+      break;
+    }
+  case instruction::_WRITEI:
+    {
+      llvmValue1 = readValueSSA(tcodeArg1);
+      LLVMValue printIntValue = llvmValue1;
+      if (getTCodeArgLLVMType(tcodeArg1) == LLVM_INT1) {
+        printIntValue = createNewPrefixedValueWithType("%.wrti.i32", LLVM_INT32);
+        createCONVERSION(LLVM_ZEXT, printIntValue, llvmValue1, LLVM_INT1);
+      }
+      createPRINTF(printIntValue, LLVM_INT);
+      break;
+    }
+  case instruction::_WRITEF:
+    {
+      llvmValue1 = readValueSSA(tcodeArg1);
+      LLVMValue fpextValue = createNewPrefixedValueWithType("%.wrtf.double", LLVM_DOUBLE);
+      createCONVERSION(LLVM_FPEXT, fpextValue, llvmValue1, LLVM_FLOAT);
+      createPRINTF(fpextValue, LLVM_DOUBLE);
+      break;
+    }
+  case instruction::_WRITEC:
+    {
+      llvmValue1 = readValueSSA(tcodeArg1);
+      LLVMValue zextValue = createNewPrefixedValueWithType("%.wrtc.i32", LLVM_INT32);
+      createCONVERSION(LLVM_ZEXT, zextValue, llvmValue1, LLVM_INT8);
+      createPUTCHAR(zextValue);
+      break;
+    }
+  case instruction::_WRITES:
+  case instruction::_WRITELN:
+  case instruction::_NOOP:
+    {
+      dumpInstruction(instr, instruction::NOOP());
+      break;
+    }
+  case instruction::_READI:
+    {
+      // the values are read in the global variables and then loaded
+      if (getTCodeArgLLVMType(tcodeArg1) == LLVM_INT1) {
+        LLVMValue globalInt = createNewPrefixedValueWithType("%.readi.global.i", LLVM_INT32);
+        LLVMValue compare0 = createNewPrefixedValueWithType("%.readi.i1.cmp1", LLVM_INT1);
+        createSCANF(LLVM_GLOBAL_INT_ADDR);
+        createLOAD(globalInt, LLVM_GLOBAL_INT_ADDR);
+        createCOMPARISON(instruction::_EQ, compare0, globalInt, LLVMValue(LLVM_ZERO_INT), LLVM_INT);
+        llvmValue1 = newDefinitionSSA(tcodeArg1);
+        createNOT(llvmValue1, compare0);
+      }
+      else {
+        createSCANF(LLVM_GLOBAL_INT_ADDR);
+        llvmValue1 = newDefinitionSSA(tcodeArg1);
+        createLOAD(llvmValue1, LLVM_GLOBAL_INT_ADDR);
+      }
+      break;
+    }
+  case instruction::_READF:
+    {
+      createSCANF(LLVM_GLOBAL_FLOAT_ADDR);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createLOAD(llvmValue1, LLVM_GLOBAL_FLOAT_ADDR);
+      break;
+    }
+  case instruction::_READC:
+    {
+      createSCANF(LLVM_GLOBAL_CHAR_ADDR);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createLOAD(llvmValue1, LLVM_GLOBAL_CHAR_ADDR);
+      break;
+    }
+  case instruction::_ADD:
+  case instruction::_SUB:
+  case instruction::_MUL:
+  case instruction::_DIV:
+    {
+      // the operands are read before the new definition: arg1 can be
+      // one of them (as in the code of the modulus)
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_INT);
+      break;
+    }
+  case instruction::_EQ:
+  case instruction::_LT:
+  case instruction::_LE:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      const LLVMType *llvmType23 = LLVM_INT;
+      if (isTCodeIdentifier(tcodeArg2) or isTCodeTemporal(tcodeArg2))
+        llvmType23 = getTCodeArgLLVMType(tcodeArg2);
+      else if (isTCodeIdentifier(tcodeArg3) or isTCodeTemporal(tcodeArg3))
+        llvmType23 = getTCodeArgLLVMType(tcodeArg3);
+      createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, llvmType23);
+      break;
+    }
+  case instruction::_FEQ:
+  case instruction::_FLT:
+  case instruction::_FLE:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createCOMPARISON(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
+      break;
+    }
+  case instruction::_NEG:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createARITHMETIC(instruction::_SUB, llvmValue1, LLVMValue(LLVM_ZERO_INT), llvmValue2, LLVM_INT);
+      break;
+    }
+  case instruction::_FADD:
+  case instruction::_FSUB:
+  case instruction::_FMUL:
+  case instruction::_FDIV:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createARITHMETIC(instr.oper, llvmValue1, llvmValue2, llvmValue3, LLVM_FLOAT);
+      break;
+    }
+  case instruction::_FNEG:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createFNEG(llvmValue1, llvmValue2);
+      break;
+    }
+  case instruction::_FLOAT:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createSITOFP(llvmValue1, llvmValue2, LLVM_INT);
+      break;
+    }
+  case instruction::_AND:
+  case instruction::_OR:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue3 = readValueSSA(tcodeArg3);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createLOGICAL(instr.oper, llvmValue1, llvmValue2, llvmValue3);
+      break;
+    }
+  case instruction::_NOT:
+    {
+      llvmValue2 = readValueSSA(tcodeArg2);
+      llvmValue1 = newDefinitionSSA(tcodeArg1);
+      createNOT(llvmValue1, llvmValue2);
+      break;
+    }
+  default:
+    {
+      llvmInstrList->push_back(LLVMInstr(LLVMInstr::COMMENT, "UNKNOWN"));
+      break;
+    }
+  }
+
+  prevInstrIsTerminator = (instr.oper == instruction::_UJUMP or
+                           instr.oper == instruction::_FJUMP or
+                           instr.oper == instruction::_RETURN);
+}
+
+void LLVMCodeGen::dumpPhiSSA(const std::string & llvmPhi) {
+  const SSAPhi & phi = ssaPhiMap.at(llvmPhi);
+  const SSABlock & block = ssaBlocks[phi.block];
+  std::vector<LLVMValue> llvmValues;
+  std::vector<std::string> labels;
+  for (std::size_t i = 0; i < phi.operands.size(); ++i) {
+    llvmValues.push_back(LLVMValue(resolvePhiSSA(phi.operands[i].getName()),
+                                   phi.operands[i].getType()));
+    labels.push_back("%" + ssaBlocks[block.preds[i]].label);
+  }
+  createPHI(LLVMValue(llvmPhi, getTCodeArgLLVMType(phi.tcodeVar)), llvmValues, labels);
+}
+
+bool LLVMCodeGen::isSSAVariable(const std::string & tcodeArg) const {
+  // the temporals and the params and local vars of basic types (the
+  // arrays and the array params, that are pointers, are not renamed)
+  if (isTCodeTemporal(tcodeArg)) return true;
+  if (not isTCodeIdentifier(tcodeArg)) return false;
+  const LLVMType *llvmType = getTCodeArgLLVMType(tcodeArg);
+  return not isLLVMArrayType(llvmType) and not isPointerType(llvmType);
+}
+
+const LLVMType * LLVMCodeGen::getTCodeArgLLVMType(const std::string & tcodeArg) const {
+  return getLLVMTypeOfValue(getLLVMValueName(tcodeArg));
+}
+
+LLVMValue LLVMCodeGen::getUndefValueSSA(const LLVMType * llvmType) const {
+  // the value of a variable used before any definition (as in memory,
+  // where the allocas are not initialized, any value would do)
+  if (llvmType == LLVM_FLOAT)
+    return LLVMValue(LLVM_ZERO_FLOAT, llvmType);
+  else if (isPointerType(llvmType))
+    return LLVMValue("null", llvmType);
+  else
+    return LLVMValue(LLVM_ZERO_INT, llvmType);
+}
+
+LLVMValue LLVMCodeGen::getArrayBaseSSA(const std::string & tcodeArg) {
+  // the address of the local arrays is the one of their alloca, the
+  // array params and the temporals already are pointers
+  if (isTCodeIdentifier(tcodeArg)) {
+    LLVMValue llvmValue = getLLVMValue(tcodeArg);
+    if (isLLVMArrayType(llvmValue.getType()))
+      return getLLVMValueAddr(llvmValue);
+    return llvmValue;
+  }
+  return readVariableSSA(tcodeArg, ssaCurrentBlock);
+}
+
+LLVMValue LLVMCodeGen::readValueSSA(const std::string & tcodeArg) {
+  if (isSSAVariable(tcodeArg))
+    return readVariableSSA(tcodeArg, ssaCurrentBlock);
+  return getLLVMValue(tcodeArg);
+}
+
+LLVMValue LLVMCodeGen::newDefinitionSSA(const std::string & tcodeVar) {
+  LLVMValue llvmValue = getLLVMValue(tcodeVar);
+  LLVMValue llvmNewValue = createNewPrefixedValueWithType(llvmValue.getName(), llvmValue.getType());
+  writeVariableSSA(tcodeVar, ssaCurrentBlock, llvmNewValue);
+  return llvmNewValue;
+}
+
+void LLVMCodeGen::writeVariableSSA(const std::string & tcodeVar, std::size_t b,
+                                   const LLVMValue & llvmValue) {
+  ssaBlocks[b].currentDef[tcodeVar] = llvmValue;
+}
+
+LLVMValue LLVMCodeGen::readVariableSSA(const std::string & tcodeVar, std::size_t b) {
+  auto it = ssaBlocks[b].currentDef.find(tcodeVar);
+  if (it != ssaBlocks[b].currentDef.end())
+    return it->second;
+  return readVariableRecursiveSSA(tcodeVar, b);
+}
+
+LLVMValue LLVMCodeGen::readVariableRecursiveSSA(const std::string & tcodeVar, std::size_t b) {
+  LLVMValue llvmValue;
+  SSABlock & block = ssaBlocks[b];
+  if (not block.sealed) {
+    // the operands will be added when the block is sealed
+    llvmValue = newPhiSSA(tcodeVar, b);
+    ssaBlocks[b].incompletePhis[tcodeVar] = llvmValue.getName();
+  }
+  else if (block.preds.empty())
+    llvmValue = getUndefValueSSA(getTCodeArgLLVMType(tcodeVar));
+  else if (block.preds.size() == 1)
+    llvmValue = readVariableSSA(tcodeVar, block.preds[0]);
+  else {
+    // the phi is the definition before reading the predecessors: it
+    // breaks the cycles of the loops
+    llvmValue = newPhiSSA(tcodeVar, b);
+    writeVariableSSA(tcodeVar, b, llvmValue);
+    addPhiOperandsSSA(llvmValue.getName());
+  }
+  writeVariableSSA(tcodeVar, b, llvmValue);
+  return llvmValue;
+}
+
+LLVMValue LLVMCodeGen::newPhiSSA(const std::string & tcodeVar, std::size_t b) {
+  LLVMValue llvmValue = getLLVMValue(tcodeVar);
+  LLVMValue llvmPhi = createNewPrefixedValueWithType(llvmValue.getName() + ".phi", llvmValue.getType());
+  SSAPhi phi;
+  phi.tcodeVar = tcodeVar;
+  phi.block = b;
+  ssaPhiMap[llvmPhi.getName()] = phi;
+  ssaPhiVec.push_back(llvmPhi.getName());
+  ssaBlocks[b].phis.push_back(llvmPhi.getName());
+  return llvmPhi;
+}
+
+void LLVMCodeGen::addPhiOperandsSSA(const std::string & llvmPhi) {
+  std::string tcodeVar = ssaPhiMap.at(llvmPhi).tcodeVar;
+  std::size_t b = ssaPhiMap.at(llvmPhi).block;
+  std::vector<LLVMValue> operands;
+  for (std::size_t pred : ssaBlocks[b].preds)
+    operands.push_back(readVariableSSA(tcodeVar, pred));
+  ssaPhiMap.at(llvmPhi).operands = operands;
+}
+
+bool LLVMCodeGen::allPredsFilledSSA(std::size_t b) const {
+  for (std::size_t pred : ssaBlocks[b].preds)
+    if (not ssaBlocks[pred].filled) return false;
+  return true;
+}
+
+void LLVMCodeGen::sealBlockSSA(std::size_t b) {
+  std::map<std::string, std::string> incompletePhis;
+  incompletePhis.swap(ssaBlocks[b].incompletePhis);
+  for (auto & varPhi : incompletePhis)
+    addPhiOperandsSSA(varPhi.second);
+  ssaBlocks[b].sealed = true;
+}
+
+void LLVMCodeGen::removeTrivialPhisSSA() {
+  // A phi whose incoming values are all the same value (or the phi
+  // itself) is replaced by that value, until no phi changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto & llvmPhi : ssaPhiVec) {
+      if (ssaReplacedPhiMap.find(llvmPhi) != ssaReplacedPhiMap.end()) continue;
+      const SSAPhi & phi = ssaPhiMap.at(llvmPhi);
+      std::string same;
+      bool trivial = true;
+      for (auto & operand : phi.operands) {
+        std::string llvmValue = resolvePhiSSA(operand.getName());
+        if (llvmValue == llvmPhi or llvmValue == same) continue;
+        if (same != "") {
+          trivial = false;
+          break;
+        }
+        same = llvmValue;
+      }
+      if (not trivial) continue;
+      if (same == "")  // unreachable, or only used by itself
+        same = getUndefValueSSA(getTCodeArgLLVMType(phi.tcodeVar)).getName();
+      ssaReplacedPhiMap[llvmPhi] = same;
+      changed = true;
+    }
+  }
+}
+
+std::string LLVMCodeGen::resolvePhiSSA(const std::string & llvmValue) const {
+  std::string resolved = llvmValue;
+  auto it = ssaReplacedPhiMap.find(resolved);
+  while (it != ssaReplacedPhiMap.end()) {
+    resolved = it->second;
+    it = ssaReplacedPhiMap.find(resolved);
+  }
+  return resolved;
+}
+
+void LLVMCodeGen::replacePhisSSA(std::vector<LLVMInstr> & llvmInstrs) const {
+  // replace the uses of the removed phis in the instructions of a block
+  if (ssaReplacedPhiMap.empty()) return;
+  for (auto & instr : llvmInstrs)
+    for (auto & operand : instr.operands)
+      if (ssaReplacedPhiMap.find(operand.getName()) != ssaReplacedPhiMap.end())
+        operand = LLVMValue(resolvePhiSSA(operand.getName()), operand.getType());
 }
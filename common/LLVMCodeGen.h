@@ -26,16 +26,20 @@
 //
 ////////////////////////////////////////////////////////////////
 
+#pragma once
 #pragma once
 
 #include "TypesMgr.h"
 #include "SymTable.h"
 #include "code.h"
+#include "LLVMIR.h"
+#include "TCodeProfile.h"
 
 #include <string>
 #include <vector>
 #include <map>
 #include <stack>
+#include <ostream>
 
 // using namespace std;
 
@@ -48,31 +52,33 @@ class LLVMCodeGen {
   const TypesMgr & Types;
   const SymTable & Symbols;
   const code     & tCode;
-  
+
+  // the types are created on demand (also by the const methods) and
+  // compared by address
+  mutable LLVMTypeContext TypeCtx;
+
   static const bool COMMENTS_ENABLED;
-  static const std::string INDENT_INSTR;
-  static const std::string INDENT_LABEL;
-  static const std::string LLVM_INT;
-  static const std::string LLVM_FLOAT;
-  static const std::string LLVM_CHAR;
-  static const std::string LLVM_BOOL;
-  static const std::string LLVM_VOID;
-  static const std::string LLVM_LABEL;
-  static const std::string LLVM_TYERR;
-  static const std::string LLVM_TYMISS;
-  static const std::string LLVM_INT_BOOL;
-  static const std::string LLVM_INT_PTR;
-  static const std::string LLVM_FLOAT_PTR;
-  static const std::string LLVM_CHAR_PTR;
-  static const std::string LLVM_BOOL_PTR;
-  static const std::string LLVM_INT1;
-  static const std::string LLVM_INT8;
-  static const std::string LLVM_INT32;
-  static const std::string LLVM_INT64;
-  static const std::string LLVM_DOUBLE;
-  static const std::string LLVM_GLOBAL_INT_ADDR;
-  static const std::string LLVM_GLOBAL_FLOAT_ADDR;
-  static const std::string LLVM_GLOBAL_CHAR_ADDR;
+  const LLVMType * const LLVM_INT;
+  const LLVMType * const LLVM_FLOAT;
+  const LLVMType * const LLVM_CHAR;
+  const LLVMType * const LLVM_BOOL;
+  const LLVMType * const LLVM_VOID;
+  const LLVMType * const LLVM_LABEL;
+  const LLVMType * const LLVM_TYERR;
+  const LLVMType * const LLVM_TYMISS;
+  const LLVMType * const LLVM_INT_BOOL;
+  const LLVMType * const LLVM_INT_PTR;
+  const LLVMType * const LLVM_FLOAT_PTR;
+  const LLVMType * const LLVM_CHAR_PTR;
+  const LLVMType * const LLVM_BOOL_PTR;
+  const LLVMType * const LLVM_INT1;
+  const LLVMType * const LLVM_INT8;
+  const LLVMType * const LLVM_INT32;
+  const LLVMType * const LLVM_INT64;
+  const LLVMType * const LLVM_DOUBLE;
+  const LLVMValue LLVM_GLOBAL_INT_ADDR;
+  const LLVMValue LLVM_GLOBAL_FLOAT_ADDR;
+  const LLVMValue LLVM_GLOBAL_CHAR_ADDR;
   static const std::string LLVM_ZERO_INT;
   static const std::string LLVM_ZERO_FLOAT;
   static const std::string LLVM_ONE_INT;
@@ -90,33 +96,81 @@ class LLVMCodeGen {
   bool globalI, globalF, globalC, globalS;
   std::vector<std::string>            writeSAslStrVec;
   std::vector<std::string::size_type> writeSLLVMStrSizeVec;
+  // effects of each function on the memory of its callers
+  struct FuncEffects {
+    bool io;                          // reads, writes or halts
+    bool readsArgs, writesArgs;       // through its array params
+    int  arrayParams;
+  };
+  std::map<std::string, FuncEffects>  funcEffectsMap;
   std::string currentFunctionName;
   bool isMain;
   bool prevInstrIsTerminator;
   std::vector<std::string>           llvmLocalValueVec;
-  std::map<std::string, std::string> llvmLocalValueTypeMap;
-  std::vector<std::string>           llvmGlobalValueVec;
-  std::map<std::string, std::string> llvmGlobalValueTypeMap;
+  std::map<std::string, const LLVMType *> llvmLocalValueTypeMap;
   std::map<std::string, int>         llvmLocalValueCountMap;
-  std::stack<std::string>            paramCallsStack;
-  std::string                        pendingCallLLVMRetType;
+  std::string                        localSymbolsFuncName;
+  std::map<std::string, TypesMgr::TypeId> localSymbolTypeMap;
+  std::stack<std::string>            tcodeParamCallsStack;
+  std::stack<LLVMValue>              llvmParamCallsStack;
+  const LLVMType *                   pendingCallLLVMRetType;
   std::string                        pendingCallFunc;
-  std::vector<std::string>           pendingCallArgs;
+  std::vector<LLVMValue>             pendingCallArgs;
+  // the list where the create* methods add the instructions
+  std::vector<LLVMInstr> *           llvmInstrList;
+
+  // SSA mode: the scalar params, local vars and temporals are not kept
+  // in memory but renamed into SSA values, with phi nodes at the joins
+  // of the control flow graph of the t-code (see dumpSubroutineSSA)
+  struct SSABlock {
+    std::string                        label;           // without the '%'
+    std::size_t                        begin, end;      // t-code instructions [begin, end)
+    std::vector<std::size_t>           preds, succs;
+    bool                               sealed, filled;
+    std::map<std::string, LLVMValue>   currentDef;      // tcode var -> llvm value
+    std::map<std::string, std::string> incompletePhis;  // tcode var -> phi
+    std::vector<std::string>           phis;
+    std::vector<LLVMInstr>             instrs;
+  };
+  struct SSAPhi {
+    std::string              tcodeVar;
+    std::size_t              block;
+    std::vector<LLVMValue>   operands;                  // one for each pred of block
+  };
+  bool                                 ssaMode;
+  std::vector<SSABlock>                ssaBlocks;
+  std::size_t                          ssaCurrentBlock;
+  std::vector<std::string>             ssaPhiVec;
+  std::map<std::string, SSAPhi>        ssaPhiMap;
+  std::map<std::string, std::string>   ssaReplacedPhiMap;
+
+  // the reads and writes call the buffered runtime of runtime/aslrt.c
+  // instead of scanf, printf and putchar
+  bool                                 runtimeIO;
+
+  // the counts of a profile run, if any: the functions get their entry
+  // count and the branches their weights, as metadata written at the
+  // end of the module
+  const TCodeProfile *                 profile;
+  const TCodeProfile::FunctionCounts * profileCounts;   // of the current function
+  std::size_t                          currentTCodePos;
+  std::vector<std::string>             profileMetadata;
 
   void check_SSA_tCode(std::string & failFunc, std::string & failTempVar) const;
   bool isTCodeTemporal   (const std::string & tcodeArg) const;
   bool isTCodeIdentifier (const std::string & tcodeArg) const;
 
   void computeReadWriteHaltInfo();
-  std::string              getFuncReturnLLVMType  (const std::string & tcodeFuncIdent)        const;
-  int                      getFuncNumberOfParams  (const std::string & tcodeFuncIdent)        const;
-  std::string              getFuncParamLLVMType   (const std::string & tcodeFuncIdent, int n) const;
-  std::vector<std::string> getFuncParamsLLVMTypes (const std::string & tcodeFuncIdent)        const;
+  void computeFunctionEffects();
+  const LLVMType *              getFuncReturnLLVMType  (const std::string & tcodeFuncIdent)        const;
+  int                           getFuncNumberOfParams  (const std::string & tcodeFuncIdent)        const;
+  const LLVMType *              getFuncParamLLVMType   (const std::string & tcodeFuncIdent, int n) const;
+  std::vector<const LLVMType *> getFuncParamsLLVMTypes (const std::string & tcodeFuncIdent)        const;
 
-  std::string              getLocalSymbolLLVMType (const std::string & tcodeFuncIdent,
-                                                   const std::string & tcodeSymbolIdent,
-                                                   bool isParameter = false) const;
-  std::string TypeIdToLLVMType(TypesMgr::TypeId tid, bool isParameter = false) const;
+  const LLVMType * getLocalSymbolLLVMType (const std::string & tcodeFuncIdent,
+                                           const std::string & tcodeSymbolIdent,
+                                           bool isParameter = false) const;
+  const LLVMType * TypeIdToLLVMType(TypesMgr::TypeId tid, bool isParameter = false) const;
 
   void getLLVMStringFromAslString(const std::string & aslString,
 				  std::string & llvmString,
@@ -124,89 +178,123 @@ class LLVMCodeGen {
   void generateReadWriteHaltBeginEndCode(std::string & begin, std::string & end) ;
   void startNewFunction(const subroutine & subr);
   void bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr);
-  std::string dumpSubroutine(const subroutine & subr);
-  std::string dumpHeader(const subroutine & subr);
-  std::string dumpAllocaParams(const subroutine & subr);
-  std::string dumpAllocaLocalVars(const subroutine & subr);
-  std::string dumpStoreParams(const subroutine & subr);
-  std::string dumpInstructionList(const subroutine & subr);
-  std::string dumpInstruction(const instruction & instr,
-                              const instruction & next);
+  void dumpSubroutine(const subroutine & subr, LLVMFunction & llvmFunction);
+  void dumpHeader(const subroutine & subr, LLVMFunction & llvmFunction);
+  void dumpAllocaParams(const subroutine & subr);
+  void dumpAllocaLocalVars(const subroutine & subr);
+  void dumpStoreParams(const subroutine & subr);
+  void dumpInstructionList(const subroutine & subr);
+  void dumpInstruction(const instruction & instr,
+                       const instruction & next);
   std::string getTCodeArg(const instruction & intr, int i) const;
-  std::string getLLVMValue(const std::string & tcodeIdent) const;
-  std::string getLLVMValueAddr(const std::string & llvmValue) const;
-
-  std::string createALLOCA(const std::string & llvmValueAddr, const std::string & llvmType) const;
-  std::string createSTORE(const std::string & llvmValue1, const std::string & llvmValue2) const;
-  std::string createLABEL(const std::string & label) const;
-  std::string createCONVERSION(const std::string & llvmInstr, const std::string & llvmValue1,
-                               const std::string & llvmValue2, const std::string & llvmType2) const;
-  std::string createLOAD(const std::string & llvmValue1, const std::string & llvmValue2) const;
-  std::string createARITHMETIC(instruction::Operation oper, const std::string & llvmValue1,
-                               const std::string & llvmValue2, const std::string & llvmValue3,
-                               const std::string & llvmType23) const;
-  std::string createCOMPARISON(instruction::Operation oper, const std::string & llvmValue1,
-                               const std::string & llvmValue2, const std::string & llvmValue3,
-                               const std::string & llvmType23) const;
-  std::string createLOGICAL(instruction::Operation oper, const std::string & llvmValue1,
-                            const std::string & llvmValue2, const std::string & llvmValue3) const;
-  std::string createNOT(const std::string & llvmValue1, const std::string & llvmValue2) const;
-  std::string createFNEG(const std::string & llvmValue1, const std::string & llvmValue2) const;
-  std::string createSITOFP(const std::string & llvmValue1,
-                           const std::string & llvmValue2, const std::string & llvmType2) const;
-  std::string createPRINTF(const std::string & llvmValue, const std::string & llvmType) const;
-  std::string createPRINTS(const std::string & str, const int sz) const;
-  std::string createPUTCHAR(const std::string & llvmValue) const;
-  std::string createSCANF(const std::string & llvmValueAddr) const;
-  std::string createHALT() const;
-  std::string createBR(const std::string & llvmValue) const;
-  std::string createBR(const std::string & llvmValue,
-                       const std::string & labelCont, const std::string & labelJump) const;
-  std::string createRET(const std::string & llvmValue, const std::string & llvmType) const;
-  std::string createRET(const std::string & llvmValue) const;
-  std::string createRET() const;
-  std::string createCALL(const std::string & tcodeFunc, const std::string & llvmValue1,
-                         const std::vector<std::string> & llvmArgs) const;
-  std::string createCALL(const std::string & tcodeFunc,
-                         const std::vector<std::string> & llvmArgs) const;
-  std::string createGETELEMENTPTR(const std::string & llvmArrayPointerValue,
-                                  const std::string & llvmArrayBaseValue,
-                                  const std::string & llvmArrayIndexValue) const;
-
-  void accessValueOfArgument(const std::string & tcodeArgIn,
-                             std::string & llvmArgOut, std::string & llvmAccInstr);
+  std::string getLLVMValueName(const std::string & tcodeIdent) const;
+  LLVMValue   getLLVMValue(const std::string & tcodeIdent) const;
+  LLVMValue   getLLVMValueAddr(const LLVMValue & llvmValue) const;
+
+  void createALLOCA(const LLVMValue & llvmValueAddr);
+  void createSTORE(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2Addr);
+  void createLABEL(const std::string & label);
+  void createCONVERSION(const std::string & llvmInstr, const LLVMValue & llvmValue1,
+                        const LLVMValue & llvmValue2, const LLVMType * llvmType2);
+  void createLOAD(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2Addr);
+  void createARITHMETIC(instruction::Operation oper, const LLVMValue & llvmValue1,
+                        const LLVMValue & llvmValue2, const LLVMValue & llvmValue3,
+                        const LLVMType * llvmType23);
+  void createCOMPARISON(instruction::Operation oper, const LLVMValue & llvmValue1,
+                        const LLVMValue & llvmValue2, const LLVMValue & llvmValue3,
+                        const LLVMType * llvmType23);
+  void createLOGICAL(instruction::Operation oper, const LLVMValue & llvmValue1,
+                     const LLVMValue & llvmValue2, const LLVMValue & llvmValue3);
+  void createNOT(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2);
+  void createFNEG(const LLVMValue & llvmValue1, const LLVMValue & llvmValue2);
+  void createSITOFP(const LLVMValue & llvmValue1,
+                    const LLVMValue & llvmValue2, const LLVMType * llvmType2);
+  void createPRINTF(const LLVMValue & llvmValue, const LLVMType * llvmType);
+  void createPRINTS(const std::string & str, const int sz);
+  void createPUTCHAR(const LLVMValue & llvmValue);
+  void createSCANF(const LLVMValue & llvmValueAddr);
+  void createHALT();
+  std::string addProfileMetadata(const std::string & node);
+  void createBR(const std::string & label);
+  void createBR(const LLVMValue & llvmValue,
+                const std::string & labelCont, const std::string & labelJump);
+  void createRET(const LLVMValue & llvmValue, const LLVMType * llvmType);
+  void createRET(const LLVMValue & llvmValue);
+  void createRET();
+  void createCALL(const std::string & tcodeFunc, const LLVMValue & llvmValue1,
+                  const std::vector<LLVMValue> & llvmArgs);
+  void createCALL(const std::string & tcodeFunc,
+                  const std::vector<LLVMValue> & llvmArgs);
+  void createGETELEMENTPTR(const LLVMValue & llvmArrayPointerValue,
+                           const LLVMValue & llvmArrayBaseValue,
+                           const LLVMValue & llvmArrayIndexValue);
+  void createPHI(const LLVMValue & llvmPhi, const std::vector<LLVMValue> & llvmValues,
+                 const std::vector<std::string> & labels);
+  void createUNREACHABLE();
+  LLVMValue getFormatString(const std::string & strFormat, int strSize) const;
+
+  void accessValueOfArgument(const std::string & tcodeArgIn, LLVMValue & llvmArgOut);
   void modifyValueOfArgument(const std::string & tCodeArgIn,
-                             std::string & llvmValueOut, std::string & llvmModInstr);
+                             LLVMValue & llvmValueOut, LLVMValue & llvmValueOutAddr);
+  void storeModifiedValue(const LLVMValue & llvmValue, const LLVMValue & llvmValueAddr);
 
-  std::string createNewPrefixedValueWithType(const std::string & llvmValuePrefix,
-                                             const std::string & llvmType);
-  void bindGlobalValuesWithTypes();
-  void bindTCodeLocalValueWithType(const std::string & tcodeArg, const std::string & llvmType);
+  LLVMValue createNewPrefixedValueWithType(const std::string & llvmValuePrefix,
+                                           const LLVMType * llvmType);
+  void bindTCodeLocalValueWithType(const std::string & tcodeArg, const LLVMType * llvmType);
   void bindPairOfTCodeLocalValuesWithTypes(const std::string & tcodeArg1,
                                            const std::string & tcodeArg2);
-  void bindLLVMLocalValueWithType(const std::string & llvmValue, const std::string & llvmType);
-  std::string getLLVMTypeOfValue(const std::string & llvmValue) const;
-
-  bool isLLVMAnyIntegerType(const std::string & llvmType) const;
-  std::string getLLVMTypeOneIntUp(const std::string & llvmIntType) const;
-  bool isLLVMArrayType(const std::string & llvmType) const;
-  std::string getLLVMElementOfArrayType(const std::string & llvmArrayType) const;
-  std::string getLLVMArrayTypeAsPointerType(const std::string & llvmArrayType) const;
-  bool isPointerType(const std::string & llvmType) const;
-  std::string getPointerToType(const std::string & llvmType) const;
-  std::string getPointedType(const std::string & llvmTypePtr) const;
+  const LLVMType * getLLVMTypeOfValue(const std::string & llvmValue) const;
+
+  bool isLLVMAnyIntegerType(const LLVMType * llvmType) const;
+  const LLVMType * getLLVMTypeOneIntUp(const LLVMType * llvmIntType) const;
+  bool isLLVMArrayType(const LLVMType * llvmType) const;
+  const LLVMType * getLLVMElementOfArrayType(const LLVMType * llvmArrayType) const;
+  const LLVMType * getLLVMArrayTypeAsPointerType(const LLVMType * llvmArrayType) const;
+  bool isPointerType(const LLVMType * llvmType) const;
+  const LLVMType * getPointerToType(const LLVMType * llvmType) const;
+  const LLVMType * getPointedType(const LLVMType * llvmTypePtr) const;
   
   void        pushTCodeParamCallStack(const std::string & tcodeParam);
   std::string topPopTCodeParamCallStack();
-  void        pushLLVMParamCallStack(const std::string & llvmParam);
-  std::string topPopLLVMParamCallStack();
+  void        pushLLVMParamCallStack(const LLVMValue & llvmParam);
+  LLVMValue   topPopLLVMParamCallStack();
   bool        isEmptyLLVMParamCallStack() const;
 
   int getAsciiCode(const std::string & s) const;
 
-  std::string llvmComment(const std::string & comm) const;
+  void llvmComment(const std::string & comm);
+
+  void        dumpSubroutineSSA(const subroutine & subr, LLVMFunction & llvmFunction);
+  void        splitBasicBlocksSSA(const instructionList & instrList);
+  void        dumpInstructionSSA(const instruction & instr);
+  void        dumpPhiSSA(const std::string & llvmPhi);
+  bool        isSSAVariable(const std::string & tcodeArg) const;
+  const LLVMType * getTCodeArgLLVMType(const std::string & tcodeArg) const;
+  LLVMValue   getUndefValueSSA(const LLVMType * llvmType) const;
+  LLVMValue   getArrayBaseSSA(const std::string & tcodeArg);
+  LLVMValue   readValueSSA(const std::string & tcodeArg);
+  LLVMValue   newDefinitionSSA(const std::string & tcodeVar);
+  void        writeVariableSSA(const std::string & tcodeVar, std::size_t b,
+                               const LLVMValue & llvmValue);
+  LLVMValue   readVariableSSA(const std::string & tcodeVar, std::size_t b);
+  LLVMValue   readVariableRecursiveSSA(const std::string & tcodeVar, std::size_t b);
+  LLVMValue   newPhiSSA(const std::string & tcodeVar, std::size_t b);
+  void        addPhiOperandsSSA(const std::string & llvmPhi);
+  bool        allPredsFilledSSA(std::size_t b) const;
+  void        sealBlockSSA(std::size_t b);
+  void        removeTrivialPhisSSA();
+  std::string resolvePhiSSA(const std::string & llvmValue) const;
+  void        replacePhisSSA(std::vector<LLVMInstr> & llvmInstrs) const;
 
 public:
-  LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
+  // Constructor: with ssaMode the IR is emitted directly in SSA form,
+  // keeping in memory (alloca) only the local arrays; with runtimeIO
+  // the I/O is done by the functions of runtime/aslrt.c; with a
+  // profile the IR has its counts (!prof)
+  LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+              bool ssaMode = false, bool runtimeIO = false,
+              const TCodeProfile * profile = nullptr);
+  // The IR of the whole program: the instructions of each function are
+  // built as records of LLVMIR.h and written as soon as it is complete
   std::string dumpLLVM();
 };
@@ -0,0 +1,307 @@
+/////////////////////////////////////////////////////////////////
+//
+//    LLVMIR - In-memory model of the LLVM IR generated for the Asl
+//             programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "LLVMIR.h"
+
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+static const char * const INDENT_INSTR = "    ";
+static const char * const INDENT_LABEL = "  ";
+
+
+////////////////////////////////////////////////////////////////
+// LLVMType class
+
+LLVMType::LLVMType(TypeKind kind, unsigned int bits, const LLVMType *element,
+                   std::size_t size, const std::string & text) :
+  Kind{kind}, Bits{bits}, Element{element}, Size{size}, Text{text},
+  PointerTo{nullptr} {
+}
+
+LLVMType::TypeKind LLVMType::getKind() const {
+  return Kind;
+}
+
+unsigned int LLVMType::getBits() const {
+  assert(Kind == INTEGER);
+  return Bits;
+}
+
+const LLVMType * LLVMType::getElement() const {
+  assert(Kind == POINTER or Kind == ARRAY);
+  return Element;
+}
+
+std::size_t LLVMType::getSize() const {
+  assert(Kind == ARRAY);
+  return Size;
+}
+
+const std::string & LLVMType::str() const {
+  return Text;
+}
+
+bool LLVMType::isInteger() const {
+  return Kind == INTEGER;
+}
+
+bool LLVMType::isPointer() const {
+  return Kind == POINTER;
+}
+
+bool LLVMType::isArray() const {
+  return Kind == ARRAY;
+}
+
+
+////////////////////////////////////////////////////////////////
+// LLVMTypeContext class
+
+LLVMTypeContext::LLVMTypeContext() {
+  VoidTy    = newType(LLVMType::VOID,     0, nullptr, 0, "void");
+  LabelTy   = newType(LLVMType::LABEL,    0, nullptr, 0, "label");
+  FloatTy   = newType(LLVMType::FLOAT,    0, nullptr, 0, "float");
+  DoubleTy  = newType(LLVMType::DOUBLE,   0, nullptr, 0, "double");
+  TyErr     = newType(LLVMType::TYERR,    0, nullptr, 0, "tErr");
+  TyMiss    = newType(LLVMType::TYMISS,   0, nullptr, 0, "tMiss");
+  IntBoolTy = newType(LLVMType::INT_BOOL, 0, nullptr, 0, "tIntBool");
+}
+
+const LLVMType * LLVMTypeContext::getVoidTy() const {
+  return VoidTy;
+}
+
+const LLVMType * LLVMTypeContext::getLabelTy() const {
+  return LabelTy;
+}
+
+const LLVMType * LLVMTypeContext::getIntTy(unsigned int bits) {
+  auto it = IntTypes.find(bits);
+  if (it != IntTypes.end()) return it->second;
+  const LLVMType *type = newType(LLVMType::INTEGER, bits, nullptr, 0, "i" + std::to_string(bits));
+  IntTypes[bits] = type;
+  return type;
+}
+
+const LLVMType * LLVMTypeContext::getFloatTy() const {
+  return FloatTy;
+}
+
+const LLVMType * LLVMTypeContext::getDoubleTy() const {
+  return DoubleTy;
+}
+
+const LLVMType * LLVMTypeContext::getPointerTo(const LLVMType *type) {
+  if (type->PointerTo == nullptr)
+    type->PointerTo = newType(LLVMType::POINTER, 0, type, 0, type->Text + "*");
+  return type->PointerTo;
+}
+
+const LLVMType * LLVMTypeContext::getArrayOf(const LLVMType *element, std::size_t size) {
+  auto key = std::make_pair(element, size);
+  auto it = ArrayTypes.find(key);
+  if (it != ArrayTypes.end()) return it->second;
+  const LLVMType *type = newType(LLVMType::ARRAY, 0, element, size,
+                                 "[" + std::to_string(size) + " x " + element->Text + "]");
+  ArrayTypes[key] = type;
+  return type;
+}
+
+const LLVMType * LLVMTypeContext::getTyErr() const {
+  return TyErr;
+}
+
+const LLVMType * LLVMTypeContext::getTyMiss() const {
+  return TyMiss;
+}
+
+const LLVMType * LLVMTypeContext::getIntBoolTy() const {
+  return IntBoolTy;
+}
+
+const LLVMType * LLVMTypeContext::newType(LLVMType::TypeKind kind, unsigned int bits,
+                                          const LLVMType *element, std::size_t size,
+                                          const std::string & text) {
+  Types.push_back(LLVMType(kind, bits, element, size, text));
+  return &Types.back();
+}
+
+
+////////////////////////////////////////////////////////////////
+// LLVMValue class
+
+LLVMValue::LLVMValue() :
+  Name{}, Type{nullptr} {
+}
+
+LLVMValue::LLVMValue(const std::string & name, const LLVMType *type) :
+  Name{name}, Type{type} {
+}
+
+const std::string & LLVMValue::getName() const {
+  return Name;
+}
+
+const LLVMType * LLVMValue::getType() const {
+  return Type;
+}
+
+bool LLVMValue::isNull() const {
+  return Name.empty();
+}
+
+
+////////////////////////////////////////////////////////////////
+// LLVMInstr class
+
+LLVMInstr::LLVMInstr(Opcode op, const std::string & name) :
+  op{op}, name{name}, result{}, type{nullptr}, varArg{false}, fastCC{false} {
+}
+
+void LLVMInstr::print(std::ostream & os) const {
+  switch (op) {
+  case LABEL:
+    os << INDENT_LABEL << name << ":\n";
+    return;
+  case COMMENT:
+    os << ";   " << name << "\n";
+    return;
+  default:
+    break;
+  }
+  os << INDENT_INSTR;
+  if (not result.isNull())
+    os << result.getName() << " = ";
+  switch (op) {
+  case ALLOCA:
+    os << "alloca " << type->str();
+    break;
+  case LOAD:
+    {
+      const LLVMType *typePtr = operands[0].getType();
+      os << "load " << typePtr->getElement()->str() << ", " << typePtr->str()
+         << " " << operands[0].getName();
+      break;
+    }
+  case STORE:
+    {
+      const LLVMType *typePtr = operands[1].getType();
+      os << "store " << typePtr->getElement()->str() << " " << operands[0].getName()
+         << ", " << typePtr->str() << " " << operands[1].getName();
+      break;
+    }
+  case BINARY:
+    os << name << " " << type->str() << " " << operands[0].getName()
+       << ", " << operands[1].getName();
+    break;
+  case UNARY:
+    os << name << " " << type->str() << " " << operands[0].getName();
+    break;
+  case CAST:
+    os << name << " " << type->str() << " " << operands[0].getName()
+       << " to " << result.getType()->str();
+    break;
+  case GEP:
+    {
+      // %arrayidx = getelementptr inbounds [10 x i32], [10 x i32]* %A, i64 0, i64 %idxprom
+      // %arrayidx = getelementptr inbounds i32, i32* %1, i64 %idxprom
+      const LLVMType *typePtr = operands[0].getType();
+      os << "getelementptr inbounds " << typePtr->getElement()->str() << ", "
+         << typePtr->str() << " " << operands[0].getName()
+         << (typePtr->getElement()->isArray() ? ", i64 0, i64 " : ", i64 ")
+         << operands[1].getName();
+      break;
+    }
+  case CALL:
+    os << "call " << (fastCC ? "fastcc " : "") << type->str() << " "
+       << (varArg ? "(i8*, ...) " : "")
+       << "@" << name << "(";
+    for (std::size_t i = 0; i < operands.size(); ++i)
+      os << (i == 0 ? "" : ", ") << operands[i].getType()->str() << " " << operands[i].getName();
+    os << ")";
+    break;
+  case BR:
+    os << "br label " << labels[0];
+    break;
+  case CONDBR:
+    os << "br i1 " << operands[0].getName() << ", label " << labels[0]
+       << ", label " << labels[1];
+    break;
+  case RET:
+    if (operands.empty())
+      os << "ret void";
+    else
+      os << "ret " << type->str() << " " << operands[0].getName();
+    break;
+  case PHI:
+    os << "phi " << type->str();
+    for (std::size_t i = 0; i < operands.size(); ++i)
+      os << (i == 0 ? " [ " : ", [ ") << operands[i].getName() << ", " << labels[i] << " ]";
+    break;
+  case UNREACHABLE:
+    os << "unreachable";
+    break;
+  default:
+    break;
+  }
+  if (not metadata.empty())
+    os << ", " << metadata;
+  os << "\n";
+}
+
+
+////////////////////////////////////////////////////////////////
+// LLVMFunction class
+
+LLVMFunction::LLVMFunction() :
+  name{}, linkage{"dso_local"}, fastCC{false}, retType{nullptr} {
+}
+
+void LLVMFunction::print(std::ostream & os) const {
+  os << "define " << linkage << " " << (fastCC ? "fastcc " : "")
+     << retType->str() << " @" << name << "(";
+  for (std::size_t i = 0; i < params.size(); ++i) {
+    os << (i == 0 ? "" : ", ") << params[i].getType()->str() << " ";
+    if (i < paramAttrs.size() and not paramAttrs[i].empty())
+      os << paramAttrs[i] << " ";
+    os << params[i].getName();
+  }
+  os << ")";
+  if (not attrs.empty())
+    os << " " << attrs;
+  os << " {\n";
+  for (auto & instr : body)
+    instr.print(os);
+  os << "}\n\n";
+}
@@ -0,0 +1,225 @@
+/////////////////////////////////////////////////////////////////
+//
+//    LLVMIR - In-memory model of the LLVM IR generated for the Asl
+//             programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <ostream>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMType: a type of the LLVM IR. The types are created only
+// by an LLVMTypeContext, and only once: two types of the same context
+// are equal if and only if their addresses are equal.
+
+class LLVMType {
+
+public:
+
+  enum TypeKind { VOID, LABEL, INTEGER, FLOAT, DOUBLE, POINTER, ARRAY,
+                  // pseudo-types of the type inference of LLVMCodeGen
+                  TYERR, TYMISS, INT_BOOL };
+
+  TypeKind           getKind    () const;
+  // Bits of an INTEGER
+  unsigned int       getBits    () const;
+  // Pointed type of a POINTER, or type of the elements of an ARRAY
+  const LLVMType *   getElement () const;
+  // Number of elements of an ARRAY
+  std::size_t        getSize    () const;
+  // The type as written in the IR ("i32", "[10 x float]", "i8*")
+  const std::string & str       () const;
+
+  bool isInteger () const;
+  bool isPointer () const;
+  bool isArray   () const;
+
+private:
+
+  friend class LLVMTypeContext;
+
+  LLVMType (TypeKind kind, unsigned int bits, const LLVMType *element,
+            std::size_t size, const std::string & text);
+
+  // Attributes
+  TypeKind          Kind;
+  unsigned int      Bits;
+  const LLVMType   *Element;
+  std::size_t       Size;
+  std::string       Text;
+  // the pointer to this type, once created by the context
+  mutable const LLVMType *PointerTo;
+
+};  // class LLVMType
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMTypeContext: creates and owns the types. The types live
+// as long as the context.
+
+class LLVMTypeContext {
+
+public:
+
+  LLVMTypeContext ();
+  LLVMTypeContext (const LLVMTypeContext &) = delete;
+  LLVMTypeContext & operator= (const LLVMTypeContext &) = delete;
+
+  const LLVMType * getVoidTy    () const;
+  const LLVMType * getLabelTy   () const;
+  const LLVMType * getIntTy     (unsigned int bits);
+  const LLVMType * getFloatTy   () const;
+  const LLVMType * getDoubleTy  () const;
+  const LLVMType * getPointerTo (const LLVMType *type);
+  const LLVMType * getArrayOf   (const LLVMType *element, std::size_t size);
+  const LLVMType * getTyErr     () const;
+  const LLVMType * getTyMiss    () const;
+  const LLVMType * getIntBoolTy () const;
+
+private:
+
+  // a deque does not move its elements when it grows
+  std::deque<LLVMType> Types;
+  const LLVMType *VoidTy, *LabelTy, *FloatTy, *DoubleTy;
+  const LLVMType *TyErr, *TyMiss, *IntBoolTy;
+  std::map<unsigned int, const LLVMType *> IntTypes;
+  std::map<std::pair<const LLVMType *, std::size_t>, const LLVMType *> ArrayTypes;
+
+  const LLVMType * newType (LLVMType::TypeKind kind, unsigned int bits,
+                            const LLVMType *element, std::size_t size,
+                            const std::string & text);
+
+};  // class LLVMTypeContext
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMValue: a handle of a value of the IR with its type: a
+// local or global variable, by its name ("%a.1", "@.global.i.addr"),
+// or a constant as written in the IR ("0", "null"). The type of a
+// constant may be null when the instruction gives it.
+
+class LLVMValue {
+
+public:
+
+  LLVMValue ();
+  LLVMValue (const std::string & name, const LLVMType *type = nullptr);
+
+  const std::string & getName () const;
+  const LLVMType *    getType () const;
+  // Is it the empty handle (no value)?
+  bool                isNull  () const;
+
+private:
+
+  std::string      Name;
+  const LLVMType  *Type;
+
+};  // class LLVMValue
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMInstr: a record of an instruction of the IR, or of a label
+// or a comment of the text. The meaning of the fields depends on op:
+//   LABEL        name: the label
+//   COMMENT      name: the text
+//   ALLOCA       result = alloca type
+//   LOAD         result = load operands[0]         (operands[0] is the address)
+//   STORE        store operands[0], operands[1]    (operands[1] is the address)
+//   BINARY       result = name type operands[0], operands[1]   ("add", "icmp slt", ...)
+//   UNARY        result = name type operands[0]                ("fneg")
+//   CAST         result = name type operands[0] to (type of result)   ("sext", ...)
+//   GEP          result = getelementptr inbounds operands[0] (the base), operands[1]
+//   CALL         [result =] call [fastcc] type [(i8*, ...)] @name(operands)
+//                                                          (fastCC, varArg)
+//   BR           br label labels[0]
+//   CONDBR       br i1 operands[0], label labels[0], label labels[1]
+//   RET          ret type operands[0]   or   ret void
+//   PHI          result = phi type [operands[i], labels[i]] ...
+//   UNREACHABLE  unreachable
+// The labels of the operands include the '%'. The metadata attachment,
+// if any, is written at the end ("!prof !3").
+
+class LLVMInstr {
+
+public:
+
+  enum Opcode { LABEL, COMMENT, ALLOCA, LOAD, STORE, BINARY, UNARY, CAST, GEP,
+                CALL, BR, CONDBR, RET, PHI, UNREACHABLE };
+
+  LLVMInstr (Opcode op, const std::string & name = "");
+
+  // Write the instruction as a line of the IR
+  void print (std::ostream & os) const;
+
+  Opcode                    op;
+  std::string               name;
+  LLVMValue                 result;
+  const LLVMType           *type;
+  std::vector<LLVMValue>    operands;
+  std::vector<std::string>  labels;
+  bool                      varArg;
+  // the call uses the fast calling convention
+  bool                      fastCC;
+  std::string               metadata;
+
+};  // class LLVMInstr
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMFunction: the definition of a function, with its body as
+// a list of instruction records:
+//   define linkage [fastcc] retType @name(params[i] paramAttrs[i], ...) attrs
+// (the attributes are written as they are, space separated)
+
+class LLVMFunction {
+
+public:
+
+  LLVMFunction ();
+
+  // Write the definition of the function
+  void print (std::ostream & os) const;
+
+  std::string               name;
+  std::string               linkage;
+  bool                      fastCC;
+  const LLVMType           *retType;
+  std::vector<LLVMValue>    params;
+  std::vector<std::string>  paramAttrs;
+  std::string               attrs;
+  std::vector<LLVMInstr>    body;
+
+};  // class LLVMFunction
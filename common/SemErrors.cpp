@@ -28,7 +28,7 @@
 
 #include "SemErrors.h"
 
-#include "antlr4-runtime.h"
+#include "AslAst.h"
 
 #include <iostream>
 #include <string>
@@ -52,97 +52,101 @@ std::size_t SemErrors::getNumberOfSemanticErrors() const {
   return ErrorList.size();
 }
 
-void SemErrors::declaredIdent(antlr4::tree::TerminalNode *node) {
-  ErrorInfo error(node->getSymbol()->getLine(), node->getSymbol()->getCharPositionInLine(), "Identifier '" + node->getSymbol()->getText() + "' already declared.");
+void SemErrors::merge(const SemErrors & other) {
+  ErrorList.insert(ErrorList.end(), other.ErrorList.begin(), other.ErrorList.end());
+}
+
+void SemErrors::declaredIdent(AstPos pos, const std::string & name) {
+  ErrorInfo error(pos.line, pos.col, "Identifier '" + name + "' already declared.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::undeclaredIdent(antlr4::tree::TerminalNode *node) {
-  ErrorInfo error(node->getSymbol()->getLine(), node->getSymbol()->getCharPositionInLine(), "Identifier '" + node->getSymbol()->getText() + "' is undeclared.");
+void SemErrors::undeclaredIdent(AstPos pos, const std::string & name) {
+  ErrorInfo error(pos.line, pos.col, "Identifier '" + name + "' is undeclared.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::incompatibleAssignment(antlr4::tree::TerminalNode *node) {
-  ErrorInfo error(node->getSymbol()->getLine(), node->getSymbol()->getCharPositionInLine(), "Assignment with incompatible types.");
+void SemErrors::incompatibleAssignment(AstPos pos) {
+  ErrorInfo error(pos.line, pos.col, "Assignment with incompatible types.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::nonReferenceableLeftExpr(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Left expression of assignment is not referenceable.");
+void SemErrors::nonReferenceableLeftExpr(const AstExpr *expr) {
+  ErrorInfo error(expr->pos.line, expr->pos.col, "Left expression of assignment is not referenceable.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::incompatibleOperator(antlr4::Token* tok) {
-  ErrorInfo error(tok->getLine(), tok->getCharPositionInLine(), "Operator '" + tok->getText() + "' with incompatible types.");
+void SemErrors::incompatibleOperator(AstPos pos, AstExpr::Operator op) {
+  ErrorInfo error(pos.line, pos.col, std::string("Operator '") + AstExpr::getOperatorText(op) + "' with incompatible types.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::nonArrayInArrayAccess(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Array access to a non array operand.");
+void SemErrors::nonArrayInArrayAccess(const AstExpr *expr) {
+  ErrorInfo error(expr->pos.line, expr->pos.col, "Array access to a non array operand.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::nonIntegerIndexInArrayAccess(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Array access with non integer index.");
+void SemErrors::nonIntegerIndexInArrayAccess(const AstExpr *expr) {
+  ErrorInfo error(expr->pos.line, expr->pos.col, "Array access with non integer index.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::booleanRequired(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Instruction '" + ctx->getStart()->getText() + "' requires a boolean condition.");
+void SemErrors::booleanRequired(const AstStmt *stmt) {
+  ErrorInfo error(stmt->pos.line, stmt->pos.col, std::string("Instruction '") + AstStmt::getKeyword(stmt->kind) + "' requires a boolean condition.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::isNotCallable(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Identifier '" + ctx->getStart()->getText() + "' is not a callable function.");
+void SemErrors::isNotCallable(const AstIdentExpr *ident, const std::string & name) {
+  ErrorInfo error(ident->pos.line, ident->pos.col, "Identifier '" + name + "' is not a callable function.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::isNotProcedure(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Identifier '" + ctx->getStart()->getText() + "' is not a procedure.");
+void SemErrors::isNotProcedure(const AstIdentExpr *ident, const std::string & name) {
+  ErrorInfo error(ident->pos.line, ident->pos.col, "Identifier '" + name + "' is not a procedure.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::isNotFunction(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Identifier '" + ctx->getStart()->getText() + "' is a void returning function.");
+void SemErrors::isNotFunction(const AstIdentExpr *ident, const std::string & name) {
+  ErrorInfo error(ident->pos.line, ident->pos.col, "Identifier '" + name + "' is a void returning function.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::numberOfParameters(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "The number of parameters in the call to '" + ctx->getStart()->getText() + "' does not match.");
+void SemErrors::numberOfParameters(const AstIdentExpr *ident, const std::string & name) {
+  ErrorInfo error(ident->pos.line, ident->pos.col, "The number of parameters in the call to '" + name + "' does not match.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::incompatibleParameter(antlr4::ParserRuleContext *pCtx,
+void SemErrors::incompatibleParameter(const AstExpr *param,
 				      unsigned int n,
-				      antlr4::ParserRuleContext *cCtx) {
-  ErrorInfo error(pCtx->getStart()->getLine(), pCtx->getStart()->getCharPositionInLine(), "Parameter #" + std::to_string(n) + " with incompatible types in call to '" + cCtx->getStart()->getText() + "'.");
+				      const std::string & name) {
+  ErrorInfo error(param->pos.line, param->pos.col, "Parameter #" + std::to_string(n) + " with incompatible types in call to '" + name + "'.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::referenceableParameter(antlr4::ParserRuleContext *pCtx,
+void SemErrors::referenceableParameter(const AstExpr *param,
 				       unsigned int n,
-				       antlr4::ParserRuleContext *cCtx) {
-  ErrorInfo error(pCtx->getStart()->getLine(), pCtx->getStart()->getCharPositionInLine(), "Parameter #" + std::to_string(n) + " is expected to be referenceable in call to '" + cCtx->getStart()->getText() + "'.");
+				       const std::string & name) {
+  ErrorInfo error(param->pos.line, param->pos.col, "Parameter #" + std::to_string(n) + " is expected to be referenceable in call to '" + name + "'.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::incompatibleReturn(antlr4::tree::TerminalNode *node) {
-  ErrorInfo error(node->getSymbol()->getLine(), node->getSymbol()->getCharPositionInLine(), "Return with incompatible type.");
+void SemErrors::incompatibleReturn(AstPos pos) {
+  ErrorInfo error(pos.line, pos.col, "Return with incompatible type.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::readWriteRequireBasic(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Basic type required in '" + ctx->getStart()->getText() + "'.");
+void SemErrors::readWriteRequireBasic(const AstStmt *stmt) {
+  ErrorInfo error(stmt->pos.line, stmt->pos.col, std::string("Basic type required in '") + AstStmt::getKeyword(stmt->kind) + "'.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::nonReferenceableExpression(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine(), "Referenceable expression required in '" + ctx->getStart()->getText() + "'.");
+void SemErrors::nonReferenceableExpression(const AstStmt *stmt) {
+  ErrorInfo error(stmt->pos.line, stmt->pos.col, std::string("Referenceable expression required in '") + AstStmt::getKeyword(stmt->kind) + "'.");
   ErrorList.push_back(error);
 }
 
-void SemErrors::noMainProperlyDeclared(antlr4::ParserRuleContext *ctx) {
-  ErrorInfo error(ctx->getStop()->getLine(), ctx->getStop()->getCharPositionInLine(), "There is no 'main' function properly declared.");
+void SemErrors::noMainProperlyDeclared(AstPos pos) {
+  ErrorInfo error(pos.line, pos.col, "There is no 'main' function properly declared.");
   ErrorList.push_back(error);
 }
 
@@ -28,7 +28,7 @@
 
 #pragma once
 
-#include "antlr4-runtime.h"
+#include "AslAst.h"
 
 #include <string>
 #include <vector>
@@ -39,6 +39,7 @@
 ////////////////////////////////////////////////////////////////
 // Class SemErrors: this class contains methods that emit
 // semantic error messages with their localization.
+// The positions are the ones kept in the AST nodes.
 // It is used by the semantic visitors:
 //   - SymbolsVisitor
 //   - TypeCheckVisitor
@@ -58,52 +59,56 @@ public:
   // Accessor to get the number of semantic errors
   std::size_t getNumberOfSemanticErrors () const;
 
+  // Add the errors of other (for example, the ones found by another
+  // thread); print sorts them all by line number
+  void merge (const SemErrors & other);
+
   // Methods that store the error messages
-  //   node is the terminal node correspondig to the token IDENT in a declaration
-  void declaredIdent                (antlr4::tree::TerminalNode *node);
-  //   node is the terminal node correspondig to the token IDENT in an expression
-  void undeclaredIdent              (antlr4::tree::TerminalNode *node);
-  //   node is the terminal node correspondig to the token ASSIG
-  void incompatibleAssignment       (antlr4::tree::TerminalNode *node);
-  //   ctx is the node corresponding to the left expression
-  void nonReferenceableLeftExpr     (antlr4::ParserRuleContext *ctx);
-  //   node is the labeled operator token (referenced by op in the grammar)
-  void incompatibleOperator         (antlr4::Token *node);
-  //   ctx is the node corresponding to an array access
-  void nonArrayInArrayAccess        (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the index expression in an array access
-  void nonIntegerIndexInArrayAccess (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the expression
-  void booleanRequired              (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the function identifier 
-  void isNotCallable                (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the function identifier
+  //   pos is the position of the token IDENT in a declaration
+  void declaredIdent                (AstPos pos, const std::string & name);
+  //   pos is the position of the token IDENT in an expression
+  void undeclaredIdent              (AstPos pos, const std::string & name);
+  //   pos is the position of the token ASSIGN
+  void incompatibleAssignment       (AstPos pos);
+  //   expr is the left expression
+  void nonReferenceableLeftExpr     (const AstExpr *expr);
+  //   pos is the position of the operator
+  void incompatibleOperator         (AstPos pos, AstExpr::Operator op);
+  //   expr is the array access
+  void nonArrayInArrayAccess        (const AstExpr *expr);
+  //   expr is the index expression in an array access
+  void nonIntegerIndexInArrayAccess (const AstExpr *expr);
+  //   stmt is the instruction with the condition
+  void booleanRequired              (const AstStmt *stmt);
+  //   ident is the function identifier
+  void isNotCallable                (const AstIdentExpr *ident, const std::string & name);
+  //   ident is the function identifier
   //   This error will not be emitted (productive functions can be called as procedures)
-  void isNotProcedure               (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the identifier
-  void isNotFunction                (antlr4::ParserRuleContext *ctx);
-  //   ctx is the node corresponding to the function identifier
-  void numberOfParameters           (antlr4::ParserRuleContext *ctx);
-  //   pCtx is actual parameter node
+  void isNotProcedure               (const AstIdentExpr *ident, const std::string & name);
+  //   ident is the identifier
+  void isNotFunction                (const AstIdentExpr *ident, const std::string & name);
+  //   ident is the function identifier of the call
+  void numberOfParameters           (const AstIdentExpr *ident, const std::string & name);
+  //   param is actual parameter
   //   n is the number of argument starting from 1
-  //   cCtc is the call node
-  void incompatibleParameter        (antlr4::ParserRuleContext *pCtx,
+  //   name is the name of the called function
+  void incompatibleParameter        (const AstExpr *param,
 				     unsigned int n,
-				     antlr4::ParserRuleContext *cCtx);
-  //   pCtx is actual parameter node
+				     const std::string & name);
+  //   param is actual parameter
   //   n is the number of argument starting from 1
-  //   cCtc is the call node
-  void referenceableParameter       (antlr4::ParserRuleContext *pCtx,
+  //   name is the name of the called function
+  void referenceableParameter       (const AstExpr *param,
 				     unsigned int n,
-				     antlr4::ParserRuleContext *cCtx);
-  //   node is the terminal node correspondig to the token RETURN
-  void incompatibleReturn           (antlr4::tree::TerminalNode *node);
-  //   ctx is the read or write instruction
-  void readWriteRequireBasic        (antlr4::ParserRuleContext *ctx);
-  //   ctx is the instruction that needs a referenceable expression
-  void nonReferenceableExpression   (antlr4::ParserRuleContext *ctx);
-  //   ctx is the program node (grammar start symbol) 
-  void noMainProperlyDeclared       (antlr4::ParserRuleContext *ctx);
+				     const std::string & name);
+  //   pos is the position of the token RETURN
+  void incompatibleReturn           (AstPos pos);
+  //   stmt is the read or write instruction
+  void readWriteRequireBasic        (const AstStmt *stmt);
+  //   stmt is the instruction that needs a referenceable expression
+  void nonReferenceableExpression   (const AstStmt *stmt);
+  //   pos is the end of the program
+  void noMainProperlyDeclared       (AstPos pos);
 
 
 private:
@@ -28,9 +28,11 @@
 
 
 #include "TypesMgr.h"
+#include "IdentTable.h"
 #include "SymTable.h"
 
 #include <string>
+#include <vector>
 #include <iostream>
 
 #include <cstddef>    // std::size_t
@@ -44,16 +46,40 @@
 // Name of the Global Scope
 const std::string SymTable::GLOBAL_SCOPE_NAME = "$global$";
 
+// ScopeId returned when a scope is not found
+const SymTable::ScopeId SymTable::NO_SCOPE;
+
 // Constructor
 SymTable::SymTable(TypesMgr & Types) :
   Types{Types} {
 }
 
+// Methods to work with the interned identifiers
+SymTable::IdentId SymTable::internIdent(const std::string & ident) {
+  return Idents.intern(ident);
+}
+
+SymTable::IdentId SymTable::findIdent(const std::string & ident) const {
+  return Idents.find(ident);
+}
+
+const std::string & SymTable::getIdentName(IdentId id) const {
+  return Idents.getName(id);
+}
+
 // Creates a new scope, push its ScopeId in the stack
 // and returns this ScopeId.
 SymTable::ScopeId SymTable::pushNewScope(const std::string & name) {
   ScopeId currScope = ScopesVec.size();
   ScopesVec.push_back(ScopeInfo(name));
+  // index the function scopes by name (the first one wins)
+  if (name != GLOBAL_SCOPE_NAME) {
+    IdentId id = Idents.intern(name);
+    if (id >= FunctionScopes.size())
+      FunctionScopes.resize(id + 1, NO_SCOPE);
+    if (FunctionScopes[id] == NO_SCOPE)
+      FunctionScopes[id] = currScope;
+  }
   ScopeIdsStack.push_back(currScope);
   return currScope;
 }
@@ -81,7 +107,8 @@ bool SymTable::findInCurrentScope(const std::string & ident) const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  return (ScopesVec[currScope].findSymbol(ident));
+  IdentId id = Idents.find(ident);
+  return (id != IdentTable::NO_IDENT and ScopesVec[currScope].findSymbol(id));
 }
 
 // Returns an integer >= 0 if ident occurs in some of the scopes
@@ -89,12 +116,18 @@ bool SymTable::findInCurrentScope(const std::string & ident) const {
 // If it occurs in the scope below the top returns 1, and so on.
 // Returns -1 if te symbol is not found.
 int SymTable::findInStack(const std::string & ident) const {
+  return findInStack(Idents.find(ident));
+}
+
+int SymTable::findInStack(IdentId id) const {
   assert(not ScopeIdsStack.empty());
+  if (id == IdentTable::NO_IDENT)
+    return -1;
   int d = 0;
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
+    if (ScopesVec[sc].findSymbol(id))
       return d;
     ++d;
   }
@@ -106,64 +139,64 @@ void SymTable::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addLocalVar(ident, type);
+  ScopesVec[currScope].addLocalVar(Idents.intern(ident), type);
 }
 void SymTable::addParameter(const std::string & ident, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addParameter(ident, type);
+  ScopesVec[currScope].addParameter(Idents.intern(ident), type);
 }
 
 void SymTable::addFunction(const std::string & ident, TypesMgr::TypeId type) {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].addFunction(ident, type);
+  ScopesVec[currScope].addFunction(Idents.intern(ident), type);
 }
 
 // Check the class of a symbol. If not found return false
 bool SymTable::isLocalVarClass(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isLocalVarClass(ident);
-  }
-  return false;
+  return getSymbolClass(Idents.find(ident)) == LocalVarId;
 }
 
 bool SymTable::isParameterClass(const std::string & ident) const {
-  assert(not ScopeIdsStack.empty());
-  for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
-    ScopeId sc = ScopeIdsStack[i];
-    assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isParameterClass(ident);
-  }
-  return false;
+  return getSymbolClass(Idents.find(ident)) == ParameterId;
 }
 
 bool SymTable::isFunctionClass(const std::string & ident) const {
+  return getSymbolClass(Idents.find(ident)) == FunctionId;
+}
+
+// Get the class of a symbol. If not found return ErrorClassId
+SymTable::SymClassId SymTable::getSymbolClass(IdentId id) const {
   assert(not ScopeIdsStack.empty());
+  if (id == IdentTable::NO_IDENT)
+    return ErrorClassId;
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].isFunctionClass(ident);
+    SymClassId c = ScopesVec[sc].getSymbolClass(id);
+    if (c != ErrorClassId)
+      return c;
   }
-  return false;
+  return ErrorClassId;
 }
 
 // Get the TypeId of a symbol. If not found return type 'error'
 TypesMgr::TypeId SymTable::getType(const std::string & ident) const {
+  return getType(Idents.find(ident));
+}
+
+TypesMgr::TypeId SymTable::getType(IdentId id) const {
   assert(not ScopeIdsStack.empty());
+  if (id == IdentTable::NO_IDENT)
+    return Types.createErrorTy();
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    if (ScopesVec[sc].findSymbol(ident))
-      return ScopesVec[sc].getType(ident);
+    if (ScopesVec[sc].findSymbol(id))
+      return ScopesVec[sc].getType(id);
   }
   return Types.createErrorTy();
 }
@@ -172,10 +205,11 @@ bool SymTable::noMainProperlyDeclared() const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  if ((not ScopesVec[currScope].findSymbol("main")) or
-      (not ScopesVec[currScope].isFunctionClass("main")))
+  IdentId mainId = Idents.find("main");
+  if (mainId == IdentTable::NO_IDENT or
+      ScopesVec[currScope].getSymbolClass(mainId) != FunctionId)
     return true;
-  TypesMgr::TypeId tid = ScopesVec[currScope].getType("main");
+  TypesMgr::TypeId tid = ScopesVec[currScope].getType(mainId);
   if (Types.isFunctionTy(tid) and
       (Types.getNumOfParameters(tid) == 0) and
       Types.isVoidFunction(tid))
@@ -186,20 +220,38 @@ bool SymTable::noMainProperlyDeclared() const {
 // Given the name of a function, returns its TypeId
 TypesMgr::TypeId SymTable::getGlobalFunctionType(const std::string & ident) const {
   assert(not ScopesVec.empty());
-  TypesMgr::TypeId tid = ScopesVec[0].getType(ident);
+  TypesMgr::TypeId tid = ScopesVec[0].getType(Idents.find(ident));
   return tid;
 }
 
 // Given the names of a function and a local symbol, returns its TypeId
 TypesMgr::TypeId SymTable::getLocalSymbolType(const std::string & funcName,
                                               const std::string & ident) const {
-  for (std::size_t i = 1; i < ScopesVec.size(); ++i) {
-    if (ScopesVec[i].getName() == funcName) {
-      TypesMgr::TypeId tid = ScopesVec[i].getType(ident);
-      return tid;
-    }
-  }
-  return Types.createErrorTy();
+  ScopeId sc = getFunctionScope(funcName);
+  if (sc == NO_SCOPE)
+    return Types.createErrorTy();
+  TypesMgr::TypeId tid = ScopesVec[sc].getType(Idents.find(ident));
+  return tid;
+}
+
+// Given the name of a function, returns its scope (or NO_SCOPE)
+SymTable::ScopeId SymTable::getFunctionScope(const std::string & funcName) const {
+  IdentId id = Idents.find(funcName);
+  if (id == IdentTable::NO_IDENT or id >= FunctionScopes.size())
+    return NO_SCOPE;
+  return FunctionScopes[id];
+}
+
+// Returns the symbols of a scope in declaration order
+std::vector<SymTable::SymbolEntry> SymTable::getScopeSymbols(ScopeId sc) const {
+  assert(sc < ScopesVec.size());
+  std::vector<SymbolEntry> symbols;
+  ScopesVec[sc].getSymbols(symbols);
+  return symbols;
+}
+
+std::size_t SymTable::getNumberOfScopes() const {
+  return ScopesVec.size();
 }
 
 // Writes the contents of the current scope (top of the stack)
@@ -208,7 +260,7 @@ void SymTable::printCurrentScope() const {
   assert(not ScopeIdsStack.empty());
   ScopeId currScope = ScopeIdsStack.back();
   assert(currScope < ScopesVec.size());
-  ScopesVec[currScope].print(Types);
+  ScopesVec[currScope].print(Types, Idents);
 }
 
 // Write the contents of the symbol table on the standard output
@@ -217,7 +269,7 @@ void SymTable::print() const {
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
     assert(sc < ScopesVec.size());
-    ScopesVec[sc].print(Types);
+    ScopesVec[sc].print(Types, Idents);
   }
   std::cout << "----------------" << std::endl;
 }
@@ -227,70 +279,88 @@ void SymTable::print() const {
 
 // Constructor
 SymTable::ScopeInfo::ScopeInfo(const std::string & name)
-  : name{name} { }
+  : name{name}, Slots(8, 0) { }
 
-// Accessors to work with the attributes: name, SymbolsMap, IdentsList
+// Accessors to work with the attributes: name, IdentsList, SymbolsList
 std::string SymTable::ScopeInfo::getName() const {
   return name;
 }
 
 // Mutators to add symbols to the scope
-void SymTable::ScopeInfo::addLocalVar(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createLocalVar(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addLocalVar(IdentId ident, TypesMgr::TypeId type) {
+  addSymbol(ident, SymbolInfo::createLocalVar(type));
 }
-void SymTable::ScopeInfo::addParameter(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createParameter(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addParameter(IdentId ident, TypesMgr::TypeId type) {
+  addSymbol(ident, SymbolInfo::createParameter(type));
 }
-void SymTable::ScopeInfo::addFunction(const std::string & ident, TypesMgr::TypeId type) {
-  assert(SymbolsMap.find(ident) == SymbolsMap.end());
-  SymbolsMap[ident] = SymbolInfo::createFunction(type);
-  IdentsList.push_back(ident);
+void SymTable::ScopeInfo::addFunction(IdentId ident, TypesMgr::TypeId type) {
+  addSymbol(ident, SymbolInfo::createFunction(type));
 }
 
-// Accessor to check the existence of a symbol
-bool SymTable::ScopeInfo::findSymbol(const std::string & ident) const {
-  return (SymbolsMap.find(ident) != SymbolsMap.end());
+void SymTable::ScopeInfo::addSymbol(IdentId ident, const SymbolInfo & info) {
+  std::size_t slot = findSlot(ident);
+  assert(Slots[slot] == 0);
+  IdentsList.push_back(ident);
+  SymbolsList.push_back(info);
+  Slots[slot] = IdentsList.size();
+  // keep the load factor under 1/2
+  if (2 * IdentsList.size() > Slots.size()) {
+    std::vector<std::size_t> oldSlots(2 * Slots.size(), 0);
+    Slots.swap(oldSlots);
+    for (std::size_t pos = 0; pos < IdentsList.size(); ++pos)
+      Slots[findSlot(IdentsList[pos])] = pos + 1;
+  }
 }
 
-// Accessors to check the class of the symbol. If not found return false
-bool SymTable::ScopeInfo::isLocalVarClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isLocalVarClass();
+// Slot of the hash table where ident is, or the empty slot where it
+// should be inserted (linear probing)
+std::size_t SymTable::ScopeInfo::findSlot(IdentId ident) const {
+  std::size_t mask = Slots.size() - 1;
+  for (std::size_t slot = (ident * 0x9E3779B9u) & mask; ;
+       slot = (slot + 1) & mask) {
+    std::size_t pos = Slots[slot];
+    if (pos == 0 or IdentsList[pos - 1] == ident)
+      return slot;
+  }
 }
-bool SymTable::ScopeInfo::isParameterClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isParameterClass();
+
+// Accessor to check the existence of a symbol
+bool SymTable::ScopeInfo::findSymbol(IdentId ident) const {
+  return Slots[findSlot(ident)] != 0;
 }
-bool SymTable::ScopeInfo::isFunctionClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isFunctionClass();
+
+// Accessor to get the class of the symbol. If not found return ErrorClassId
+SymTable::SymClassId SymTable::ScopeInfo::getSymbolClass(IdentId ident) const {
+  std::size_t pos = Slots[findSlot(ident)];
+  if (pos == 0)
+    return ErrorClassId;
+  return SymbolsList[pos - 1].getClass();
 }
 
 // Accessor to get the TypeId of a symbol. The symbol MUST exist.
-TypesMgr::TypeId SymTable::ScopeInfo::getType(const std::string & ident) const {
-  assert(SymbolsMap.find(ident) != SymbolsMap.end());
-  auto const & it = SymbolsMap.find(ident);
-  return it->second.getType();
+TypesMgr::TypeId SymTable::ScopeInfo::getType(IdentId ident) const {
+  std::size_t pos = Slots[findSlot(ident)];
+  assert(pos != 0);
+  return SymbolsList[pos - 1].getType();
+}
+
+// Appends the symbols of the scope (in declaration order) to symbols
+void SymTable::ScopeInfo::getSymbols(std::vector<SymbolEntry> & symbols) const {
+  symbols.reserve(symbols.size() + IdentsList.size());
+  for (std::size_t pos = 0; pos < IdentsList.size(); ++pos) {
+    const SymbolInfo & info = SymbolsList[pos];
+    symbols.push_back(SymbolEntry{IdentsList[pos], info.getClass(), info.getType()});
+  }
 }
 
 // Writes the contents of the scope to the standard output.
-void SymTable::ScopeInfo::print(TypesMgr & Types) const {
+void SymTable::ScopeInfo::print(TypesMgr & Types, const IdentTable & Idents) const {
   std::cout << "---------------- scope name: " << name << std::endl;
-  for (auto & id : IdentsList) {
-    auto const & it = SymbolsMap.find(id);
-    std::cout << id << ":" << it->second.class2string();
-    if (not it->second.isErrorClass()) {
-      std::cout << "," << Types.to_string(it->second.getType());
+  for (std::size_t pos = 0; pos < IdentsList.size(); ++pos) {
+    const SymbolInfo & info = SymbolsList[pos];
+    std::cout << Idents.getName(IdentsList[pos]) << ":" << info.class2string();
+    if (not info.isErrorClass()) {
+      std::cout << "," << Types.to_string(info.getType());
     }
     std::cout << std::endl;
   }
@@ -309,6 +379,9 @@ SymTable::ScopeInfo::SymbolInfo::SymbolInfo(SymClassId c, TypesMgr::TypeId tid)
 }
 
 // Accessors for working with the attributes: class and type
+SymTable::SymClassId SymTable::ScopeInfo::SymbolInfo::getClass() const {
+  return classId;
+}
 bool SymTable::ScopeInfo::SymbolInfo::isLocalVarClass() const {
   return classId == LocalVarId;
 }
@@ -28,9 +28,9 @@
 #pragma once
 
 #include "TypesMgr.h"
+#include "IdentTable.h"
 
 #include <string>
-#include <map>
 #include <vector>
 
 #include <cstddef>    // std::size_t
@@ -56,6 +56,10 @@
 // scopes that determines which symbols are visible and
 // which are not. Entering in a function will push a new
 // scope to the stack and exiting will pop the stack.
+// Identifiers are interned in an IdentTable, and each scope is an
+// open-addressing hash table keyed by IdentId, so a lookup costs a
+// few integer compares per scope. The methods that take a string
+// find its IdentId first (without interning it).
 
 class SymTable {
 
@@ -64,14 +68,46 @@ public:
   // The ScopeId is an index in a vector
   typedef std::size_t ScopeId;
 
+  // The IdentId of an interned identifier
+  typedef IdentTable::IdentId IdentId;
+
+  // The classes of the symbols
+  enum SymClassId {
+    FirstSymClassId = -2,
+    ErrorClassId    = -1,      // "error" symbol class (symbol not found)
+    // Normal symbol classes:
+    LocalVarId      =  0,      // local variables
+    ParameterId     ,          // parameters
+    FunctionId      ,          // functions
+    LastSymClassId  ,
+  };
+
+  // One symbol of a scope, as returned by getScopeSymbols
+  struct SymbolEntry {
+    IdentId          ident;
+    SymClassId       symClass;
+    TypesMgr::TypeId type;
+  };
+
   // Name of the Global Scope
   static const std::string GLOBAL_SCOPE_NAME;
 
+  // ScopeId returned when a scope is not found
+  static const ScopeId NO_SCOPE = ScopeId(-1);
+
   // Constructor
   SymTable(TypesMgr & Types);
   // Destructor
   ~SymTable() = default;
 
+  // Methods to work with the interned identifiers
+  //   - returns the IdentId of ident, interning it if it is new
+  IdentId             internIdent  (const std::string & ident);
+  //   - returns the IdentId of ident, or IdentTable::NO_IDENT
+  IdentId             findIdent    (const std::string & ident) const;
+  //   - returns the name of an interned identifier
+  const std::string & getIdentName (IdentId id)                const;
+
   // Manage the stack of scopes
   //   - create a new empty scope and push its ScopeId in the stack
   ScopeId pushNewScope  (const std::string & name);
@@ -88,6 +124,7 @@ public:
   //   - in the whole stack. Returns the number of scopes skipped to
                           // find the symbol, or -1 if it is not found
   int     findInStack        (const std::string & ident)             const;
+  int     findInStack        (IdentId id)                            const;
 
   // Adds a new symbol in the current scope
   void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
@@ -98,9 +135,12 @@ public:
   bool isLocalVarClass  (const std::string & ident) const;
   bool isParameterClass (const std::string & ident) const;
   bool isFunctionClass  (const std::string & ident) const;
+  // Accessor to get the class of the symbol. If not found return ErrorClassId
+  SymClassId getSymbolClass (IdentId id) const;
 
   // Accessor to get the TypeId of a symbol. If not found return type 'error'
   TypesMgr::TypeId getType (const std::string & ident) const;
+  TypesMgr::TypeId getType (IdentId id)                const;
 
   // Check the existence of the "main" function
   bool noMainProperlyDeclared() const;
@@ -111,6 +151,14 @@ public:
   TypesMgr::TypeId getLocalSymbolType    (const std::string & funcName,
                                           const std::string & ident) const;
 
+  // Given the name of a function, returns its scope (or NO_SCOPE)
+  ScopeId                  getFunctionScope (const std::string & funcName) const;
+  // Returns the symbols of a scope in declaration order
+  std::vector<SymbolEntry> getScopeSymbols  (ScopeId sc)                   const;
+
+  // Number of scopes created
+  std::size_t getNumberOfScopes () const;
+
   // Print the symbols of a scope on the standard output
   //   - the symbols of the current scope (top of the stack)
   void printCurrentScope () const;
@@ -124,8 +172,11 @@ private:
 
   // Attributes:
   TypesMgr               & Types;
+  IdentTable               Idents;
   std::vector<ScopeInfo>   ScopesVec;
   std::vector<ScopeId>     ScopeIdsStack;
+  // Scope of each function, indexed by the IdentId of its name
+  std::vector<ScopeId>     FunctionScopes;
 
   //////////////////////////////////////////////////////////////////
   // Class ScopeInfo: is declared inside SymTable and is private,
@@ -142,23 +193,24 @@ private:
     std::string getName () const;
 
     // Mutators to add symbols to the scope
-    void addLocalVar  (const std::string & ident, TypesMgr::TypeId type);
-    void addParameter (const std::string & ident, TypesMgr::TypeId type);
-    void addFunction  (const std::string & ident, TypesMgr::TypeId type);
+    void addLocalVar  (IdentId ident, TypesMgr::TypeId type);
+    void addParameter (IdentId ident, TypesMgr::TypeId type);
+    void addFunction  (IdentId ident, TypesMgr::TypeId type);
 
     // Accessor to check the existence of a symbol
-    bool findSymbol (const std::string & ident) const;
+    bool findSymbol (IdentId ident) const;
 
-    // Accessors to check the class of the symbol. If not found return false
-    bool isLocalVarClass  (const std::string & ident) const;
-    bool isParameterClass (const std::string & ident) const;
-    bool isFunctionClass  (const std::string & ident) const;
+    // Accessor to get the class of the symbol. If not found return ErrorClassId
+    SymClassId getSymbolClass (IdentId ident) const;
 
     // Accessor to get the TypeId of a symbol. The symbol MUST exist
-    TypesMgr::TypeId getType (const std::string & ident) const;
+    TypesMgr::TypeId getType (IdentId ident) const;
+
+    // Appends the symbols of the scope (in declaration order) to symbols
+    void getSymbols (std::vector<SymbolEntry> & symbols) const;
 
     // Writes the contents of the scope to the standard output
-    void print (TypesMgr & Types) const;
+    void print (TypesMgr & Types, const IdentTable & Idents) const;
 
   private:
 
@@ -167,10 +219,18 @@ private:
 
     // For the name of the scope
     std::string name;
-    // The information associated to each identifier declared in this scope.
-    std::map<std::string, SymbolInfo> SymbolsMap;
-    // For remember the order in which the Ids where introduced.
-    std::vector<std::string> IdentsList;
+    // The information associated to each identifier declared in this
+    // scope, in the order in which the Ids where introduced.
+    std::vector<IdentId>    IdentsList;
+    std::vector<SymbolInfo> SymbolsList;
+    // Hash table from IdentId to position in the lists above
+    // (position+1 of each used slot, 0 if empty)
+    std::vector<std::size_t> Slots;
+
+    // Adds a new symbol (that MUST NOT exist) to the scope
+    void addSymbol (IdentId ident, const SymbolInfo & info);
+    // Slot where ident is (or where it should be inserted)
+    std::size_t findSlot (IdentId ident) const;
 
 
     //////////////////////////////////////////////////////////////////
@@ -181,21 +241,12 @@ private:
 
     class SymbolInfo {
     public:
-      enum SymClassId {
-        FirstSymClassId = -2,
-        ErrorClassId    = -1,      // "error" symbol class
-        // Normal symbol classes:
-        LocalVarId      =  0,      // local variables
-        ParameterId     ,          // parameters
-        FunctionId      ,          // functions
-        LastSymClassId  ,
-      };
-
       // Constructors
       SymbolInfo ();
       SymbolInfo (SymClassId c, TypesMgr::TypeId tid);
 
       // Accessors for working with the symbol attributes: class and type
+      SymClassId       getClass         () const;
       bool             isLocalVarClass  () const;
       bool             isParameterClass () const;
       bool             isFunctionClass  () const;
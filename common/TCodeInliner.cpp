@@ -0,0 +1,392 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeInliner - Inlining of the calls of the t-code of the Asl
+//                   programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TCodeInliner.h"
+#include "TCodeTypes.h"
+
+#include <algorithm>
+#include <iterator>
+
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+// A callee with up to TINY_SIZE instructions is always inlined (its
+// body is about the size of the protocol of the call); without a
+// profile the limit is SMALL_SIZE, and with one a call executed at
+// least HOT_COUNT times can inline up to HOT_SIZE instructions (and
+// a call that has not been executed only the tiny ones). No more
+// calls are inlined into a function once it has MAX_CALLER_SIZE
+static const std::size_t   TINY_SIZE       = 8;
+static const std::size_t   SMALL_SIZE      = 20;
+static const std::size_t   HOT_SIZE        = 60;
+static const std::uint64_t HOT_COUNT       = 1000;
+static const std::size_t   MAX_CALLER_SIZE = 4000;
+
+
+TCodeInliner::TCodeInliner(const TypesMgr & Types, SymTable & Symbols, code & tCode,
+                           const TCodeProfile * profile) :
+  Types{Types}, Symbols{Symbols}, tCode{tCode}, profile{profile}, nextTemp{0} {
+}
+
+void TCodeInliner::inlineCalls() {
+  sites.clear();
+  buildCallGraph();
+  for (auto & name : bottomUpOrder)
+    inlineCallsOf(tCode.get_subroutine(name));
+}
+
+const std::vector<TCodeInliner::Site> & TCodeInliner::getInlinedSites() const {
+  return sites;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Call graph
+
+// A function is recursive if it can be reached from its callees
+void TCodeInliner::buildCallGraph() {
+  callGraph.clear();
+  recursive.clear();
+  bottomUpOrder.clear();
+  for (auto & subr : tCode.get_subroutine_list()) {
+    std::set<std::string> & callees = callGraph[subr.get_name()];
+    for (auto & instr : subr.get_instructions())
+      if (instr.oper == instruction::_CALL) callees.insert(instr.arg1);
+  }
+  for (auto & func : callGraph) {
+    std::set<std::string> reached;
+    std::vector<std::string> pending(func.second.begin(), func.second.end());
+    while (not pending.empty()) {
+      std::string name = pending.back();
+      pending.pop_back();
+      auto it = callGraph.find(name);
+      if (reached.insert(name).second and it != callGraph.end())
+        pending.insert(pending.end(), it->second.begin(), it->second.end());
+    }
+    if (reached.count(func.first) > 0) recursive.insert(func.first);
+  }
+  std::set<std::string> visited;
+  for (auto & subr : tCode.get_subroutine_list())
+    visitBottomUp(subr.get_name(), visited);
+}
+
+void TCodeInliner::visitBottomUp(const std::string & func, std::set<std::string> & visited) {
+  auto it = callGraph.find(func);
+  if (it == callGraph.end() or not visited.insert(func).second) return;
+  for (auto & callee : it->second)
+    visitBottomUp(callee, visited);
+  bottomUpOrder.push_back(func);
+}
+
+
+////////////////////////////////////////////////////////////////
+// Heuristics
+
+// The local vars of an inlined body are cleared as the ones of a new
+// frame (but the char ones, that have no constant to do it); the
+// local arrays are not copied
+bool TCodeInliner::isInlinable(const subroutine & callee) const {
+  std::string name = callee.get_name();
+  if (name == "main" or recursive.count(name) > 0) return false;
+  for (auto & varlocal : callee.vars)
+    if (Types.isArrayTy(Symbols.getLocalSymbolType(name, varlocal.name))) return false;
+  for (auto & varlocal : getLocalsToClear(callee))
+    if (Types.isCharacterTy(Symbols.getLocalSymbolType(name, varlocal))) return false;
+  return true;
+}
+
+// The executions of a call are the ones of the block it is in
+bool TCodeInliner::shouldInline(const subroutine & caller, std::size_t pos, std::size_t callerSize,
+                                const subroutine & callee, std::uint64_t & count) const {
+  count = 0;
+  if (callerSize >= MAX_CALLER_SIZE or not isInlinable(callee)) return false;
+  const TCodeProfile::FunctionCounts * counts = (profile == nullptr) ? nullptr :
+    profile->findFunction(caller.get_name(), caller.get_number_of_instructions());
+  if (counts != nullptr) {
+    auto it = counts->blocks.upper_bound(pos);
+    if (it != counts->blocks.begin()) count = std::prev(it)->second;
+  }
+  std::size_t size = getSize(callee);
+  if (size <= TINY_SIZE)  return true;
+  if (counts != nullptr) return count >= HOT_COUNT and size <= HOT_SIZE;
+  return size <= SMALL_SIZE;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Inlining
+
+// The params of a call are the last ones pushed (and not taken by an
+// inner call), and the popparams come right after the call
+void TCodeInliner::inlineCallsOf(subroutine & caller) {
+  const instructionList instrs = caller.get_instructions();
+  std::size_t n = instrs.size();
+  std::size_t callerSize = getSize(caller);
+  nextTemp = getMaxTemp(caller) + 1;
+
+  std::vector<std::size_t>             pushes;
+  std::map<std::size_t, instructionList> replaced;   // by position
+  std::vector<bool>                    removed(n, false);
+  for (std::size_t pos = 0; pos < n; ++pos) {
+    const instruction & instr = instrs[pos];
+    if (instr.oper == instruction::_PUSH) {
+      pushes.push_back(pos);
+      continue;
+    }
+    if (instr.oper != instruction::_CALL) continue;
+    const subroutine & callee = tCode.get_subroutine(instr.arg1);
+    std::size_t k = callee.params.size();
+    if (pushes.size() < k or pos + k >= n) break;
+    std::vector<std::size_t> pushPos(pushes.end() - k, pushes.end());
+    pushes.resize(pushes.size() - k);
+    bool popped = true;
+    for (std::size_t i = 1; i <= k; ++i)
+      popped = popped and instrs[pos + i].oper == instruction::_POP;
+    std::uint64_t count;
+    if (not popped or not shouldInline(caller, pos, callerSize, callee, count))
+      continue;
+
+    std::vector<std::string> args;
+    for (std::size_t p : pushPos) args.push_back(instrs[p].arg1);
+    std::string result = (k > 0 and callee.params.front().name == "_result") ?
+                         instrs[pos + k].arg1 : "";
+    std::vector<instructionList> paramLoads;
+    instructionList body;
+    inlineBody(caller, callee, sites.size() + 1, args, result, paramLoads, body);
+    for (std::size_t j = 0; j < k; ++j)
+      replaced[pushPos[j]] = std::move(paramLoads[j]);
+    replaced[pos] = std::move(body);
+    for (std::size_t i = 1; i <= k; ++i) removed[pos + i] = true;
+    std::size_t size = getSize(callee);
+    callerSize += size;
+    sites.push_back(Site{caller.get_name(), callee.get_name(), pos, size, count});
+  }
+  if (replaced.empty()) return;
+
+  instructionList newInstrs;
+  newInstrs.reserve(n);
+  for (std::size_t pos = 0; pos < n; ++pos) {
+    auto it = replaced.find(pos);
+    if (it != replaced.end())
+      newInstrs.insert(newInstrs.end(), it->second.begin(), it->second.end());
+    else if (not removed[pos])
+      newInstrs.push_back(instrs[pos]);
+  }
+  caller.set_instructions(std::move(newInstrs));
+}
+
+// The body of the callee for the call number site: the returns (but
+// the last ones) jump to the end of the body, where the result is
+// copied to the popped temporal. paramLoads gets the copy of each
+// scalar param, that replaces its pushparam
+void TCodeInliner::inlineBody(subroutine & caller, const subroutine & callee, std::size_t site,
+                              const std::vector<std::string> & args, const std::string & result,
+                              std::vector<instructionList> & paramLoads, instructionList & body) {
+  std::string calleeName = callee.get_name();
+  std::string suffix = "_" + std::to_string(site);
+  auto newName = [&](const std::string & name) {
+    return (name[0] == '_' ? name : "_" + name) + suffix;
+  };
+  int tempOffset = nextTemp - 1;
+  nextTemp += getMaxTemp(callee);
+
+  // the params and local vars of the callee in the caller
+  std::map<std::string, std::string> names;
+  std::set<std::string>              arrayParams;
+  Symbols.pushThisScope(Symbols.getFunctionScope(caller.get_name()));
+  std::size_t j = 0;
+  paramLoads.assign(args.size(), instructionList());
+  for (auto & param : callee.params) {
+    if (param.name == "_result") {
+      // a local of the type of the result (the callee may assign it an
+      // int when it returns a float), copied to the popped temporal
+      std::string name = newName(param.name);
+      names[param.name] = name;
+      caller.add_var(name, param.type);
+      TypesMgr::TypeId tFunc = Symbols.getGlobalFunctionType(calleeName);
+      Symbols.addLocalVar(name, Types.getFuncReturnType(tFunc));
+    }
+    else {
+      TypesMgr::TypeId tid = Symbols.getLocalSymbolType(calleeName, param.name);
+      if (Types.isArrayTy(tid)) {
+        names[param.name] = args[j];
+        arrayParams.insert(param.name);
+      }
+      else {
+        std::string name = newName(param.name);
+        names[param.name] = name;
+        caller.add_var(name, param.type);
+        Symbols.addLocalVar(name, tid);
+        paramLoads[j] = instruction::LOAD(name, args[j]);
+      }
+    }
+    ++j;
+  }
+  for (auto & varlocal : callee.vars) {
+    std::string name = newName(varlocal.name);
+    names[varlocal.name] = name;
+    caller.add_var(name, varlocal.type, varlocal.nelem);
+    Symbols.addLocalVar(name, Symbols.getLocalSymbolType(calleeName, varlocal.name));
+  }
+  Symbols.popScope();
+
+  auto operand = [&](const std::string & arg) -> std::string {
+    if (TCodeTypes::isTemporal(arg))
+      return "%" + std::to_string(std::stoi(arg.substr(1)) + tempOffset);
+    auto it = names.find(arg);
+    return (it == names.end()) ? arg : it->second;
+  };
+
+  for (auto & varlocal : getLocalsToClear(callee)) {
+    std::string temp = "%" + std::to_string(nextTemp++);
+    if (Types.isFloatTy(Symbols.getLocalSymbolType(calleeName, varlocal)))
+      body.push_back(instruction::FLOAD(temp, "0.0"));
+    else
+      body.push_back(instruction::ILOAD(temp, "0"));
+    body.push_back(instruction::LOAD(names[varlocal], temp));
+  }
+
+  const instructionList instrs = callee.get_instructions();
+  std::size_t end = instrs.size();
+  while (end > 0 and instrs[end-1].oper == instruction::_RETURN) --end;
+  std::string endLabel = "endCall" + suffix;
+  bool jumpsToEnd = false;
+  for (std::size_t pos = 0; pos < end; ++pos) {
+    instruction instr = instrs[pos];
+    switch (instr.oper) {
+    case instruction::_LABEL:
+    case instruction::_UJUMP:
+      instr.arg1 += suffix;
+      break;
+    case instruction::_FJUMP:
+      instr.arg1 = operand(instr.arg1);
+      instr.arg2 += suffix;
+      break;
+    case instruction::_RETURN:
+      instr = instruction::UJUMP(endLabel);
+      jumpsToEnd = true;
+      break;
+    case instruction::_CALL:
+    case instruction::_HALT:
+    case instruction::_WRITES:
+    case instruction::_WRITELN:
+      break;
+    case instruction::_ILOAD:
+    case instruction::_CHLOAD:
+    case instruction::_FLOAD:
+      instr.arg1 = operand(instr.arg1);
+      break;
+    case instruction::_ALOAD:
+      // the address of an array param is the pointer pushed
+      if (arrayParams.count(instr.arg2) > 0)
+        instr = instruction::LOAD(operand(instr.arg1), operand(instr.arg2));
+      else {
+        instr.arg1 = operand(instr.arg1);
+        instr.arg2 = operand(instr.arg2);
+      }
+      break;
+    default:
+      instr.arg1 = operand(instr.arg1);
+      instr.arg2 = operand(instr.arg2);
+      instr.arg3 = operand(instr.arg3);
+    }
+    body.push_back(std::move(instr));
+  }
+  if (jumpsToEnd) body.push_back(instruction::LABEL(endLabel));
+  if (not result.empty()) body.push_back(instruction::LOAD(result, names["_result"]));
+}
+
+
+////////////////////////////////////////////////////////////////
+// Helpers
+
+// The size of a subroutine is its number of instructions (but the
+// labels and noops)
+std::size_t TCodeInliner::getSize(const subroutine & subr) {
+  std::size_t size = 0;
+  for (auto & instr : subr.get_instructions())
+    if (instr.oper != instruction::_LABEL and instr.oper != instruction::_NOOP) ++size;
+  return size;
+}
+
+int TCodeInliner::getMaxTemp(const subroutine & subr) {
+  int maxTemp = 0;
+  for (auto & instr : subr.get_instructions())
+    for (const std::string * arg : {&instr.arg1, &instr.arg2, &instr.arg3})
+      if (TCodeTypes::isTemporal(*arg))
+        maxTemp = std::max(maxTemp, std::stoi(arg->substr(1)));
+  return maxTemp;
+}
+
+// The local vars that may be read before they are assigned: the ones
+// that are not assigned (before being read) in the instructions up to
+// the first label, jump or return
+std::set<std::string> TCodeInliner::getLocalsToClear(const subroutine & subr) {
+  std::set<std::string> locals, assigned, toClear;
+  for (auto & varlocal : subr.vars) locals.insert(varlocal.name);
+  for (auto & instr : subr.get_instructions()) {
+    if (instr.oper == instruction::_LABEL or instr.oper == instruction::_UJUMP or
+        instr.oper == instruction::_RETURN or instr.oper == instruction::_HALT)
+      break;
+    bool defines = false;
+    switch (instr.oper) {
+    case instruction::_ADD:  case instruction::_SUB:  case instruction::_MUL:
+    case instruction::_DIV:  case instruction::_EQ:   case instruction::_LT:
+    case instruction::_LE:   case instruction::_NEG:  case instruction::_NOT:
+    case instruction::_AND:  case instruction::_OR:   case instruction::_FLOAT:
+    case instruction::_FADD: case instruction::_FSUB: case instruction::_FMUL:
+    case instruction::_FDIV: case instruction::_FEQ:  case instruction::_FLT:
+    case instruction::_FLE:  case instruction::_FNEG: case instruction::_LOAD:
+    case instruction::_ILOAD: case instruction::_CHLOAD: case instruction::_FLOAD:
+    case instruction::_LOADX: case instruction::_ALOAD: case instruction::_LOADC:
+    case instruction::_READI: case instruction::_READF: case instruction::_READC:
+    case instruction::_POP:
+      defines = true;
+      break;
+    default:
+      break;
+    }
+    if (instr.oper != instruction::_ILOAD and instr.oper != instruction::_CHLOAD and
+        instr.oper != instruction::_FLOAD and instr.oper != instruction::_WRITES) {
+      for (const std::string * arg : {&instr.arg1, &instr.arg2, &instr.arg3}) {
+        if (defines and arg == &instr.arg1) continue;
+        if (locals.count(*arg) > 0 and assigned.count(*arg) == 0) toClear.insert(*arg);
+      }
+    }
+    if (defines and locals.count(instr.arg1) > 0) assigned.insert(instr.arg1);
+    if (instr.oper == instruction::_FJUMP) break;
+  }
+  for (auto & name : locals)
+    if (assigned.count(name) == 0) toClear.insert(name);
+  return toClear;
+}
@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeInliner - Inlining of the calls of the t-code of the Asl
+//                   programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+#include "code.h"
+#include "TCodeProfile.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+
+// using namespace std;
+
+class code;
+class subroutine;
+class instruction;
+
+// Inlining of the calls of a program: the pushparam/call/popparam of
+// a call to a small function (or, with a profile, to a function called
+// from a hot block) are replaced by a copy of its body. The scalar
+// params, the local vars and _result of the callee become local vars
+// of the caller (added to its scope of the symbol table, so the
+// backends know their types), the result is copied at the end to the
+// temporal it was popped to, the array params are the addresses that
+// were pushed, and the temporals and labels get new names. The
+// functions are done bottom-up in the call graph, so the inlined bodies
+// already have their own calls inlined; the recursive functions, main
+// and the functions with local arrays are never inlined
+class TCodeInliner {
+ public:
+  // a call that has been inlined
+  struct Site {
+    std::string   caller, callee;
+    std::size_t   pos;        // of the call, in the t-code of the caller
+    std::size_t   size;       // instructions of the body of the callee
+    std::uint64_t count;      // executions of the call in the profile (0 if none)
+  };
+
+  TCodeInliner(const TypesMgr & Types, SymTable & Symbols, code & tCode,
+               const TCodeProfile * profile = nullptr);
+
+  // inline the calls of all the subroutines
+  void inlineCalls();
+
+  const std::vector<Site> & getInlinedSites() const;
+
+ private:
+  const TypesMgr     & Types;
+  SymTable           & Symbols;
+  code               & tCode;
+  const TCodeProfile * profile;
+
+  std::map<std::string, std::set<std::string>> callGraph;    // callees of each function
+  std::set<std::string>                         recursive;
+  std::vector<std::string>                      bottomUpOrder;
+  std::vector<Site>                             sites;
+
+  // the next temporal of the subroutine being done
+  int nextTemp;
+
+  void buildCallGraph();
+  void visitBottomUp(const std::string & func, std::set<std::string> & visited);
+  bool isInlinable(const subroutine & callee) const;
+  bool shouldInline(const subroutine & caller, std::size_t pos, std::size_t callerSize,
+                    const subroutine & callee, std::uint64_t & count) const;
+  void inlineCallsOf(subroutine & caller);
+  void inlineBody(subroutine & caller, const subroutine & callee, std::size_t site,
+                  const std::vector<std::string> & args, const std::string & result,
+                  std::vector<instructionList> & paramLoads, instructionList & body);
+
+  static std::size_t getSize(const subroutine & subr);
+  static int         getMaxTemp(const subroutine & subr);
+  static std::set<std::string> getLocalsToClear(const subroutine & subr);
+};
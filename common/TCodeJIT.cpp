@@ -0,0 +1,422 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeJIT - Baseline JIT of the t-code of the Asl programming
+//               language (x86-64)
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TCodeJIT.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) and (defined(__linux__) or defined(__APPLE__))
+#define ASL_JIT_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// using namespace std;
+
+
+// Registers of the templates: %eax, %ecx and %edx (and %xmm0) are the
+// scratch ones, %esi the second argument of the calls to the VM
+static const int EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7;
+
+// setcc %al (the second byte of the opcode)
+static const std::uint8_t SETE = 0x94, SETNE = 0x95, SETL = 0x9C, SETLE = 0x9E,
+                          SETA = 0x97, SETAE = 0x93;
+
+
+////////////////////////////////////////////////////////////////
+// Calls from the native code to the VM (with plain integer params,
+// that go in %rdi and %rsi)
+
+static void jitPush(TCodeVM * vm, std::uint64_t bits) {
+  TCodeVM::Slot value;
+  value.bits = bits;
+  vm->pushParam(value);
+}
+
+static std::uint64_t jitPop(TCodeVM * vm) {
+  return vm->popParam().bits;
+}
+
+static void jitCall(TCodeVM * vm, int func) {
+  vm->call(func);
+}
+
+static void jitReadInt(TCodeVM * vm, TCodeVM::Slot * s) {
+  vm->readInt(*s);
+}
+
+static void jitReadFloat(TCodeVM * vm, TCodeVM::Slot * s) {
+  vm->readFloat(*s);
+}
+
+static void jitReadChar(TCodeVM * vm, TCodeVM::Slot * s) {
+  vm->readChar(*s);
+}
+
+static void jitWriteInt(TCodeVM * vm, std::int32_t n) {
+  vm->writeInt(n);
+}
+
+static void jitWriteFloat(TCodeVM * vm, std::uint32_t bits) {
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  vm->writeFloat(f);
+}
+
+static void jitWriteChar(TCodeVM * vm, std::int32_t c) {
+  vm->writeChar(c);
+}
+
+static void jitWriteString(TCodeVM * vm, int str) {
+  vm->writeString(str);
+}
+
+static void jitHalt(TCodeVM * vm, int str) {
+  vm->halt(str);
+}
+
+template <typename F>
+static std::uintptr_t helperAddress(F helper) {
+  return reinterpret_cast<std::uintptr_t>(helper);
+}
+
+
+////////////////////////////////////////////////////////////////
+// Code buffers
+
+TCodeJIT::TCodeJIT() {
+}
+
+TCodeJIT::~TCodeJIT() {
+#ifdef ASL_JIT_X86_64
+  for (auto & buffer : buffers)
+    munmap(buffer.first, buffer.second);
+#endif
+}
+
+bool TCodeJIT::isAvailable() {
+#ifdef ASL_JIT_X86_64
+  return true;
+#else
+  return false;
+#endif
+}
+
+// The native code is called as code(frame, vm): the frame stays in
+// %rbx and the VM in %r12 (callee-saved), and a third push keeps %rsp
+// aligned to 16 bytes at the calls to the VM
+TCodeVM::NativeCode TCodeJIT::compile(const TCodeVM::Function & func) {
+#ifdef ASL_JIT_X86_64
+  bytes.clear();
+  jumps.clear();
+  emit({0x53,                         // push %rbx
+        0x41, 0x54,                   // push %r12
+        0x50,                         // push %rax
+        0x48, 0x89, 0xFB,             // mov  %rdi, %rbx
+        0x49, 0x89, 0xF4});           // mov  %rsi, %r12
+  std::vector<std::size_t> positions;
+  for (auto & in : func.instrs) {
+    positions.push_back(bytes.size());
+    emitInstr(in);
+  }
+  for (auto & jump : jumps) {
+    std::int32_t rel = std::int32_t(positions[jump.second]) - std::int32_t(jump.first + 4);
+    std::memcpy(&bytes[jump.first], &rel, sizeof(rel));
+  }
+
+  std::size_t pageSize = sysconf(_SC_PAGESIZE);
+  std::size_t size = (bytes.size() + pageSize - 1) / pageSize * pageSize;
+  void * buffer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer == MAP_FAILED)
+    return nullptr;
+  std::memcpy(buffer, bytes.data(), bytes.size());
+  if (mprotect(buffer, size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(buffer, size);
+    return nullptr;
+  }
+  buffers.push_back(std::make_pair(buffer, size));
+  return reinterpret_cast<TCodeVM::NativeCode>(buffer);
+#else
+  (void)func;
+  return nullptr;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////
+// Templates
+
+void TCodeJIT::emit(std::initializer_list<std::uint8_t> code) {
+  bytes.insert(bytes.end(), code.begin(), code.end());
+}
+
+void TCodeJIT::emit32(std::uint32_t n) {
+  for (int k = 0; k < 4; ++k)
+    bytes.push_back(std::uint8_t(n >> (8 * k)));
+}
+
+void TCodeJIT::emit64(std::uint64_t n) {
+  emit32(std::uint32_t(n));
+  emit32(std::uint32_t(n >> 32));
+}
+
+// the operand disp32(%rbx) (mod 10, r/m 011)
+void TCodeJIT::emitSlot(std::initializer_list<std::uint8_t> opcode, int reg, int slot) {
+  emit(opcode);
+  bytes.push_back(std::uint8_t(0x80 | (reg & 7) << 3 | 3));
+  emit32(std::uint32_t(8 * slot));
+}
+
+void TCodeJIT::emitJump(std::initializer_list<std::uint8_t> opcode, int target) {
+  emit(opcode);
+  jumps.push_back(std::make_pair(bytes.size(), target));
+  emit32(0);
+}
+
+// helper(vm, %rsi)
+void TCodeJIT::emitHelperCall(std::uintptr_t helper) {
+  emit({0x4C, 0x89, 0xE7});           // mov  %r12, %rdi
+  emit({0x48, 0xB8});                 // mov  $helper, %rax
+  emit64(helper);
+  emit({0xFF, 0xD0});                 // call *%rax
+}
+
+// slot = the flag in %al (0 or 1)
+void TCodeJIT::emitSetFlag(std::uint8_t setcc, int slot) {
+  emit({0x0F, setcc, 0xC0});          // setcc %al
+  emit({0x0F, 0xB6, 0xC0});           // movzbl %al, %eax
+  emitSlot({0x89}, EAX, slot);        // mov  %eax, slot
+}
+
+void TCodeJIT::emitInstr(const TCodeVM::Instr & in) {
+  switch (in.oper) {
+  case instruction::_UJUMP:
+    emitJump({0xE9}, in.a1);                              // jmp
+    break;
+  case instruction::_FJUMP:
+    emitSlot({0x83}, EDI, in.a1);                         // cmpl $0, a1
+    bytes.push_back(0);
+    emitJump({0x0F, 0x84}, in.a2);                        // je
+    break;
+  case instruction::_HALT:
+    emit({0xBE});                                         // mov  $str, %esi
+    emit32(in.a1);
+    emitHelperCall(helperAddress(&jitHalt));
+    break;
+  case instruction::_PUSH:
+    if (in.mode & TCodeVM::ARRAY1)
+      emitSlot({0x48, 0x8D}, ESI, in.a1);                 // lea  a1, %rsi
+    else if (in.a1 >= 0)
+      emitSlot({0x48, 0x8B}, ESI, in.a1);                 // mov  a1, %rsi
+    else
+      emit({0x31, 0xF6});                                 // xor  %esi, %esi
+    emitHelperCall(helperAddress(&jitPush));
+    break;
+  case instruction::_POP:
+    emitHelperCall(helperAddress(&jitPop));
+    if (in.a1 >= 0)
+      emitSlot({0x48, 0x89}, EAX, in.a1);                 // mov  %rax, a1
+    break;
+  case instruction::_CALL:
+    emit({0xBE});                                         // mov  $func, %esi
+    emit32(in.a1);
+    emitHelperCall(helperAddress(&jitCall));
+    break;
+  case instruction::_RETURN:
+    emit({0x58,                                           // pop  %rax
+          0x41, 0x5C,                                     // pop  %r12
+          0x5B,                                           // pop  %rbx
+          0xC3});                                         // ret
+    break;
+  case instruction::_ADD:
+  case instruction::_SUB:
+  case instruction::_MUL:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    if (in.oper == instruction::_ADD)
+      emitSlot({0x03}, EAX, in.a3);                       // add  a3, %eax
+    else if (in.oper == instruction::_SUB)
+      emitSlot({0x2B}, EAX, in.a3);                       // sub  a3, %eax
+    else
+      emitSlot({0x0F, 0xAF}, EAX, in.a3);                 // imul a3, %eax
+    emitSlot({0x89}, EAX, in.a1);                         // mov  %eax, a1
+    break;
+  case instruction::_DIV:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emit({0x99});                                         // cltd
+    emitSlot({0xF7}, EDI, in.a3);                         // idivl a3
+    emitSlot({0x89}, EAX, in.a1);                         // mov  %eax, a1
+    break;
+  case instruction::_EQ:
+  case instruction::_LT:
+  case instruction::_LE:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emitSlot({0x3B}, EAX, in.a3);                         // cmp  a3, %eax
+    emitSetFlag(in.oper == instruction::_EQ ? SETE : in.oper == instruction::_LT ? SETL : SETLE,
+                in.a1);
+    break;
+  case instruction::_NEG:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emit({0xF7, 0xD8});                                   // neg  %eax
+    emitSlot({0x89}, EAX, in.a1);                         // mov  %eax, a1
+    break;
+  case instruction::_NOT:
+    emitSlot({0x83}, EDI, in.a2);                         // cmpl $0, a2
+    bytes.push_back(0);
+    emitSetFlag(SETE, in.a1);
+    break;
+  case instruction::_AND:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emit({0x85, 0xC0,                                     // test %eax, %eax
+          0x0F, 0x95, 0xC2});                             // setne %dl
+    emitSlot({0x8B}, ECX, in.a3);                         // mov  a3, %ecx
+    emit({0x85, 0xC9,                                     // test %ecx, %ecx
+          0x0F, 0x95, 0xC0,                               // setne %al
+          0x20, 0xD0});                                   // and  %dl, %al
+    emit({0x0F, 0xB6, 0xC0});                             // movzbl %al, %eax
+    emitSlot({0x89}, EAX, in.a1);                         // mov  %eax, a1
+    break;
+  case instruction::_OR:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emitSlot({0x0B}, EAX, in.a3);                         // or   a3, %eax
+    emitSetFlag(SETNE, in.a1);
+    break;
+  case instruction::_FLOAT:
+    emitSlot({0xF3, 0x0F, 0x2A}, EAX, in.a2);             // cvtsi2ssl a2, %xmm0
+    emitSlot({0xF3, 0x0F, 0x11}, EAX, in.a1);             // movss %xmm0, a1
+    break;
+  case instruction::_FADD:
+  case instruction::_FSUB:
+  case instruction::_FMUL:
+  case instruction::_FDIV:
+    {
+      std::uint8_t op = (in.oper == instruction::_FADD ? 0x58 :
+                         in.oper == instruction::_FSUB ? 0x5C :
+                         in.oper == instruction::_FMUL ? 0x59 : 0x5E);
+      emitSlot({0xF3, 0x0F, 0x10}, EAX, in.a2);           // movss a2, %xmm0
+      emitSlot({0xF3, 0x0F, op}, EAX, in.a3);             // addss/.. a3, %xmm0
+      emitSlot({0xF3, 0x0F, 0x11}, EAX, in.a1);           // movss %xmm0, a1
+      break;
+    }
+  case instruction::_FEQ:
+  case instruction::_FLT:
+  case instruction::_FLE:
+    // the flags of a3 compared with a2 (unordered: all set)
+    emitSlot({0xF3, 0x0F, 0x10}, EAX, in.a3);             // movss a3, %xmm0
+    emitSlot({0x0F, 0x2E}, EAX, in.a2);                   // ucomiss a2, %xmm0
+    if (in.oper == instruction::_FEQ) {
+      emit({0x0F, 0x94, 0xC0,                             // sete  %al
+            0x0F, 0x9B, 0xC1,                             // setnp %cl
+            0x20, 0xC8});                                 // and   %cl, %al
+      emit({0x0F, 0xB6, 0xC0});                           // movzbl %al, %eax
+      emitSlot({0x89}, EAX, in.a1);                       // mov  %eax, a1
+    }
+    else
+      emitSetFlag(in.oper == instruction::_FLT ? SETA : SETAE, in.a1);
+    break;
+  case instruction::_FNEG:
+    emitSlot({0x8B}, EAX, in.a2);                         // mov  a2, %eax
+    emit({0x35});                                         // xor  $0x80000000, %eax
+    emit32(0x80000000u);
+    emitSlot({0x89}, EAX, in.a1);                         // mov  %eax, a1
+    break;
+  case instruction::_LOAD:
+    if (in.mode & TCodeVM::ARRAY2)
+      emitSlot({0x48, 0x8D}, EAX, in.a2);                 // lea  a2, %rax
+    else
+      emitSlot({0x48, 0x8B}, EAX, in.a2);                 // mov  a2, %rax
+    emitSlot({0x48, 0x89}, EAX, in.a1);                   // mov  %rax, a1
+    break;
+  case instruction::_ILOAD:
+    emitSlot({0x48, 0xC7}, EAX, in.a1);                   // movq $value, a1
+    emit32(std::uint32_t(in.value.bits));
+    break;
+  case instruction::_LOADX:
+    emitSlot({0x48, 0x63}, EAX, in.a3);                   // movslq a3, %rax
+    if (in.mode & TCodeVM::ARRAY2) {
+      emit({0x48, 0x8B, 0x94, 0xC3});                     // mov  a2(%rbx,%rax,8), %rdx
+      emit32(std::uint32_t(8 * in.a2));
+    }
+    else {
+      emitSlot({0x48, 0x8B}, ECX, in.a2);                 // mov  a2, %rcx
+      emit({0x48, 0x8B, 0x14, 0xC1});                     // mov  (%rcx,%rax,8), %rdx
+    }
+    emitSlot({0x48, 0x89}, EDX, in.a1);                   // mov  %rdx, a1
+    break;
+  case instruction::_XLOAD:
+    emitSlot({0x48, 0x63}, EAX, in.a2);                   // movslq a2, %rax
+    emitSlot({0x48, 0x8B}, EDX, in.a3);                   // mov  a3, %rdx
+    if (in.mode & TCodeVM::ARRAY1) {
+      emit({0x48, 0x89, 0x94, 0xC3});                     // mov  %rdx, a1(%rbx,%rax,8)
+      emit32(std::uint32_t(8 * in.a1));
+    }
+    else {
+      emitSlot({0x48, 0x8B}, ECX, in.a1);                 // mov  a1, %rcx
+      emit({0x48, 0x89, 0x14, 0xC1});                     // mov  %rdx, (%rcx,%rax,8)
+    }
+    break;
+  case instruction::_LOADC:
+    emitSlot({0x48, 0x8B}, ECX, in.a2);                   // mov  a2, %rcx
+    emit({0x48, 0x8B, 0x11});                             // mov  (%rcx), %rdx
+    emitSlot({0x48, 0x89}, EDX, in.a1);                   // mov  %rdx, a1
+    break;
+  case instruction::_CLOAD:
+    emitSlot({0x48, 0x8B}, ECX, in.a1);                   // mov  a1, %rcx
+    emitSlot({0x48, 0x8B}, EDX, in.a2);                   // mov  a2, %rdx
+    emit({0x48, 0x89, 0x11});                             // mov  %rdx, (%rcx)
+    break;
+  case instruction::_READI:
+  case instruction::_READF:
+  case instruction::_READC:
+    emitSlot({0x48, 0x8D}, ESI, in.a1);                   // lea  a1, %rsi
+    emitHelperCall(in.oper == instruction::_READI ? helperAddress(&jitReadInt) :
+                   in.oper == instruction::_READF ? helperAddress(&jitReadFloat) :
+                                                    helperAddress(&jitReadChar));
+    break;
+  case instruction::_WRITEI:
+  case instruction::_WRITEF:
+  case instruction::_WRITEC:
+    emitSlot({0x8B}, ESI, in.a1);                         // mov  a1, %esi
+    emitHelperCall(in.oper == instruction::_WRITEI ? helperAddress(&jitWriteInt) :
+                   in.oper == instruction::_WRITEF ? helperAddress(&jitWriteFloat) :
+                                                     helperAddress(&jitWriteChar));
+    break;
+  case instruction::_WRITES:
+    emit({0xBE});                                         // mov  $str, %esi
+    emit32(in.a1);
+    emitHelperCall(helperAddress(&jitWriteString));
+    break;
+  case instruction::_WRITELN:
+    emit({0xBE});                                         // mov  $'\n', %esi
+    emit32('\n');
+    emitHelperCall(helperAddress(&jitWriteChar));
+    break;
+  default:
+    break;
+  }
+}
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeJIT - Baseline JIT of the t-code of the Asl programming
+//               language (x86-64)
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TCodeVM.h"
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <initializer_list>
+
+// using namespace std;
+
+// Translation of the decoded t-code of a function into x86-64 machine
+// code, by stitching a template of bytes for each instruction. The
+// values stay in the slots of the frame of the VM (at %rbx), and the
+// calls, the params and the I/O call back the VM (kept in %r12). The
+// code of each function is in its own mmap'd buffer, executable once
+// it has been written
+class TCodeJIT {
+ private:
+  // the mapped buffers (address and size)
+  std::vector<std::pair<void *, std::size_t>> buffers;
+
+  // the code of the function being compiled, and the jumps to patch
+  // once the positions of their targets are known
+  std::vector<std::uint8_t>                   bytes;
+  std::vector<std::pair<std::size_t, int>>    jumps;
+
+  void emit(std::initializer_list<std::uint8_t> code);
+  void emit32(std::uint32_t n);
+  void emit64(std::uint64_t n);
+  // opcode with a ModRM operand that is the slot of the frame
+  void emitSlot(std::initializer_list<std::uint8_t> opcode, int reg, int slot);
+  void emitJump(std::initializer_list<std::uint8_t> opcode, int target);
+  void emitHelperCall(std::uintptr_t helper);
+  void emitSetFlag(std::uint8_t setcc, int slot);
+  void emitInstr(const TCodeVM::Instr & in);
+
+ public:
+  TCodeJIT();
+  ~TCodeJIT();
+
+  // whether native code can be generated in this machine
+  static bool isAvailable();
+
+  // the native code of func (nullptr if it cannot be generated)
+  TCodeVM::NativeCode compile(const TCodeVM::Function & func);
+};
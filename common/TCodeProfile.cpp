@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TCodeProfile - Execution counts of the t-code of a program, written
+//                   by the VM and read by the code generators
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "TCodeProfile.h"
+
+#include <fstream>
+#include <sstream>
+
+// using namespace std;
+
+
+bool TCodeProfile::load(const std::string & fileName) {
+  std::ifstream file(fileName);
+  if (not file) return false;
+  Functions.clear();
+  FunctionCounts *func = nullptr;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    if (not (fields >> kind)) continue;
+    if (kind == "function") {
+      std::string name;
+      FunctionCounts counts;
+      if (not (fields >> name >> counts.numInstrs >> counts.calls)) return false;
+      func = &(Functions[name] = counts);
+    }
+    else if (kind == "block" and func != nullptr) {
+      std::size_t pos;
+      std::uint64_t count;
+      if (not (fields >> pos >> count)) return false;
+      func->blocks[pos] = count;
+    }
+    else if (kind == "branch" and func != nullptr) {
+      std::size_t pos;
+      std::uint64_t jumps, fallThroughs;
+      if (not (fields >> pos >> jumps >> fallThroughs)) return false;
+      func->branches[pos] = std::make_pair(jumps, fallThroughs);
+    }
+    else
+      return false;
+  }
+  return true;
+}
+
+bool TCodeProfile::save(const std::string & fileName) const {
+  std::ofstream file(fileName);
+  for (auto & named : Functions) {
+    const FunctionCounts & counts = named.second;
+    file << "function " << named.first << " " << counts.numInstrs << " "
+         << counts.calls << "\n";
+    for (auto & block : counts.blocks)
+      file << "block " << block.first << " " << block.second << "\n";
+    for (auto & branch : counts.branches)
+      file << "branch " << branch.first << " " << branch.second.first << " "
+           << branch.second.second << "\n";
+  }
+  return bool(file);
+}
+
+TCodeProfile::FunctionCounts & TCodeProfile::getFunction(const std::string & name) {
+  return Functions[name];
+}
+
+const TCodeProfile::FunctionCounts *
+TCodeProfile::findFunction(const std::string & name, std::size_t numInstrs) const {
+  auto it = Functions.find(name);
+  if (it == Functions.end() or it->second.numInstrs != numInstrs)
+    return nullptr;
+  return &it->second;
+}
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TCodeProfile - Execution counts of the t-code of a program, written
+//                   by the VM and read by the code generators
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <utility>
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint64_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TCodeProfile: the execution counts of each function of a
+// program run by the VM (asl --run --profile=<file>): its calls, the
+// times each basic block has been entered (by the position of its
+// first instruction) and, for each ifFalse, the times it has jumped
+// and fallen through. The file is a text with a line for each count:
+//   function <name> <number of instructions> <calls>
+//   block <position> <count>
+//   branch <position> <jumps> <fall-throughs>
+// The positions are the ones in the t-code of the function, so the
+// counts of a function whose number of instructions has changed since
+// the profile was written are not used.
+
+class TCodeProfile {
+
+public:
+
+  struct FunctionCounts {
+    std::size_t                                  numInstrs;
+    std::uint64_t                                calls;
+    std::map<std::size_t, std::uint64_t>         blocks;
+    std::map<std::size_t,
+             std::pair<std::uint64_t, std::uint64_t>> branches;
+  };
+
+  // Read the profile of fileName (false if it cannot be read or it is
+  // malformed)
+  bool load (const std::string & fileName);
+  // Write the profile to fileName (false if it cannot be written)
+  bool save (const std::string & fileName) const;
+
+  // The counts of a function, created empty if there are none
+  FunctionCounts & getFunction (const std::string & name);
+  // The counts of a function with numInstrs instructions (nullptr if
+  // there are none, or they are stale)
+  const FunctionCounts * findFunction (const std::string & name,
+                                       std::size_t numInstrs) const;
+
+private:
+
+  // Attributes
+  std::map<std::string, FunctionCounts> Functions;
+
+};  // class TCodeProfile
@@ -0,0 +1,225 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeTypes - Types of the values of the t-code of a program
+//                 of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TCodeTypes.h"
+
+#include <cctype>
+
+// using namespace std;
+
+
+TCodeTypes::TCodeTypes(const TypesMgr & Types, const SymTable & Symbols, const code & tCode) :
+  Types{Types}, Symbols{Symbols}, tCode{tCode} {
+  bindFunctions();
+}
+
+const TCodeTypes::FunctionType & TCodeTypes::getFunctionType(const std::string & funcName) const {
+  return functionMap.at(funcName);
+}
+
+void TCodeTypes::bindSubroutine(const subroutine & subr) {
+  bindLocalSymbols(subr);
+  inferTemporalTypes(subr);
+}
+
+bool TCodeTypes::isSymbol(const std::string & tcodeArg) const {
+  return symbolTypeMap.count(tcodeArg) > 0;
+}
+
+const std::map<std::string, TCodeTypes::ValueType> & TCodeTypes::getTemporalTypes() const {
+  return tempTypeMap;
+}
+
+TCodeTypes::ValueType TCodeTypes::TypeIdToValueType(TypesMgr::TypeId tid, bool isParameter) const {
+  ValueType type{"", 0, false};
+  if (Types.isIntegerTy(tid))
+    type.elem = "int";
+  else if (Types.isFloatTy(tid))
+    type.elem = "float";
+  else if (Types.isBooleanTy(tid))
+    type.elem = "bool";
+  else if (Types.isCharacterTy(tid))
+    type.elem = "char";
+  else if (Types.isArrayTy(tid)) {
+    type.elem = TypeIdToValueType(Types.getArrayElemType(tid)).elem;
+    if (isParameter)
+      type.pointer = true;
+    else
+      type.size = Types.getArraySize(tid);
+  }
+  return type;
+}
+
+bool TCodeTypes::isTemporal(const std::string & tcodeArg) {
+  return tcodeArg.size() >= 2 and tcodeArg[0] == '%' and std::isdigit(tcodeArg[1]);
+}
+
+void TCodeTypes::bindFunctions() {
+  functionMap.clear();
+  for (auto & subr : tCode.get_subroutine_list()) {
+    std::string funcName = subr.get_name();
+    FunctionType & func = functionMap[funcName];
+    func.ret = ValueType{"", 0, false};
+    if (funcName == "main") continue;
+    TypesMgr::TypeId tFunc = Symbols.getGlobalFunctionType(funcName);
+    func.ret = TypeIdToValueType(Types.getFuncReturnType(tFunc));
+    for (std::size_t i = 0; i < Types.getNumOfParameters(tFunc); ++i)
+      func.params.push_back(TypeIdToValueType(Types.getParameterType(tFunc, i), true));
+  }
+}
+
+void TCodeTypes::bindLocalSymbols(const subroutine & subr) {
+  currentFunctionName = subr.get_name();
+  symbolTypeMap.clear();
+  // fetch the types of all the params and local vars of the function at once
+  std::map<std::string, TypesMgr::TypeId> symbolTypeIdMap;
+  SymTable::ScopeId sc = Symbols.getFunctionScope(currentFunctionName);
+  if (sc != SymTable::NO_SCOPE) {
+    for (auto & sym : Symbols.getScopeSymbols(sc))
+      symbolTypeIdMap[Symbols.getIdentName(sym.ident)] = sym.type;
+  }
+  for (auto & param : subr.params) {
+    if (param.name == "_result")
+      symbolTypeMap[param.name] = functionMap[currentFunctionName].ret;
+    else
+      symbolTypeMap[param.name] = TypeIdToValueType(symbolTypeIdMap.at(param.name), true);
+  }
+  for (auto & varlocal : subr.vars)
+    symbolTypeMap[varlocal.name] = TypeIdToValueType(symbolTypeIdMap.at(varlocal.name));
+}
+
+// The type of each temporal is the one of the values assigned to it.
+// A temporal can be assigned more than once (in the branches of an
+// expression, or when its value comes from a loop): the scalar types
+// are joined (into float if one of them is float, and int otherwise)
+void TCodeTypes::inferTemporalTypes(const subroutine & subr) {
+  tempTypeMap.clear();
+  const ValueType INT{"int", 0, false}, FLOAT{"float", 0, false};
+  const ValueType BOOL{"bool", 0, false}, CHAR{"char", 0, false};
+  bool changed = true;
+  auto bind = [&](const std::string & temp, const ValueType & type) {
+    if (not isTemporal(temp) or type.elem.empty()) return;
+    auto it = tempTypeMap.find(temp);
+    if (it == tempTypeMap.end()) {
+      tempTypeMap[temp] = type;
+      changed = true;
+      return;
+    }
+    ValueType & old = it->second;
+    if (old.pointer or type.pointer or old.elem == type.elem) return;
+    std::string joined = (old.elem == "float" or type.elem == "float") ? "float" : "int";
+    if (old.elem != joined) {
+      old.elem = joined;
+      changed = true;
+    }
+  };
+  auto elemOf = [&](const std::string & tcodeArg) {
+    ValueType type = getTypeOf(tcodeArg);
+    return ValueType{type.elem, 0, false};
+  };
+  auto addressOf = [&](const std::string & tcodeArg) {
+    ValueType type = getTypeOf(tcodeArg);
+    return ValueType{type.elem, 0, type.elem != ""};
+  };
+  while (changed) {
+    changed = false;
+    std::string lastCall;
+    for (auto & instr : subr.get_instructions()) {
+      switch (instr.oper) {
+      case instruction::_ILOAD:
+      case instruction::_ADD:
+      case instruction::_SUB:
+      case instruction::_MUL:
+      case instruction::_DIV:
+      case instruction::_NEG:
+      case instruction::_READI:
+        bind(instr.arg1, INT);
+        break;
+      case instruction::_FLOAD:
+      case instruction::_FLOAT:
+      case instruction::_FADD:
+      case instruction::_FSUB:
+      case instruction::_FMUL:
+      case instruction::_FDIV:
+      case instruction::_FNEG:
+      case instruction::_READF:
+        bind(instr.arg1, FLOAT);
+        break;
+      case instruction::_CHLOAD:
+      case instruction::_READC:
+        bind(instr.arg1, CHAR);
+        break;
+      case instruction::_EQ:
+      case instruction::_LT:
+      case instruction::_LE:
+      case instruction::_NOT:
+      case instruction::_AND:
+      case instruction::_OR:
+      case instruction::_FEQ:
+      case instruction::_FLT:
+      case instruction::_FLE:
+        bind(instr.arg1, BOOL);
+        break;
+      case instruction::_LOAD:
+        {
+          ValueType type = getTypeOf(instr.arg2);
+          if (type.size > 0)             // %4 = a   (as in _ALOAD)
+            type = addressOf(instr.arg2);
+          bind(instr.arg1, type);
+          break;
+        }
+      case instruction::_LOADX:
+      case instruction::_LOADC:
+        bind(instr.arg1, elemOf(instr.arg2));
+        break;
+      case instruction::_ALOAD:
+        bind(instr.arg1, addressOf(instr.arg2));
+        break;
+      case instruction::_CALL:
+        lastCall = instr.arg1;
+        break;
+      case instruction::_POP:
+        if (functionMap.count(lastCall))
+          bind(instr.arg1, functionMap[lastCall].ret);
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+TCodeTypes::ValueType TCodeTypes::getTypeOf(const std::string & tcodeArg) const {
+  const std::map<std::string, ValueType> & typeMap =
+    isTemporal(tcodeArg) ? tempTypeMap : symbolTypeMap;
+  auto it = typeMap.find(tcodeArg);
+  if (it != typeMap.end())
+    return it->second;
+  return ValueType{"", 0, false};
+}
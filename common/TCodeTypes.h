@@ -0,0 +1,95 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeTypes - Types of the values of the t-code of a program
+//                 of the Asl programming language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+#include "code.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+// using namespace std;
+
+class code;
+class subroutine;
+
+// The types of the functions, params, local vars and temporals of the
+// t-code, for the backends that translate it to C or to assembler
+// (the LLVM one binds its own types): the types of the functions and
+// of the symbols come from the symbol table, and the ones of the
+// temporals are inferred from the instructions that assign them
+class TCodeTypes {
+ public:
+  // type of a value: a scalar, a local array or a pointer to the
+  // elements of an array (an array param or the address of an array)
+  struct ValueType {
+    std::string elem;         // int, float, bool or char ("" if unknown)
+    std::size_t size;         // of a local array (0 otherwise)
+    bool        pointer;
+
+    bool isFloat()   const { return elem == "float" and size == 0 and not pointer; }
+    bool isArray()   const { return size > 0; }
+    bool isPointer() const { return pointer; }
+  };
+  struct FunctionType {
+    ValueType              ret;   // elem "" if it does not return a value
+    std::vector<ValueType> params;
+  };
+
+  TCodeTypes(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
+
+  const FunctionType & getFunctionType(const std::string & funcName) const;
+
+  // bind the types of the params, local vars and temporals of subr
+  void bindSubroutine(const subroutine & subr);
+  // the type of a param, local var or temporal of the bound subroutine
+  ValueType getTypeOf(const std::string & tcodeArg) const;
+  bool      isSymbol(const std::string & tcodeArg) const;
+  const std::map<std::string, ValueType> & getTemporalTypes() const;
+
+  static bool isTemporal(const std::string & tcodeArg);
+
+ private:
+  const TypesMgr & Types;
+  const SymTable & Symbols;
+  const code     & tCode;
+
+  std::map<std::string, FunctionType> functionMap;
+  std::string                         currentFunctionName;
+  std::map<std::string, ValueType>    symbolTypeMap;
+  std::map<std::string, ValueType>    tempTypeMap;
+
+  ValueType TypeIdToValueType(TypesMgr::TypeId tid, bool isParameter = false) const;
+  void bindFunctions();
+  void bindLocalSymbols(const subroutine & subr);
+  void inferTemporalTypes(const subroutine & subr);
+};
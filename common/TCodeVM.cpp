@@ -0,0 +1,581 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeVM - Virtual machine for the t-code of the Asl programming
+//              language, with a baseline JIT for the hot functions
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "TCodeVM.h"
+#include "TCodeJIT.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstdint>
+
+#include <sys/resource.h>   // getrlimit
+
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+// slots of the stack of frames (its memory is not touched until used)
+static const std::size_t STACK_SLOTS = std::size_t(1) << 23;
+
+// bytes of the stack of the host kept free when the calls stop (for
+// the rest of the call, the output and the exit), and the size taken
+// when the stack has no limit
+static const std::size_t HOST_STACK_MARGIN = std::size_t(1) << 18;
+static const std::size_t HOST_STACK_SIZE   = std::size_t(1) << 30;
+
+
+TCodeVM::TCodeVM(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+                 unsigned long jitThreshold, bool profiling) :
+  Types{Types}, Symbols{Symbols}, tCode{tCode},
+  stack{new Slot[STACK_SLOTS]}, stackTop{stack.get()}, stackEnd{stack.get() + STACK_SLOTS},
+  hostStackEnd{0},
+  jitThreshold{jitThreshold}, profiling{profiling}, numCompiled{0}, trace{nullptr} {
+  // the native code does not count
+  if (jitThreshold > 0 and not profiling and TCodeJIT::isAvailable())
+    jit.reset(new TCodeJIT());
+  decodeFunctions();
+}
+
+TCodeVM::~TCodeVM() {
+}
+
+void TCodeVM::setTrace(TraceWriter * trace) {
+  this->trace = trace;
+}
+
+int TCodeVM::run() {
+  auto it = functionIds.find("main");
+  if (it == functionIds.end()) {
+    std::cerr << "There is no function main." << std::endl;
+    return EXIT_FAILURE;
+  }
+  // the calls (interpreted or native) recurse on the stack of the
+  // host, that can grow up to its rlimit from about here
+  std::size_t hostStackSize = HOST_STACK_SIZE;
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_STACK, &limit) == 0 and limit.rlim_cur != RLIM_INFINITY and
+      limit.rlim_cur < hostStackSize)
+    hostStackSize = limit.rlim_cur;
+  char here;
+  hostStackEnd = reinterpret_cast<std::uintptr_t>(&here) -
+                 (hostStackSize - std::min(hostStackSize / 2, HOST_STACK_MARGIN));
+  call(it->second);
+  std::fflush(stdout);
+  return EXIT_SUCCESS;
+}
+
+std::size_t TCodeVM::getNumberOfCompiledFunctions() const {
+  return numCompiled;
+}
+
+// A block begins at the first instruction, at the targets of the jumps
+// and after the jumps and returns
+void TCodeVM::getProfile(TCodeProfile & profile) const {
+  for (auto & func : functions) {
+    TCodeProfile::FunctionCounts & counts = profile.getFunction(func.name);
+    counts.numInstrs = func.numTCodeInstrs;
+    counts.calls = func.calls;
+    counts.blocks.clear();
+    counts.branches.clear();
+    if (not profiling) continue;
+    std::size_t n = func.numTCodeInstrs;
+    std::vector<bool> leader(n + 1, false);
+    leader[0] = true;
+    for (std::size_t pos = 0; pos < n; ++pos) {
+      const Instr & in = func.instrs[pos];
+      if (in.oper == instruction::_UJUMP)
+        leader[in.a1] = true;
+      else if (in.oper == instruction::_FJUMP)
+        leader[in.a2] = true;
+      if (in.oper == instruction::_UJUMP or in.oper == instruction::_FJUMP or
+          in.oper == instruction::_RETURN or in.oper == instruction::_HALT)
+        leader[pos + 1] = true;
+    }
+    for (std::size_t pos = 0; pos < n; ++pos) {
+      if (leader[pos])
+        counts.blocks[pos] = func.counts[pos];
+      if (func.instrs[pos].oper == instruction::_FJUMP)
+        counts.branches[pos] = std::make_pair(func.jumps[pos],
+                                              func.counts[pos] - func.jumps[pos]);
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////
+// Decoding
+
+// The char of a character constant: a (or an escape sequence: \n)
+static int getCharCode(const std::string & s) {
+  if (s.size() < 2 or s[0] != '\\')
+    return static_cast<signed char>(s[0]);
+  switch (s[1]) {
+  case 'b': return '\b';
+  case 't': return '\t';
+  case 'n': return '\n';
+  case 'f': return '\f';
+  case 'r': return '\r';
+  default:  return static_cast<signed char>(s[1]);    // \" \' and '\\'
+  }
+}
+
+// The chars of a string constant ("..." with escape sequences)
+static std::string getStringChars(const std::string & aslString) {
+  std::string chars;
+  for (std::size_t i = 1; i + 1 < aslString.size(); ++i) {
+    if (aslString[i] == '\\' and i + 2 < aslString.size())
+      chars += char(getCharCode(aslString.substr(i++, 2)));
+    else
+      chars += aslString[i];
+  }
+  return chars;
+}
+
+void TCodeVM::decodeFunctions() {
+  const std::vector<subroutine> & subrs = tCode.get_subroutine_list();
+  functions.assign(subrs.size(), Function());
+  for (std::size_t f = 0; f < subrs.size(); ++f)
+    functionIds[subrs[f].get_name()] = f;
+  TCodeTypes ValueTypes(Types, Symbols, tCode);
+  for (std::size_t f = 0; f < subrs.size(); ++f)
+    decodeSubroutine(subrs[f], ValueTypes, functions[f]);
+}
+
+// The frame has the params first (in the order they are pushed), then
+// the local vars (an array takes a slot for each element) and the
+// temporals
+void TCodeVM::decodeSubroutine(const subroutine & subr, TCodeTypes & ValueTypes,
+                               Function & func) {
+  ValueTypes.bindSubroutine(subr);
+  func.name = subr.get_name();
+  func.numTCodeInstrs = subr.get_number_of_instructions();
+  func.calls = 0;
+  func.native = nullptr;
+  func.jitFailed = false;
+  std::map<std::string, int> slots;
+  int numSlots = 0;
+  for (auto & param : subr.params)
+    slots[param.name] = numSlots++;
+  func.numParams = numSlots;
+  for (auto & varlocal : subr.vars) {
+    TCodeTypes::ValueType type = ValueTypes.getTypeOf(varlocal.name);
+    slots[varlocal.name] = numSlots;
+    numSlots += type.isArray() ? type.size : 1;
+  }
+  auto slotOf = [&](const std::string & tcodeArg) -> int {
+    if (tcodeArg.empty()) return -1;
+    auto it = slots.find(tcodeArg);
+    if (it != slots.end()) return it->second;
+    slots[tcodeArg] = numSlots;            // a temporal
+    return numSlots++;
+  };
+  auto isLocalArray = [&](const std::string & tcodeArg) {
+    return not TCodeTypes::isTemporal(tcodeArg) and ValueTypes.getTypeOf(tcodeArg).isArray();
+  };
+  auto isArraySymbol = [&](const std::string & tcodeArg) {
+    if (TCodeTypes::isTemporal(tcodeArg)) return false;
+    TCodeTypes::ValueType type = ValueTypes.getTypeOf(tcodeArg);
+    return type.isArray() or type.isPointer();
+  };
+
+  const instructionList & instrs = subr.get_instructions();
+  std::map<std::string, int> labelPos;
+  for (std::size_t pos = 0; pos < instrs.size(); ++pos)
+    if (instrs[pos].oper == instruction::_LABEL)
+      labelPos[instrs[pos].arg1] = pos;
+
+  func.instrs.clear();
+  for (const instruction & instr : instrs) {
+    Instr in;
+    in.oper = instr.oper;
+    in.a1 = in.a2 = in.a3 = -1;
+    in.value.bits = 0;
+    in.mode = 0;
+    switch (instr.oper) {
+    case instruction::_LABEL:
+      in.oper = instruction::_NOOP;
+      break;
+    case instruction::_UJUMP:
+      in.a1 = labelPos.at(instr.arg1);
+      break;
+    case instruction::_FJUMP:
+      in.a1 = slotOf(instr.arg1);
+      in.a2 = labelPos.at(instr.arg2);
+      break;
+    case instruction::_HALT:
+    case instruction::_WRITES:
+      in.a1 = strings.size();
+      strings.push_back(instr.oper == instruction::_HALT ? instr.arg1
+                                                         : getStringChars(instr.arg1));
+      break;
+    case instruction::_CALL:
+      in.a1 = functionIds.at(instr.arg1);
+      break;
+    case instruction::_PUSH:
+      in.a1 = slotOf(instr.arg1);
+      if (isLocalArray(instr.arg1)) in.mode = ARRAY1;
+      break;
+    case instruction::_LOAD:
+    case instruction::_ALOAD:
+      // in an array copy the elements are copied before
+      if (instr.oper == instruction::_LOAD and isArraySymbol(instr.arg1)) {
+        in.oper = instruction::_NOOP;
+        break;
+      }
+      in.a1 = slotOf(instr.arg1);
+      in.a2 = slotOf(instr.arg2);
+      // &a of an array param is the pointer it holds
+      if (instr.oper == instruction::_ALOAD) {
+        in.oper = instruction::_LOAD;
+        if (not ValueTypes.getTypeOf(instr.arg2).isPointer()) in.mode = ARRAY2;
+      }
+      else if (isLocalArray(instr.arg2))
+        in.mode = ARRAY2;
+      else if (ValueTypes.getTypeOf(instr.arg1).isFloat() and
+               not ValueTypes.getTypeOf(instr.arg2).isFloat() and
+               not ValueTypes.getTypeOf(instr.arg2).elem.empty())
+        in.oper = instruction::_FLOAT;
+      break;
+    case instruction::_ILOAD:
+    case instruction::_CHLOAD:
+      {
+        in.a1 = slotOf(instr.arg1);
+        int n = (instr.oper == instruction::_CHLOAD) ? getCharCode(instr.arg2)
+                                                     : int(std::stoll(instr.arg2));
+        if (ValueTypes.getTypeOf(instr.arg1).isFloat())
+          in.value.f = float(n);
+        else
+          in.value.i = n;
+        in.oper = instruction::_ILOAD;
+        break;
+      }
+    case instruction::_FLOAD:
+      in.a1 = slotOf(instr.arg1);
+      in.value.f = std::strtof(instr.arg2.c_str(), nullptr);
+      in.oper = instruction::_ILOAD;
+      break;
+    case instruction::_LOADX:
+      in.a1 = slotOf(instr.arg1);
+      in.a2 = slotOf(instr.arg2);
+      in.a3 = slotOf(instr.arg3);
+      if (isLocalArray(instr.arg2)) in.mode = ARRAY2;
+      break;
+    case instruction::_XLOAD:
+      in.a1 = slotOf(instr.arg1);
+      in.a2 = slotOf(instr.arg2);
+      in.a3 = slotOf(instr.arg3);
+      if (isLocalArray(instr.arg1)) in.mode = ARRAY1;
+      break;
+    default:
+      in.a1 = slotOf(instr.arg1);
+      in.a2 = slotOf(instr.arg2);
+      in.a3 = slotOf(instr.arg3);
+      break;
+    }
+    func.instrs.push_back(in);
+  }
+  if (func.instrs.empty() or func.instrs.back().oper != instruction::_RETURN) {
+    Instr ret;
+    ret.oper = instruction::_RETURN;
+    ret.a1 = ret.a2 = ret.a3 = -1;
+    ret.value.bits = 0;
+    ret.mode = 0;
+    func.instrs.push_back(ret);
+  }
+  func.frameSize = numSlots;
+  if (profiling) {
+    func.counts.assign(func.instrs.size(), 0);
+    func.jumps.assign(func.instrs.size(), 0);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////
+// Execution
+
+void TCodeVM::pushParam(Slot value) {
+  params.push_back(value);
+}
+
+TCodeVM::Slot TCodeVM::popParam() {
+  assert(not params.empty());
+  Slot value = params.back();
+  params.pop_back();
+  return value;
+}
+
+// The params of the callee are the last ones pushed: they are copied
+// to its frame, and back when it returns (the result is popped from
+// the slot of _result). The stack overflows when the frame does not
+// fit in the stack of frames or the host has no room for a deeper call
+void TCodeVM::call(int f) {
+  Function & func = functions[f];
+  char here;
+  if (func.frameSize > std::size_t(stackEnd - stackTop) or
+      reinterpret_cast<std::uintptr_t>(&here) < hostStackEnd) {
+    std::fflush(stdout);
+    std::cerr << "Stack overflow in function " << func.name << "." << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  assert(params.size() >= func.numParams);
+  Slot * frame = stackTop;
+  stackTop += func.frameSize;
+  std::copy(params.end() - func.numParams, params.end(), frame);
+  std::fill(frame + func.numParams, stackTop, Slot{0});
+  ++func.calls;
+  if (func.native == nullptr and jit and not func.jitFailed and
+      func.calls >= jitThreshold) {
+    TraceWriter::Span span(trace, "jit", func.name);
+    func.native = jit->compile(func);
+    if (func.native != nullptr)
+      ++numCompiled;
+    else
+      func.jitFailed = true;
+  }
+  if (func.native != nullptr) {
+    TraceWriter::Span span(trace, "native", func.name);
+    func.native(frame, this);
+  }
+  else {
+    TraceWriter::Span span(trace, "interpret", func.name);
+    if (profiling)
+      interpret<true>(func, frame);
+    else
+      interpret<false>(func, frame);
+  }
+  std::copy(frame, frame + func.numParams, params.end() - func.numParams);
+  stackTop = frame;
+}
+
+template <bool Profiling>
+void TCodeVM::interpret(Function & func, Slot * frame) {
+  const Instr * instrs = func.instrs.data();
+  const Instr * pc = instrs;
+  for (;;) {
+    if (Profiling) ++func.counts[pc - instrs];
+    const Instr & in = *pc++;
+    switch (in.oper) {
+    case instruction::_UJUMP:
+      pc = instrs + in.a1;
+      break;
+    case instruction::_FJUMP:
+      if (frame[in.a1].i == 0) {
+        if (Profiling) ++func.jumps[pc - 1 - instrs];
+        pc = instrs + in.a2;
+      }
+      break;
+    case instruction::_HALT:
+      halt(in.a1);
+      break;
+    case instruction::_PUSH:
+      {
+        Slot value{0};
+        if (in.mode & ARRAY1)
+          value.p = frame + in.a1;
+        else if (in.a1 >= 0)
+          value = frame[in.a1];
+        pushParam(value);
+        break;
+      }
+    case instruction::_POP:
+      {
+        Slot value = popParam();
+        if (in.a1 >= 0) frame[in.a1] = value;
+        break;
+      }
+    case instruction::_CALL:
+      call(in.a1);
+      break;
+    case instruction::_RETURN:
+      return;
+    case instruction::_ADD:
+      frame[in.a1].i = std::int32_t(std::uint32_t(frame[in.a2].i) + std::uint32_t(frame[in.a3].i));
+      break;
+    case instruction::_SUB:
+      frame[in.a1].i = std::int32_t(std::uint32_t(frame[in.a2].i) - std::uint32_t(frame[in.a3].i));
+      break;
+    case instruction::_MUL:
+      frame[in.a1].i = std::int32_t(std::uint32_t(frame[in.a2].i) * std::uint32_t(frame[in.a3].i));
+      break;
+    case instruction::_DIV:
+      frame[in.a1].i = frame[in.a2].i / frame[in.a3].i;
+      break;
+    case instruction::_EQ:
+      frame[in.a1].i = (frame[in.a2].i == frame[in.a3].i);
+      break;
+    case instruction::_LT:
+      frame[in.a1].i = (frame[in.a2].i < frame[in.a3].i);
+      break;
+    case instruction::_LE:
+      frame[in.a1].i = (frame[in.a2].i <= frame[in.a3].i);
+      break;
+    case instruction::_NEG:
+      frame[in.a1].i = std::int32_t(0u - std::uint32_t(frame[in.a2].i));
+      break;
+    case instruction::_NOT:
+      frame[in.a1].i = (frame[in.a2].i == 0);
+      break;
+    case instruction::_AND:
+      frame[in.a1].i = (frame[in.a2].i != 0 and frame[in.a3].i != 0);
+      break;
+    case instruction::_OR:
+      frame[in.a1].i = (frame[in.a2].i != 0 or frame[in.a3].i != 0);
+      break;
+    case instruction::_FLOAT:
+      frame[in.a1].f = float(frame[in.a2].i);
+      break;
+    case instruction::_FADD:
+      frame[in.a1].f = frame[in.a2].f + frame[in.a3].f;
+      break;
+    case instruction::_FSUB:
+      frame[in.a1].f = frame[in.a2].f - frame[in.a3].f;
+      break;
+    case instruction::_FMUL:
+      frame[in.a1].f = frame[in.a2].f * frame[in.a3].f;
+      break;
+    case instruction::_FDIV:
+      frame[in.a1].f = frame[in.a2].f / frame[in.a3].f;
+      break;
+    case instruction::_FEQ:
+      frame[in.a1].i = (frame[in.a2].f == frame[in.a3].f);
+      break;
+    case instruction::_FLT:
+      frame[in.a1].i = (frame[in.a2].f < frame[in.a3].f);
+      break;
+    case instruction::_FLE:
+      frame[in.a1].i = (frame[in.a2].f <= frame[in.a3].f);
+      break;
+    case instruction::_FNEG:
+      frame[in.a1].f = -frame[in.a2].f;
+      break;
+    case instruction::_LOAD:
+      if (in.mode & ARRAY2)
+        frame[in.a1].p = frame + in.a2;
+      else
+        frame[in.a1] = frame[in.a2];
+      break;
+    case instruction::_ILOAD:
+      frame[in.a1] = in.value;
+      break;
+    case instruction::_LOADX:
+      {
+        Slot * elems = (in.mode & ARRAY2) ? frame + in.a2 : frame[in.a2].p;
+        frame[in.a1] = elems[frame[in.a3].i];
+        break;
+      }
+    case instruction::_XLOAD:
+      {
+        Slot * elems = (in.mode & ARRAY1) ? frame + in.a1 : frame[in.a1].p;
+        elems[frame[in.a2].i] = frame[in.a3];
+        break;
+      }
+    case instruction::_LOADC:
+      frame[in.a1] = *frame[in.a2].p;
+      break;
+    case instruction::_CLOAD:
+      *frame[in.a1].p = frame[in.a2];
+      break;
+    case instruction::_READI:
+      readInt(frame[in.a1]);
+      break;
+    case instruction::_READF:
+      readFloat(frame[in.a1]);
+      break;
+    case instruction::_READC:
+      readChar(frame[in.a1]);
+      break;
+    case instruction::_WRITEI:
+      writeInt(frame[in.a1].i);
+      break;
+    case instruction::_WRITEF:
+      writeFloat(frame[in.a1].f);
+      break;
+    case instruction::_WRITEC:
+      writeChar(frame[in.a1].i);
+      break;
+    case instruction::_WRITES:
+      writeString(in.a1);
+      break;
+    case instruction::_WRITELN:
+      writeChar('\n');
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////
+// Input and output (as printf "%d", "%g" and "%c", and scanf: a
+// failed read leaves the value unchanged). As in the tvm, a char is
+// read after skipping the white space (scanf " %c")
+
+void TCodeVM::readInt(Slot & s) {
+  int n = std::scanf("%d", &s.i);
+  (void)n;
+}
+
+void TCodeVM::readFloat(Slot & s) {
+  int n = std::scanf("%f", &s.f);
+  (void)n;
+}
+
+void TCodeVM::readChar(Slot & s) {
+  char c;
+  if (std::scanf(" %c", &c) == 1)
+    s.i = static_cast<signed char>(c);
+}
+
+void TCodeVM::writeInt(std::int32_t n) {
+  std::printf("%d", n);
+}
+
+void TCodeVM::writeFloat(float f) {
+  std::printf("%g", double(f));
+}
+
+void TCodeVM::writeChar(std::int32_t c) {
+  std::putchar(c);
+}
+
+void TCodeVM::writeString(int str) {
+  std::fwrite(strings[str].data(), 1, strings[str].size(), stdout);
+}
+
+void TCodeVM::halt(int str) {
+  std::fflush(stdout);
+  std::cerr << strings[str] << std::endl;
+  std::exit(EXIT_FAILURE);
+}
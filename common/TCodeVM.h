@@ -0,0 +1,160 @@
+/////////////////////////////////////////////////////////////////
+//
+//    TCodeVM - Virtual machine for the t-code of the Asl programming
+//              language, with a baseline JIT for the hot functions
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+#include "code.h"
+#include "TCodeTypes.h"
+#include "TCodeProfile.h"
+#include "TraceWriter.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+// using namespace std;
+
+class TCodeJIT;
+
+// Execution of the t-code of a program, with the same output as the
+// tvm. Each subroutine is decoded once (the operands become slots of
+// its frame, the labels positions and the callees indexes) and run by
+// an interpreter; once a function has been called jitThreshold times
+// it is translated to native code by TCodeJIT (0 disables the JIT).
+// When profiling, every function is interpreted and the execution
+// counts of its instructions are kept for a TCodeProfile. With a
+// trace, each call and each compilation by the JIT is a span
+class TCodeVM {
+ public:
+  // a value of the t-code: an int (int, bool and char), a float or a
+  // pointer to the elements of an array (each element is a slot)
+  union Slot {
+    std::uint64_t bits;
+    std::int32_t  i;
+    float         f;
+    Slot        * p;
+  };
+
+  // the operand is a local array: its value is the address of its
+  // first slot in the frame
+  static const std::uint8_t ARRAY1 = 1;
+  static const std::uint8_t ARRAY2 = 2;
+
+  // a decoded instruction: the operands are slots of the frame (-1 if
+  // there is none), positions of the instructions for the jumps, the
+  // index of the callee for a call and the index of the string for a
+  // write of a string or a halt. The labels are decoded as NOOP, the
+  // constants as ILOAD and the address of an array as LOAD
+  struct Instr {
+    instruction::Operation oper;
+    int                    a1, a2, a3;
+    Slot                   value;     // of ILOAD
+    std::uint8_t           mode;      // ARRAY1 | ARRAY2
+  };
+
+  typedef void (*NativeCode)(Slot * frame, TCodeVM * vm);
+
+  struct Function {
+    std::string        name;
+    std::size_t        numParams;     // with _result
+    std::size_t        frameSize;     // slots of params, vars and temporals
+    std::vector<Instr> instrs;
+    std::size_t        numTCodeInstrs;
+    unsigned long      calls;
+    NativeCode         native;        // nullptr until it is compiled
+    bool               jitFailed;
+    // when profiling: executions of each instruction, and jumps of
+    // each ifFalse
+    std::vector<std::uint64_t> counts, jumps;
+  };
+
+  TCodeVM(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+          unsigned long jitThreshold, bool profiling = false);
+  ~TCodeVM();
+
+  // trace where a span is added for each call (null: no trace)
+  void setTrace(TraceWriter * trace);
+
+  // run the program (its function main) and return the exit status
+  int run();
+
+  // the counts of the blocks and branches of each function (when
+  // profiling)
+  void getProfile(TCodeProfile & profile) const;
+
+  // the number of functions compiled by the JIT
+  std::size_t getNumberOfCompiledFunctions() const;
+
+  // the operations of the call protocol and the I/O, used by the
+  // interpreter and by the native code
+  void pushParam(Slot value);
+  Slot popParam();
+  void call(int func);
+  void readInt(Slot & s);
+  void readFloat(Slot & s);
+  void readChar(Slot & s);
+  void writeInt(std::int32_t n);
+  void writeFloat(float f);
+  void writeChar(std::int32_t c);
+  void writeString(int str);
+  void halt(int str);
+
+ private:
+  const TypesMgr & Types;
+  const SymTable & Symbols;
+  const code     & tCode;
+
+  std::vector<Function>      functions;
+  std::map<std::string, int> functionIds;
+  std::vector<std::string>   strings;       // of the writes and halts
+
+  // the frames, in a stack that never moves (the pointers to the
+  // local arrays are addresses of its slots)
+  std::unique_ptr<Slot[]> stack;
+  Slot                  * stackTop;
+  Slot                  * stackEnd;
+  std::vector<Slot>       params;           // pushed and not popped
+  // the lowest address of the stack of the host that a call may use
+  std::uintptr_t          hostStackEnd;
+
+  unsigned long             jitThreshold;
+  bool                      profiling;
+  std::unique_ptr<TCodeJIT> jit;
+  std::size_t               numCompiled;
+  TraceWriter             * trace;
+
+  void decodeFunctions();
+  void decodeSubroutine(const subroutine & subr, TCodeTypes & ValueTypes, Function & func);
+  template <bool Profiling>
+  void interpret(Function & func, Slot * frame);
+};
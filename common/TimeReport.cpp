@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TimeReport - Time and memory used by the phases of the
+//                 compiler, and sizes of its data structures
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "TimeReport.h"
+
+#include <fstream>
+#include <iomanip>
+
+#include <ctime>      // std::clock
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+// using namespace std;
+
+
+// Constructor
+TimeReport::TimeReport(bool enabled) :
+  Enabled{enabled}, PhaseStart{0, 0, 0}, Trace{nullptr} {
+}
+
+bool TimeReport::isEnabled() const {
+  return Enabled;
+}
+
+void TimeReport::setTrace(TraceWriter *trace) {
+  Trace = trace;
+}
+
+void TimeReport::startPhase(const std::string & name) {
+  if (not Enabled) return;
+  endPhase();
+  CurrentPhase = name;
+  PhaseStart = now();
+}
+
+void TimeReport::endPhase() {
+  if (not Enabled or CurrentPhase.empty()) return;
+  Sample end = now();
+  Phases.push_back(PhaseTimes{CurrentPhase, end.wall - PhaseStart.wall,
+                              end.cpu - PhaseStart.cpu,
+                              end.rssKB - PhaseStart.rssKB});
+  if (Trace != nullptr) Trace->addSpan("phase", CurrentPhase, PhaseStart.wall, end.wall);
+  CurrentPhase.clear();
+}
+
+void TimeReport::addCount(const std::string & name, std::size_t value) {
+  if (not Enabled) return;
+  for (auto & count : Counts) {
+    if (count.first == name) {
+      count.second = value;
+      return;
+    }
+  }
+  Counts.push_back(std::make_pair(name, value));
+}
+
+void TimeReport::print(std::ostream & os) const {
+  if (not Enabled) return;
+  std::ios::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(4);
+  os << "-- Time report " << std::setw(14) << "wall (s)" << std::setw(12) << "cpu (s)"
+     << std::setw(16) << "rss delta (KB)" << std::endl;
+  double wall = 0, cpu = 0;
+  for (auto & phase : Phases) {
+    os << "   " << std::left << std::setw(18) << phase.name << std::right
+       << std::setw(12) << phase.wall << std::setw(12) << phase.cpu
+       << std::setw(16) << std::showpos << phase.rssDeltaKB << std::noshowpos << std::endl;
+    wall += phase.wall;
+    cpu  += phase.cpu;
+  }
+  os << "   " << std::left << std::setw(18) << "total" << std::right
+     << std::setw(12) << wall << std::setw(12) << cpu
+     << std::setw(16) << peakRssKB() << " (peak rss)" << std::endl;
+  if (not Counts.empty()) {
+    os << "-- Counts" << std::endl;
+    for (auto & count : Counts)
+      os << "   " << std::left << std::setw(18) << count.first << std::right
+         << std::setw(12) << count.second << std::endl;
+  }
+  os.flags(flags);
+}
+
+void TimeReport::printJSON(std::ostream & os) const {
+  if (not Enabled) return;
+  std::ios::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(6);
+  // the names are identifiers chosen by the compiler: no escapes needed
+  os << "{\"phases\": [";
+  double wall = 0, cpu = 0;
+  for (std::size_t i = 0; i < Phases.size(); ++i) {
+    const PhaseTimes & phase = Phases[i];
+    os << (i == 0 ? "" : ", ")
+       << "{\"name\": \"" << phase.name << "\", \"wall\": " << phase.wall
+       << ", \"cpu\": " << phase.cpu << ", \"rssDeltaKB\": " << phase.rssDeltaKB << "}";
+    wall += phase.wall;
+    cpu  += phase.cpu;
+  }
+  os << "], \"total\": {\"wall\": " << wall << ", \"cpu\": " << cpu
+     << ", \"peakRssKB\": " << peakRssKB() << "}, \"counts\": {";
+  for (std::size_t i = 0; i < Counts.size(); ++i)
+    os << (i == 0 ? "" : ", ") << "\"" << Counts[i].first << "\": " << Counts[i].second;
+  os << "}}" << std::endl;
+  os.flags(flags);
+}
+
+TimeReport::Sample TimeReport::now() {
+  Sample s;
+  s.wall = TraceWriter::now();
+  s.cpu  = double(std::clock()) / CLOCKS_PER_SEC;
+  // the second field of statm is the number of resident pages
+  long size = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  if (statm >> size >> resident) s.rssKB = resident * (sysconf(_SC_PAGESIZE) / 1024);
+  else                           s.rssKB = 0;
+  return s;
+}
+
+long TimeReport::peakRssKB() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_maxrss;
+}
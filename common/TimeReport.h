@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TimeReport - Time and memory used by the phases of the
+//                 compiler, and sizes of its data structures
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TraceWriter.h"
+
+#include <string>
+#include <vector>
+#include <utility>    // std::pair
+#include <ostream>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TimeReport: measures the wall time, the CPU time and the
+// change of the resident memory (RSS) of each phase of a compilation,
+// and keeps a list of named counts (tokens, nodes, types, ...).
+// The phases are consecutive: starting a phase ends the previous one.
+// A disabled report does nothing, so the compiler can call it
+// unconditionally. The phases can also be written to a trace.
+
+class TimeReport {
+
+public:
+
+  // Constructor (a report that is not enabled ignores all the calls)
+  TimeReport(bool enabled);
+
+  // Is the report enabled?
+  bool isEnabled () const;
+
+  // Trace where a span is added for each phase (null: no trace)
+  void setTrace (TraceWriter *trace);
+
+  // End the current phase (if any) and start the phase name
+  void startPhase (const std::string & name);
+  // End the current phase (if any)
+  void endPhase   ();
+
+  // Record the count name (a later count with the same name replaces it)
+  void addCount (const std::string & name, std::size_t value);
+
+  // Write the report as a table, or as a JSON object
+  void print     (std::ostream & os) const;
+  void printJSON (std::ostream & os) const;
+
+private:
+
+  // The clocks and the resident memory at one point
+  struct Sample {
+    double wall;      // seconds
+    double cpu;       // seconds of CPU of the process
+    long   rssKB;     // resident memory
+  };
+
+  // What a phase used
+  struct PhaseTimes {
+    std::string name;
+    double      wall;
+    double      cpu;
+    long        rssDeltaKB;
+  };
+
+  // Attributes
+  bool                                             Enabled;
+  Sample                                           PhaseStart;
+  std::string                                      CurrentPhase;
+  TraceWriter                                    * Trace;
+  std::vector<PhaseTimes>                          Phases;
+  std::vector<std::pair<std::string, std::size_t>> Counts;
+
+  static Sample now ();
+  // Peak resident memory of the process
+  static long peakRssKB ();
+
+};  // class TimeReport
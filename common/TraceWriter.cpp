@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TraceWriter - Write the spans of a compilation in the Chrome
+//                  trace event format
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "TraceWriter.h"
+
+#include <chrono>
+#include <cstdio>     // std::snprintf
+
+#include <unistd.h>   // getpid
+
+// using namespace std;
+
+
+// Constructor
+TraceWriter::TraceWriter(const std::string & path) :
+  File(path, std::ofstream::out | std::ofstream::trunc),
+  FirstEvent{true}, Origin{now()} {
+  if (File) File << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+}
+
+// Destructor
+TraceWriter::~TraceWriter() {
+  if (File) File << "\n]}" << std::endl;
+}
+
+bool TraceWriter::isOpen() const {
+  return bool(File);
+}
+
+void TraceWriter::addSpan(const std::string & cat, const std::string & name,
+                          double start, double end) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  if (not File) return;
+  // small thread numbers, in order of appearance (the main thread is 1)
+  auto tid = ThreadIds.insert(std::make_pair(std::this_thread::get_id(),
+                                             int(ThreadIds.size()) + 1)).first->second;
+  // timestamps and durations are in microseconds
+  char times[96];
+  std::snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f",
+                (start - Origin) * 1e6, (end - start) * 1e6);
+  File << (FirstEvent ? "\n" : ",\n") << "{\"name\": ";
+  writeString(name);
+  File << ", \"cat\": ";
+  writeString(cat);
+  File << ", \"ph\": \"X\", " << times
+       << ", \"pid\": " << getpid() << ", \"tid\": " << tid << "}";
+  FirstEvent = false;
+}
+
+double TraceWriter::now() {
+  return std::chrono::duration<double>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceWriter::writeString(const std::string & s) {
+  File << '"';
+  for (char c : s) {
+    if (c == '"' or c == '\\') File << '\\' << c;
+    else if ((unsigned char) c < 0x20) {
+      char esc[8];
+      std::snprintf(esc, sizeof(esc), "\\u%04x", (unsigned int) c);
+      File << esc;
+    }
+    else File << c;
+  }
+  File << '"';
+}
+
+
+////////////////////////////////////////////////////////////////
+// Span class
+
+TraceWriter::Span::Span(TraceWriter *trace, const char *cat, const std::string & name) :
+  Trace{trace}, Cat{cat}, Name{}, Start{0} {
+  if (Trace == nullptr) return;
+  Name  = name;
+  Start = now();
+}
+
+TraceWriter::Span::~Span() {
+  if (Trace != nullptr) Trace->addSpan(Cat, Name, Start, now());
+}
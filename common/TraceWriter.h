@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    TraceWriter - Write the spans of a compilation in the Chrome
+//                  trace event format
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TraceWriter: writes a JSON file in the Chrome trace event
+// format (the one of chrome://tracing and Perfetto) with a complete
+// event ("ph": "X") for each span: the phases of the compiler and
+// each function visited by each visitor. The events are written as
+// the spans end, and the threads of the parallel typecheck can add
+// spans at the same time (each one gets its own track).
+
+class TraceWriter {
+
+public:
+
+  // Constructor: creates the file path (see isOpen)
+  TraceWriter(const std::string & path);
+  // Destructor: closes the file
+  ~TraceWriter();
+
+  // Could the file be created?
+  bool isOpen () const;
+
+  // Add a span of the category cat. The times are the ones of now()
+  void addSpan (const std::string & cat, const std::string & name,
+                double start, double end);
+
+  // Seconds of a steady clock (the times of the spans)
+  static double now ();
+
+  //////////////////////////////////////////////////////////////////////
+  // Class Span: adds a span from its construction to its destruction.
+  // A span of a null TraceWriter does nothing
+  class Span {
+  public:
+    Span (TraceWriter *trace, const char *cat, const std::string & name);
+    ~Span ();
+    Span (const Span &) = delete;
+    Span & operator= (const Span &) = delete;
+  private:
+    TraceWriter *Trace;
+    const char  *Cat;
+    std::string  Name;
+    double       Start;
+  };  // class Span
+
+private:
+
+  // Attributes
+  std::mutex                       Mutex;
+  std::ofstream                    File;
+  bool                             FirstEvent;
+  double                           Origin;
+  std::map<std::thread::id, int>   ThreadIds;
+
+  // Write s as a JSON string
+  void writeString (const std::string & s);
+
+};  // class TraceWriter
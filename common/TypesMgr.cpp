@@ -30,8 +30,10 @@
 #include "TypesMgr.h"
 
 #include <vector>
+#include <map>
 #include <string>
 #include <iostream>
+#include <utility>    // std::pair, std::make_pair, std::move
 
 #include <cstddef>    // std::size_t
 // uncomment to disable assert()
@@ -87,13 +89,23 @@ TypesMgr::TypeId TypesMgr::createVoidTy() {
 
 TypesMgr::TypeId TypesMgr::createFunctionTy(const std::vector<TypeId> & paramsTypes,
 					    TypeId returnType) {
+  auto key = std::make_pair(paramsTypes, returnType);
+  auto it = FunctionTypes.find(key);
+  if (it != FunctionTypes.end())
+    return it->second;
   TypesVec.push_back(Type(paramsTypes, returnType));
+  FunctionTypes.emplace(std::move(key), TypesVec.size()-1);
   return TypesVec.size()-1;
 }
 
 TypesMgr::TypeId TypesMgr::createArrayTy(unsigned int size,
 					 TypeId elemType) {
+  auto key = std::make_pair(size, elemType);
+  auto it = ArrayTypes.find(key);
+  if (it != ArrayTypes.end())
+    return it->second;
   TypesVec.push_back(Type{size, elemType});
+  ArrayTypes.emplace(key, TypesVec.size()-1);
   return TypesVec.size()-1;
 }
 
@@ -206,38 +218,9 @@ TypesMgr::TypeId TypesMgr::getArrayElemType(TypeId tid) const {
 // methods for checking different compatibilities of Types
 
 bool TypesMgr::equalTypes(TypeId tid1, TypeId tid2) const {
-  if (tid1 == tid2)
-    return true;
-  const Type & t1 = TypesVec.at(tid1);
-  const Type & t2 = TypesVec.at(tid2);
-  if (t1.getTypeKind() != t2.getTypeKind())
-    return false;
-  if (t1.isPrimitiveTy() and t2.isPrimitiveTy())
-    return true;
-  if (t1.isFunctionTy()) {  // or: if (t2.isFunctionTy()) {
-    if (t1.getNumOfParameters() != t2.getNumOfParameters())
-      return false;
-    TypeId tid1_aux;
-    TypeId tid2_aux;
-    for (unsigned int i = 0; i < t1.getNumOfParameters(); ++i) {
-      tid1_aux = t1.getParameterType(i);
-      tid2_aux = t2.getParameterType(i);
-      if (not equalTypes(tid1_aux, tid2_aux))
-	return false;
-    }
-    tid1_aux = t1.getFuncReturnType();
-    tid2_aux = t2.getFuncReturnType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  if (t1.isArrayTy()) {  // or: if (t2.isArrayTy()) {
-    if (t1.getArraySize() != t2.getArraySize()) {
-      return false;
-    }
-    TypeId tid1_aux = t1.getArrayElemType();
-    TypeId tid2_aux = t2.getArrayElemType();
-    return equalTypes(tid1_aux, tid2_aux);
-  }
-  return false;
+  // compound types are hash-consed, so structurally equal types
+  // have the same TypeId
+  return tid1 == tid2;
 }
 
 bool TypesMgr::comparableTypes(TypeId tid1, TypeId tid2,
@@ -255,7 +238,7 @@ bool TypesMgr::comparableTypes(TypeId tid1, TypeId tid2,
 }
 
 bool TypesMgr::copyableTypes(TypeId tid1, TypeId tid2) const {
-  if (equalTypes(tid1, tid2))
+  if (tid1 == tid2)
     return true;
   if (isFloatTy(tid1) and isIntegerTy(tid2))
     return true;
@@ -275,6 +258,10 @@ std::size_t TypesMgr::getSizeOfType (TypeId tid) const {
   return 0;
 }
 
+std::size_t TypesMgr::getNumberOfTypes () const {
+  return TypesVec.size();
+}
+
 // ----------------------------------------------------------------------
 // methods to convert to string and print types
 
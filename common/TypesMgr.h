@@ -29,8 +29,10 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <string>
 #include <iostream>
+#include <utility>    // std::pair
 
 #include <cstddef>    // std::size_t
 
@@ -46,6 +48,8 @@
 // integer, float, boolean, character and void. Also it
 // recognizes two compound types: functions and fixed-size
 // arrays. Finally there exist a special type 'error'.
+// Compound types are hash-consed: structurally equal types are
+// created only once, so they always share the same TypeId.
 
 class TypesMgr {
 
@@ -98,7 +102,7 @@ public:
   TypeId       getArrayElemType (TypeId tid) const;
 
   // Methods to check different compatibilities of types
-  //   - structurally equal?
+  //   - structurally equal? (the same TypeId, as types are unique)
   bool equalTypes      (TypeId tid1, TypeId tid2)     const;
   //   - comparable with the relational operator op?
   bool comparableTypes (TypeId tid1, TypeId tid2,
@@ -109,6 +113,9 @@ public:
   // Method to compute the size of a type (primitive type size = 1)
   std::size_t getSizeOfType (TypeId tid) const;
 
+  // Number of different types created
+  std::size_t getNumberOfTypes () const;
+
   // Methods to convert to string and print types.
   std::string to_string (TypeId tidm) const;
   void        dump      (TypeId         tid,
@@ -124,6 +131,10 @@ private:
   // Attributes:
   //   - vector to save the Types
   std::vector<Type> TypesVec;
+  //   - maps from the structure of the compound types already
+  //     created to their TypeId's
+  std::map<std::pair<std::vector<TypeId>, TypeId>, TypeId> FunctionTypes;
+  std::map<std::pair<unsigned int, TypeId>, TypeId>        ArrayTypes;
 
   // There are eight kinds of types:
   //   - an especial kind error,
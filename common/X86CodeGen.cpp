@@ -0,0 +1,1387 @@
+/////////////////////////////////////////////////////////////////
+//
+//    X86CodeGen - x86-64 assembler generation for the Asl programming
+//                 language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "X86CodeGen.h"
+
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+// uncomment to disable assert()
+// #define NDEBUG
+#include <cassert>
+
+// using namespace std;
+
+
+// The allocatable registers: the caller-saved ones first, that are
+// preferred for the values that do not live across a call. %rax, %rdx
+// and %r11 (and %xmm14-15) are the scratch registers of the
+// instructions, and %rbp is the frame pointer
+static const char * const GPR_NAMES64[] = {
+  "%rsi", "%rdi", "%rcx", "%r8",  "%r9",  "%r10",
+  "%rbx", "%r12", "%r13", "%r14", "%r15"
+};
+static const char * const GPR_NAMES32[] = {
+  "%esi", "%edi", "%ecx", "%r8d", "%r9d", "%r10d",
+  "%ebx", "%r12d", "%r13d", "%r14d", "%r15d"
+};
+static const int NUM_CALLER_SAVED = 6;
+static const int NUM_GPR          = 11;
+static const int NUM_XMM          = 14;
+
+// registers of the params (System V ABI)
+static const char * const ARG_GPR64[] = { "%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9" };
+static const char * const ARG_GPR32[] = { "%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d" };
+static const int NUM_ARG_GPR = 6;
+static const int NUM_ARG_XMM = 8;
+
+static const int ELEM_SIZE = 4;
+
+static int getCharCode(const std::string & s);
+
+
+X86CodeGen::X86CodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode) :
+  Types{Types}, Symbols{Symbols}, tCode{tCode}, ValueTypes{Types, Symbols, tCode},
+  framePointer{true}, frameSize{0}, scratchOffset{0}, fnegMask{false} {
+}
+
+std::string X86CodeGen::dumpX86() {
+  std::ostringstream x86Code;
+  x86Code << "# x86-64 code generated by asl:\n"
+          << "#   as <file>.s -o <file>.o && cc <file>.o runtime/aslrt.c -lm\n\n"
+          << "\t.text\n";
+  strings.clear();
+  fnegMask = false;
+  for (auto & subr : tCode.get_subroutine_list())
+    dumpSubroutine(subr, x86Code);
+  dumpData(x86Code);
+  return x86Code.str();
+}
+
+
+////////////////////////////////////////////////////////////////
+// Values
+
+bool X86CodeGen::isLocalArray(const std::string & tcodeArg) const {
+  return arrayOffsets.count(tcodeArg) > 0;
+}
+
+int X86CodeGen::getValueId(const std::string & tcodeArg) const {
+  auto it = valueIds.find(tcodeArg);
+  return it == valueIds.end() ? -1 : it->second;
+}
+
+X86CodeGen::ValueClass X86CodeGen::getClassOf(const TCodeTypes::ValueType & type) const {
+  if (type.isPointer() or type.isArray())
+    return POINTER;
+  else if (type.isFloat())
+    return FLOAT32;
+  else
+    return INT32;
+}
+
+void X86CodeGen::bindValues(const subroutine & subr) {
+  currentFunctionName = subr.get_name();
+  ValueTypes.bindSubroutine(subr);
+  valueNames.clear();
+  valueIds.clear();
+  valueClasses.clear();
+  arrayOffsets.clear();
+  auto addValue = [&](const std::string & name, const TCodeTypes::ValueType & type) {
+    valueIds[name] = valueNames.size();
+    valueNames.push_back(name);
+    valueClasses.push_back(getClassOf(type));
+  };
+  for (auto & param : subr.params)
+    addValue(param.name, ValueTypes.getTypeOf(param.name));
+  for (auto & varlocal : subr.vars) {
+    TCodeTypes::ValueType type = ValueTypes.getTypeOf(varlocal.name);
+    if (type.isArray())
+      arrayOffsets[varlocal.name] = 0;
+    else
+      addValue(varlocal.name, type);
+  }
+  for (auto & pair : ValueTypes.getTemporalTypes())
+    addValue(pair.first, pair.second);
+}
+
+void X86CodeGen::computeCallSites(const subroutine & subr) {
+  callSites.clear();
+  callPositions.clear();
+  struct PendingCall {
+    CallSite    site;
+    std::size_t pops;
+  };
+  std::vector<std::string> pushedParams;
+  std::vector<PendingCall> pendingCalls;
+  const instructionList & instrs = subr.get_instructions();
+  for (std::size_t pos = 0; pos < instrs.size(); ++pos) {
+    const instruction & instr = instrs[pos];
+    switch (instr.oper) {
+    case instruction::_PUSH:
+      pushedParams.push_back(instr.arg1);
+      break;
+    case instruction::_CALL:
+      {
+        // the params of the callee (with the slot of the result) are
+        // the last ones pushed
+        PendingCall call;
+        call.site.func = instr.arg1;
+        call.pops = tCode.get_subroutine(instr.arg1).params.size();
+        assert(pushedParams.size() >= call.pops);
+        auto first = pushedParams.end() - call.pops;
+        if (not ValueTypes.getFunctionType(instr.arg1).ret.elem.empty())
+          ++first;
+        call.site.args.assign(first, pushedParams.end());
+        pushedParams.erase(pushedParams.end() - call.pops, pushedParams.end());
+        if (call.pops == 0)
+          callSites[pos] = call.site;
+        else
+          pendingCalls.push_back(call);
+        break;
+      }
+    case instruction::_POP:
+      {
+        // the result is the last one popped
+        if (pendingCalls.empty()) break;
+        PendingCall & call = pendingCalls.back();
+        if (not instr.arg1.empty())
+          call.site.result = instr.arg1;
+        if (--call.pops == 0) {
+          callSites[pos] = call.site;
+          pendingCalls.pop_back();
+        }
+        break;
+      }
+    case instruction::_READI:
+    case instruction::_READF:
+    case instruction::_READC:
+    case instruction::_WRITEI:
+    case instruction::_WRITEF:
+    case instruction::_WRITEC:
+    case instruction::_WRITES:
+    case instruction::_WRITELN:
+    case instruction::_HALT:
+      callPositions.push_back(pos);
+      break;
+    default:
+      break;
+    }
+  }
+  for (auto & pair : callSites)
+    callPositions.push_back(pair.first);
+  std::sort(callPositions.begin(), callPositions.end());
+}
+
+void X86CodeGen::computeUsesDefs(const subroutine & subr) {
+  const instructionList & instrs = subr.get_instructions();
+  instrUses.assign(instrs.size(), std::vector<int>());
+  instrDefs.assign(instrs.size(), std::vector<int>());
+  useCounts.assign(valueNames.size(), 0);
+  copyHints.assign(valueNames.size(), -1);
+  regHints.assign(valueNames.size(), -1);
+  for (std::size_t pos = 0; pos < instrs.size(); ++pos) {
+    const instruction & instr = instrs[pos];
+    std::vector<int> & uses = instrUses[pos];
+    std::vector<int> & defs = instrDefs[pos];
+    auto use = [&](const std::string & tcodeArg) {
+      int v = getValueId(tcodeArg);
+      if (v >= 0) {
+        uses.push_back(v);
+        ++useCounts[v];
+      }
+    };
+    auto def = [&](const std::string & tcodeArg) {
+      int v = getValueId(tcodeArg);
+      if (v >= 0) defs.push_back(v);
+    };
+    switch (instr.oper) {
+    case instruction::_LOAD:
+      // in an array copy the elements are copied before
+      if (isLocalArray(instr.arg1) or
+          (not TCodeTypes::isTemporal(instr.arg1) and
+           ValueTypes.getTypeOf(instr.arg1).isPointer()))
+        break;
+      use(instr.arg2);
+      def(instr.arg1);
+      if (getValueId(instr.arg1) >= 0 and getValueId(instr.arg2) >= 0)
+        copyHints[getValueId(instr.arg1)] = getValueId(instr.arg2);
+      break;
+    case instruction::_ILOAD:
+    case instruction::_FLOAD:
+    case instruction::_CHLOAD:
+    case instruction::_READI:
+    case instruction::_READF:
+    case instruction::_READC:
+      def(instr.arg1);
+      break;
+    case instruction::_ADD:
+    case instruction::_SUB:
+    case instruction::_MUL:
+    case instruction::_DIV:
+    case instruction::_EQ:
+    case instruction::_LT:
+    case instruction::_LE:
+    case instruction::_AND:
+    case instruction::_OR:
+    case instruction::_FADD:
+    case instruction::_FSUB:
+    case instruction::_FMUL:
+    case instruction::_FDIV:
+    case instruction::_FEQ:
+    case instruction::_FLT:
+    case instruction::_FLE:
+    case instruction::_LOADX:
+      use(instr.arg2);
+      use(instr.arg3);
+      def(instr.arg1);
+      break;
+    case instruction::_NOT:
+    case instruction::_NEG:
+    case instruction::_FNEG:
+    case instruction::_FLOAT:
+    case instruction::_ALOAD:
+    case instruction::_LOADC:
+      use(instr.arg2);
+      def(instr.arg1);
+      break;
+    case instruction::_XLOAD:
+      use(instr.arg1);
+      use(instr.arg2);
+      use(instr.arg3);
+      break;
+    case instruction::_CLOAD:
+      use(instr.arg1);
+      use(instr.arg2);
+      break;
+    case instruction::_FJUMP:
+    case instruction::_WRITEI:
+    case instruction::_WRITEF:
+    case instruction::_WRITEC:
+      use(instr.arg1);
+      break;
+    case instruction::_RETURN:
+      use("_result");
+      break;
+    case instruction::_CALL:
+    case instruction::_POP:
+      {
+        auto it = callSites.find(pos);
+        if (it == callSites.end()) break;
+        const TCodeTypes::FunctionType & func = ValueTypes.getFunctionType(it->second.func);
+        int nGPR = 0, nXMM = 0;
+        for (std::size_t i = 0; i < it->second.args.size(); ++i) {
+          const std::string & arg = it->second.args[i];
+          use(arg);
+          int v = getValueId(arg);
+          bool isFloat = (i < func.params.size() and func.params[i].isFloat());
+          int reg = -1;
+          if (isFloat and nXMM < NUM_ARG_XMM)
+            reg = nXMM++;
+          else if (not isFloat and nGPR < NUM_ARG_GPR) {
+            const char * name = ARG_GPR64[nGPR++];
+            for (int r = 0; r < NUM_CALLER_SAVED; ++r)
+              if (std::strcmp(GPR_NAMES64[r], name) == 0) reg = r;
+          }
+          if (v >= 0 and regHints[v] < 0) regHints[v] = reg;
+        }
+        def(it->second.result);
+        break;
+      }
+    default:
+      break;
+    }
+  }
+}
+
+
+// The temporals assigned once, with an ILOAD or a CHLOAD of an
+// integer, are constants: they are immediate operands where they are
+// used, and they get no live interval
+void X86CodeGen::findConstants(const subroutine & subr) {
+  const instructionList & instrs = subr.get_instructions();
+  constants.clear();
+  std::vector<int> defCounts(valueNames.size(), 0);
+  for (auto & defs : instrDefs)
+    for (int v : defs) ++defCounts[v];
+  for (std::size_t pos = 0; pos < instrs.size(); ++pos) {
+    const instruction & instr = instrs[pos];
+    if (instr.oper != instruction::_ILOAD and instr.oper != instruction::_CHLOAD) continue;
+    int v = getValueId(instr.arg1);
+    if (v < 0 or defCounts[v] != 1 or valueClasses[v] != INT32 or
+        not TCodeTypes::isTemporal(instr.arg1))
+      continue;
+    constants[v] = (instr.oper == instruction::_CHLOAD) ? getCharCode(instr.arg2)
+                                                         : std::int32_t(std::stoll(instr.arg2));
+  }
+  if (constants.empty()) return;
+  auto isConstant = [&](int v) { return constants.count(v) > 0; };
+  for (auto & uses : instrUses)
+    uses.erase(std::remove_if(uses.begin(), uses.end(), isConstant), uses.end());
+  for (auto & defs : instrDefs)
+    defs.erase(std::remove_if(defs.begin(), defs.end(), isConstant), defs.end());
+}
+
+
+////////////////////////////////////////////////////////////////
+// Live intervals and register allocation
+
+// The live interval of a value goes from the first to the last
+// position where it is live (a value live at the beginning or at the
+// end of a basic block is live in all of it)
+std::vector<X86CodeGen::Interval> X86CodeGen::computeIntervals(const subroutine & subr) {
+  const instructionList & instrs = subr.get_instructions();
+  std::size_t n = instrs.size();
+  std::size_t nValues = valueNames.size();
+  std::size_t words = (nValues + 63) / 64;
+  typedef std::vector<std::uint64_t> BitSet;
+
+  // the basic blocks of the t-code
+  std::map<std::string, std::size_t> labelPos;
+  std::vector<bool> leader(n + 1, false);
+  leader[0] = true;
+  for (std::size_t pos = 0; pos < n; ++pos) {
+    const instruction & instr = instrs[pos];
+    if (instr.oper == instruction::_LABEL) {
+      labelPos[instr.arg1] = pos;
+      leader[pos] = true;
+    }
+    else if (instr.oper == instruction::_UJUMP or instr.oper == instruction::_FJUMP or
+             instr.oper == instruction::_RETURN or instr.oper == instruction::_HALT)
+      leader[pos + 1] = true;
+  }
+  struct Block {
+    std::size_t begin, end;
+    std::vector<std::size_t> succs;
+    BitSet use, def, liveIn, liveOut;
+  };
+  std::vector<Block> blocks;
+  std::vector<std::size_t> blockOf(n + 1, 0);
+  for (std::size_t pos = 0; pos < n; ++pos) {
+    if (leader[pos]) {
+      blocks.push_back(Block{pos, pos, {}, BitSet(words, 0), BitSet(words, 0),
+                             BitSet(words, 0), BitSet(words, 0)});
+    }
+    blocks.back().end = pos + 1;
+    blockOf[pos] = blocks.size() - 1;
+  }
+  for (std::size_t b = 0; b < blocks.size(); ++b) {
+    Block & block = blocks[b];
+    const instruction & last = instrs[block.end - 1];
+    if (last.oper == instruction::_UJUMP or last.oper == instruction::_FJUMP)
+      block.succs.push_back(blockOf[labelPos.at(last.oper == instruction::_UJUMP ? last.arg1 : last.arg2)]);
+    if (last.oper != instruction::_UJUMP and last.oper != instruction::_RETURN and
+        last.oper != instruction::_HALT and b + 1 < blocks.size())
+      block.succs.push_back(b + 1);
+    for (std::size_t pos = block.begin; pos < block.end; ++pos) {
+      for (int v : instrUses[pos])
+        if (not (block.def[v / 64] >> (v % 64) & 1))
+          block.use[v / 64] |= std::uint64_t(1) << (v % 64);
+      for (int v : instrDefs[pos])
+        block.def[v / 64] |= std::uint64_t(1) << (v % 64);
+    }
+  }
+
+  // liveness: liveIn = use + (liveOut - def)
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (std::size_t b = blocks.size(); b-- > 0; ) {
+      Block & block = blocks[b];
+      for (std::size_t w = 0; w < words; ++w) {
+        std::uint64_t out = 0;
+        for (std::size_t s : block.succs)
+          out |= blocks[s].liveIn[w];
+        std::uint64_t in = block.use[w] | (out & ~block.def[w]);
+        if (out != block.liveOut[w] or in != block.liveIn[w]) {
+          block.liveOut[w] = out;
+          block.liveIn[w] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // the values live after a call (or a read or a write) that it does
+  // not define live across it
+  std::vector<bool> crossesCall(nValues, false);
+  for (auto & block : blocks) {
+    BitSet live = block.liveOut;
+    for (std::size_t pos = block.end; pos-- > block.begin; ) {
+      for (int v : instrDefs[pos])
+        live[v / 64] &= ~(std::uint64_t(1) << (v % 64));
+      if (std::binary_search(callPositions.begin(), callPositions.end(), pos))
+        for (std::size_t v = 0; v < nValues; ++v)
+          if (live[v / 64] >> (v % 64) & 1) crossesCall[v] = true;
+      for (int v : instrUses[pos])
+        live[v / 64] |= std::uint64_t(1) << (v % 64);
+    }
+  }
+
+  std::vector<int> starts(nValues, INT_MAX), ends(nValues, -1);
+  auto extend = [&](int v, int pos) {
+    starts[v] = std::min(starts[v], pos);
+    ends[v]   = std::max(ends[v], pos);
+  };
+  // the values live at the entry are set by the prologue (before the
+  // first instruction)
+  liveAtEntry.assign(nValues, false);
+  if (not blocks.empty())
+    for (std::size_t v = 0; v < nValues; ++v)
+      if (blocks[0].liveIn[v / 64] >> (v % 64) & 1) {
+        liveAtEntry[v] = true;
+        extend(v, -1);
+      }
+  for (auto & block : blocks) {
+    for (std::size_t v = 0; v < nValues; ++v) {
+      if (block.liveIn[v / 64] >> (v % 64) & 1)  extend(v, block.begin);
+      if (block.liveOut[v / 64] >> (v % 64) & 1) extend(v, block.end - 1);
+    }
+    for (std::size_t pos = block.begin; pos < block.end; ++pos) {
+      for (int v : instrUses[pos]) extend(v, pos);
+      for (int v : instrDefs[pos]) extend(v, pos);
+    }
+  }
+  std::vector<Interval> intervals;
+  intervalEnds.assign(nValues, -1);
+  for (std::size_t v = 0; v < nValues; ++v) {
+    if (ends[v] < 0) continue;
+    intervals.push_back(Interval{int(v), starts[v], ends[v], crossesCall[v]});
+    intervalEnds[v] = ends[v];
+  }
+  return intervals;
+}
+
+// Linear scan: the intervals are visited in the order of their starts,
+// and each one gets a free register of its class. The values that
+// live across a call get a callee-saved register (there are no
+// callee-saved xmm registers: the floats go to the frame). When there
+// is no free register, the interval that ends last is spilled
+void X86CodeGen::allocateRegisters(std::vector<Interval> & intervals) {
+  locations.assign(valueNames.size(), Location{Location::NONE, 0, 0});
+  std::sort(intervals.begin(), intervals.end(),
+            [](const Interval & a, const Interval & b) {
+              return a.start < b.start or (a.start == b.start and a.value < b.value);
+            });
+  std::vector<int> gprOwner(NUM_GPR, -1), xmmOwner(NUM_XMM, -1);
+  std::vector<bool> gprUsed(NUM_GPR, false);
+  std::vector<const Interval *> active;
+  auto spill = [&](int v) {
+    locations[v] = Location{Location::STACK, 0, 0};
+  };
+  for (auto & cur : intervals) {
+    // the registers of the intervals that have ended are free (an
+    // instruction reads its operands before writing its result)
+    for (auto it = active.begin(); it != active.end(); ) {
+      if ((*it)->end <= cur.start) {
+        const Location & loc = locations[(*it)->value];
+        if (loc.kind == Location::GPR) gprOwner[loc.reg] = -1;
+        if (loc.kind == Location::XMM) xmmOwner[loc.reg] = -1;
+        it = active.erase(it);
+      }
+      else
+        ++it;
+    }
+    bool isFloat = (valueClasses[cur.value] == FLOAT32);
+    if (isFloat and cur.crossesCall) {
+      spill(cur.value);
+      continue;
+    }
+    int first = (isFloat or not cur.crossesCall) ? 0 : NUM_CALLER_SAVED;
+    int last  = isFloat ? NUM_XMM : NUM_GPR;
+    std::vector<int> & owner = isFloat ? xmmOwner : gprOwner;
+    auto isFree = [&](int r) { return r >= first and r < last and owner[r] < 0; };
+    Location::Kind kind = isFloat ? Location::XMM : Location::GPR;
+    int copy = copyHints[cur.value];
+    int reg = -1;
+    if (copy >= 0 and locations[copy].kind == kind and isFree(locations[copy].reg))
+      reg = locations[copy].reg;
+    else if (regHints[cur.value] >= 0 and isFree(regHints[cur.value]))
+      reg = regHints[cur.value];
+    for (int r = first; r < last and reg < 0; ++r)
+      if (owner[r] < 0) reg = r;
+    if (reg < 0) {
+      // the active interval (with a register valid for cur) that ends last
+      const Interval *victim = nullptr;
+      for (auto a : active) {
+        const Location & loc = locations[a->value];
+        if (loc.kind != (isFloat ? Location::XMM : Location::GPR) or loc.reg < first) continue;
+        if (victim == nullptr or a->end > victim->end) victim = a;
+      }
+      if (victim == nullptr or victim->end <= cur.end) {
+        spill(cur.value);
+        continue;
+      }
+      reg = locations[victim->value].reg;
+      spill(victim->value);
+      active.erase(std::find(active.begin(), active.end(), victim));
+    }
+    owner[reg] = cur.value;
+    locations[cur.value] = Location{isFloat ? Location::XMM : Location::GPR, reg, 0};
+    if (not isFloat) gprUsed[reg] = true;
+    active.push_back(&cur);
+  }
+  for (auto & pair : constants)
+    locations[pair.first] = Location{Location::IMM, 0, pair.second};
+  savedRegs.clear();
+  for (int r = NUM_CALLER_SAVED; r < NUM_GPR; ++r)
+    if (gprUsed[r]) savedRegs.push_back(r);
+}
+
+// The frame: the callee-saved registers, the spilled values and the
+// local arrays, and a slot for the reads; the size keeps %rsp aligned
+// to 16 bytes at the calls. A function that needs no slot (and has no
+// params in the stack) has no frame pointer: its frame is only the
+// callee-saved registers
+void X86CodeGen::layoutFrame(const subroutine & subr) {
+  bool needsSlots = not arrayOffsets.empty();
+  for (auto & instr : subr.get_instructions())
+    if (instr.oper == instruction::_READI or instr.oper == instruction::_READF or
+        instr.oper == instruction::_READC)
+      needsSlots = true;
+  for (auto & loc : locations)
+    if (loc.kind == Location::STACK) needsSlots = true;
+  int nGPR = 0, nXMM = 0;
+  for (auto & param : subr.params) {
+    if (param.name == "_result") continue;
+    bool isFloat = (valueClasses[getValueId(param.name)] == FLOAT32);
+    if ((isFloat and nXMM++ >= NUM_ARG_XMM) or (not isFloat and nGPR++ >= NUM_ARG_GPR))
+      needsSlots = true;
+  }
+  framePointer = needsSlots;
+  if (not framePointer) {
+    // at the entry %rsp + 8 is aligned
+    frameSize = (not callPositions.empty() and savedRegs.size() % 2 == 0) ? 8 : 0;
+    return;
+  }
+
+  int offset = 8 * savedRegs.size();
+  for (auto & loc : locations) {
+    if (loc.kind == Location::STACK) {
+      offset += 8;
+      loc.offset = -offset;
+    }
+  }
+  for (auto & varlocal : subr.vars) {
+    if (not isLocalArray(varlocal.name)) continue;
+    int bytes = ELEM_SIZE * ValueTypes.getTypeOf(varlocal.name).size;
+    offset += (bytes + 7) / 8 * 8;
+    arrayOffsets[varlocal.name] = -offset;
+  }
+  offset += 8;
+  scratchOffset = -offset;
+  frameSize = offset - 8 * savedRegs.size();
+  if ((8 * savedRegs.size() + frameSize) % 16 != 0)
+    frameSize += 8;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Operands
+
+std::string X86CodeGen::operand(const Location & loc, bool bits64) const {
+  switch (loc.kind) {
+  case Location::GPR:
+    return bits64 ? GPR_NAMES64[loc.reg] : GPR_NAMES32[loc.reg];
+  case Location::XMM:
+    return "%xmm" + std::to_string(loc.reg);
+  case Location::STACK:
+    return std::to_string(loc.offset) + "(%rbp)";
+  case Location::IMM:
+    return "$" + std::to_string(loc.offset);
+  default:
+    return "$0";
+  }
+}
+
+std::string X86CodeGen::operand(const std::string & tcodeArg, bool bits64) const {
+  return operand(locationOf(tcodeArg), bits64);
+}
+
+const X86CodeGen::Location & X86CodeGen::locationOf(const std::string & tcodeArg) const {
+  static const Location NO_LOCATION{Location::NONE, 0, 0};
+  int v = getValueId(tcodeArg);
+  return v < 0 ? NO_LOCATION : locations[v];
+}
+
+// the labels of the t-code are local to each function
+std::string X86CodeGen::labelName(const std::string & func, const std::string & label) {
+  return ".L" + func + "." + label;
+}
+
+
+////////////////////////////////////////////////////////////////
+// Instructions
+
+void X86CodeGen::emitMove(ValueClass cls, const Location & src, const Location & dst,
+                          std::ostream & os) const {
+  if (dst.kind == Location::NONE) return;
+  if (src.kind == dst.kind and src.reg == dst.reg and src.offset == dst.offset) return;
+  bool bits64 = (cls == POINTER);
+  std::string suffix  = bits64 ? "q" : "l";
+  std::string scratch = bits64 ? "%rax" : "%eax";
+  if (src.kind == Location::NONE) {           // a value never assigned
+    if (dst.kind == Location::XMM)
+      os << "\txorps " << operand(dst) << ", " << operand(dst) << "\n";
+    else
+      os << "\tmov" << suffix << " $0, " << operand(dst, bits64) << "\n";
+  }
+  else if (src.kind == Location::IMM)
+    os << "\tmovl " << operand(src) << ", " << operand(dst) << "\n";
+  else if (src.kind == Location::XMM and dst.kind == Location::XMM)
+    os << "\tmovaps " << operand(src) << ", " << operand(dst) << "\n";
+  else if (src.kind == Location::XMM or dst.kind == Location::XMM)
+    os << "\tmovss " << operand(src) << ", " << operand(dst) << "\n";
+  else if (src.kind == Location::GPR or dst.kind == Location::GPR)
+    os << "\tmov" << suffix << " " << operand(src, bits64) << ", " << operand(dst, bits64) << "\n";
+  else
+    os << "\tmov" << suffix << " " << operand(src, bits64) << ", " << scratch << "\n"
+       << "\tmov" << suffix << " " << scratch << ", " << operand(dst, bits64) << "\n";
+}
+
+void X86CodeGen::emitLoadInt(const std::string & tcodeArg, const std::string & reg32,
+                             std::ostream & os) const {
+  std::string src = operand(tcodeArg);
+  if (src != reg32)
+    os << "\tmovl " << src << ", " << reg32 << "\n";
+}
+
+// the operand of an int for the instructions that take no immediate
+// (a constant is loaded into reg32)
+std::string X86CodeGen::emitNotImmediate(const std::string & tcodeArg, const std::string & reg32,
+                                         std::ostream & os) const {
+  if (locationOf(tcodeArg).kind != Location::IMM)
+    return operand(tcodeArg);
+  emitLoadInt(tcodeArg, reg32, os);
+  return reg32;
+}
+
+// The moves are done once no other move reads their register; the
+// cycles are broken by moving a source to %rax (or %xmm15)
+void X86CodeGen::emitParallelMoves(std::vector<RegMove> & moves, std::ostream & os) const {
+  moves.erase(std::remove_if(moves.begin(), moves.end(),
+                             [](const RegMove & m) {
+                               return not m.srcReg.empty() and m.srcReg == m.dstReg;
+                             }),
+              moves.end());
+  while (not moves.empty()) {
+    std::size_t ready = moves.size();
+    for (std::size_t i = 0; i < moves.size() and ready == moves.size(); ++i) {
+      bool read = false;
+      for (std::size_t j = 0; j < moves.size() and not read; ++j)
+        read = (j != i and not moves[i].dstReg.empty() and moves[j].srcReg == moves[i].dstReg);
+      if (not read) ready = i;
+    }
+    if (ready == moves.size()) {
+      RegMove & m = moves[0];
+      bool isFloat = (m.srcReg.compare(0, 4, "%xmm") == 0);
+      std::string scratch = isFloat ? "%xmm15" : "%rax";
+      os << (isFloat ? "\tmovaps " : "\tmovq ") << m.srcReg << ", " << scratch << "\n";
+      m.src = (m.instr == "movl") ? "%eax" : scratch;
+      m.srcReg = "";
+      continue;
+    }
+    const RegMove & m = moves[ready];
+    os << "\t" << m.instr << " " << m.src << ", " << m.dst << "\n";
+    moves.erase(moves.begin() + ready);
+  }
+}
+
+// push the 8 bytes of a param (the upper half of the 32 bits values
+// is not used)
+void X86CodeGen::emitPushValue(const std::string & tcodeArg, std::ostream & os) const {
+  if (isLocalArray(tcodeArg)) {
+    os << "\tleaq " << arrayOffsets.at(tcodeArg) << "(%rbp), %rax\n"
+       << "\tpushq %rax\n";
+    return;
+  }
+  const Location & loc = locationOf(tcodeArg);
+  if (loc.kind == Location::XMM)
+    os << "\tmovd " << operand(loc) << ", %eax\n"
+       << "\tpushq %rax\n";
+  else
+    os << "\tpushq " << operand(loc, true) << "\n";
+}
+
+// the address of array[index] (the index is left in %rax, or is a
+// displacement if it is a constant)
+void X86CodeGen::emitElementAddress(const std::string & array, const std::string & index,
+                                    std::string & address, std::ostream & os) const {
+  const Location & idx = locationOf(index);
+  if (idx.kind == Location::IMM) {
+    int disp = ELEM_SIZE * idx.offset;
+    if (isLocalArray(array))
+      address = std::to_string(arrayOffsets.at(array) + disp) + "(%rbp)";
+    else {
+      const Location & loc = locationOf(array);
+      std::string base = "%r11";
+      if (loc.kind == Location::GPR)
+        base = operand(loc, true);
+      else
+        os << "\tmovq " << operand(loc, true) << ", %r11\n";
+      address = std::to_string(disp) + "(" + base + ")";
+    }
+    return;
+  }
+  os << "\tmovslq " << operand(index) << ", %rax\n";
+  if (isLocalArray(array)) {
+    address = std::to_string(arrayOffsets.at(array)) + "(%rbp,%rax," +
+              std::to_string(ELEM_SIZE) + ")";
+    return;
+  }
+  const Location & loc = locationOf(array);
+  std::string base = "%r11";
+  if (loc.kind == Location::GPR)
+    base = operand(loc, true);
+  else
+    os << "\tmovq " << operand(loc, true) << ", %r11\n";
+  address = "(" + base + ",%rax," + std::to_string(ELEM_SIZE) + ")";
+}
+
+// a1 = a2 op a3, in the register of a1. If a3 is in it (and a2 is
+// not), the op is a1 op= a2, and a subtraction is -a1 + a2
+void X86CodeGen::emitIntBinary(const std::string & op, const instruction & instr,
+                               std::ostream & os) const {
+  const Location & dst = locationOf(instr.arg1);
+  const Location & src2 = locationOf(instr.arg2);
+  const Location & src3 = locationOf(instr.arg3);
+  auto inDst = [&](const Location & src) {
+    return src.kind == Location::GPR and src.reg == dst.reg;
+  };
+  if (dst.kind == Location::GPR and inDst(src3) and not inDst(src2)) {
+    if (op == "subl")
+      os << "\tnegl " << operand(dst) << "\n"
+         << "\taddl " << operand(src2) << ", " << operand(dst) << "\n";
+    else
+      os << "\t" << op << " " << operand(src2) << ", " << operand(dst) << "\n";
+    return;
+  }
+  std::string target = (dst.kind == Location::GPR) ? operand(dst) : "%eax";
+  emitLoadInt(instr.arg2, target, os);
+  os << "\t" << op << " " << operand(src3) << ", " << target << "\n";
+  if (dst.kind != Location::GPR and dst.kind != Location::NONE)
+    os << "\tmovl %eax, " << operand(dst) << "\n";
+}
+
+void X86CodeGen::emitFloatBinary(const std::string & op, const instruction & instr,
+                                 std::ostream & os) const {
+  const Location & dst = locationOf(instr.arg1);
+  const Location & src3 = locationOf(instr.arg3);
+  bool direct = (dst.kind == Location::XMM and
+                 not (src3.kind == Location::XMM and src3.reg == dst.reg));
+  Location target = direct ? dst : Location{Location::XMM, 15, 0};
+  emitMove(FLOAT32, locationOf(instr.arg2), target, os);
+  os << "\t" << op << " " << operand(src3) << ", " << operand(target) << "\n";
+  if (not direct)
+    emitMove(FLOAT32, target, dst, os);
+}
+
+// The comparison followed by the jump that is its only use is done
+// with a conditional jump (fused), and otherwise with a setcc
+void X86CodeGen::emitCompare(const instruction & instr, const instruction * next,
+                             bool & fused, std::ostream & os) const {
+  bool isFloat = (instr.oper == instruction::_FEQ or instr.oper == instruction::_FLT or
+                  instr.oper == instruction::_FLE);
+  if (isFloat) {
+    // the flags of a3 compared with a2 (unordered: CF, ZF and PF set)
+    emitMove(FLOAT32, locationOf(instr.arg3), Location{Location::XMM, 15, 0}, os);
+    os << "\tucomiss " << operand(instr.arg2) << ", %xmm15\n";
+  }
+  else {
+    // a2 is compared where it is, unless it is a constant or both
+    // operands are in the frame
+    const Location & src2 = locationOf(instr.arg2);
+    const Location & src3 = locationOf(instr.arg3);
+    std::string left = operand(src2);
+    if (not (src2.kind == Location::GPR or
+             (src2.kind == Location::STACK and src3.kind != Location::STACK))) {
+      emitLoadInt(instr.arg2, "%eax", os);
+      left = "%eax";
+    }
+    os << "\tcmpl " << operand(src3) << ", " << left << "\n";
+  }
+  int v = getValueId(instr.arg1);
+  fused = (next != nullptr and next->oper == instruction::_FJUMP and
+           next->arg1 == instr.arg1 and v >= 0 and useCounts[v] == 1);
+  if (fused) {
+    std::string label = labelName(currentFunctionName, next->arg2);
+    switch (instr.oper) {
+    case instruction::_EQ:  os << "\tjne " << label << "\n"; break;
+    case instruction::_LT:  os << "\tjge " << label << "\n"; break;
+    case instruction::_LE:  os << "\tjg "  << label << "\n"; break;
+    case instruction::_FEQ: os << "\tjne " << label << "\n"
+                               << "\tjp "  << label << "\n"; break;
+    case instruction::_FLT: os << "\tjbe " << label << "\n"; break;
+    case instruction::_FLE: os << "\tjb "  << label << "\n"; break;
+    default: break;
+    }
+    return;
+  }
+  switch (instr.oper) {
+  case instruction::_EQ:  os << "\tsete %al\n";  break;
+  case instruction::_LT:  os << "\tsetl %al\n";  break;
+  case instruction::_LE:  os << "\tsetle %al\n"; break;
+  case instruction::_FEQ: os << "\tsete %al\n"
+                             << "\tsetnp %dl\n"
+                             << "\tandb %dl, %al\n"; break;
+  case instruction::_FLT: os << "\tseta %al\n";  break;
+  case instruction::_FLE: os << "\tsetae %al\n"; break;
+  default: break;
+  }
+  const Location & dst = locationOf(instr.arg1);
+  if (dst.kind == Location::GPR)
+    os << "\tmovzbl %al, " << operand(dst) << "\n";
+  else if (dst.kind != Location::NONE)
+    os << "\tmovzbl %al, %eax\n"
+       << "\tmovl %eax, " << operand(dst) << "\n";
+}
+
+// The params in the stack are pushed, and the ones in the registers of
+// the ABI are moved to them with a parallel move, so that no param is
+// overwritten before it is read. The values that live across the call
+// are in callee-saved registers or in the frame
+void X86CodeGen::emitCall(const CallSite & call, std::ostream & os) const {
+  const TCodeTypes::FunctionType & func = ValueTypes.getFunctionType(call.func);
+  std::vector<RegMove>     moves;
+  std::vector<std::string> stackArgs;
+  int nGPR = 0, nXMM = 0;
+  for (std::size_t i = 0; i < call.args.size(); ++i) {
+    const std::string & arg = call.args[i];
+    bool isFloat = (i < func.params.size() and func.params[i].isFloat());
+    if (isFloat and nXMM < NUM_ARG_XMM) {
+      std::string reg = "%xmm" + std::to_string(nXMM++);
+      const Location & loc = locationOf(arg);
+      if (loc.kind == Location::XMM)
+        moves.push_back(RegMove{"movaps", operand(loc), reg, operand(loc), reg});
+      else if (loc.kind == Location::STACK)
+        moves.push_back(RegMove{"movss", operand(loc), reg, "", reg});
+      else
+        moves.push_back(RegMove{"xorps", reg, reg, "", reg});
+    }
+    else if (not isFloat and nGPR < NUM_ARG_GPR) {
+      int r = nGPR++;
+      const Location & loc = locationOf(arg);
+      if (isLocalArray(arg))
+        moves.push_back(RegMove{"leaq", std::to_string(arrayOffsets.at(arg)) + "(%rbp)",
+                                ARG_GPR64[r], "", ARG_GPR64[r]});
+      else if (loc.kind == Location::NONE)
+        moves.push_back(RegMove{"movl", "$0", ARG_GPR32[r], "", ARG_GPR64[r]});
+      else {
+        bool bits64 = (valueClasses[getValueId(arg)] == POINTER);
+        moves.push_back(RegMove{bits64 ? "movq" : "movl", operand(loc, bits64),
+                                bits64 ? ARG_GPR64[r] : ARG_GPR32[r],
+                                loc.kind == Location::GPR ? GPR_NAMES64[loc.reg] : "",
+                                ARG_GPR64[r]});
+      }
+    }
+    else
+      stackArgs.push_back(arg);
+  }
+  int stackBytes = 8 * stackArgs.size();
+  if (stackBytes % 16 != 0) {
+    os << "\tsubq $8, %rsp\n";
+    stackBytes += 8;
+  }
+  for (auto it = stackArgs.rbegin(); it != stackArgs.rend(); ++it)
+    emitPushValue(*it, os);
+  emitParallelMoves(moves, os);
+  os << "\tcall f_" << call.func << "\n";
+  if (stackBytes > 0)
+    os << "\taddq $" << stackBytes << ", %rsp\n";
+  if (call.result.empty()) return;
+  if (func.ret.isFloat())
+    emitMove(FLOAT32, Location{Location::XMM, 0, 0}, locationOf(call.result), os);
+  else {
+    const Location & dst = locationOf(call.result);
+    if (dst.kind != Location::NONE)
+      os << "\tmovl %eax, " << operand(dst) << "\n";
+  }
+}
+
+// The value read is left in the slot of the reads (a failed read
+// leaves a zero)
+void X86CodeGen::emitRead(const instruction & instr, std::ostream & os) const {
+  Location scratch{Location::STACK, 0, scratchOffset};
+  std::string func = (instr.oper == instruction::_READI ? "__asl_read_int" :
+                      instr.oper == instruction::_READF ? "__asl_read_float" :
+                      "__asl_read_char");
+  os << "\tmovl $0, " << operand(scratch) << "\n"
+     << "\tleaq " << operand(scratch) << ", %rdi\n"
+     << "\tcall " << func << "@PLT\n";
+  const Location & dst = locationOf(instr.arg1);
+  if (dst.kind == Location::NONE) return;
+  if (instr.oper == instruction::_READC) {
+    if (dst.kind == Location::GPR)
+      os << "\tmovsbl " << operand(scratch) << ", " << operand(dst) << "\n";
+    else
+      os << "\tmovsbl " << operand(scratch) << ", %eax\n"
+         << "\tmovl %eax, " << operand(dst) << "\n";
+  }
+  else
+    emitMove(valueClasses[getValueId(instr.arg1)], scratch, dst, os);
+}
+
+// The result is _result, or the value copied to it just before the
+// return
+void X86CodeGen::emitReturn(const std::string & result, std::ostream & os) const {
+  int v = getValueId("_result");
+  if (v >= 0) {
+    const Location & loc = locationOf(result);
+    if (valueClasses[v] == FLOAT32) {
+      if (loc.kind == Location::NONE)
+        os << "\txorps %xmm0, %xmm0\n";
+      else
+        emitMove(FLOAT32, loc, Location{Location::XMM, 0, 0}, os);
+    }
+    else
+      os << "\tmovl " << operand(loc) << ", %eax\n";
+  }
+  else if (currentFunctionName == "main")
+    os << "\txorl %eax, %eax\n";
+  if (not framePointer) {
+    if (frameSize > 0)
+      os << "\taddq $" << frameSize << ", %rsp\n";
+  }
+  else if (savedRegs.empty())
+    os << "\tmovq %rbp, %rsp\n";
+  else
+    os << "\tleaq " << -8 * int(savedRegs.size()) << "(%rbp), %rsp\n";
+  for (auto it = savedRegs.rbegin(); it != savedRegs.rend(); ++it)
+    os << "\tpopq " << GPR_NAMES64[*it] << "\n";
+  if (framePointer)
+    os << "\tpopq %rbp\n";
+  os << "\tret\n";
+}
+
+
+////////////////////////////////////////////////////////////////
+// Code
+
+// The char of a character constant: a (or an escape sequence: \n)
+static int getCharCode(const std::string & s) {
+  if (s.size() < 2 or s[0] != '\\')
+    return static_cast<signed char>(s[0]);
+  switch (s[1]) {
+  case 'b': return '\b';
+  case 't': return '\t';
+  case 'n': return '\n';
+  case 'f': return '\f';
+  case 'r': return '\r';
+  default:  return static_cast<signed char>(s[1]);    // \" \' and '\\'
+  }
+}
+
+// The chars of a string constant ("..." with escape sequences)
+static std::string getStringChars(const std::string & aslString) {
+  std::string chars;
+  for (std::size_t i = 1; i + 1 < aslString.size(); ++i) {
+    if (aslString[i] == '\\' and i + 2 < aslString.size())
+      chars += char(getCharCode(aslString.substr(i++, 2)));
+    else
+      chars += aslString[i];
+  }
+  return chars;
+}
+
+static std::uint32_t getFloatBits(float f) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+void X86CodeGen::dumpSubroutine(const subroutine & subr, std::ostream & os) {
+  bindValues(subr);
+  computeCallSites(subr);
+  computeUsesDefs(subr);
+  findConstants(subr);
+  std::vector<Interval> intervals = computeIntervals(subr);
+  allocateRegisters(intervals);
+  layoutFrame(subr);
+
+  dumpPrologue(subr, os);
+  // the instructions after a jump or a return, up to the next label,
+  // are never executed
+  const instructionList & instrs = subr.get_instructions();
+  bool skipNext = false, reachable = true;
+  for (std::size_t pos = 0; pos < instrs.size(); ++pos) {
+    instruction::Operation oper = instrs[pos].oper;
+    if (oper == instruction::_LABEL) reachable = true;
+    if (skipNext)
+      skipNext = false;
+    else if (reachable)
+      dumpInstruction(subr, pos, skipNext, os);
+    if (oper == instruction::_UJUMP or oper == instruction::_RETURN) reachable = false;
+  }
+  if (reachable)
+    emitReturn("_result", os);
+  std::string name = (currentFunctionName == "main") ? "main" : "f_" + currentFunctionName;
+  os << "\t.size " << name << ", .-" << name << "\n\n";
+}
+
+void X86CodeGen::dumpPrologue(const subroutine & subr, std::ostream & os) const {
+  std::string name = (currentFunctionName == "main") ? "main" : "f_" + currentFunctionName;
+  os << "\t.p2align 4\n";
+  if (currentFunctionName == "main")
+    os << "\t.globl main\n";
+  os << "\t.type " << name << ", @function\n"
+     << name << ":\n";
+  if (framePointer)
+    os << "\tpushq %rbp\n"
+       << "\tmovq %rsp, %rbp\n";
+  for (int r : savedRegs)
+    os << "\tpushq " << GPR_NAMES64[r] << "\n";
+  if (frameSize > 0)
+    os << "\tsubq $" << frameSize << ", %rsp\n";
+
+  // the local arrays start at zero (cleared with %rax, that is no
+  // param)
+  for (auto & varlocal : subr.vars) {
+    if (not isLocalArray(varlocal.name)) continue;
+    int words = (ELEM_SIZE * ValueTypes.getTypeOf(varlocal.name).size + 7) / 8;
+    std::string label = labelName(currentFunctionName, "zero." + varlocal.name);
+    os << "\tmovl $" << words << ", %eax\n"
+       << label << ":\n"
+       << "\tmovq $0, " << arrayOffsets.at(varlocal.name) - 8 << "(%rbp,%rax,8)\n"
+       << "\tsubl $1, %eax\n"
+       << "\tjnz " << label << "\n";
+  }
+
+  // the params in registers are moved to their locations with a
+  // parallel move, and then the ones in the stack
+  std::vector<RegMove> moves;
+  std::vector<int>     stackParams;
+  std::vector<bool>    isParam(valueNames.size(), false);
+  int nGPR = 0, nXMM = 0;
+  for (auto & param : subr.params) {
+    if (param.name == "_result") continue;
+    int v = getValueId(param.name);
+    isParam[v] = true;
+    const Location & dst = locations[v];
+    bool isFloat = (valueClasses[v] == FLOAT32);
+    if (isFloat and nXMM < NUM_ARG_XMM) {
+      std::string reg = "%xmm" + std::to_string(nXMM++);
+      if (dst.kind == Location::XMM)
+        moves.push_back(RegMove{"movaps", reg, operand(dst), reg, operand(dst)});
+      else if (dst.kind == Location::STACK)
+        moves.push_back(RegMove{"movss", reg, operand(dst), reg, ""});
+    }
+    else if (not isFloat and nGPR < NUM_ARG_GPR) {
+      int r = nGPR++;
+      bool bits64 = (valueClasses[v] == POINTER);
+      if (dst.kind == Location::GPR or dst.kind == Location::STACK)
+        moves.push_back(RegMove{bits64 ? "movq" : "movl", bits64 ? ARG_GPR64[r] : ARG_GPR32[r],
+                                operand(dst, bits64), ARG_GPR64[r],
+                                dst.kind == Location::GPR ? GPR_NAMES64[dst.reg] : ""});
+    }
+    else
+      stackParams.push_back(v);
+  }
+  emitParallelMoves(moves, os);
+  for (std::size_t i = 0; i < stackParams.size(); ++i)
+    emitMove(valueClasses[stackParams[i]], Location{Location::STACK, 0, int(16 + 8 * i)},
+             locations[stackParams[i]], os);
+
+  // the vars that can be read before written start at zero
+  for (std::size_t v = 0; v < valueNames.size(); ++v) {
+    if (not liveAtEntry[v] or isParam[v] or TCodeTypes::isTemporal(valueNames[v])) continue;
+    emitMove(valueClasses[v], Location{Location::NONE, 0, 0}, locations[v], os);
+  }
+}
+
+void X86CodeGen::dumpInstruction(const subroutine & subr, std::size_t pos,
+                                 bool & skipNext, std::ostream & os) {
+  const instructionList & instrs = subr.get_instructions();
+  const instruction & instr = instrs[pos];
+  const instruction * next = (pos + 1 < instrs.size()) ? &instrs[pos + 1] : nullptr;
+  const Location & dst = locationOf(instr.arg1);
+  int v1 = getValueId(instr.arg1);
+  switch (instr.oper) {
+  case instruction::_LABEL:
+    os << labelName(currentFunctionName, instr.arg1) << ":\n";
+    break;
+  case instruction::_UJUMP:
+    os << "\tjmp " << labelName(currentFunctionName, instr.arg1) << "\n";
+    break;
+  case instruction::_FJUMP:
+    {
+      std::string label = labelName(currentFunctionName, instr.arg2);
+      if (dst.kind == Location::GPR)
+        os << "\ttestl " << operand(dst) << ", " << operand(dst) << "\n"
+           << "\tje " << label << "\n";
+      else if (dst.kind == Location::STACK)
+        os << "\tcmpl $0, " << operand(dst) << "\n"
+           << "\tje " << label << "\n";
+      else if (dst.kind == Location::NONE or dst.offset == 0)
+        os << "\tjmp " << label << "\n";
+      break;
+    }
+  case instruction::_HALT:
+    os << "\tmovl $1, %edi\n"
+       << "\tcall exit@PLT\n";
+    break;
+  case instruction::_PUSH:
+    break;
+  case instruction::_CALL:
+  case instruction::_POP:
+    {
+      auto it = callSites.find(pos);
+      if (it != callSites.end())
+        emitCall(it->second, os);
+      break;
+    }
+  case instruction::_RETURN:
+    emitReturn("_result", os);
+    break;
+  case instruction::_LOAD:
+  case instruction::_ALOAD:
+    {
+      // in an array copy the elements are copied before
+      if (v1 < 0) break;
+      if (instr.oper == instruction::_LOAD and not TCodeTypes::isTemporal(instr.arg1) and
+          ValueTypes.getTypeOf(instr.arg1).isPointer())
+        break;
+      ValueClass cls = valueClasses[v1];
+      int v2 = getValueId(instr.arg2);
+      if (instr.arg1 == "_result" and next != nullptr and next->oper == instruction::_RETURN and
+          v2 >= 0 and valueClasses[v2] == cls) {
+        // the value is returned without the copy
+        emitReturn(instr.arg2, os);
+        skipNext = true;
+      }
+      else if (isLocalArray(instr.arg2)) {
+        // the address of a local array
+        std::string addr = std::to_string(arrayOffsets.at(instr.arg2)) + "(%rbp)";
+        if (dst.kind == Location::GPR)
+          os << "\tleaq " << addr << ", " << operand(dst, true) << "\n";
+        else if (dst.kind != Location::NONE)
+          os << "\tleaq " << addr << ", %rax\n"
+             << "\tmovq %rax, " << operand(dst, true) << "\n";
+      }
+      else if (cls == FLOAT32 and v2 >= 0 and valueClasses[v2] == INT32) {
+        std::string src = emitNotImmediate(instr.arg2, "%eax", os);
+        os << "\tcvtsi2ssl " << src << ", %xmm15\n";
+        emitMove(FLOAT32, Location{Location::XMM, 15, 0}, dst, os);
+      }
+      else
+        emitMove(cls, locationOf(instr.arg2), dst, os);
+      break;
+    }
+  case instruction::_ILOAD:
+  case instruction::_CHLOAD:
+  case instruction::_FLOAD:
+    {
+      if (dst.kind == Location::NONE or dst.kind == Location::IMM) break;
+      std::uint32_t bits;
+      if (instr.oper == instruction::_FLOAD)
+        bits = getFloatBits(std::strtof(instr.arg2.c_str(), nullptr));
+      else {
+        int n = (instr.oper == instruction::_CHLOAD) ? getCharCode(instr.arg2)
+                                                     : int(std::stoll(instr.arg2));
+        bits = (valueClasses[v1] == FLOAT32) ? getFloatBits(float(n)) : std::uint32_t(n);
+      }
+      if (dst.kind == Location::XMM)
+        os << "\tmovl $" << bits << ", %eax\n"
+           << "\tmovd %eax, " << operand(dst) << "\n";
+      else
+        os << "\tmovl $" << int(bits) << ", " << operand(dst) << "\n";
+      break;
+    }
+  case instruction::_LOADX:
+  case instruction::_LOADC:
+    {
+      std::string address;
+      if (instr.oper == instruction::_LOADX)
+        emitElementAddress(instr.arg2, instr.arg3, address, os);
+      else {
+        os << "\tmovq " << operand(instr.arg2, true) << ", %r11\n";
+        address = "(%r11)";
+      }
+      if (dst.kind == Location::GPR or dst.kind == Location::XMM)
+        os << (dst.kind == Location::XMM ? "\tmovss " : "\tmovl ")
+           << address << ", " << operand(dst) << "\n";
+      else if (dst.kind == Location::STACK)
+        os << "\tmovl " << address << ", %edx\n"
+           << "\tmovl %edx, " << operand(dst) << "\n";
+      break;
+    }
+  case instruction::_XLOAD:
+  case instruction::_CLOAD:
+    {
+      std::string address, value;
+      if (instr.oper == instruction::_XLOAD) {
+        emitElementAddress(instr.arg1, instr.arg2, address, os);
+        value = instr.arg3;
+      }
+      else {
+        os << "\tmovq " << operand(instr.arg1, true) << ", %r11\n";
+        address = "(%r11)";
+        value = instr.arg2;
+      }
+      const Location & src = locationOf(value);
+      if (src.kind == Location::GPR or src.kind == Location::XMM)
+        os << (src.kind == Location::XMM ? "\tmovss " : "\tmovl ")
+           << operand(src) << ", " << address << "\n";
+      else if (src.kind == Location::STACK)
+        os << "\tmovl " << operand(src) << ", %edx\n"
+           << "\tmovl %edx, " << address << "\n";
+      else
+        os << "\tmovl " << operand(src) << ", " << address << "\n";
+      break;
+    }
+  case instruction::_ADD:
+    emitIntBinary("addl", instr, os);
+    break;
+  case instruction::_SUB:
+    emitIntBinary("subl", instr, os);
+    break;
+  case instruction::_MUL:
+    emitIntBinary("imull", instr, os);
+    break;
+  case instruction::_AND:
+    emitIntBinary("andl", instr, os);
+    break;
+  case instruction::_OR:
+    emitIntBinary("orl", instr, os);
+    break;
+  case instruction::_DIV:
+    emitLoadInt(instr.arg2, "%eax", os);
+    {
+      std::string divisor = emitNotImmediate(instr.arg3, "%r11d", os);
+      os << "\tcltd\n"
+         << "\tidivl " << divisor << "\n";
+    }
+    if (dst.kind != Location::NONE)
+      os << "\tmovl %eax, " << operand(dst) << "\n";
+    break;
+  case instruction::_NOT:
+  case instruction::_NEG:
+    {
+      std::string target = (dst.kind == Location::GPR) ? operand(dst) : "%eax";
+      emitLoadInt(instr.arg2, target, os);
+      os << (instr.oper == instruction::_NOT ? "\txorl $1, " : "\tnegl ") << target << "\n";
+      if (dst.kind != Location::GPR and dst.kind != Location::NONE)
+        os << "\tmovl %eax, " << operand(dst) << "\n";
+      break;
+    }
+  case instruction::_EQ:
+  case instruction::_LT:
+  case instruction::_LE:
+  case instruction::_FEQ:
+  case instruction::_FLT:
+  case instruction::_FLE:
+    emitCompare(instr, next, skipNext, os);
+    break;
+  case instruction::_FADD:
+    emitFloatBinary("addss", instr, os);
+    break;
+  case instruction::_FSUB:
+    emitFloatBinary("subss", instr, os);
+    break;
+  case instruction::_FMUL:
+    emitFloatBinary("mulss", instr, os);
+    break;
+  case instruction::_FDIV:
+    emitFloatBinary("divss", instr, os);
+    break;
+  case instruction::_FNEG:
+    emitMove(FLOAT32, locationOf(instr.arg2), Location{Location::XMM, 15, 0}, os);
+    os << "\txorps .LCfneg(%rip), %xmm15\n";
+    emitMove(FLOAT32, Location{Location::XMM, 15, 0}, dst, os);
+    fnegMask = true;
+    break;
+  case instruction::_FLOAT:
+    {
+      if (dst.kind == Location::NONE) break;
+      std::string src = emitNotImmediate(instr.arg2, "%eax", os);
+      if (dst.kind == Location::XMM)
+        os << "\tcvtsi2ssl " << src << ", " << operand(dst) << "\n";
+      else
+        os << "\tcvtsi2ssl " << src << ", %xmm15\n"
+           << "\tmovss %xmm15, " << operand(dst) << "\n";
+      break;
+    }
+  case instruction::_READI:
+  case instruction::_READF:
+  case instruction::_READC:
+    emitRead(instr, os);
+    break;
+  case instruction::_WRITEI:
+  case instruction::_WRITEC:
+    os << "\tmovl " << operand(dst) << ", %edi\n"
+       << "\tcall " << (instr.oper == instruction::_WRITEI ? "__asl_write_int" : "__asl_write_char")
+       << "@PLT\n";
+    break;
+  case instruction::_WRITEF:
+    os << "\tcvtss2sd " << operand(dst) << ", %xmm0\n"
+       << "\tcall __asl_write_float@PLT\n";
+    break;
+  case instruction::_WRITES:
+    {
+      std::string chars = getStringChars(instr.arg1);
+      os << "\tleaq .LS" << strings.size() << "(%rip), %rdi\n"
+         << "\tmovl $" << chars.size() << ", %esi\n"
+         << "\tcall __asl_write_str@PLT\n";
+      strings.push_back(chars);
+      break;
+    }
+  case instruction::_WRITELN:
+    os << "\tmovl $10, %edi\n"
+       << "\tcall __asl_write_char@PLT\n";
+    break;
+  default:
+    break;
+  }
+}
+
+void X86CodeGen::dumpData(std::ostream & os) const {
+  if (not strings.empty() or fnegMask)
+    os << "\t.section .rodata\n";
+  for (std::size_t i = 0; i < strings.size(); ++i) {
+    os << ".LS" << i << ":\n"
+       << "\t.ascii \"";
+    for (char c : strings[i]) {
+      unsigned char u = c;
+      if (u >= 32 and u < 127 and c != '"' and c != '\\')
+        os << c;
+      else {
+        const char digits[] = "01234567";
+        os << '\\' << digits[u >> 6] << digits[(u >> 3) & 7] << digits[u & 7];
+      }
+    }
+    os << "\"\n";
+  }
+  if (fnegMask)
+    os << "\t.p2align 4\n"
+       << ".LCfneg:\n"
+       << "\t.long 0x80000000, 0, 0, 0\n";
+  os << "\t.section .note.GNU-stack,\"\",@progbits\n";
+}
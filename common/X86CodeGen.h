@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////
+//
+//    X86CodeGen - x86-64 assembler generation for the Asl programming
+//                 language
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TypesMgr.h"
+#include "SymTable.h"
+#include "code.h"
+#include "TCodeTypes.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <ostream>
+
+// using namespace std;
+
+class code;
+class subroutine;
+class instruction;
+
+// Translation of the t-code of a program into x86-64 assembler (GNU as,
+// AT&T syntax) for the System V ABI. The params, local vars (but the
+// arrays) and temporals of each function get a register, or a slot of
+// the frame, by a linear scan over their live intervals; the local
+// arrays are in the frame, with 4 bytes for each element. The reads and
+// writes call the runtime of runtime/aslrt.c:
+//   as prog.s -o prog.o && cc prog.o runtime/aslrt.c -lm
+class X86CodeGen {
+ private:
+  const TypesMgr & Types;
+  const SymTable & Symbols;
+  const code     & tCode;
+
+  // types of the functions and of the values of the current function
+  TCodeTypes ValueTypes;
+
+  // the values that get a location: 32 bits integers (int, bool and
+  // char), pointers (to the elements of an array) and floats
+  enum ValueClass { INT32, POINTER, FLOAT32 };
+  struct Location {
+    enum Kind { NONE, GPR, XMM, STACK, IMM } kind;
+    int reg;                  // GPR: index in GPR_NAMES; XMM: number
+    int offset;               // STACK: from %rbp; IMM: the constant
+  };
+  struct Interval {
+    int  value;
+    int  start, end;          // positions of the t-code instructions
+    bool crossesCall;
+  };
+  // a call is done at the last popparam of its params (or at the call
+  // itself if there are none)
+  struct CallSite {
+    std::string              func;
+    std::vector<std::string> args;
+    std::string              result;
+  };
+  // a move to a register of a parallel move (the registers are named
+  // by their 64 bits names, and a move reads no register if src is a
+  // constant, an address or a slot of the frame)
+  struct RegMove {
+    std::string instr;        // movl, movq, movss, movaps, leaq or xorps
+    std::string src, dst;     // operands
+    std::string srcReg, dstReg;
+  };
+
+  std::string                    currentFunctionName;
+  std::vector<std::string>       valueNames;
+  std::map<std::string, int>     valueIds;
+  std::vector<ValueClass>        valueClasses;
+  std::vector<Location>          locations;
+  std::map<std::string, int>     arrayOffsets;     // local arrays
+  std::map<std::size_t, CallSite> callSites;       // by position
+  std::vector<std::size_t>       callPositions;    // calls, reads and writes
+  std::vector<std::vector<int>>  instrUses, instrDefs;
+  std::vector<int>               intervalEnds;     // by value (-1 if none)
+  std::vector<int>               useCounts;        // by value
+  std::map<int, std::int32_t>    constants;        // temporals, by value
+  // by value: the value copied to it, and the register of the ABI
+  // where it is passed to a call (-1 if none), preferred by the
+  // allocation so that the moves are not needed
+  std::vector<int>               copyHints, regHints;
+  std::vector<bool>              liveAtEntry;      // by value
+  std::vector<int>               savedRegs;        // callee-saved GPRs used
+  bool                           framePointer;     // %rbp is set
+  int                            frameSize;
+  int                            scratchOffset;    // of the reads
+  std::vector<std::string>       strings;          // of the writes
+  bool                           fnegMask;
+
+  bool isLocalArray(const std::string & tcodeArg) const;
+  int  getValueId(const std::string & tcodeArg) const;
+  ValueClass getClassOf(const TCodeTypes::ValueType & type) const;
+
+  void bindValues(const subroutine & subr);
+  void computeCallSites(const subroutine & subr);
+  void computeUsesDefs(const subroutine & subr);
+  void findConstants(const subroutine & subr);
+  std::vector<Interval> computeIntervals(const subroutine & subr);
+  void allocateRegisters(std::vector<Interval> & intervals);
+  void layoutFrame(const subroutine & subr);
+
+  std::string operand(const Location & loc, bool bits64 = false) const;
+  std::string operand(const std::string & tcodeArg, bool bits64 = false) const;
+  const Location & locationOf(const std::string & tcodeArg) const;
+  static std::string labelName(const std::string & func, const std::string & label);
+
+  void emitMove(ValueClass cls, const Location & src, const Location & dst, std::ostream & os) const;
+  void emitLoadInt(const std::string & tcodeArg, const std::string & reg32, std::ostream & os) const;
+  std::string emitNotImmediate(const std::string & tcodeArg, const std::string & reg32,
+                               std::ostream & os) const;
+  void emitParallelMoves(std::vector<RegMove> & moves, std::ostream & os) const;
+  void emitPushValue(const std::string & tcodeArg, std::ostream & os) const;
+  void emitElementAddress(const std::string & array, const std::string & index,
+                          std::string & address, std::ostream & os) const;
+  void emitIntBinary(const std::string & op, const instruction & instr, std::ostream & os) const;
+  void emitFloatBinary(const std::string & op, const instruction & instr, std::ostream & os) const;
+  void emitCompare(const instruction & instr, const instruction * next,
+                   bool & fused, std::ostream & os) const;
+  void emitCall(const CallSite & call, std::ostream & os) const;
+  void emitRead(const instruction & instr, std::ostream & os) const;
+  void emitReturn(const std::string & result, std::ostream & os) const;
+
+  void dumpSubroutine(const subroutine & subr, std::ostream & os);
+  void dumpPrologue(const subroutine & subr, std::ostream & os) const;
+  void dumpInstruction(const subroutine & subr, std::size_t pos,
+                       bool & skipNext, std::ostream & os);
+  void dumpData(std::ostream & os) const;
+
+ public:
+  X86CodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
+
+  // the assembler of the program
+  std::string dumpX86();
+};
@@ -28,8 +28,12 @@
 
 #include <iostream>
 #include <vector>
+#include <utility>
+#include <iterator>
 #include "code.h"
 #include "LLVMCodeGen.h"
+#include "CCodeGen.h"
+#include "X86CodeGen.h"
 
 using namespace std;
 
@@ -171,11 +175,20 @@ instructionList::instructionList(const instruction &inst) { this->push_back(inst
 instructionList::~instructionList() {}
 
 // concatenation of lists (or list+instruction, via automatic coertion)
-instructionList instructionList::operator||(const instructionList &lst) const {
+instructionList instructionList::operator||(const instructionList &lst) const & {
   instructionList newlist = (*this);
   newlist.insert(newlist.end(), lst.begin(), lst.end());
   return newlist;
 }
+instructionList instructionList::operator||(const instructionList &lst) && {
+  this->insert(this->end(), lst.begin(), lst.end());
+  return std::move(*this);
+}
+instructionList instructionList::operator||(instructionList &&lst) && {
+  this->insert(this->end(), std::make_move_iterator(lst.begin()),
+               std::make_move_iterator(lst.end()));
+  return std::move(*this);
+}
 
 // print instructionList (for debugging)
 string instructionList::dump() const {
@@ -242,8 +255,17 @@ void subroutine::add_instructions(const instructionList &lins) {
 /// set instruction list (overwritting current instructions)
 void subroutine::set_instructions(const instructionList &lins) {
   instructions.clear();
+  labels.clear();
   this->add_instructions(lins);
 }
+/// set instruction list, taking it without copying
+void subroutine::set_instructions(instructionList &&lins) {
+  instructions = std::move(lins);
+  labels.clear();
+  for (size_t pc = 0; pc < instructions.size(); ++pc)
+    if (instructions[pc].oper == instruction::_LABEL)
+      labels.insert(make_pair(instructions[pc].arg1, pc));
+}
 /// get instruction at given program counter
 instruction subroutine::get_instruction_at(size_t pc) const {
   if (pc>=instructions.size()) return instruction(instruction::_INVALID);
@@ -255,6 +277,9 @@ size_t subroutine::get_label_pc(std::string &lab) const { return labels.find(lab
 instructionList subroutine::get_instructions() const {
   return instructions;
 }
+size_t subroutine::get_number_of_instructions() const {
+  return instructions.size();
+}
 /// print (for debugging)
 string subroutine::dump() const {
   string s;
@@ -277,6 +302,102 @@ string subroutine::dump() const {
   return s;
 }
 
+/// serialization: one record per line, strings as <length>:<chars>
+static void put_field(string &out, const string &f) {
+  out += " " + std::to_string(f.size()) + ":" + f;
+}
+static bool get_field(const string &text, size_t &pos, string &f) {
+  if (pos >= text.size() or text[pos] != ' ') return false;
+  size_t colon = text.find(':', ++pos);
+  if (colon == string::npos or colon == pos) return false;
+  size_t len = 0;
+  for (size_t i = pos; i < colon; ++i) {
+    if (text[i] < '0' or text[i] > '9') return false;
+    len = len*10 + (text[i]-'0');
+  }
+  if (colon + 1 + len > text.size()) return false;
+  f = text.substr(colon+1, len);
+  pos = colon + 1 + len;
+  return true;
+}
+static bool get_number(const string &text, size_t &pos, size_t &n) {
+  string f;
+  if (not get_field(text, pos, f) or f.empty()) return false;
+  n = 0;
+  for (char c : f) {
+    if (c < '0' or c > '9') return false;
+    n = n*10 + (c-'0');
+  }
+  return true;
+}
+
+/// write in serialized form
+string subroutine::serialize() const {
+  string s = "subroutine";
+  put_field(s, name);
+  s += "\n";
+  for (auto &p : params) {
+    s += "param";
+    put_field(s, p.name); put_field(s, p.type); put_field(s, std::to_string(p.nelem));
+    s += "\n";
+  }
+  for (auto &v : vars) {
+    s += "var";
+    put_field(s, v.name); put_field(s, v.type); put_field(s, std::to_string(v.nelem));
+    s += "\n";
+  }
+  for (auto &i : instructions) {
+    s += "instr";
+    put_field(s, std::to_string(i.oper));
+    put_field(s, i.arg1); put_field(s, i.arg2); put_field(s, i.arg3);
+    s += "\n";
+  }
+  s += "endsubroutine\n";
+  return s;
+}
+
+/// read from serialized form
+bool subroutine::deserialize(const string &text, subroutine &s) {
+  s.name.clear();
+  s.instructions.clear();
+  s.labels.clear();
+  s.vars.clear();
+  s.params.clear();
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t sp = text.find_first_of(" \n", pos);
+    if (sp == string::npos) return false;
+    string rec = text.substr(pos, sp-pos);
+    pos = sp;
+    if (rec == "subroutine") {
+      if (not get_field(text, pos, s.name)) return false;
+    }
+    else if (rec == "param" or rec == "var") {
+      string vname, vtype;
+      size_t nelem;
+      if (not get_field(text, pos, vname) or not get_field(text, pos, vtype) or
+          not get_number(text, pos, nelem)) return false;
+      if (rec == "param") s.params.push_back(var(vname, vtype, nelem));
+      else                s.vars.push_back(var(vname, vtype, nelem));
+    }
+    else if (rec == "instr") {
+      size_t op;
+      string a1, a2, a3;
+      if (not get_number(text, pos, op) or op >= instruction::_INVALID or
+          not get_field(text, pos, a1) or not get_field(text, pos, a2) or
+          not get_field(text, pos, a3)) return false;
+      s.add_instruction(instruction(instruction::Operation(op), a1, a2, a3));
+    }
+    else if (rec == "endsubroutine") {
+      return pos + 1 == text.size() and text[pos] == '\n' and not s.name.empty();
+    }
+    else return false;
+    if (pos >= text.size() or text[pos] != '\n') return false;
+    ++pos;
+  }
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////
 /// Implementation for class 'code'
 
@@ -297,15 +418,29 @@ const subroutine& code::get_subroutine(const string &name) const {
   size_t p = names.find(name)->second;
   return subs[p];
 }
+subroutine& code::get_subroutine(const string &name) {
+  size_t p = names.find(name)->second;
+  return subs[p];
+}
 /// add subroutine
 void code::add_subroutine(const subroutine &s) {
   subs.push_back(s);
   names.insert(make_pair(s.get_name(), subs.size()-1));
 }
+void code::add_subroutine(subroutine &&s) {
+  std::string sname = s.get_name();
+  subs.push_back(std::move(s));
+  names.insert(make_pair(sname, subs.size()-1));
+}
 /// get the list of subroutine's (needed only in LLVMCodeGen)
 const std::vector<subroutine> & code::get_subroutine_list() const {
   return subs;
 }
+size_t code::get_number_of_instructions() const {
+  size_t n = 0;
+  for (auto &s : subs) n += s.get_number_of_instructions();
+  return n;
+}
 /// print (for debugging)
 string code::dump() const {
   string c;
@@ -313,22 +448,35 @@ string code::dump() const {
   return c;
 }
 /// print the code in LLVM IR
-std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols) const {
-  LLVMCodeGen llvmCode(Types, Symbols, *this);
+std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols,
+                           bool ssaMode, bool runtimeIO,
+                           const TCodeProfile * profile) const {
+  LLVMCodeGen llvmCode(Types, Symbols, *this, ssaMode, runtimeIO, profile);
   std::string llvmStr = llvmCode.dumpLLVM();
   return llvmStr;
 }
 
+std::string code::dumpC(const TypesMgr & Types, const SymTable & Symbols) const {
+  CCodeGen cCode(Types, Symbols, *this);
+  return cCode.dumpC();
+}
+
+std::string code::dumpX86(const TypesMgr & Types, const SymTable & Symbols) const {
+  X86CodeGen x86Code(Types, Symbols, *this);
+  return x86Code.dumpX86();
+}
+
 
 ////////////////////////////////////////////////////////////////////
 /// Static methods to manage counters
 int counters::countIF = 0;
 int counters::countWHILE = 0;
 int counters::countTEMP = 0;
+long counters::countAllTEMP = 0;
 
 string counters::newLabelIF() { return std::to_string(++countIF); }
 string counters::newLabelWHILE() { return std::to_string(++countWHILE); }
-string counters::newTEMP() { return std::to_string(++countTEMP); }
+string counters::newTEMP() { ++countAllTEMP; return std::to_string(++countTEMP); }
 
 void counters::resetLabelIF() { countIF = 0; }
 void counters::resetLabelWHILE() { countWHILE = 0; }
@@ -336,3 +484,5 @@ void counters::resetTEMP() { countTEMP = 0; }
 
 void counters::resetLabels() { resetLabelIF(); resetLabelWHILE(); }
 void counters::reset() { resetLabels(); resetTEMP(); }
+
+long counters::getNumberOfTEMPs() { return countAllTEMP; }
@@ -38,6 +38,7 @@
 /// predeclaration
 class instructionList;
 class LLVMCodeGen;
+class TCodeProfile;
 
 ////////////////////////////////////////////////////////////////////
 /// Class instruction stores a VM instruction code with its operands
@@ -62,6 +63,11 @@ public:
 
   /// destructor
   ~instruction();
+  /// copy and move (declared because of the destructor)
+  instruction(const instruction &) = default;
+  instruction(instruction &&) = default;
+  instruction & operator=(const instruction &) = default;
+  instruction & operator=(instruction &&) = default;
 
   // concatenation of instruction+list (or instruction+instruction, via automatic coertion)
   instructionList operator||(const instructionList &lst) const;
@@ -177,9 +183,18 @@ public:
   instructionList(const instruction &);
   // destructor
   ~instructionList();
+  // copy and move (declared because of the destructor)
+  instructionList(const instructionList &) = default;
+  instructionList(instructionList &&) = default;
+  instructionList & operator=(const instructionList &) = default;
+  instructionList & operator=(instructionList &&) = default;
 
   // concatenation of lists (or list+instruction, via automatic coertion)
-  instructionList operator||(const instructionList &lst) const;
+  instructionList operator||(const instructionList &lst) const &;
+  // the same, appending to a temporary list instead of copying it
+  instructionList operator||(const instructionList &lst) &&;
+  // the same, moving the instructions of a temporary list
+  instructionList operator||(instructionList &&lst) &&;
 
   // print instructionList
   std::string dump() const;   
@@ -197,6 +212,10 @@ public:
 
   var(const std::string &name, const std::string &type, size_t nelem=1);
   ~var();
+  var(const var &) = default;
+  var(var &&) = default;
+  var & operator=(const var &) = default;
+  var & operator=(var &&) = default;
 
   // print var
   std::string dump() const; 
@@ -225,6 +244,10 @@ public:
   /// constructor and destructor
   subroutine(const std::string &sname);
   ~subroutine();
+  subroutine(const subroutine &) = default;
+  subroutine(subroutine &&) = default;
+  subroutine & operator=(const subroutine &) = default;
+  subroutine & operator=(subroutine &&) = default;
 
   /// get subroutine name
   std::string get_name() const;
@@ -240,6 +263,7 @@ public:
   void add_instructions(const instructionList &lins);
   /// set instruction list (overwritting current instructions)
   void set_instructions(const instructionList &lins);
+  void set_instructions(instructionList &&lins);
   
   /// get instruction at given program counter in subroutine
   instruction get_instruction_at(size_t pc) const;
@@ -247,9 +271,18 @@ public:
   size_t get_label_pc(std::string &lab) const;
   /// get the list of instructions (needed only in LLVMCodeGen)
   instructionList get_instructions() const;
+  /// get the number of instructions
+  size_t get_number_of_instructions() const;
 
   // print subroutine (params, vars, and instructions)
   std::string dump() const;
+
+  /// write the subroutine in a format that can be read back (used by
+  /// the per-function cache)
+  std::string serialize() const;
+  /// rebuild a subroutine from the output of serialize(). Returns
+  /// false (leaving s unspecified) if the text is malformed
+  static bool deserialize(const std::string &text, subroutine &s);
 };
 
 
@@ -267,20 +300,37 @@ public:
   /// constructor and destructor
   code();
   ~code();
+  code(const code &) = default;
+  code(code &&) = default;
+  code & operator=(const code &) = default;
+  code & operator=(code &&) = default;
 
   /// get most recently added subroutine (i.e. the one currently being processed)
   subroutine& get_last_subroutine();
   /// get subroutine by name
   const subroutine& get_subroutine(const std::string &name) const;
+  subroutine& get_subroutine(const std::string &name);
   /// add new subroutine
   void add_subroutine(const subroutine &s);
+  void add_subroutine(subroutine &&s);
   /// get the list of subroutines (needed only in LLVMCodeGen)
   const std::vector<subroutine> & get_subroutine_list() const;
+  /// get the number of instructions of all the subroutines
+  size_t get_number_of_instructions() const;
 
   // print code (all info for all subroutines)
   std::string dump() const;
-  /// print the code in LLVM IR
-  std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols) const;
+  /// print the code in LLVM IR (in SSA form, without memory for the
+  /// scalar variables, if ssaMode; with the I/O done by the runtime
+  /// of runtime/aslrt.c, if runtimeIO; with the counts of profile
+  /// as metadata, if any)
+  std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols,
+                       bool ssaMode = false, bool runtimeIO = false,
+                       const TCodeProfile * profile = nullptr) const;
+  /// print the code in C99
+  std::string dumpC(const TypesMgr & Types, const SymTable &Symbols) const;
+  /// print the code in x86-64 assembler (GNU as)
+  std::string dumpX86(const TypesMgr & Types, const SymTable &Symbols) const;
   
   // Error codes for "HALT" instruction
   static const std::string INDEX_OUT_OF_RANGE;
@@ -298,6 +348,7 @@ private:
   static int countIF;
   static int countWHILE;
   static int countTEMP;
+  static long countAllTEMP;
 
 public:
   // return id for new label or temp (id is a number, but returned as string
@@ -315,4 +366,6 @@ public:
   static void resetLabels();
   // reset all counters (IF, WHILE, and TEMP)
   static void reset();
+  // number of temps created by the process (never reset)
+  static long getNumberOfTEMPs();
 };
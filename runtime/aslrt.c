@@ -0,0 +1,428 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    aslrt - Run-time support of the LLVM IR generated for the Asl
+//            programming language with --llvmRuntime: buffered
+//            reads and writes with the format of printf/scanf
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+// Compiled along with the .ll of the program, or linked with the .s
+// of --x86:
+//   clang prog.ll runtime/aslrt.c
+//   as prog.s -o prog.o && cc prog.o runtime/aslrt.c -lm
+//
+// The output is the same as the one of printf "%d", "%g" and putchar,
+// and the values read are the ones of scanf "%d", "%g" and " %c" (a
+// char is read after the white space, as in the tvm; a failed read
+// leaves the variable unchanged). The output is written
+// when the buffer is full, before waiting for input and at exit.
+
+#include <errno.h>
+#include <iso646.h>   // and, or, not
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>   // read, write
+
+
+#define OUT_SIZE   (1 << 16)
+#define IN_SIZE    (1 << 16)
+#define TOKEN_SIZE 512
+
+static char   outBuf[OUT_SIZE];
+static size_t outLen = 0;
+static int    flushAtExit = 0;
+
+static char   inBuf[IN_SIZE];
+static size_t inPos = 0, inLen = 0;
+static int    inEOF = 0;
+
+
+//////////////////////////////////////////////////////////////////////
+// Output
+
+static void flushOutput(void) {
+  size_t done = 0;
+  while (done < outLen) {
+    ssize_t n = write(1, outBuf + done, outLen - done);
+    if (n < 0 and errno == EINTR) continue;
+    if (n <= 0) break;
+    done += n;
+  }
+  outLen = 0;
+}
+
+static void reserveOutput(size_t n) {
+  if (not flushAtExit) {
+    // also when the program halts (exit)
+    atexit(flushOutput);
+    flushAtExit = 1;
+  }
+  if (outLen + n > OUT_SIZE) flushOutput();
+}
+
+static void putBytes(const char *s, size_t n) {
+  if (n > OUT_SIZE) {
+    reserveOutput(OUT_SIZE);
+    flushOutput();
+    while (n > 0) {
+      ssize_t w = write(1, s, n);
+      if (w < 0 and errno == EINTR) continue;
+      if (w <= 0) break;
+      s += w;
+      n -= w;
+    }
+    return;
+  }
+  reserveOutput(n);
+  memcpy(outBuf + outLen, s, n);
+  outLen += n;
+}
+
+// The decimal digits of v, from the end of buf; returns the first one
+static char *formatUnsigned(uint64_t v, char *end) {
+  char *p = end;
+  do {
+    *--p = '0' + v % 10;
+    v /= 10;
+  } while (v != 0);
+  return p;
+}
+
+void __asl_write_int(int32_t v) {
+  char buf[16];
+  char *end = buf + sizeof(buf);
+  uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+  char *p = formatUnsigned(u, end);
+  if (v < 0) *--p = '-';
+  putBytes(p, end - p);
+}
+
+void __asl_write_char(int32_t c) {
+  reserveOutput(1);
+  outBuf[outLen++] = (char)c;
+}
+
+void __asl_write_str(const char *s, int32_t n) {
+  putBytes(s, n);
+}
+
+
+// Float output: "%g", that is, the value rounded to 6 significant
+// digits (the exact value, rounding half to even), in fixed notation
+// if its exponent is in [-4, 6) and in scientific notation otherwise,
+// without the trailing zeros of the fraction.
+
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 uint128;
+
+// The integer part of m * 2^e * 10^s, and whether it has to be
+// rounded up (the rest is over a half, or a half and it is odd), if
+// it can be computed exactly in 128 bits (always, but for the values
+// below 1e-20 or so)
+static int scaleExactly(uint64_t m, int e, int s, uint64_t *fl, int *roundUp) {
+  static const uint128 MAX = ~(uint128)0;
+  uint128 num = m, den = 1, p10 = 1;
+  int i;
+  for (i = 0; i < (s < 0 ? -s : s); ++i) {
+    if (p10 > MAX / 10) return 0;
+    p10 *= 10;
+  }
+  if (e >= 0) {
+    if (e > 127 or num > (MAX >> e)) return 0;
+    num <<= e;
+  }
+  else {
+    if (-e > 126) return 0;
+    den <<= -e;
+  }
+  if (s >= 0) {
+    if (num > MAX / p10) return 0;
+    num *= p10;
+  }
+  else {
+    if (den > (MAX >> 1) / p10) return 0;
+    den *= p10;
+  }
+  uint128 q = num / den, r = num % den;
+  if (q > UINT64_MAX) return 0;
+  *fl = (uint64_t)q;
+  *roundUp = 2*r > den or (2*r == den and (q & 1));
+  return 1;
+}
+
+// The 6 significant digits of d > 0 (in [100000, 999999]) and the
+// decimal exponent of the first one
+static int roundTo6Digits(double d, uint64_t *digits, int *exp10) {
+  int e2;
+  double f = frexp(d, &e2);
+  uint64_t m = (uint64_t)ldexp(f, 53);
+  int e = e2 - 53;
+  while ((m & 1) == 0) {
+    m >>= 1;
+    ++e;
+  }
+  // the estimate of the exponent can be one off
+  int x = (int)floor(log10(d));
+  int tries;
+  for (tries = 0; tries < 3; ++tries) {
+    uint64_t q;
+    int roundUp;
+    if (not scaleExactly(m, e, 5 - x, &q, &roundUp)) return 0;
+    if (q >= 1000000) {
+      ++x;
+      continue;
+    }
+    if (q < 100000) {
+      --x;
+      continue;
+    }
+    q += roundUp;
+    if (q == 1000000) {            // rounded up to the next power of 10
+      q = 100000;
+      ++x;
+    }
+    *digits = q;
+    *exp10 = x;
+    return 1;
+  }
+  return 0;
+}
+#else
+static int roundTo6Digits(double d, uint64_t *digits, int *exp10) {
+  (void)d; (void)digits; (void)exp10;
+  return 0;
+}
+#endif
+
+void __asl_write_float(double d) {
+  char buf[32];
+  size_t n = 0;
+  if (signbit(d)) {
+    buf[n++] = '-';
+    d = -d;
+  }
+  uint64_t digits;
+  int x;
+  if (isnan(d) or isinf(d) or d == 0.0) {
+    const char *s = isnan(d) ? "nan" : isinf(d) ? "inf" : "0";
+    putBytes(buf, n);
+    putBytes(s, strlen(s));
+    return;
+  }
+  if (not roundTo6Digits(d, &digits, &x)) {
+    snprintf(buf + n, sizeof(buf) - n, "%g", d);
+    putBytes(buf, strlen(buf));
+    return;
+  }
+  char ds[6];
+  formatUnsigned(digits, ds + 6);
+  int last = 5;                        // last digit that is not a trailing zero
+  while (last > 0 and ds[last] == '0') --last;
+  int i;
+  if (x < -4 or x >= 6) {
+    buf[n++] = ds[0];
+    if (last > 0) {
+      buf[n++] = '.';
+      for (i = 1; i <= last; ++i) buf[n++] = ds[i];
+    }
+    buf[n++] = 'e';
+    buf[n++] = x < 0 ? '-' : '+';
+    int ax = x < 0 ? -x : x;
+    if (ax >= 100) buf[n++] = '0' + ax / 100;
+    buf[n++] = '0' + ax / 10 % 10;
+    buf[n++] = '0' + ax % 10;
+  }
+  else if (x >= 0) {
+    for (i = 0; i <= x; ++i) buf[n++] = ds[i];
+    if (last > x) {
+      buf[n++] = '.';
+      for (i = x + 1; i <= last; ++i) buf[n++] = ds[i];
+    }
+  }
+  else {
+    buf[n++] = '0';
+    buf[n++] = '.';
+    for (i = 0; i < -x - 1; ++i) buf[n++] = '0';
+    for (i = 0; i <= last; ++i) buf[n++] = ds[i];
+  }
+  putBytes(buf, n);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// Input
+
+// The next char of the input (without consuming it), or EOF
+static int peekChar(void) {
+  if (inPos < inLen) return (unsigned char)inBuf[inPos];
+  if (inEOF) return EOF;
+  // the output written so far is seen before waiting for input
+  flushOutput();
+  for (;;) {
+    ssize_t n = read(0, inBuf, IN_SIZE);
+    if (n < 0 and errno == EINTR) continue;
+    if (n <= 0) {
+      inEOF = 1;
+      return EOF;
+    }
+    inPos = 0;
+    inLen = n;
+    return (unsigned char)inBuf[0];
+  }
+}
+
+static int isSpace(int c) {
+  return c == ' ' or c == '\t' or c == '\n' or c == '\v' or c == '\f' or c == '\r';
+}
+
+static int isDigit(int c) {
+  return c >= '0' and c <= '9';
+}
+
+static void skipSpaces(void) {
+  while (isSpace(peekChar())) ++inPos;
+}
+
+// As scanf "%d" does (with the semantics of strtol), the number is
+// read into a 64-bit value, saturated to its range, and truncated
+void __asl_read_int(int32_t *v) {
+  skipSpaces();
+  int negative = 0;
+  int c = peekChar();
+  if (c == '-' or c == '+') {
+    negative = (c == '-');
+    ++inPos;
+  }
+  if (not isDigit(peekChar())) return;
+  uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+  uint64_t u = 0;
+  while (isDigit(c = peekChar())) {
+    unsigned d = c - '0';
+    u = (u > (limit - d) / 10) ? limit : u * 10 + d;
+    ++inPos;
+  }
+  *v = (int32_t)(uint32_t)(negative ? 0 - u : u);
+}
+
+void __asl_read_char(char *v) {
+  skipSpaces();
+  int c = peekChar();
+  if (c == EOF) return;
+  ++inPos;
+  *v = (char)c;
+}
+
+// Append the chars of the input while they match the word (ignoring
+// the case); returns the number of them
+static size_t matchWord(const char *word, char *token, size_t *n) {
+  size_t i;
+  for (i = 0; word[i] != '\0' and *n < TOKEN_SIZE - 1; ++i) {
+    int c = peekChar();
+    if (c == EOF or (c | 0x20) != word[i]) break;
+    token[(*n)++] = (char)c;
+    ++inPos;
+  }
+  return i;
+}
+
+static int isHexDigit(int c) {
+  return isDigit(c) or ((c | 0x20) >= 'a' and (c | 0x20) <= 'f');
+}
+
+// Append the (hex) digits of the input; returns the number of them
+static size_t appendDigits(int hex, char *token, size_t *n) {
+  size_t digits = 0;
+  int c;
+  while ((hex ? isHexDigit(c = peekChar()) : isDigit(c = peekChar())) and
+         *n < TOKEN_SIZE - 1) {
+    token[(*n)++] = (char)c;
+    ++inPos;
+    ++digits;
+  }
+  return digits;
+}
+
+// The token of a decimal float ([sign] digits [. digits] [e [sign]
+// digits]), a hex float ([sign] 0x hexdigits [. hexdigits] [p [sign]
+// digits]), an infinity or a nan is read and converted by strtof. As
+// scanf does, a "0x" not followed by hex digits nor a '.' is a failed read
+void __asl_read_float(float *v) {
+  char token[TOKEN_SIZE];
+  size_t n = 0, digits = 0;
+  int c, hex = 0;
+  skipSpaces();
+  c = peekChar();
+  if (c == '-' or c == '+') {
+    token[n++] = (char)c;
+    ++inPos;
+  }
+  c = peekChar();
+  if ((c | 0x20) == 'i') {
+    if (matchWord("inf", token, &n) == 3) matchWord("inity", token, &n);
+  }
+  else if ((c | 0x20) == 'n') {
+    matchWord("nan", token, &n);
+  }
+  else {
+    if (c == '0') {
+      token[n++] = (char)c;
+      ++inPos;
+      ++digits;
+      if ((peekChar() | 0x20) == 'x') {
+        token[n++] = (char)peekChar();
+        ++inPos;
+        hex = 1;
+        digits = 0;
+      }
+    }
+    digits += appendDigits(hex, token, &n);
+    c = peekChar();
+    if (hex and digits == 0 and c != '.') return;
+    if (c == '.' and n < TOKEN_SIZE - 1) {
+      token[n++] = (char)c;
+      ++inPos;
+      digits += appendDigits(hex, token, &n);
+      c = peekChar();
+    }
+    if (digits > 0 and (c | 0x20) == (hex ? 'p' : 'e') and n < TOKEN_SIZE - 3) {
+      token[n++] = (char)c;
+      ++inPos;
+      c = peekChar();
+      if (c == '-' or c == '+') {
+        token[n++] = (char)c;
+        ++inPos;
+      }
+      appendDigits(0, token, &n);
+    }
+  }
+  token[n] = '\0';
+  char *end;
+  float f = strtof(token, &end);
+  if (end != token) *v = f;
+}